@@ -0,0 +1,241 @@
+//
+// BenchmarkRunner.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "BenchmarkRunner.h"
+
+#include "time/TaskTimer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Two-tailed critical values of Student's t-distribution for a 95% confidence
+// interval, indexed by degrees of freedom. Larger sample counts use the normal
+// approximation.
+static const double kStudentT95[] = {
+    0.0,    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+    2.228,  2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+    2.086,  2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+    2.042};
+static const unsigned int kStudentT95Size =
+    sizeof(kStudentT95) / sizeof(double);
+
+BenchmarkSuite newBenchmarkSuite(char *name) {
+  BenchmarkSuite suite = (BenchmarkSuite)malloc(sizeof(BenchmarkSuiteMembers));
+  suite->name = name;
+  suite->benchmarks = newLinkedList();
+  return suite;
+}
+
+void addBenchmark(BenchmarkSuite self, char *name, char *unitName,
+                  unsigned long unitsPerIteration, BenchmarkSetupFunc setup,
+                  BenchmarkRunFunc run, BenchmarkTeardownFunc teardown) {
+  Benchmark benchmark = (Benchmark)malloc(sizeof(BenchmarkMembers));
+  benchmark->name = name;
+  benchmark->unitName = unitName;
+  benchmark->unitsPerIteration = unitsPerIteration;
+  benchmark->setup = setup;
+  benchmark->run = run;
+  benchmark->teardown = teardown;
+  linkedListAppend(self->benchmarks, benchmark);
+}
+
+Benchmark findBenchmark(BenchmarkSuite self, const char *name) {
+  LinkedListIterator iterator = self->benchmarks;
+
+  while (iterator != NULL && iterator->item != NULL) {
+    Benchmark benchmark = (Benchmark)iterator->item;
+
+    if (!strcmp(benchmark->name, name)) {
+      return benchmark;
+    }
+
+    iterator = (LinkedListIterator)iterator->nextItem;
+  }
+
+  return NULL;
+}
+
+void freeBenchmarkSuite(BenchmarkSuite self) {
+  if (self != NULL) {
+    freeLinkedListAndItems(self->benchmarks, free);
+    free(self);
+  }
+}
+
+BenchmarkRunner newBenchmarkRunner(JsonWriter jsonWriter) {
+  BenchmarkRunner runner =
+      (BenchmarkRunner)malloc(sizeof(BenchmarkRunnerMembers));
+  runner->numSamples = DEFAULT_BENCHMARK_SAMPLES;
+  runner->numWarmupSamples = DEFAULT_BENCHMARK_WARMUP_SAMPLES;
+  runner->minSampleTimeInMs = DEFAULT_BENCHMARK_SAMPLE_TIME_IN_MS;
+  runner->jsonWriter = jsonWriter;
+  return runner;
+}
+
+static unsigned long long _runIterations(const Benchmark benchmark,
+                                         void *userData,
+                                         unsigned long iterations) {
+  unsigned long long startTime = taskTimerGetCurrentTimeInNs();
+  unsigned long i;
+
+  for (i = 0; i < iterations; i++) {
+    benchmark->run(userData);
+  }
+
+  return taskTimerGetCurrentTimeInNs() - startTime;
+}
+
+static void _writeResult(JsonWriter jsonWriter, const BenchmarkSuite suite,
+                         const Benchmark benchmark,
+                         const BenchmarkResult result) {
+  jsonWriterBeginObject(jsonWriter, NULL);
+  jsonWriterWriteString(jsonWriter, "suite", suite->name);
+  jsonWriterWriteString(jsonWriter, "name", benchmark->name);
+  jsonWriterWriteString(jsonWriter, "unit", benchmark->unitName);
+  jsonWriterWriteUnsignedLong(jsonWriter, "unitsPerIteration",
+                              benchmark->unitsPerIteration);
+  jsonWriterWriteUnsignedLong(jsonWriter, "iterationsPerSample",
+                              result->iterationsPerSample);
+  jsonWriterWriteUnsignedLong(jsonWriter, "samples", result->numSamples);
+  jsonWriterWriteDouble(jsonWriter, "meanNsPerUnit", result->meanNsPerUnit);
+  jsonWriterWriteDouble(jsonWriter, "stddevNsPerUnit",
+                        result->stddevNsPerUnit);
+  jsonWriterWriteDouble(jsonWriter, "ci95NsPerUnit",
+                        result->confidenceIntervalNsPerUnit);
+  jsonWriterWriteDouble(jsonWriter, "minNsPerUnit", result->minNsPerUnit);
+  jsonWriterWriteDouble(jsonWriter, "maxNsPerUnit", result->maxNsPerUnit);
+  jsonWriterEndObject(jsonWriter);
+}
+
+BenchmarkResult benchmarkRunnerRun(BenchmarkRunner self,
+                                   const BenchmarkSuite suite,
+                                   const Benchmark benchmark) {
+  BenchmarkResult result =
+      (BenchmarkResult)malloc(sizeof(BenchmarkResultMembers));
+  const unsigned long long minSampleTimeInNs =
+      (unsigned long long)(self->minSampleTimeInMs * 1000000.0);
+  const unsigned int numSamples = self->numSamples > 0 ? self->numSamples : 1;
+  double *samples = (double *)malloc(sizeof(double) * numSamples);
+  void *userData = NULL;
+  double unitsPerSample, sum = 0.0, sumOfSquares = 0.0;
+  unsigned long iterations = 1;
+  unsigned int i;
+
+  if (benchmark->setup != NULL) {
+    userData = benchmark->setup();
+  }
+
+  // Double the number of iterations until a single sample takes long enough
+  // to be measured accurately
+  while (_runIterations(benchmark, userData, iterations) < minSampleTimeInNs) {
+    iterations *= 2;
+  }
+
+  for (i = 0; i < self->numWarmupSamples; i++) {
+    _runIterations(benchmark, userData, iterations);
+  }
+
+  unitsPerSample = (double)iterations * benchmark->unitsPerIteration;
+  result->iterationsPerSample = iterations;
+  result->numSamples = numSamples;
+
+  for (i = 0; i < numSamples; i++) {
+    samples[i] =
+        _runIterations(benchmark, userData, iterations) / unitsPerSample;
+    sum += samples[i];
+  }
+
+  if (benchmark->teardown != NULL) {
+    benchmark->teardown(userData);
+  }
+
+  result->meanNsPerUnit = sum / numSamples;
+  result->minNsPerUnit = samples[0];
+  result->maxNsPerUnit = samples[0];
+
+  for (i = 0; i < numSamples; i++) {
+    const double delta = samples[i] - result->meanNsPerUnit;
+    sumOfSquares += delta * delta;
+
+    if (samples[i] < result->minNsPerUnit) {
+      result->minNsPerUnit = samples[i];
+    }
+
+    if (samples[i] > result->maxNsPerUnit) {
+      result->maxNsPerUnit = samples[i];
+    }
+  }
+
+  if (numSamples > 1) {
+    result->stddevNsPerUnit = sqrt(sumOfSquares / (numSamples - 1));
+    result->confidenceIntervalNsPerUnit =
+        (numSamples - 1 < kStudentT95Size ? kStudentT95[numSamples - 1]
+                                          : 1.96) *
+        result->stddevNsPerUnit / sqrt((double)numSamples);
+  } else {
+    result->stddevNsPerUnit = 0.0;
+    result->confidenceIntervalNsPerUnit = 0.0;
+  }
+
+  if (self->jsonWriter != NULL) {
+    _writeResult(self->jsonWriter, suite, benchmark, result);
+  }
+
+  free(samples);
+  return result;
+}
+
+static void _runBenchmark(void *item, void *userData) {
+  Benchmark benchmark = (Benchmark)item;
+  void **args = (void **)userData;
+  BenchmarkRunner runner = (BenchmarkRunner)args[0];
+  BenchmarkSuite suite = (BenchmarkSuite)args[1];
+  BenchmarkResult result;
+
+  printf("  %s: ", benchmark->name);
+  fflush(stdout);
+  result = benchmarkRunnerRun(runner, suite, benchmark);
+  printf("%.3f ns/%s (+/- %.3f, min %.3f, stddev %.3f)\n",
+         result->meanNsPerUnit, benchmark->unitName,
+         result->confidenceIntervalNsPerUnit, result->minNsPerUnit,
+         result->stddevNsPerUnit);
+  freeBenchmarkResult(result);
+}
+
+void benchmarkRunnerRunSuite(BenchmarkRunner self, const BenchmarkSuite suite) {
+  void *args[2];
+  args[0] = self;
+  args[1] = suite;
+
+  printf("Running benchmarks in %s\n", suite->name);
+  linkedListForeach(suite->benchmarks, _runBenchmark, args);
+}
+
+void freeBenchmarkResult(BenchmarkResult self) { free(self); }
+
+void freeBenchmarkRunner(BenchmarkRunner self) { free(self); }
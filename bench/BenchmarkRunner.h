@@ -0,0 +1,125 @@
+//
+// BenchmarkRunner.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatsonBench_BenchmarkRunner_h
+#define MrsWatsonBench_BenchmarkRunner_h
+
+#include "base/CharString.h"
+#include "base/JsonWriter.h"
+#include "base/LinkedList.h"
+
+#define DEFAULT_BENCHMARK_SAMPLES 20
+#define DEFAULT_BENCHMARK_WARMUP_SAMPLES 3
+#define DEFAULT_BENCHMARK_SAMPLE_TIME_IN_MS 20.0
+
+/**
+ * Called once before a benchmark is run. The returned pointer is passed to the
+ * run and teardown functions, and may be NULL if no data is needed.
+ */
+typedef void *(*BenchmarkSetupFunc)(void);
+/**
+ * Run one iteration of the benchmark, which should process exactly
+ * unitsPerIteration units (frames, events, items, etc.) of work.
+ */
+typedef void (*BenchmarkRunFunc)(void *userData);
+typedef void (*BenchmarkTeardownFunc)(void *userData);
+
+typedef struct {
+  char *name;
+  char *unitName;
+  unsigned long unitsPerIteration;
+  BenchmarkSetupFunc setup;
+  BenchmarkRunFunc run;
+  BenchmarkTeardownFunc teardown;
+} BenchmarkMembers;
+typedef BenchmarkMembers *Benchmark;
+
+typedef struct {
+  char *name;
+  LinkedList benchmarks;
+} BenchmarkSuiteMembers;
+typedef BenchmarkSuiteMembers *BenchmarkSuite;
+
+typedef struct {
+  unsigned long iterationsPerSample;
+  unsigned int numSamples;
+  double meanNsPerUnit;
+  double stddevNsPerUnit;
+  double confidenceIntervalNsPerUnit;
+  double minNsPerUnit;
+  double maxNsPerUnit;
+} BenchmarkResultMembers;
+typedef BenchmarkResultMembers *BenchmarkResult;
+
+typedef struct {
+  unsigned int numSamples;
+  unsigned int numWarmupSamples;
+  double minSampleTimeInMs;
+  JsonWriter jsonWriter;
+} BenchmarkRunnerMembers;
+typedef BenchmarkRunnerMembers *BenchmarkRunner;
+
+BenchmarkSuite newBenchmarkSuite(char *name);
+void addBenchmark(BenchmarkSuite self, char *name, char *unitName,
+                  unsigned long unitsPerIteration, BenchmarkSetupFunc setup,
+                  BenchmarkRunFunc run, BenchmarkTeardownFunc teardown);
+Benchmark findBenchmark(BenchmarkSuite self, const char *name);
+void freeBenchmarkSuite(BenchmarkSuite self);
+
+/**
+ * Create a new benchmark runner
+ * @param jsonWriter If not NULL, results are written to this writer as
+ * objects. The caller is responsible for opening and closing the enclosing
+ * array.
+ * @return Initialized BenchmarkRunner
+ */
+BenchmarkRunner newBenchmarkRunner(JsonWriter jsonWriter);
+
+/**
+ * Run a single benchmark. The number of iterations in each sample is first
+ * calibrated so that a sample takes at least minSampleTimeInMs, which also
+ * serves to warm up caches and the branch predictor. Then a number of warm-up
+ * samples are discarded before the measured samples are taken.
+ * @param self
+ * @param suite Suite which the benchmark belongs to
+ * @param benchmark Benchmark to run
+ * @return Results, which must be freed by the caller
+ */
+BenchmarkResult benchmarkRunnerRun(BenchmarkRunner self,
+                                   const BenchmarkSuite suite,
+                                   const Benchmark benchmark);
+
+/**
+ * Run all benchmarks in a suite and print the results
+ * @param self
+ * @param suite Suite to run
+ */
+void benchmarkRunnerRunSuite(BenchmarkRunner self, const BenchmarkSuite suite);
+
+void freeBenchmarkResult(BenchmarkResult self);
+void freeBenchmarkRunner(BenchmarkRunner self);
+
+#endif
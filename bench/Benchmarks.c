@@ -0,0 +1,87 @@
+//
+// Benchmarks.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "BenchmarkRunner.h"
+
+#include <stdio.h>
+
+extern BenchmarkSuite addInternalPluginBenchmarks(void);
+extern BenchmarkSuite addLinkedListBenchmarks(void);
+extern BenchmarkSuite addMidiSequenceBenchmarks(void);
+extern BenchmarkSuite addMidiSourceFileBenchmarks(void);
+extern BenchmarkSuite addPcmSampleBufferBenchmarks(void);
+extern BenchmarkSuite addSampleBufferBenchmarks(void);
+extern BenchmarkSuite addSampleSourceWaveBenchmarks(void);
+
+LinkedList getBenchmarkSuites(void);
+LinkedList getBenchmarkSuites(void) {
+  LinkedList benchmarkSuites = newLinkedList();
+
+  linkedListAppend(benchmarkSuites, addInternalPluginBenchmarks());
+  linkedListAppend(benchmarkSuites, addLinkedListBenchmarks());
+  linkedListAppend(benchmarkSuites, addMidiSequenceBenchmarks());
+  linkedListAppend(benchmarkSuites, addMidiSourceFileBenchmarks());
+  linkedListAppend(benchmarkSuites, addPcmSampleBufferBenchmarks());
+  linkedListAppend(benchmarkSuites, addSampleBufferBenchmarks());
+  linkedListAppend(benchmarkSuites, addSampleSourceWaveBenchmarks());
+
+  return benchmarkSuites;
+}
+
+BenchmarkSuite findBenchmarkSuite(LinkedList benchmarkSuites,
+                                  const CharString name);
+BenchmarkSuite findBenchmarkSuite(LinkedList benchmarkSuites,
+                                  const CharString name) {
+  LinkedListIterator iterator = benchmarkSuites;
+
+  while (iterator != NULL && iterator->item != NULL) {
+    BenchmarkSuite suite = (BenchmarkSuite)iterator->item;
+
+    if (charStringIsEqualToCString(name, suite->name, true)) {
+      return suite;
+    }
+
+    iterator = (LinkedListIterator)iterator->nextItem;
+  }
+
+  return NULL;
+}
+
+static void _printBenchmarkName(void *item, void *userData) {
+  Benchmark benchmark = (Benchmark)item;
+  BenchmarkSuite suite = (BenchmarkSuite)userData;
+  printf("%s:%s\n", suite->name, benchmark->name);
+}
+
+static void _printBenchmarkSuite(void *item, void *userData) {
+  BenchmarkSuite suite = (BenchmarkSuite)item;
+  linkedListForeach(suite->benchmarks, _printBenchmarkName, suite);
+}
+
+void printBenchmarks(LinkedList benchmarkSuites);
+void printBenchmarks(LinkedList benchmarkSuites) {
+  linkedListForeach(benchmarkSuites, _printBenchmarkSuite, NULL);
+}
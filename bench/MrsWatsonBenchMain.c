@@ -0,0 +1,261 @@
+//
+// MrsWatsonBenchMain.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "MrsWatsonBenchMain.h"
+
+#include "BenchmarkRunner.h"
+#include "app/BuildInfo.h"
+#include "app/ProgramOption.h"
+#include "base/PlatformInfo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern LinkedList getBenchmarkSuites(void);
+extern BenchmarkSuite findBenchmarkSuite(LinkedList benchmarkSuites,
+                                         const CharString name);
+extern void printBenchmarks(LinkedList benchmarkSuites);
+
+static ProgramOptions _newBenchProgramOptions(void) {
+  ProgramOptions programOptions = newProgramOptions(NUM_BENCH_OPTIONS);
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(OPTION_BENCH_SUITE, "suite",
+                               "Choose a benchmark suite to run. Run with "
+                               "'--list' option to see all benchmarks.",
+                               true, kProgramOptionTypeString,
+                               kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_NAME, "benchmark",
+          "Run a single benchmark. Benchmarks are named 'Suite:Name', for \
+example:\n\t-b 'SampleBuffer:CopyStereoToStereo'",
+          true, kProgramOptionTypeString, kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_PRINT_BENCHMARKS, "list",
+          "List all benchmarks in the same format required by --benchmark",
+          true, kProgramOptionTypeEmpty, kProgramOptionArgumentTypeNone));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_OUTPUT, "output",
+          "Write results to the given file in JSON format. This file can be \
+kept as a baseline and compared with the results of another build. Two \
+results for the same benchmark differ significantly when their confidence \
+intervals (mean +/- ci95NsPerUnit) do not overlap.",
+          true, kProgramOptionTypeString, kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(OPTION_BENCH_SAMPLES, "samples",
+                               "Number of measured samples for each benchmark",
+                               true, kProgramOptionTypeNumber,
+                               kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(programOptions, OPTION_BENCH_SAMPLES,
+                          DEFAULT_BENCHMARK_SAMPLES);
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_SAMPLE_TIME, "sample-time",
+          "Minimum time for each sample, in milliseconds. Benchmarks are \
+repeated within a sample until this much time has elapsed.",
+          true, kProgramOptionTypeNumber, kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(programOptions, OPTION_BENCH_SAMPLE_TIME,
+                          (float)DEFAULT_BENCHMARK_SAMPLE_TIME_IN_MS);
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_HELP, "help", "Print full program help (this screen), "
+                                     "or just the help for a single argument.",
+          true, kProgramOptionTypeString, kProgramOptionArgumentTypeOptional));
+
+  return programOptions;
+}
+
+static JsonWriter _newBenchmarkJsonWriter(const CharString outputPath,
+                                          const BenchmarkRunner runner) {
+  JsonWriter jsonWriter = newJsonWriterWithPath(outputPath);
+  PlatformInfo platform;
+  CharString versionString;
+
+  if (jsonWriter == NULL) {
+    return NULL;
+  }
+
+  platform = newPlatformInfo();
+  versionString = buildInfoGetVersionString();
+
+  jsonWriterBeginObject(jsonWriter, NULL);
+  jsonWriterWriteString(jsonWriter, "version", versionString->data);
+  jsonWriterWriteString(jsonWriter, "platform", platform->shortName->data);
+  jsonWriterWriteBool(jsonWriter, "is64Bit", platform->is64BitRuntime);
+  jsonWriterWriteUnsignedLong(jsonWriter, "samples", runner->numSamples);
+  jsonWriterWriteDouble(jsonWriter, "sampleTimeInMs",
+                        runner->minSampleTimeInMs);
+  jsonWriterBeginArray(jsonWriter, "benchmarks");
+
+  freeCharString(versionString);
+  freePlatformInfo(platform);
+  return jsonWriter;
+}
+
+static void _runBenchmarkSuite(void *item, void *userData) {
+  benchmarkRunnerRunSuite((BenchmarkRunner)userData, (BenchmarkSuite)item);
+}
+
+int main(int argc, char *argv[]) {
+  ProgramOptions programOptions;
+  LinkedList benchmarkSuites = NULL;
+  BenchmarkSuite suite = NULL;
+  Benchmark benchmark = NULL;
+  BenchmarkRunner runner = NULL;
+  BenchmarkResult result = NULL;
+  JsonWriter jsonWriter = NULL;
+  CharString suiteName = NULL;
+  char *benchmarkArgument;
+  char *colon;
+  int returnCode = 0;
+
+  programOptions = _newBenchProgramOptions();
+
+  if (!programOptionsParseArgs(programOptions, argc, argv)) {
+    printf("Or run with --help (option) to see help for a single option\n");
+    freeProgramOptions(programOptions);
+    return -1;
+  }
+
+  if (programOptions->options[OPTION_BENCH_HELP]->enabled) {
+    printf("Run with '--help full' to see extended help for all options.\n");
+
+    if (charStringIsEmpty(
+            programOptionsGetString(programOptions, OPTION_BENCH_HELP))) {
+      printf("All options, where <argument> is required and [argument] is "
+             "optional\n");
+      programOptionsPrintHelp(programOptions, false, DEFAULT_INDENT_SIZE);
+    } else {
+      programOptionsPrintHelp(programOptions, true, DEFAULT_INDENT_SIZE);
+    }
+
+    freeProgramOptions(programOptions);
+    return -1;
+  }
+
+  benchmarkSuites = getBenchmarkSuites();
+
+  if (programOptions->options[OPTION_BENCH_PRINT_BENCHMARKS]->enabled) {
+    printBenchmarks(benchmarkSuites);
+    freeLinkedListAndItems(benchmarkSuites,
+                           (LinkedListFreeItemFunc)freeBenchmarkSuite);
+    freeProgramOptions(programOptions);
+    return -1;
+  }
+
+  runner = newBenchmarkRunner(NULL);
+  runner->numSamples = (unsigned int)programOptionsGetNumber(
+      programOptions, OPTION_BENCH_SAMPLES);
+  runner->minSampleTimeInMs =
+      programOptionsGetNumber(programOptions, OPTION_BENCH_SAMPLE_TIME);
+
+  if (programOptions->options[OPTION_BENCH_OUTPUT]->enabled) {
+    jsonWriter = _newBenchmarkJsonWriter(
+        programOptionsGetString(programOptions, OPTION_BENCH_OUTPUT), runner);
+
+    if (jsonWriter == NULL) {
+      printf("ERROR: Could not open output file\n");
+      freeBenchmarkRunner(runner);
+      freeLinkedListAndItems(benchmarkSuites,
+                             (LinkedListFreeItemFunc)freeBenchmarkSuite);
+      freeProgramOptions(programOptions);
+      return -1;
+    }
+
+    runner->jsonWriter = jsonWriter;
+  }
+
+  if (programOptions->options[OPTION_BENCH_NAME]->enabled) {
+    benchmarkArgument =
+        programOptionsGetString(programOptions, OPTION_BENCH_NAME)->data;
+    colon = strchr(benchmarkArgument, ':');
+
+    if (colon == NULL) {
+      printf("ERROR: Invalid benchmark name\n");
+      programOptionPrintHelp(programOptions->options[OPTION_BENCH_NAME], true,
+                             DEFAULT_INDENT_SIZE, 0);
+      returnCode = -1;
+    } else {
+      *colon = '\0';
+      suiteName = programOptionsGetString(programOptions, OPTION_BENCH_NAME);
+      suite = findBenchmarkSuite(benchmarkSuites, suiteName);
+
+      if (suite != NULL) {
+        benchmark = findBenchmark(suite, colon + 1);
+      }
+
+      if (benchmark == NULL) {
+        printf("ERROR: Could not find benchmark '%s:%s'\n", suiteName->data,
+               colon + 1);
+        returnCode = -1;
+      } else {
+        result = benchmarkRunnerRun(runner, suite, benchmark);
+        printf("%s:%s: %.3f ns/%s (+/- %.3f, min %.3f, stddev %.3f)\n",
+               suite->name, benchmark->name, result->meanNsPerUnit,
+               benchmark->unitName, result->confidenceIntervalNsPerUnit,
+               result->minNsPerUnit, result->stddevNsPerUnit);
+        freeBenchmarkResult(result);
+      }
+    }
+  } else if (programOptions->options[OPTION_BENCH_SUITE]->enabled) {
+    suiteName = programOptionsGetString(programOptions, OPTION_BENCH_SUITE);
+    suite = findBenchmarkSuite(benchmarkSuites, suiteName);
+
+    if (suite == NULL) {
+      printf("ERROR: Invalid benchmark suite '%s'\n", suiteName->data);
+      printf("Run with '--list' to show all benchmarks\n");
+      returnCode = -1;
+    } else {
+      benchmarkRunnerRunSuite(runner, suite);
+    }
+  } else {
+    linkedListForeach(benchmarkSuites, _runBenchmarkSuite, runner);
+  }
+
+  freeJsonWriter(jsonWriter);
+  freeBenchmarkRunner(runner);
+  freeLinkedListAndItems(benchmarkSuites,
+                         (LinkedListFreeItemFunc)freeBenchmarkSuite);
+  freeProgramOptions(programOptions);
+  return returnCode;
+}
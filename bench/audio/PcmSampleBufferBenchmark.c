@@ -0,0 +1,128 @@
+//
+// PcmSampleBufferBenchmark.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/PcmSampleBuffer.h"
+#include "BenchmarkRunner.h"
+
+#include <stdlib.h>
+
+#define BENCHMARK_BLOCKSIZE 512
+#define BENCHMARK_CHANNELS 2
+
+typedef struct {
+  PcmSampleBuffer pcmSampleBuffer;
+  SampleBuffer sampleBuffer;
+} PcmSampleBufferData;
+
+static void *_newPcmSampleBufferData(BitDepth bitDepth, boolByte littleEndian) {
+  PcmSampleBufferData *data =
+      (PcmSampleBufferData *)malloc(sizeof(PcmSampleBufferData));
+  SampleCount i;
+  ChannelCount j;
+
+  data->pcmSampleBuffer =
+      newPcmSampleBuffer(BENCHMARK_CHANNELS, BENCHMARK_BLOCKSIZE, bitDepth);
+  data->pcmSampleBuffer->littleEndian = littleEndian;
+  data->sampleBuffer = newSampleBuffer(BENCHMARK_CHANNELS, BENCHMARK_BLOCKSIZE);
+
+  // Use a simple ramp rather than silence, so that conversion of the sign bits
+  // is also exercised
+  for (j = 0; j < BENCHMARK_CHANNELS; j++) {
+    for (i = 0; i < BENCHMARK_BLOCKSIZE; i++) {
+      data->sampleBuffer->samples[j][i] =
+          (Sample)(2.0 * i / BENCHMARK_BLOCKSIZE - 1.0) * 0.9f;
+    }
+  }
+
+  data->pcmSampleBuffer->setSampleBuffer(data->pcmSampleBuffer,
+                                         data->sampleBuffer);
+  return data;
+}
+
+static void *_setup8Bit(void) {
+  return _newPcmSampleBufferData(kBitDepth8Bit, true);
+}
+static void *_setup16Bit(void) {
+  return _newPcmSampleBufferData(kBitDepth16Bit, true);
+}
+static void *_setup16BitBigEndian(void) {
+  return _newPcmSampleBufferData(kBitDepth16Bit, false);
+}
+static void *_setup24Bit(void) {
+  return _newPcmSampleBufferData(kBitDepth24Bit, true);
+}
+static void *_setup32Bit(void) {
+  return _newPcmSampleBufferData(kBitDepth32Bit, true);
+}
+static void *_setup32BitBigEndian(void) {
+  return _newPcmSampleBufferData(kBitDepth32Bit, false);
+}
+
+static void _runEncode(void *userData) {
+  PcmSampleBufferData *data = (PcmSampleBufferData *)userData;
+  data->pcmSampleBuffer->setSampleBuffer(data->pcmSampleBuffer,
+                                         data->sampleBuffer);
+}
+
+static void _runDecode(void *userData) {
+  PcmSampleBufferData *data = (PcmSampleBufferData *)userData;
+  data->pcmSampleBuffer->setSamples(data->pcmSampleBuffer);
+}
+
+static void _teardownPcmSampleBufferData(void *userData) {
+  PcmSampleBufferData *data = (PcmSampleBufferData *)userData;
+  freePcmSampleBuffer(data->pcmSampleBuffer);
+  freeSampleBuffer(data->sampleBuffer);
+  free(data);
+}
+
+BenchmarkSuite addPcmSampleBufferBenchmarks(void);
+BenchmarkSuite addPcmSampleBufferBenchmarks(void) {
+  BenchmarkSuite suite = newBenchmarkSuite("PcmSampleBuffer");
+
+  addBenchmark(suite, "Encode8Bit", "frame", BENCHMARK_BLOCKSIZE, _setup8Bit,
+               _runEncode, _teardownPcmSampleBufferData);
+  addBenchmark(suite, "Decode8Bit", "frame", BENCHMARK_BLOCKSIZE, _setup8Bit,
+               _runDecode, _teardownPcmSampleBufferData);
+  addBenchmark(suite, "Encode16Bit", "frame", BENCHMARK_BLOCKSIZE, _setup16Bit,
+               _runEncode, _teardownPcmSampleBufferData);
+  addBenchmark(suite, "Decode16Bit", "frame", BENCHMARK_BLOCKSIZE, _setup16Bit,
+               _runDecode, _teardownPcmSampleBufferData);
+  addBenchmark(suite, "Decode16BitBigEndian", "frame", BENCHMARK_BLOCKSIZE,
+               _setup16BitBigEndian, _runDecode, _teardownPcmSampleBufferData);
+  addBenchmark(suite, "Encode24Bit", "frame", BENCHMARK_BLOCKSIZE, _setup24Bit,
+               _runEncode, _teardownPcmSampleBufferData);
+  addBenchmark(suite, "Decode24Bit", "frame", BENCHMARK_BLOCKSIZE, _setup24Bit,
+               _runDecode, _teardownPcmSampleBufferData);
+  addBenchmark(suite, "Encode32Bit", "frame", BENCHMARK_BLOCKSIZE, _setup32Bit,
+               _runEncode, _teardownPcmSampleBufferData);
+  addBenchmark(suite, "Decode32Bit", "frame", BENCHMARK_BLOCKSIZE, _setup32Bit,
+               _runDecode, _teardownPcmSampleBufferData);
+  addBenchmark(suite, "Decode32BitBigEndian", "frame", BENCHMARK_BLOCKSIZE,
+               _setup32BitBigEndian, _runDecode, _teardownPcmSampleBufferData);
+
+  return suite;
+}
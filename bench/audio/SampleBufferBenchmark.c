@@ -0,0 +1,111 @@
+//
+// SampleBufferBenchmark.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/SampleBuffer.h"
+#include "BenchmarkRunner.h"
+
+#include <stdlib.h>
+
+#define BENCHMARK_BLOCKSIZE 512
+
+typedef struct {
+  SampleBuffer source;
+  SampleBuffer destination;
+} SampleBufferCopyData;
+
+static void *_newSampleBufferCopyData(ChannelCount sourceChannels,
+                                      ChannelCount destinationChannels) {
+  SampleBufferCopyData *data =
+      (SampleBufferCopyData *)malloc(sizeof(SampleBufferCopyData));
+  data->source = newSampleBuffer(sourceChannels, BENCHMARK_BLOCKSIZE);
+  data->destination = newSampleBuffer(destinationChannels, BENCHMARK_BLOCKSIZE);
+  return data;
+}
+
+static void *_setupMonoToMono(void) { return _newSampleBufferCopyData(1, 1); }
+static void *_setupStereoToStereo(void) {
+  return _newSampleBufferCopyData(2, 2);
+}
+static void *_setupMonoToStereo(void) { return _newSampleBufferCopyData(1, 2); }
+static void *_setupStereoToMono(void) { return _newSampleBufferCopyData(2, 1); }
+static void *_setupStereoToSurround(void) {
+  return _newSampleBufferCopyData(2, 6);
+}
+static void *_setupSurroundToStereo(void) {
+  return _newSampleBufferCopyData(6, 2);
+}
+
+static void _runCopyAndMapChannels(void *userData) {
+  SampleBufferCopyData *data = (SampleBufferCopyData *)userData;
+  sampleBufferCopyAndMapChannels(data->destination, data->source);
+}
+
+static void _teardownSampleBufferCopyData(void *userData) {
+  SampleBufferCopyData *data = (SampleBufferCopyData *)userData;
+  freeSampleBuffer(data->source);
+  freeSampleBuffer(data->destination);
+  free(data);
+}
+
+static void *_setupClear(void) {
+  return newSampleBuffer(2, BENCHMARK_BLOCKSIZE);
+}
+
+static void _runClear(void *userData) {
+  sampleBufferClear((SampleBuffer)userData);
+}
+
+static void _teardownClear(void *userData) {
+  freeSampleBuffer((SampleBuffer)userData);
+}
+
+BenchmarkSuite addSampleBufferBenchmarks(void);
+BenchmarkSuite addSampleBufferBenchmarks(void) {
+  BenchmarkSuite suite = newBenchmarkSuite("SampleBuffer");
+
+  addBenchmark(suite, "CopyMonoToMono", "frame", BENCHMARK_BLOCKSIZE,
+               _setupMonoToMono, _runCopyAndMapChannels,
+               _teardownSampleBufferCopyData);
+  addBenchmark(suite, "CopyStereoToStereo", "frame", BENCHMARK_BLOCKSIZE,
+               _setupStereoToStereo, _runCopyAndMapChannels,
+               _teardownSampleBufferCopyData);
+  addBenchmark(suite, "CopyMonoToStereo", "frame", BENCHMARK_BLOCKSIZE,
+               _setupMonoToStereo, _runCopyAndMapChannels,
+               _teardownSampleBufferCopyData);
+  addBenchmark(suite, "CopyStereoToMono", "frame", BENCHMARK_BLOCKSIZE,
+               _setupStereoToMono, _runCopyAndMapChannels,
+               _teardownSampleBufferCopyData);
+  addBenchmark(suite, "CopyStereoToSurround", "frame", BENCHMARK_BLOCKSIZE,
+               _setupStereoToSurround, _runCopyAndMapChannels,
+               _teardownSampleBufferCopyData);
+  addBenchmark(suite, "CopySurroundToStereo", "frame", BENCHMARK_BLOCKSIZE,
+               _setupSurroundToStereo, _runCopyAndMapChannels,
+               _teardownSampleBufferCopyData);
+  addBenchmark(suite, "ClearStereo", "frame", BENCHMARK_BLOCKSIZE, _setupClear,
+               _runClear, _teardownClear);
+
+  return suite;
+}
@@ -0,0 +1,98 @@
+//
+// LinkedListBenchmark.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "base/LinkedList.h"
+#include "BenchmarkRunner.h"
+
+#include <stdlib.h>
+
+#define BENCHMARK_NUM_ITEMS 1000
+
+static int _item = 0;
+
+static void _runAppend(void *userData) {
+  LinkedList list = newLinkedList();
+  int i;
+
+  for (i = 0; i < BENCHMARK_NUM_ITEMS; i++) {
+    linkedListAppend(list, &_item);
+  }
+
+  freeLinkedList(list);
+}
+
+static void *_setupFilledList(void) {
+  LinkedList list = newLinkedList();
+  int i;
+
+  for (i = 0; i < BENCHMARK_NUM_ITEMS; i++) {
+    linkedListAppend(list, &_item);
+  }
+
+  return list;
+}
+
+static void _runClearAndAppend(void *userData) {
+  LinkedList list = (LinkedList)userData;
+  int i;
+
+  linkedListClear(list);
+
+  for (i = 0; i < BENCHMARK_NUM_ITEMS; i++) {
+    linkedListAppend(list, &_item);
+  }
+}
+
+static void _countItem(void *item, void *userData) { (*(int *)userData)++; }
+
+static void _runForeach(void *userData) {
+  int count = 0;
+  linkedListForeach((LinkedList)userData, _countItem, &count);
+}
+
+static void _runToArray(void *userData) {
+  free(linkedListToArray((LinkedList)userData));
+}
+
+static void _teardownFilledList(void *userData) {
+  freeLinkedList((LinkedList)userData);
+}
+
+BenchmarkSuite addLinkedListBenchmarks(void);
+BenchmarkSuite addLinkedListBenchmarks(void) {
+  BenchmarkSuite suite = newBenchmarkSuite("LinkedList");
+
+  addBenchmark(suite, "Append", "item", BENCHMARK_NUM_ITEMS, NULL, _runAppend,
+               NULL);
+  addBenchmark(suite, "ClearAndAppend", "item", BENCHMARK_NUM_ITEMS,
+               _setupFilledList, _runClearAndAppend, _teardownFilledList);
+  addBenchmark(suite, "Foreach", "item", BENCHMARK_NUM_ITEMS, _setupFilledList,
+               _runForeach, _teardownFilledList);
+  addBenchmark(suite, "ToArray", "item", BENCHMARK_NUM_ITEMS, _setupFilledList,
+               _runToArray, _teardownFilledList);
+
+  return suite;
+}
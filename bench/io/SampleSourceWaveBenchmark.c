@@ -0,0 +1,117 @@
+//
+// SampleSourceWaveBenchmark.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/AudioSettings.h"
+#include "base/File.h"
+#include "io/SampleSource.h"
+#include "BenchmarkRunner.h"
+
+#include <stdlib.h>
+
+#define BENCHMARK_WAVE_FILENAME "benchmark.wav"
+#define BENCHMARK_NUM_BLOCKS 64
+
+// The WAVE source is created directly rather than with sampleSourceFactory(),
+// since the factory prefers libaudiofile when it is available
+extern SampleSource _newSampleSourceWave(const CharString sampleSourceName);
+
+typedef struct {
+  CharString filename;
+  SampleBuffer sampleBuffer;
+} SampleSourceWaveData;
+
+static void *_setupWaveFile(void) {
+  SampleSourceWaveData *data =
+      (SampleSourceWaveData *)malloc(sizeof(SampleSourceWaveData));
+  SampleSource sampleSource;
+  int i;
+
+  initAudioSettings();
+  data->filename = newCharStringWithCString(BENCHMARK_WAVE_FILENAME);
+  data->sampleBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+
+  sampleSource = _newSampleSourceWave(data->filename);
+  sampleSource->openSampleSource(sampleSource, SAMPLE_SOURCE_OPEN_WRITE);
+
+  for (i = 0; i < BENCHMARK_NUM_BLOCKS; i++) {
+    sampleSource->writeSampleBlock(sampleSource, data->sampleBuffer);
+  }
+
+  sampleSource->closeSampleSource(sampleSource);
+  freeSampleSource(sampleSource);
+  return data;
+}
+
+static void _runParseHeader(void *userData) {
+  SampleSourceWaveData *data = (SampleSourceWaveData *)userData;
+  SampleSource sampleSource = _newSampleSourceWave(data->filename);
+  sampleSource->openSampleSource(sampleSource, SAMPLE_SOURCE_OPEN_READ);
+  sampleSource->closeSampleSource(sampleSource);
+  freeSampleSource(sampleSource);
+}
+
+static void _runReadFile(void *userData) {
+  SampleSourceWaveData *data = (SampleSourceWaveData *)userData;
+  SampleSource sampleSource = _newSampleSourceWave(data->filename);
+  int i;
+
+  sampleSource->openSampleSource(sampleSource, SAMPLE_SOURCE_OPEN_READ);
+
+  for (i = 0; i < BENCHMARK_NUM_BLOCKS; i++) {
+    sampleSource->readSampleBlock(sampleSource, data->sampleBuffer);
+  }
+
+  sampleSource->closeSampleSource(sampleSource);
+  freeSampleSource(sampleSource);
+}
+
+static void _teardownWaveFile(void *userData) {
+  SampleSourceWaveData *data = (SampleSourceWaveData *)userData;
+  File file = newFileWithPath(data->filename);
+
+  if (fileExists(file)) {
+    fileRemove(file);
+  }
+
+  freeFile(file);
+  freeCharString(data->filename);
+  freeSampleBuffer(data->sampleBuffer);
+  freeAudioSettings();
+  free(data);
+}
+
+BenchmarkSuite addSampleSourceWaveBenchmarks(void);
+BenchmarkSuite addSampleSourceWaveBenchmarks(void) {
+  BenchmarkSuite suite = newBenchmarkSuite("SampleSourceWave");
+
+  addBenchmark(suite, "ParseHeader", "file", 1, _setupWaveFile,
+               _runParseHeader, _teardownWaveFile);
+  addBenchmark(suite, "ReadFile", "frame",
+               BENCHMARK_NUM_BLOCKS * DEFAULT_BLOCKSIZE, _setupWaveFile,
+               _runReadFile, _teardownWaveFile);
+
+  return suite;
+}
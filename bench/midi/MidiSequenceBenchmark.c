@@ -0,0 +1,98 @@
+//
+// MidiSequenceBenchmark.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "midi/MidiSequence.h"
+#include "BenchmarkRunner.h"
+
+#define BENCHMARK_BLOCKSIZE 512
+#define BENCHMARK_NUM_FRAMES (BENCHMARK_BLOCKSIZE * 64)
+
+static MidiSequence _newMidiSequenceWithEventSpacing(unsigned long spacing) {
+  MidiSequence midiSequence = newMidiSequence();
+  MidiEvent midiEvent;
+  unsigned long i;
+
+  for (i = 0; i < BENCHMARK_NUM_FRAMES; i += spacing) {
+    midiEvent = newMidiEvent();
+    midiEvent->eventType = MIDI_TYPE_REGULAR;
+    midiEvent->status = (byte)((i / spacing) % 2 ? 0x80 : 0x90);
+    midiEvent->data1 = 60;
+    midiEvent->data2 = 100;
+    midiEvent->timestamp = i;
+    appendMidiEventToSequence(midiSequence, midiEvent);
+  }
+
+  return midiSequence;
+}
+
+static void *_setupDenseSequence(void) {
+  return _newMidiSequenceWithEventSpacing(4);
+}
+
+static void *_setupSparseSequence(void) {
+  return _newMidiSequenceWithEventSpacing(BENCHMARK_BLOCKSIZE * 4);
+}
+
+static void _runFillMidiEventsFromRange(void *userData) {
+  MidiSequence midiSequence = (MidiSequence)userData;
+  LinkedList midiEventsForBlock = newLinkedList();
+  unsigned long frame;
+
+  midiSequenceRewind(midiSequence);
+
+  // Same as the main processing loop, which reuses one list for all blocks
+  for (frame = 0; frame < BENCHMARK_NUM_FRAMES; frame += BENCHMARK_BLOCKSIZE) {
+    linkedListClear(midiEventsForBlock);
+    fillMidiEventsFromRange(midiSequence, frame, BENCHMARK_BLOCKSIZE,
+                            midiEventsForBlock);
+  }
+
+  freeLinkedList(midiEventsForBlock);
+}
+
+static void _runAppendMidiEvents(void *userData) {
+  freeMidiSequence(_newMidiSequenceWithEventSpacing(4));
+}
+
+static void _teardownMidiSequence(void *userData) {
+  freeMidiSequence((MidiSequence)userData);
+}
+
+BenchmarkSuite addMidiSequenceBenchmarks(void);
+BenchmarkSuite addMidiSequenceBenchmarks(void) {
+  BenchmarkSuite suite = newBenchmarkSuite("MidiSequence");
+
+  addBenchmark(suite, "Append", "event", BENCHMARK_NUM_FRAMES / 4, NULL,
+               _runAppendMidiEvents, NULL);
+  addBenchmark(suite, "FillDenseSequence", "frame", BENCHMARK_NUM_FRAMES,
+               _setupDenseSequence, _runFillMidiEventsFromRange,
+               _teardownMidiSequence);
+  addBenchmark(suite, "FillSparseSequence", "frame", BENCHMARK_NUM_FRAMES,
+               _setupSparseSequence, _runFillMidiEventsFromRange,
+               _teardownMidiSequence);
+
+  return suite;
+}
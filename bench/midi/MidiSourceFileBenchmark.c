@@ -0,0 +1,136 @@
+//
+// MidiSourceFileBenchmark.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/AudioSettings.h"
+#include "base/File.h"
+#include "midi/MidiSource.h"
+#include "BenchmarkRunner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCHMARK_MIDI_FILENAME "benchmark.mid"
+#define BENCHMARK_NUM_NOTES 2048
+// Each note has a note on and note off event, plus the track end event
+#define BENCHMARK_NUM_EVENTS (BENCHMARK_NUM_NOTES * 2 + 1)
+// Multi-track files are split into tracks of this many notes each
+#define BENCHMARK_NUM_TRACKS 64
+#define BENCHMARK_NUM_NOTES_PER_TRACK 256
+#define BENCHMARK_NUM_MULTITRACK_EVENTS                                        \
+  (BENCHMARK_NUM_TRACKS * (BENCHMARK_NUM_NOTES_PER_TRACK * 2 + 1))
+
+static void _writeBigEndian(FILE *file, unsigned long value,
+                            unsigned int numBytes) {
+  while (numBytes > 0) {
+    numBytes--;
+    fputc((int)((value >> (numBytes * 8)) & 0xff), file);
+  }
+}
+
+static CharString _writeMidiFile(const int formatType, const int numTracks,
+                                 const int numNotesPerTrack) {
+  CharString filename = newCharStringWithCString(BENCHMARK_MIDI_FILENAME);
+  FILE *midiFile = fopen(filename->data, "wb");
+  int track, i;
+
+  if (midiFile == NULL) {
+    printf("ERROR: Could not write '%s'\n", filename->data);
+    return filename;
+  }
+
+  // 96 ticks per beat
+  fputs("MThd", midiFile);
+  _writeBigEndian(midiFile, 6, 4);
+  _writeBigEndian(midiFile, (unsigned long)formatType, 2);
+  _writeBigEndian(midiFile, (unsigned long)numTracks, 2);
+  _writeBigEndian(midiFile, 96, 2);
+
+  for (track = 0; track < numTracks; track++) {
+    // Each note is 8 bytes, the end of track event is 4 bytes
+    fputs("MTrk", midiFile);
+    _writeBigEndian(midiFile, (unsigned long)(numNotesPerTrack * 8 + 4), 4);
+
+    for (i = 0; i < numNotesPerTrack; i++) {
+      const byte note[8] = {0x10, 0x90, (byte)(36 + i % 48), 0x64,
+                            0x10, 0x80, (byte)(36 + i % 48), 0x00};
+      fwrite(note, sizeof(byte), 8, midiFile);
+    }
+
+    _writeBigEndian(midiFile, 0x00ff2f00, 4);
+  }
+
+  fclose(midiFile);
+
+  initAudioSettings();
+  return filename;
+}
+
+static void *_setupMidiFile(void) {
+  return _writeMidiFile(0, 1, BENCHMARK_NUM_NOTES);
+}
+
+static void *_setupMultiTrackMidiFile(void) {
+  return _writeMidiFile(1, BENCHMARK_NUM_TRACKS, BENCHMARK_NUM_NOTES_PER_TRACK);
+}
+
+static void _runParseMidiFile(void *userData) {
+  CharString filename = (CharString)userData;
+  MidiSource midiSource = newMidiSource(MIDI_SOURCE_TYPE_FILE, filename);
+  MidiSequence midiSequence = newMidiSequence();
+
+  if (midiSource->openMidiSource(midiSource)) {
+    midiSource->readMidiEvents(midiSource, midiSequence);
+  }
+
+  freeMidiSequence(midiSequence);
+  freeMidiSource(midiSource);
+}
+
+static void _teardownMidiFile(void *userData) {
+  CharString filename = (CharString)userData;
+  File file = newFileWithPath(filename);
+
+  if (fileExists(file)) {
+    fileRemove(file);
+  }
+
+  freeFile(file);
+  freeCharString(filename);
+  freeAudioSettings();
+}
+
+BenchmarkSuite addMidiSourceFileBenchmarks(void);
+BenchmarkSuite addMidiSourceFileBenchmarks(void) {
+  BenchmarkSuite suite = newBenchmarkSuite("MidiSourceFile");
+
+  addBenchmark(suite, "ParseFile", "event", BENCHMARK_NUM_EVENTS,
+               _setupMidiFile, _runParseMidiFile, _teardownMidiFile);
+  addBenchmark(suite, "ParseMultiTrackFile", "event",
+               BENCHMARK_NUM_MULTITRACK_EVENTS, _setupMultiTrackMidiFile,
+               _runParseMidiFile, _teardownMidiFile);
+
+  return suite;
+}
@@ -0,0 +1,112 @@
+//
+// InternalPluginBenchmark.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/AudioSettings.h"
+#include "plugin/PluginGain.h"
+#include "plugin/PluginLimiter.h"
+#include "plugin/PluginPassthru.h"
+#include "plugin/PluginSilence.h"
+#include "BenchmarkRunner.h"
+
+#include <stdlib.h>
+
+typedef struct {
+  Plugin plugin;
+  SampleBuffer inputs;
+  SampleBuffer outputs;
+} InternalPluginData;
+
+typedef Plugin (*NewInternalPluginFunc)(const CharString pluginName);
+
+static void *_newInternalPluginData(NewInternalPluginFunc newPluginFunc,
+                                    const char *pluginName) {
+  InternalPluginData *data =
+      (InternalPluginData *)malloc(sizeof(InternalPluginData));
+  CharString pluginNameString = newCharStringWithCString(pluginName);
+  SampleCount i;
+  ChannelCount j;
+
+  initAudioSettings();
+  data->plugin = newPluginFunc(pluginNameString);
+  openPlugin(data->plugin);
+  data->plugin->prepareForProcessing(data->plugin);
+  data->inputs = newSampleBuffer(getNumChannels(), getBlocksize());
+  data->outputs = newSampleBuffer(getNumChannels(), getBlocksize());
+
+  // Use a loud signal so that the limiter has some work to do
+  for (j = 0; j < data->inputs->numChannels; j++) {
+    for (i = 0; i < data->inputs->blocksize; i++) {
+      data->inputs->samples[j][i] = (Sample)(i % 2 ? 1.5 : -1.5);
+    }
+  }
+
+  freeCharString(pluginNameString);
+  return data;
+}
+
+static void *_setupGain(void) {
+  return _newInternalPluginData(newPluginGain, kInternalPluginGainName);
+}
+static void *_setupLimiter(void) {
+  return _newInternalPluginData(newPluginLimiter, kInternalPluginLimiterName);
+}
+static void *_setupPassthru(void) {
+  return _newInternalPluginData(newPluginPassthru, kInternalPluginPassthruName);
+}
+static void *_setupSilence(void) {
+  return _newInternalPluginData(newPluginSilence, kInternalPluginSilenceName);
+}
+
+static void _runProcessAudio(void *userData) {
+  InternalPluginData *data = (InternalPluginData *)userData;
+  data->plugin->processAudio(data->plugin, data->inputs, data->outputs);
+}
+
+static void _teardownInternalPluginData(void *userData) {
+  InternalPluginData *data = (InternalPluginData *)userData;
+  closePlugin(data->plugin);
+  freePlugin(data->plugin);
+  freeSampleBuffer(data->inputs);
+  freeSampleBuffer(data->outputs);
+  freeAudioSettings();
+  free(data);
+}
+
+BenchmarkSuite addInternalPluginBenchmarks(void);
+BenchmarkSuite addInternalPluginBenchmarks(void) {
+  BenchmarkSuite suite = newBenchmarkSuite("InternalPlugin");
+
+  addBenchmark(suite, "Gain", "frame", DEFAULT_BLOCKSIZE, _setupGain,
+               _runProcessAudio, _teardownInternalPluginData);
+  addBenchmark(suite, "Limiter", "frame", DEFAULT_BLOCKSIZE, _setupLimiter,
+               _runProcessAudio, _teardownInternalPluginData);
+  addBenchmark(suite, "Passthru", "frame", DEFAULT_BLOCKSIZE, _setupPassthru,
+               _runProcessAudio, _teardownInternalPluginData);
+  addBenchmark(suite, "Silence", "frame", DEFAULT_BLOCKSIZE, _setupSilence,
+               _runProcessAudio, _teardownInternalPluginData);
+
+  return suite;
+}
@@ -10,7 +10,7 @@ function(configure_target target wordsize)
       set_target_properties(${target} PROPERTIES COMPILE_FLAGS "-m64")
       set_target_properties(${target} PROPERTIES LINK_FLAGS "-m64")
     endif()
-    target_link_libraries(${target} dl)
+    target_link_libraries(${target} dl pthread)
 
     if(WITH_GUI)
       target_link_libraries(${target} x11)
@@ -29,6 +29,7 @@ function(configure_target target wordsize)
     else()
       set_target_properties(${target} PROPERTIES COMPILE_FLAGS "/DWIN64=1")
     endif()
+    target_link_libraries(${target} psapi)
   endif()
 
   target_compile_definitions(${target} PUBLIC PLATFORM_BITS=${wordsize})
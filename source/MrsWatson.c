@@ -28,17 +28,31 @@
 #include "MrsWatsonOptions.h"
 
 #include "app/BuildInfo.h"
+#include "app/ParameterSweep.h"
+#include "app/PipelineBenchmark.h"
+#include "app/PresetSweep.h"
+#include "app/RenderCache.h"
+#include "app/StageCache.h"
+#include "app/StatsReport.h"
 #include "audio/AudioSettings.h"
+#include "audio/ChannelMap.h"
+#include "audio/DelayCompensator.h"
+#include "audio/OfflineSession.h"
+#include "base/File.h"
 #include "base/PlatformInfo.h"
 #include "io/SampleSource.h"
+#include "io/SampleSourceMemory.h"
 #include "io/SampleSourcePcm.h"
 #include "logging/EventLogger.h"
 #include "logging/LogPrinter.h"
+#include "logging/TraceLogger.h"
 #include "midi/MidiSequence.h"
 #include "midi/MidiSource.h"
 #include "plugin/PluginChain.h"
+#include "plugin/PluginSandbox.h"
 #include "time/AudioClock.h"
 
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -48,10 +62,19 @@ static void _printTaskTime(void *item, void *userData) {
   CharString prettyTimeString = taskTimerHumanReadbleString(taskTimer);
   double timePercentage =
       100.0f * taskTimer->totalTaskTime / totalTimer->totalTaskTime;
+  CharString histogramString = NULL;
   logInfo("  %s %s: %s (%2.1f%%)", taskTimer->component->data,
           taskTimer->subcomponent->data, prettyTimeString->data,
           timePercentage);
+
+  if (taskTimer->histogram != NULL && taskTimer->histogram->numSamples > 0) {
+    histogramString = latencyHistogramToString(taskTimer->histogram);
+    logInfo("    %lu blocks: %s", taskTimer->histogram->numSamples,
+            histogramString->data);
+  }
+
   freeCharString(prettyTimeString);
+  freeCharString(histogramString);
 }
 
 static void _remapFileToErrorReport(ErrorReporter errorReporter,
@@ -177,16 +200,20 @@ static ReturnCode setupMidiSource(MidiSource midiSource,
       return RETURN_CODE_IO_ERROR;
     }
 
-    // Read in all events from the MIDI source
-    // TODO: This will not work if we want to support streaming MIDI events (ie,
-    // from a pipe)
     *outSequence = newMidiSequence();
 
-    if (!midiSource->readMidiEvents(midiSource, *outSequence)) {
+    // Streaming sources are read incrementally while processing, otherwise
+    // read in all events from the MIDI source up front
+    if (!midiSource->isStream &&
+        !midiSource->readMidiEvents(midiSource, *outSequence)) {
       logWarn("Failed reading MIDI events from source '%s'",
               midiSource->sourceName->data);
       return RETURN_CODE_IO_ERROR;
     }
+
+    // Sources which know all tempo changes in advance provide a tempo map, so
+    // the clock can calculate the musical position without replaying them
+    audioClockSetTempoMap(getAudioClock(), (*outSequence)->tempoMap);
   }
 
   return RETURN_CODE_SUCCESS;
@@ -206,6 +233,334 @@ static ReturnCode setupOutputSource(SampleSource outputSource) {
   return RETURN_CODE_SUCCESS;
 }
 
+static boolByte _isStreamSource(const SampleSource sampleSource) {
+  // PCM sources rename themselves to stdin/stdout when opened, so check the
+  // source data rather than the name
+  return (boolByte)(sampleSource->sampleSourceType == SAMPLE_SOURCE_TYPE_PCM &&
+                    ((SampleSourcePcmData)sampleSource->extraData)->isStream);
+}
+
+/**
+ * Replace an opened input source with a memory source which reads from the
+ * decoded input cache. If the input has not been cached yet, it is decoded and
+ * written to the cache directory first.
+ * @param inputSource Opened input source
+ * @param cacheDirectory Directory which holds the cache files
+ * @return Memory source which replaces the input source, or the original input
+ * source if the cache could not be used. In the former case, the original input
+ * source has been closed and freed.
+ */
+static SampleSource _openCachedInputSource(SampleSource inputSource,
+                                           const CharString cacheDirectory) {
+  SampleSource result = NULL;
+  CharString cacheName;
+  File cacheDir;
+  File cacheFile;
+
+  cacheName = sampleSourceMemoryGetCacheName(
+      inputSource->sourceName, getSampleRate(), getNumChannels());
+
+  if (cacheName == NULL) {
+    logWarn("Could not read input source '%s', not using the input cache",
+            inputSource->sourceName->data);
+    return inputSource;
+  }
+
+  cacheDir = newFileWithPath(cacheDirectory);
+
+  if (!fileExists(cacheDir) && !fileCreate(cacheDir, kFileTypeDirectory)) {
+    logWarn("Could not create input cache directory '%s'",
+            cacheDirectory->data);
+    freeFile(cacheDir);
+    freeCharString(cacheName);
+    return inputSource;
+  }
+
+  cacheFile = newFileWithParent(cacheDir, cacheName);
+  freeFile(cacheDir);
+  freeCharString(cacheName);
+
+  if (cacheFile == NULL) {
+    logWarn("Input cache '%s' is not a directory", cacheDirectory->data);
+    return inputSource;
+  }
+
+  result = newSampleSourceMemoryFromCache(cacheFile->absolutePath);
+
+  if (result != NULL) {
+    logInfo("Reading input from cache file '%s'",
+            cacheFile->absolutePath->data);
+  } else {
+    result = newSampleSourceMemory(inputSource);
+
+    if (result != NULL &&
+        sampleSourceMemoryWriteCache(result, cacheFile->absolutePath,
+                                     getSampleRate())) {
+      logInfo("Wrote input to cache file '%s'", cacheFile->absolutePath->data);
+    }
+  }
+
+  freeFile(cacheFile);
+
+  if (result == NULL) {
+    return inputSource;
+  }
+
+  // Keep the original name, since it is shown in the output
+  charStringCopy(result->sourceName, inputSource->sourceName);
+  inputSource->closeSampleSource(inputSource);
+  freeSampleSource(inputSource);
+  return result;
+}
+
+/**
+ * Create a render cache whose key identifies everything which influences the
+ * output of this run.
+ * @param cacheDirectory Directory which holds the cache entries
+ * @param outStageKeys If not NULL, receives the key after each plugin in the
+ * chain, which identifies the output of that plugin
+ * @return New render cache. If some part of the key could not be read, the
+ * cache will neither restore nor store any output.
+ */
+static RenderCache _newRenderCacheForRun(const ProgramOptions programOptions,
+                                         const CharString cacheDirectory,
+                                         const SampleSource inputSource,
+                                         const MidiSource midiSource,
+                                         const PluginChain pluginChain,
+                                         const unsigned long maxTimeInMs,
+                                         HashValue *outStageKeys) {
+  RenderCache renderCache = newRenderCache(cacheDirectory);
+  LinkedListIterator iterator;
+  CharString graphDescription;
+  unsigned int i;
+
+  if (inputSource->sampleSourceType == SAMPLE_SOURCE_TYPE_SILENCE) {
+    renderCacheAddString(renderCache, "input", "silence");
+  } else {
+    renderCacheAddFile(renderCache, "input", inputSource->sourceName);
+  }
+
+  if (midiSource != NULL) {
+    renderCacheAddFile(renderCache, "midi", midiSource->sourceName);
+  }
+
+  if (programOptions->options[OPTION_AUTOMATION]->enabled) {
+    renderCacheAddFile(
+        renderCache, "automation",
+        programOptionsGetString(programOptions, OPTION_AUTOMATION));
+    renderCacheAddNumber(renderCache, "controlRate",
+                         programOptionsGetNumber(
+                             programOptions, OPTION_AUTOMATION_CONTROL_RATE));
+  }
+
+  renderCacheAddNumber(renderCache, "sampleRate", getSampleRate());
+  renderCacheAddNumber(renderCache, "blocksize", getBlocksize());
+  renderCacheAddNumber(renderCache, "bitDepth", getBitDepth());
+  renderCacheAddNumber(renderCache, "channels", getNumChannels());
+  renderCacheAddNumber(renderCache, "tempo", getTempo());
+  renderCacheAddNumber(renderCache, "beatsPerMeasure",
+                       getTimeSignatureBeatsPerMeasure());
+  renderCacheAddNumber(renderCache, "noteValue", getTimeSignatureNoteValue());
+  renderCacheAddNumber(renderCache, "maxTime", maxTimeInMs);
+  renderCacheAddString(
+      renderCache, "endian",
+      programOptionsGetString(programOptions, OPTION_ENDIAN)->data);
+  renderCacheAddNumber(
+      renderCache, "tail",
+      programOptions->options[OPTION_TAIL]->enabled
+          ? programOptionsGetNumber(programOptions, OPTION_TAIL)
+          : -1.0);
+  if (programOptions->options[OPTION_CHANNEL_MAP]->enabled) {
+    renderCacheAddString(
+        renderCache, "channelMap",
+        programOptionsGetString(programOptions, OPTION_CHANNEL_MAP)->data);
+  }
+
+  // Skipping silence drops any noise which plugins make in their tails
+  renderCacheAddNumber(renderCache, "skipSilence",
+                       programOptions->options[OPTION_SKIP_SILENCE]->enabled);
+  renderCacheAddNumber(
+      renderCache, "doublePrecision",
+      programOptions->options[OPTION_DOUBLE_PRECISION]->enabled);
+  renderCacheAddNumber(renderCache, "offline",
+                       programOptions->options[OPTION_OFFLINE]->enabled);
+
+  // Plugins are described by their index in the graph
+  if (pluginChain->graph != NULL) {
+    graphDescription = pluginGraphDescribe(pluginChain->graph);
+    renderCacheAddString(renderCache, "graph", graphDescription->data);
+    freeCharString(graphDescription);
+  }
+
+  for (i = 0; i < pluginChain->numPlugins; i++) {
+    renderCacheAddPlugin(renderCache, pluginChain, i);
+
+    // Parameters are always set on the head plugin
+    if (i == 0 && programOptions->options[OPTION_PARAMETER]->enabled) {
+      iterator = programOptionsGetList(programOptions, OPTION_PARAMETER);
+
+      while (iterator != NULL && iterator->item != NULL) {
+        renderCacheAddString(renderCache, "parameter",
+                             (const char *)iterator->item);
+        iterator = iterator->nextItem;
+      }
+    }
+
+    if (outStageKeys != NULL) {
+      outStageKeys[i] = renderCache->key;
+    }
+  }
+
+  return renderCache;
+}
+
+/**
+ * Close a sample source and open a fresh instance of it, so that reading or
+ * writing starts again from the beginning of the file. Sources which have been
+ * read into memory are rewound instead.
+ * @param sampleSource Sample source to reopen. This object is freed, unless it
+ * is a memory source.
+ * @param openAs Mode to open the new sample source with
+ * @param outSuccess Set to false if the new sample source could not be opened
+ * @return New sample source. It is always safe to close and free this object,
+ * even if opening it failed.
+ */
+static SampleSource _reopenSampleSource(SampleSource sampleSource,
+                                        const SampleSourceOpenAs openAs,
+                                        boolByte *outSuccess) {
+  SampleSource result;
+  ReturnCode returnCode;
+
+  if (sampleSource->sampleSourceType == SAMPLE_SOURCE_TYPE_MEMORY) {
+    sampleSourceMemoryRewind(sampleSource);
+    return sampleSource;
+  }
+
+  sampleSource->closeSampleSource(sampleSource);
+
+  if (sampleSource->sampleSourceType == SAMPLE_SOURCE_TYPE_SILENCE) {
+    result = sampleSourceFactory(NULL);
+  } else {
+    result = sampleSourceFactory(sampleSource->sourceName);
+  }
+
+  freeSampleSource(sampleSource);
+
+  if (openAs == SAMPLE_SOURCE_OPEN_READ) {
+    returnCode = setupInputSource(result);
+  } else {
+    returnCode = setupOutputSource(result);
+  }
+
+  if (returnCode != RETURN_CODE_SUCCESS) {
+    *outSuccess = false;
+  }
+
+  return result;
+}
+
+/**
+ * Return everything to the state it was in before the first block was
+ * processed, so that the same input can be processed again when benchmarking.
+ */
+static boolByte _rewindForBenchmark(SampleSource *inputSource,
+                                    SampleSource *outputSource,
+                                    DelayCompensator delayCompensator,
+                                    MidiSequence midiSequence,
+                                    PluginChain pluginChain) {
+  boolByte success = true;
+
+  *inputSource =
+      _reopenSampleSource(*inputSource, SAMPLE_SOURCE_OPEN_READ, &success);
+  *outputSource =
+      _reopenSampleSource(*outputSource, SAMPLE_SOURCE_OPEN_WRITE, &success);
+  delayCompensatorReset(delayCompensator);
+
+  if (midiSequence != NULL) {
+    midiSequenceRewind(midiSequence);
+  }
+
+  // Suspending and resuming the plugins should clear any internal state, such
+  // as reverb tails or delay lines, left over from the previous iteration
+  pluginChainSuspend(pluginChain);
+  pluginChainPrepareForProcessing(pluginChain);
+  audioClockRewind(getAudioClock());
+
+  return success;
+}
+
+/**
+ * Prepare for rendering a point of a preset or parameter sweep. Except for the
+ * first point, the output for the previous point is closed and the sources are
+ * rewound. The plugins are suspended while the preset or parameters are set,
+ * so that they start without any state left over from the previous point.
+ */
+static boolByte _rewindForSweep(const PresetSweep presetSweep,
+                                const ParameterSweep parameterSweep,
+                                const unsigned long point,
+                                const CharString outputName,
+                                SampleSource *inputSource,
+                                SampleSource *outputSource,
+                                DelayCompensator delayCompensator,
+                                MidiSequence midiSequence,
+                                PluginChain pluginChain) {
+  boolByte success = true;
+  CharString pointOutputName;
+  PluginPreset preset;
+
+  if (point > 0) {
+    if (presetSweep != NULL) {
+      pointOutputName = presetSweepGetOutputName(presetSweep, outputName,
+                                                 (unsigned int)point);
+    } else {
+      pointOutputName =
+          parameterSweepGetOutputName(parameterSweep, outputName, point);
+    }
+
+    (*outputSource)->closeSampleSource(*outputSource);
+    freeSampleSource(*outputSource);
+    *outputSource = sampleSourceFactory(pointOutputName);
+    freeCharString(pointOutputName);
+
+    if (*outputSource == NULL) {
+      // The main loop expects a valid output source to close
+      *outputSource = sampleSourceFactory(NULL);
+      success = false;
+    } else if (setupOutputSource(*outputSource) != RETURN_CODE_SUCCESS) {
+      success = false;
+    }
+
+    *inputSource =
+        _reopenSampleSource(*inputSource, SAMPLE_SOURCE_OPEN_READ, &success);
+    delayCompensatorReset(delayCompensator);
+
+    if (midiSequence != NULL) {
+      midiSequenceRewind(midiSequence);
+    }
+  }
+
+  pluginChainSuspend(pluginChain);
+
+  if (presetSweep != NULL) {
+    preset = pluginPresetFactory(presetSweep->presetNames[point]);
+
+    if (preset == NULL || !pluginChainLoadPreset(pluginChain, 0, preset)) {
+      success = false;
+    }
+  } else if (!parameterSweepApply(parameterSweep, point,
+                                  pluginChain->plugins[0])) {
+    success = false;
+  }
+
+  pluginChainPrepareForProcessing(pluginChain);
+
+  if (point > 0) {
+    audioClockRewind(getAudioClock());
+  }
+
+  return success;
+}
+
 static void _processMidiMetaEvent(void *item, void *userData) {
   MidiEvent midiEvent = (MidiEvent)item;
   boolByte *finishedReading = (boolByte *)userData;
@@ -214,6 +569,7 @@ static void _processMidiMetaEvent(void *item, void *userData) {
     switch (midiEvent->status) {
     case MIDI_META_TYPE_TEMPO:
       setTempoFromMidiBytes(midiEvent->extraData);
+      audioClockUpdateTransport(getAudioClock());
       break;
 
     case MIDI_META_TYPE_TIME_SIGNATURE:
@@ -221,6 +577,7 @@ static void _processMidiMetaEvent(void *item, void *userData) {
         logWarn("Could not set time signature from MIDI file");
       }
 
+      audioClockUpdateTransport(getAudioClock());
       break;
 
     case MIDI_META_TYPE_TRACK_END:
@@ -241,29 +598,35 @@ static void _processMidiMetaEvent(void *item, void *userData) {
  *
  * @param inputSource The SampleSource to read from.
  * @param buffer The SampleBuffer to which the samples will be written.
+ * @param totalFramesRead Incremented by the number of frames which were read.
+ * The last block is padded with silence, so this may be less than the
+ * blocksize.
  * @return True if there is more input to read.
  */
-boolByte readInput(SampleSource inputSource, SampleBuffer buffer) {
+boolByte readInput(SampleSource inputSource, SampleBuffer buffer,
+                   unsigned long *totalFramesRead) {
   unsigned long framesRead;
   unsigned long bufferSize = buffer->blocksize;
 
   inputSource->readSampleBlock(inputSource, buffer);
   // buffer->blocksize tells how many frames have been read from inputSource
   framesRead = buffer->blocksize;
+  *totalFramesRead += framesRead;
 
   if (framesRead == bufferSize) {
     // We have filled up the buffer, so return true to ask for more input
     return true;
   } else if (framesRead < bufferSize) {
-    // Partial read, meaning that we have reached the end of file
-    unsigned long numberOfFrames = (bufferSize - framesRead);
-    SampleBuffer silenceBuffer =
-        newSampleBuffer(buffer->numChannels, numberOfFrames);
+    // Partial read, meaning that we have reached the end of file. Pad the rest
+    // of the block with silence.
+    ChannelCount i;
 
-    buffer->blocksize = framesRead + numberOfFrames;
-    sampleBufferCopyAndMapChannelsWithOffset(buffer, framesRead, silenceBuffer,
-                                             0, numberOfFrames);
-    freeSampleBuffer(silenceBuffer);
+    for (i = 0; i < buffer->numChannels; i++) {
+      memset(buffer->samples[i] + framesRead, 0,
+             sizeof(Sample) * (bufferSize - framesRead));
+    }
+
+    buffer->blocksize = bufferSize;
 
     // Finished reading
     return false;
@@ -276,56 +639,120 @@ boolByte readInput(SampleSource inputSource, SampleBuffer buffer) {
   }
 }
 
+// Tail rendering stops early once the output has been silent for this long
+static const double kTailSilenceTimeInMs = 500.0;
+
 /**
- *  Writes to outputSource.
+ * Write the output of the plugin chain with its processing delay removed.
+ * Frames which do not fill a block yet are kept in the delay compensator until
+ * the next call, unless they are the last frames to be written.
  *
  * @param outputSource The SampleSource to write to.
- * @param silenceSource The source from where to write skipHeadFrames frames.
- * @param buffer The SampleBuffer with the samples to be written.
- * @param skipHeadFrames Number of frames to ignore before writing to
- * outputSource.
+ * @param delayCompensator Delay compensator for the output.
+ * @param buffer The output of the plugin chain. This buffer is reused to read
+ * blocks back from the delay compensator, and its blocksize is restored
+ * afterwards.
+ * @param maxFrames Maximum number of frames to write, so that the output ends
+ * exactly where the input (and its tail) ends.
+ * @return Number of frames written
  */
-void writeOutput(SampleSource outputSource, SampleSource silenceSource,
-                 SampleBuffer buffer, unsigned long skipHeadFrames) {
-  unsigned long framesSkipped =
-      silenceSource->numSamplesProcessed / buffer->numChannels;
-  unsigned long framesProcessed =
-      framesSkipped + outputSource->numSamplesProcessed / buffer->numChannels;
-  unsigned long nextBlockStart = framesProcessed + buffer->blocksize;
-
-  if (framesProcessed != getAudioClock()->currentFrame) {
-    logWarn("framesProcessed (%lu) != getAudioClock()->currentFrame (%lu)",
-            framesProcessed, getAudioClock()->currentFrame);
-  }
-
-  // Cut the delay at the start
-  if (nextBlockStart <= skipHeadFrames) {
-    // Cutting away the whole block. nothing is written to the outputSource
-    silenceSource->writeSampleBlock(silenceSource, buffer);
-  } else if (framesProcessed < skipHeadFrames &&
-             skipHeadFrames < nextBlockStart) {
-    SampleBuffer sourceBuffer =
-        newSampleBuffer(buffer->numChannels, buffer->blocksize);
-    unsigned long skippedFrames = skipHeadFrames - framesProcessed;
-    unsigned long soundFrames = nextBlockStart - skipHeadFrames;
-
-    // Cutting away start part of the block.
-    sourceBuffer->blocksize = skippedFrames;
-    sampleBufferCopyAndMapChannelsWithOffset(sourceBuffer, 0, buffer, 0,
-                                             sourceBuffer->blocksize);
-    silenceSource->writeSampleBlock(silenceSource, sourceBuffer);
-
-    // Writing remaining end part of the block.
-    sourceBuffer->blocksize = soundFrames;
-    sampleBufferCopyAndMapChannelsWithOffset(
-        sourceBuffer, 0, buffer, skippedFrames, sourceBuffer->blocksize);
-    outputSource->writeSampleBlock(outputSource, sourceBuffer);
-
-    freeSampleBuffer(sourceBuffer);
-  } else {
-    // Normal case: Nothing more to cut. The whole block shall be written.
+unsigned long writeOutput(SampleSource outputSource,
+                          DelayCompensator delayCompensator,
+                          SampleBuffer buffer, const unsigned long maxFrames) {
+  const SampleCount blocksize = buffer->blocksize;
+  unsigned long framesWritten = 0;
+
+  delayCompensatorPush(delayCompensator, buffer);
+
+  while (framesWritten < maxFrames) {
+    if (maxFrames - framesWritten < (unsigned long)blocksize) {
+      buffer->blocksize = (SampleCount)(maxFrames - framesWritten);
+    }
+
+    if (!delayCompensatorRead(delayCompensator, buffer)) {
+      break;
+    }
+
+    outputSource->writeSampleBlock(outputSource, buffer);
+    framesWritten += buffer->blocksize;
+  }
+
+  buffer->blocksize = blocksize;
+  return framesWritten;
+}
+
+/**
+ * Process the entire input at once with a plugin which supports offline
+ * processing. The input is read into memory first, so that the plugin can read
+ * it in any order and as many times as it needs.
+ *
+ * @param pluginChain Plugin chain, which must be able to process offline
+ * @param inputSource Opened input source. If this is not a memory source, it
+ * is replaced by one which holds all of its frames.
+ * @param outputSource The SampleSource to write to.
+ * @param buffer Buffer used to write the output in blocks
+ * @return RETURN_CODE_SUCCESS on success, other code on failure
+ */
+static ReturnCode _processOffline(PluginChain pluginChain,
+                                  SampleSource *inputSource,
+                                  SampleSource outputSource,
+                                  SampleBuffer buffer) {
+  SampleSource memorySource = *inputSource;
+  SampleSourceMemoryData memoryData;
+  OfflineSession session;
+  SampleCount position;
+  SampleCount numFrames;
+  const SampleCount blocksize = buffer->blocksize;
+
+  if (memorySource->sampleSourceType != SAMPLE_SOURCE_TYPE_MEMORY) {
+    memorySource = newSampleSourceMemory(*inputSource);
+
+    if (memorySource == NULL) {
+      logError("Could not read input source '%s' into memory for offline "
+               "processing",
+               (*inputSource)->sourceName->data);
+      return RETURN_CODE_IO_ERROR;
+    }
+
+    charStringCopy(memorySource->sourceName, (*inputSource)->sourceName);
+    (*inputSource)->closeSampleSource(*inputSource);
+    freeSampleSource(*inputSource);
+    *inputSource = memorySource;
+  }
+
+  memoryData = (SampleSourceMemoryData)memorySource->extraData;
+  session = newOfflineSession(
+      memorySource->sourceName, memoryData->buffer,
+      pluginChain->plugins[0]->outputBuffer->numChannels);
+  logInfo("Processing %lu frames offline", memoryData->buffer->blocksize);
+
+  if (!pluginChainProcessOffline(pluginChain, session)) {
+    freeOfflineSession(session);
+    return RETURN_CODE_PLUGIN_ERROR;
+  }
+
+  // The plugin read the input itself, but it still counts as being read
+  memorySource->numSamplesProcessed =
+      memoryData->buffer->blocksize * memoryData->buffer->numChannels;
+
+  for (position = 0; position < session->output->blocksize;
+       position += numFrames) {
+    numFrames = session->output->blocksize - position;
+
+    if (numFrames > blocksize) {
+      numFrames = blocksize;
+    }
+
+    buffer->blocksize = numFrames;
+    sampleBufferCopyAndMapChannelsWithOffset(buffer, 0, session->output,
+                                             position, numFrames);
     outputSource->writeSampleBlock(outputSource, buffer);
+    advanceAudioClock(getAudioClock(), numFrames);
   }
+
+  buffer->blocksize = blocksize;
+  freeOfflineSession(session);
+  return RETURN_CODE_SUCCESS;
 }
 
 int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
@@ -342,22 +769,50 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
   unsigned long maxTimeInMs = 0;
   unsigned long maxTimeInFrames = 0;
   unsigned long processingDelayInFrames;
+  unsigned long tailInFrames = 0;
+  unsigned long inputFramesRead;
+  unsigned long inputEndFrame = 0;
+  unsigned long cachedStageDelayInFrames;
+  unsigned long stageDelays[MAX_PLUGINS];
+  unsigned long flushEndFrame;
+  unsigned long outputEndFrame;
+  unsigned long outputFramesWritten;
+  unsigned long silentTailFrames;
+  double tailTimeInMs;
+  double blockBudgetInMs;
   ProgramOptions programOptions;
   ProgramOption option;
   Plugin headPlugin;
   SampleBuffer inputSampleBuffer = NULL;
   SampleBuffer outputSampleBuffer = NULL;
+  LinkedList midiEventsForBlock = NULL;
   TaskTimer initTimer, totalTimer, inputTimer, outputTimer = NULL;
   LinkedList taskTimerList = NULL;
+  StatsReport statsReport = NULL;
+  boolByte statsReportWritten = true;
+  PipelineBenchmark pipelineBenchmark = NULL;
+  unsigned long numBenchmarkIterations = 0;
+  PresetSweep presetSweep = NULL;
+  ParameterSweep parameterSweep = NULL;
+  CharString sweepOutputName = NULL;
+  RenderCache renderCache = NULL;
+  boolByte renderCacheHit = false;
+  boolByte processOffline = false;
+  boolByte outputReopened = true;
+  StageCache stageCache = NULL;
+  unsigned long numIterations, iteration;
   CharString totalTimeString = NULL;
   boolByte finishedReading = false;
-  SampleSource silentSampleOutput;
+  boolByte finishedReadingInput;
+  DelayCompensator delayCompensator = NULL;
   unsigned int i;
 
   initTimer = newTaskTimerWithCString(PROGRAM_NAME, "Initialization");
   totalTimer = newTaskTimerWithCString(PROGRAM_NAME, "Total Time");
-  taskTimerStart(initTimer);
+  // The total timer must enclose the initialization timer, otherwise the spans
+  // will overlap when written to the trace file
   taskTimerStart(totalTimer);
+  taskTimerStart(initTimer);
 
   initEventLogger();
   initAudioSettings();
@@ -541,12 +996,51 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     setLogFile(programOptionsGetString(programOptions, OPTION_LOG_FILE));
   }
 
+  if (programOptions->options[OPTION_TRACE_FILE]->enabled) {
+    if (!initTraceLogger(
+            programOptionsGetString(programOptions, OPTION_TRACE_FILE))) {
+      freeSampleSource(inputSource);
+      freeSampleSource(outputSource);
+      freePluginChain(pluginChain);
+      freeProgramOptions(programOptions);
+      freeTaskTimer(initTimer);
+      freeTaskTimer(totalTimer);
+      freeCharString(pluginSearchRoot);
+      freeAudioSettings();
+      freeEventLogger();
+      freeAudioClock(getAudioClock());
+      return RETURN_CODE_IO_ERROR;
+    }
+  }
+
   // Parse other options and set up necessary objects
   for (i = 0; i < programOptions->numOptions; i++) {
     option = programOptions->options[i];
 
     if (option->enabled) {
       switch (option->index) {
+      case OPTION_BENCHMARK:
+        if (programOptionsGetNumber(programOptions, OPTION_BENCHMARK) < 1.0f) {
+          logError("Number of benchmark iterations must be at least 1");
+          freeSampleSource(inputSource);
+          freeSampleSource(outputSource);
+          freePluginChain(pluginChain);
+          freeProgramOptions(programOptions);
+          freeTaskTimer(initTimer);
+          freeTaskTimer(totalTimer);
+          freeCharString(pluginSearchRoot);
+          freeMidiSource(midiSource);
+          freeAudioSettings();
+          freeEventLogger();
+          freeTraceLogger();
+          freeAudioClock(getAudioClock());
+          return RETURN_CODE_INVALID_ARGUMENT;
+        }
+
+        numBenchmarkIterations = (const unsigned long)programOptionsGetNumber(
+            programOptions, OPTION_BENCHMARK);
+        break;
+
       case OPTION_BIT_DEPTH:
         if (!setBitDepth((const BitDepth)(short)programOptionsGetNumber(
                 programOptions, OPTION_BIT_DEPTH))) {
@@ -560,6 +1054,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
           freeMidiSource(midiSource);
           freeAudioSettings();
           freeEventLogger();
+          freeTraceLogger();
           freeAudioClock(getAudioClock());
           return RETURN_CODE_INVALID_ARGUMENT;
         }
@@ -579,6 +1074,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
           freeMidiSource(midiSource);
           freeAudioSettings();
           freeEventLogger();
+          freeTraceLogger();
           freeAudioClock(getAudioClock());
           return RETURN_CODE_INVALID_ARGUMENT;
         }
@@ -598,6 +1094,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
           freeMidiSource(midiSource);
           freeAudioSettings();
           freeEventLogger();
+          freeTraceLogger();
           freeAudioClock(getAudioClock());
           return RETURN_CODE_INVALID_ARGUMENT;
         }
@@ -641,6 +1138,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
 
       case OPTION_REALTIME:
         pluginChainSetRealtime(pluginChain, true);
+        audioClock->isRealtime = true;
         break;
 
       case OPTION_SAMPLE_RATE:
@@ -656,6 +1154,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
           freeMidiSource(midiSource);
           freeAudioSettings();
           freeEventLogger();
+          freeTraceLogger();
           freeAudioClock(getAudioClock());
           return RETURN_CODE_INVALID_ARGUMENT;
         }
@@ -674,6 +1173,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
           freeMidiSource(midiSource);
           freeAudioSettings();
           freeEventLogger();
+          freeTraceLogger();
           freeAudioClock(getAudioClock());
           return RETURN_CODE_INVALID_ARGUMENT;
         }
@@ -693,6 +1193,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
           freeMidiSource(midiSource);
           freeAudioSettings();
           freeEventLogger();
+          freeTraceLogger();
           freeAudioClock(getAudioClock());
           return RETURN_CODE_INVALID_ARGUMENT;
         }
@@ -723,6 +1224,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeMidiSource(midiSource);
     freeAudioSettings();
     freeEventLogger();
+    freeTraceLogger();
     freeAudioClock(getAudioClock());
     return RETURN_CODE_NOT_RUN;
   }
@@ -739,13 +1241,18 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeMidiSource(midiSource);
     freeAudioSettings();
     freeEventLogger();
+    freeTraceLogger();
     freeAudioClock(getAudioClock());
     return RETURN_CODE_NOT_RUN;
   }
 
   printWelcomeMessage(argc, argv);
 
-  if ((result = setupInputSource(inputSource)) != RETURN_CODE_SUCCESS) {
+  traceLoggerBeginEvent("init", "Open input source");
+  result = setupInputSource(inputSource);
+  traceLoggerEndEvent();
+
+  if (result != RETURN_CODE_SUCCESS) {
     logError("Input source could not be opened, exiting");
     freeSampleSource(inputSource);
     freeSampleSource(outputSource);
@@ -757,13 +1264,44 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeMidiSource(midiSource);
     freeAudioSettings();
     freeEventLogger();
+    freeTraceLogger();
     freeAudioClock(getAudioClock());
     return result;
   }
 
-  if ((result = buildPluginChain(
-           pluginChain, programOptionsGetString(programOptions, OPTION_PLUGIN),
-           pluginSearchRoot)) != RETURN_CODE_SUCCESS) {
+  if (programOptions->options[OPTION_INPUT_CACHE]->enabled &&
+      inputSource->sampleSourceType != SAMPLE_SOURCE_TYPE_SILENCE &&
+      !_isStreamSource(inputSource)) {
+    traceLoggerBeginEvent("init", "Open input cache");
+    inputSource = _openCachedInputSource(
+        inputSource,
+        programOptionsGetString(programOptions, OPTION_INPUT_CACHE));
+    traceLoggerEndEvent();
+  }
+
+  // Plugins are put in the sandbox as they are added to the chain
+  if (programOptions->options[OPTION_SANDBOX]->enabled) {
+    if (programOptionsGetNumber(programOptions, OPTION_SANDBOX) <= 0.0f) {
+      logWarn("Invalid sandbox timeout, using %dms instead",
+              DEFAULT_SANDBOX_TIMEOUT_IN_MS);
+      programOptionsSetNumber(programOptions, OPTION_SANDBOX,
+                              (const float)DEFAULT_SANDBOX_TIMEOUT_IN_MS);
+    }
+
+    if (!pluginChainSetSandbox(
+            pluginChain, (unsigned long)programOptionsGetNumber(
+                             programOptions, OPTION_SANDBOX))) {
+      logWarn("Plugins will be loaded without a sandbox");
+    }
+  }
+
+  traceLoggerBeginEvent("init", "Build plugin chain");
+  result = buildPluginChain(
+      pluginChain, programOptionsGetString(programOptions, OPTION_PLUGIN),
+      pluginSearchRoot);
+  traceLoggerEndEvent();
+
+  if (result != RETURN_CODE_SUCCESS) {
     logError("Plugin chain could not be constructed, exiting");
     freeSampleSource(inputSource);
     freeSampleSource(outputSource);
@@ -775,6 +1313,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeMidiSource(midiSource);
     freeAudioSettings();
     freeEventLogger();
+    freeTraceLogger();
     freeAudioClock(getAudioClock());
     return result;
   }
@@ -783,7 +1322,9 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
   freeCharString(pluginSearchRoot);
 
   if (midiSource != NULL) {
+    traceLoggerBeginEvent("init", "Read MIDI source");
     result = setupMidiSource(midiSource, &midiSequence);
+    traceLoggerEndEvent();
 
     if (result != RETURN_CODE_SUCCESS) {
       logError("MIDI source could not be opened, exiting");
@@ -797,6 +1338,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
       freeMidiSequence(midiSequence);
       freeAudioSettings();
       freeEventLogger();
+      freeTraceLogger();
       freeAudioClock(getAudioClock());
       return result;
     }
@@ -812,7 +1354,9 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
   }
 
   // Initialize the plugin chain after the global sample rate has been set
+  traceLoggerBeginEvent("init", "Initialize plugin chain");
   result = pluginChainInitialize(pluginChain);
+  traceLoggerEndEvent();
 
   if (result != RETURN_CODE_SUCCESS) {
     logError("Could not initialize plugin chain");
@@ -826,6 +1370,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeMidiSequence(midiSequence);
     freeAudioSettings();
     freeEventLogger();
+    freeTraceLogger();
     freeAudioClock(getAudioClock());
     return result;
   }
@@ -848,6 +1393,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeSampleSource(inputSource);
     freeAudioSettings();
     freeEventLogger();
+    freeTraceLogger();
     freeAudioClock(getAudioClock());
     return RETURN_CODE_NOT_RUN;
   }
@@ -867,15 +1413,186 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
       freeMidiSequence(midiSequence);
       freeAudioSettings();
       freeEventLogger();
+      freeTraceLogger();
+      freeAudioClock(getAudioClock());
+      return RETURN_CODE_INVALID_ARGUMENT;
+    }
+  }
+
+  // The channel map routes the input into the first plugin
+  if (programOptions->options[OPTION_CHANNEL_MAP]->enabled) {
+    ChannelMap channelMap = newChannelMapWithString(
+        getNumChannels(), pluginChain->plugins[0]->inputBuffer->numChannels,
+        programOptionsGetString(programOptions, OPTION_CHANNEL_MAP));
+
+    if (channelMap == NULL ||
+        !pluginChainSetChannelMap(pluginChain, 0, channelMap)) {
+      freeChannelMap(channelMap);
+      freeSampleSource(inputSource);
+      freeSampleSource(outputSource);
+      freePluginChain(pluginChain);
+      freeProgramOptions(programOptions);
+      freeTaskTimer(initTimer);
+      freeTaskTimer(totalTimer);
+      freeMidiSource(midiSource);
+      freeMidiSequence(midiSequence);
+      freeAudioSettings();
+      freeEventLogger();
+      freeTraceLogger();
       freeAudioClock(getAudioClock());
       return RETURN_CODE_INVALID_ARGUMENT;
     }
   }
 
+  if (programOptions->options[OPTION_AUTOMATION]->enabled) {
+    PluginAutomation automation = newPluginAutomation();
+    automation->controlRate = (unsigned long)programOptionsGetNumber(
+        programOptions, OPTION_AUTOMATION_CONTROL_RATE);
+
+    if (!pluginAutomationReadFile(
+            automation,
+            programOptionsGetString(programOptions, OPTION_AUTOMATION)) ||
+        !pluginChainSetAutomation(pluginChain, automation)) {
+      freePluginAutomation(automation);
+      freeSampleSource(inputSource);
+      freeSampleSource(outputSource);
+      freePluginChain(pluginChain);
+      freeProgramOptions(programOptions);
+      freeTaskTimer(initTimer);
+      freeTaskTimer(totalTimer);
+      freeMidiSource(midiSource);
+      freeMidiSequence(midiSequence);
+      freeAudioSettings();
+      freeEventLogger();
+      freeTraceLogger();
+      freeAudioClock(getAudioClock());
+      return RETURN_CODE_INVALID_ARGUMENT;
+    }
+  }
+
+  // The output names of a sweep are derived from the given output name, so
+  // the output for the first point must be named before it is opened
+  if (programOptions->options[OPTION_PRESET_SWEEP]->enabled ||
+      programOptions->options[OPTION_SWEEP]->enabled) {
+    CharString firstOutputName;
+    result = RETURN_CODE_INVALID_ARGUMENT;
+
+    if (programOptions->options[OPTION_PRESET_SWEEP]->enabled &&
+        programOptions->options[OPTION_SWEEP]->enabled) {
+      logError("--preset-sweep cannot be used together with --sweep");
+    } else if (numBenchmarkIterations > 0) {
+      logError("Sweeps cannot be used together with --benchmark");
+    } else if (outputSource == NULL ||
+               outputSource->sampleSourceType == SAMPLE_SOURCE_TYPE_SILENCE ||
+               charStringIsEqualToCString(outputSource->sourceName, "-",
+                                          false)) {
+      logError("Sweeps require an output file");
+    } else if (programOptions->options[OPTION_PRESET_SWEEP]->enabled) {
+      presetSweep = newPresetSweep();
+
+      if (presetSweepAddPresets(presetSweep,
+                                programOptionsGetString(programOptions,
+                                                        OPTION_PRESET_SWEEP))) {
+        logInfo("Sweeping %u presets", presetSweep->numPresets);
+        result = RETURN_CODE_SUCCESS;
+      } else {
+        logError("No presets found in '%s'",
+                 programOptionsGetString(programOptions, OPTION_PRESET_SWEEP)
+                     ->data);
+      }
+    } else {
+      parameterSweep = newParameterSweep();
+
+      // The parser logs the reason if the sweep is invalid
+      if (parameterSweepParse(parameterSweep,
+                              programOptionsGetString(programOptions,
+                                                      OPTION_SWEEP))) {
+        if (!programOptions->options[OPTION_SWEEP_RANDOM]->enabled) {
+          result = RETURN_CODE_SUCCESS;
+        } else if (programOptionsGetNumber(programOptions,
+                                           OPTION_SWEEP_RANDOM) < 1.0f) {
+          logError("Number of random sweep points must be at least 1");
+        } else {
+          parameterSweepRandomize(
+              parameterSweep,
+              (unsigned long)programOptionsGetNumber(programOptions,
+                                                     OPTION_SWEEP_RANDOM),
+              0);
+          result = RETURN_CODE_SUCCESS;
+        }
+      }
+
+      // Set the first point now to check that the plugin accepts the swept
+      // parameters, as otherwise the manifest would list outputs which are
+      // never rendered. The point is set again before rendering it.
+      if (result == RETURN_CODE_SUCCESS &&
+          !parameterSweepApply(parameterSweep, 0, pluginChain->plugins[0])) {
+        logError("Plugin '%s' does not accept the swept parameters",
+                 pluginChain->plugins[0]->pluginName->data);
+        result = RETURN_CODE_INVALID_ARGUMENT;
+      }
+
+      if (result == RETURN_CODE_SUCCESS) {
+        logInfo("Sweeping %lu parameter combinations",
+                parameterSweep->numPoints);
+      }
+    }
+
+    if (result == RETURN_CODE_SUCCESS) {
+      sweepOutputName =
+          newCharStringWithCString(outputSource->sourceName->data);
+
+      if (presetSweep != NULL) {
+        firstOutputName =
+            presetSweepGetOutputName(presetSweep, sweepOutputName, 0);
+      } else {
+        firstOutputName =
+            parameterSweepGetOutputName(parameterSweep, sweepOutputName, 0);
+
+        if (!parameterSweepWriteManifest(parameterSweep, sweepOutputName)) {
+          result = RETURN_CODE_IO_ERROR;
+        }
+      }
+
+      freeSampleSource(outputSource);
+      outputSource = sampleSourceFactory(firstOutputName);
+      freeCharString(firstOutputName);
+    }
+
+    if (result != RETURN_CODE_SUCCESS) {
+      freeSampleSource(inputSource);
+      freeSampleSource(outputSource);
+      freePluginChain(pluginChain);
+      freeProgramOptions(programOptions);
+      freeTaskTimer(initTimer);
+      freeTaskTimer(totalTimer);
+      freeMidiSource(midiSource);
+      freeMidiSequence(midiSequence);
+      freePresetSweep(presetSweep);
+      freeParameterSweep(parameterSweep);
+      freeCharString(sweepOutputName);
+      freeAudioSettings();
+      freeEventLogger();
+      freeTraceLogger();
+      freeAudioClock(getAudioClock());
+      return result;
+    }
+  }
+
+  // Benchmark output is usually not interesting, so it may be discarded
+  if (numBenchmarkIterations > 0 && outputSource == NULL) {
+    logInfo("No output source given, benchmark output will be discarded");
+    outputSource = sampleSourceFactory(NULL);
+  }
+
   // Setup output source here. Having an invalid output source should not cause
   // the program
   // to exit if the user only wants to list plugins or query info about a chain.
-  if ((result = setupOutputSource(outputSource)) != RETURN_CODE_SUCCESS) {
+  traceLoggerBeginEvent("init", "Open output source");
+  result = setupOutputSource(outputSource);
+  traceLoggerEndEvent();
+
+  if (result != RETURN_CODE_SUCCESS) {
     logError("Output source could not be opened, exiting");
     freeSampleSource(inputSource);
     freeSampleSource(outputSource);
@@ -885,8 +1602,12 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeTaskTimer(totalTimer);
     freeMidiSource(midiSource);
     freeMidiSequence(midiSequence);
+    freePresetSweep(presetSweep);
+    freeParameterSweep(parameterSweep);
+    freeCharString(sweepOutputName);
     freeAudioSettings();
     freeEventLogger();
+    freeTraceLogger();
     freeAudioClock(getAudioClock());
     return result;
   }
@@ -908,15 +1629,18 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
       freeTaskTimer(totalTimer);
       freeMidiSource(midiSource);
       freeMidiSequence(midiSequence);
+      freePresetSweep(presetSweep);
+      freeParameterSweep(parameterSweep);
+      freeCharString(sweepOutputName);
       freeAudioSettings();
       freeEventLogger();
+      freeTraceLogger();
       freeAudioClock(getAudioClock());
       return RETURN_CODE_NOT_RUN;
     }
 
-    if (midiSource != NULL &&
-        charStringIsEqualToCString(midiSource->sourceName, "-", false)) {
-      printf("ERROR: MIDI source from stdin is incompatible with "
+    if (midiSource != NULL && midiSource->isStream) {
+      printf("ERROR: Streaming MIDI sources are incompatible with "
              "--error-report\n");
       freeSampleSource(inputSource);
       freeSampleSource(outputSource);
@@ -926,13 +1650,42 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
       freeTaskTimer(totalTimer);
       freeMidiSource(midiSource);
       freeMidiSequence(midiSequence);
+      freePresetSweep(presetSweep);
+      freeParameterSweep(parameterSweep);
+      freeCharString(sweepOutputName);
       freeAudioSettings();
       freeEventLogger();
+      freeTraceLogger();
       freeAudioClock(getAudioClock());
       return RETURN_CODE_NOT_RUN;
     }
   }
 
+  // Streams cannot be rewound, so they can only be processed once
+  if (numBenchmarkIterations > 0 || sweepOutputName != NULL) {
+    if (_isStreamSource(inputSource) || _isStreamSource(outputSource) ||
+        (midiSource != NULL && midiSource->isStream)) {
+      logError("Using stdin/stdout or pipes is incompatible with %s",
+               sweepOutputName != NULL ? "sweeps" : "--benchmark");
+      freeSampleSource(inputSource);
+      freeSampleSource(outputSource);
+      freePluginChain(pluginChain);
+      freeProgramOptions(programOptions);
+      freeTaskTimer(initTimer);
+      freeTaskTimer(totalTimer);
+      freeMidiSource(midiSource);
+      freeMidiSequence(midiSequence);
+      freePresetSweep(presetSweep);
+      freeParameterSweep(parameterSweep);
+      freeCharString(sweepOutputName);
+      freeAudioSettings();
+      freeEventLogger();
+      freeTraceLogger();
+      freeAudioClock(getAudioClock());
+      return RETURN_CODE_INVALID_ARGUMENT;
+    }
+  }
+
   if (outputSource == NULL) {
     logInternalError("Default output sample source was null");
     freeSampleSource(inputSource);
@@ -943,8 +1696,12 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeTaskTimer(totalTimer);
     freeMidiSource(midiSource);
     freeMidiSequence(midiSequence);
+    freePresetSweep(presetSweep);
+    freeParameterSweep(parameterSweep);
+    freeCharString(sweepOutputName);
     freeAudioSettings();
     freeEventLogger();
+    freeTraceLogger();
     freeAudioClock(getAudioClock());
     return RETURN_CODE_INTERNAL_ERROR;
   }
@@ -981,8 +1738,12 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
           freeTaskTimer(totalTimer);
           freeMidiSource(midiSource);
           freeMidiSequence(midiSequence);
+          freePresetSweep(presetSweep);
+          freeParameterSweep(parameterSweep);
+          freeCharString(sweepOutputName);
           freeAudioSettings();
           freeEventLogger();
+          freeTraceLogger();
           freeAudioClock(getAudioClock());
           return RETURN_CODE_MISSING_REQUIRED_OPTION;
         } else {
@@ -1002,17 +1763,210 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
       freeTaskTimer(totalTimer);
       freeMidiSource(midiSource);
       freeMidiSequence(midiSequence);
+      freePresetSweep(presetSweep);
+      freeParameterSweep(parameterSweep);
+      freeCharString(sweepOutputName);
       freeAudioSettings();
       freeEventLogger();
+      freeTraceLogger();
       freeAudioClock(getAudioClock());
       return RETURN_CODE_MISSING_REQUIRED_OPTION;
     }
   }
 
+  // Identical renders are restored from the cache, in which case the output
+  // is replaced with a silent source so that nothing is rendered
+  if (programOptions->options[OPTION_RENDER_CACHE]->enabled) {
+    if (sweepOutputName != NULL || numBenchmarkIterations > 0) {
+      logWarn("--render-cache has no effect for sweeps or benchmarks");
+    } else if (outputSource->sampleSourceType == SAMPLE_SOURCE_TYPE_SILENCE ||
+               _isStreamSource(outputSource) || _isStreamSource(inputSource) ||
+               (midiSource != NULL && midiSource->isStream)) {
+      logWarn("--render-cache requires input and output files, ignoring");
+    } else {
+      traceLoggerBeginEvent("init", "Look up render cache");
+      renderCache = _newRenderCacheForRun(
+          programOptions,
+          programOptionsGetString(programOptions, OPTION_RENDER_CACHE),
+          inputSource, midiSource, pluginChain, maxTimeInMs, NULL);
+
+      if (renderCacheHasEntry(renderCache, outputSource->sourceName)) {
+        // The output file must be closed before it can be replaced
+        outputSource->closeSampleSource(outputSource);
+        renderCacheHit =
+            renderCacheRestore(renderCache, outputSource->sourceName);
+
+        if (renderCacheHit) {
+          freeSampleSource(outputSource);
+          outputSource = sampleSourceFactory(NULL);
+          setupOutputSource(outputSource);
+        } else {
+          outputSource = _reopenSampleSource(
+              outputSource, SAMPLE_SOURCE_OPEN_WRITE, &outputReopened);
+        }
+      }
+
+      traceLoggerEndEvent();
+    }
+
+    if (!outputReopened) {
+      logError("Output source could not be opened, exiting");
+      freeSampleSource(inputSource);
+      freeSampleSource(outputSource);
+      freePluginChain(pluginChain);
+      freeProgramOptions(programOptions);
+      freeTaskTimer(initTimer);
+      freeTaskTimer(totalTimer);
+      freeMidiSource(midiSource);
+      freeMidiSequence(midiSequence);
+      freeRenderCache(renderCache);
+      freeAudioSettings();
+      freeEventLogger();
+      freeTraceLogger();
+      freeAudioClock(getAudioClock());
+      return RETURN_CODE_IO_ERROR;
+    }
+  }
+
+  // Start from the output of the deepest plugin which is cached, and record
+  // the output of the plugins after it
+  if (programOptions->options[OPTION_STAGE_CACHE]->enabled && !renderCacheHit) {
+    if (sweepOutputName != NULL || numBenchmarkIterations > 0) {
+      logWarn("--stage-cache has no effect for sweeps or benchmarks");
+    } else if (pluginChain->graph != NULL) {
+      // Stages are only recorded for plugins which are processed in serial
+      logWarn("--stage-cache cannot be used with plugin graphs, ignoring");
+    } else if (_isStreamSource(inputSource) ||
+               (midiSource != NULL && midiSource->isStream)) {
+      logWarn("--stage-cache cannot be used with streams, ignoring");
+    } else if (programOptions->options[OPTION_TAIL]->enabled) {
+      // Stages are cut at the end of the input, so a run which starts from a
+      // cached stage would lose the tails of the plugins before it
+      logWarn("--stage-cache cannot be used with --tail, ignoring");
+    } else {
+      HashValue stageKeys[MAX_PLUGINS];
+      RenderCache stageKeyBuilder;
+      SampleSource cachedInput;
+
+      traceLoggerBeginEvent("init", "Look up stage cache");
+      stageKeyBuilder = _newRenderCacheForRun(
+          programOptions,
+          programOptionsGetString(programOptions, OPTION_STAGE_CACHE),
+          inputSource, midiSource, pluginChain, maxTimeInMs, stageKeys);
+
+      if (stageKeyBuilder->isKeyValid) {
+        stageCache = newStageCache(
+            programOptionsGetString(programOptions, OPTION_STAGE_CACHE),
+            (unsigned long)(programOptionsGetNumber(programOptions,
+                                                    OPTION_STAGE_CACHE_SIZE) *
+                            1024.0 * 1024.0),
+            stageKeys, pluginChain->numPlugins);
+        cachedInput = stageCacheOpenDeepestStage(stageCache);
+
+        if (cachedInput != NULL) {
+          charStringCopy(cachedInput->sourceName, inputSource->sourceName);
+          inputSource->closeSampleSource(inputSource);
+          freeSampleSource(inputSource);
+          inputSource = cachedInput;
+          pluginChainSetFirstPlugin(pluginChain, stageCache->numCachedStages);
+        }
+
+        stageCacheBeginWriting(stageCache, getNumChannels(), getSampleRate());
+        pluginChainSetStageOutputCallback(pluginChain, stageCacheWriteStage,
+                                          stageCache);
+      }
+
+      freeRenderCache(stageKeyBuilder);
+      traceLoggerEndEvent();
+    }
+  }
+
+  // The same input is rendered for every point in a sweep, so decode it only
+  // once. If this fails, the input is reopened for each point instead.
+  if (sweepOutputName != NULL &&
+      inputSource->sampleSourceType != SAMPLE_SOURCE_TYPE_SILENCE &&
+      inputSource->sampleSourceType != SAMPLE_SOURCE_TYPE_MEMORY) {
+    SampleSource memorySource;
+
+    traceLoggerBeginEvent("init", "Read input into memory");
+    memorySource = newSampleSourceMemory(inputSource);
+    traceLoggerEndEvent();
+
+    if (memorySource != NULL) {
+      inputSource->closeSampleSource(inputSource);
+      freeSampleSource(inputSource);
+      inputSource = memorySource;
+    }
+  }
+
   inputSampleBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
   inputTimer = newTaskTimerWithCString(PROGRAM_NAME, "Input Source");
   outputSampleBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
   outputTimer = newTaskTimerWithCString(PROGRAM_NAME, "Output Source");
+  // Reused for each block, so that no memory is allocated for MIDI events once
+  // the list has grown to fit the busiest block
+  midiEventsForBlock = newLinkedList();
+
+  if (programOptions->options[OPTION_STATS_FILE]->enabled) {
+    statsReport = newStatsReport(
+        programOptionsGetString(programOptions, OPTION_STATS_FILE));
+  }
+
+  if (numBenchmarkIterations > 0) {
+    pipelineBenchmark =
+        newPipelineBenchmark(numBenchmarkIterations, pluginChain);
+
+    if (statsReport != NULL) {
+      statsReport->benchmark = pipelineBenchmark;
+    }
+  }
+
+  if (statsReport != NULL) {
+    statsReport->renderCache = renderCache;
+    statsReport->stageCache = stageCache;
+  }
+
+  if (programOptions->options[OPTION_SKIP_SILENCE]->enabled) {
+    pluginChainSetSkipSilence(pluginChain, true);
+  }
+
+  if (programOptions->options[OPTION_PARALLEL_BRANCHES]->enabled) {
+    if (pluginChain->graph == NULL) {
+      logWarn("--parallel-branches has no effect without a plugin graph");
+    } else {
+      pluginChainSetParallelBranches(pluginChain, true);
+    }
+  }
+
+  if (programOptions->options[OPTION_DOUBLE_PRECISION]->enabled &&
+      pluginChainSetDoublePrecision(pluginChain, true) == 0) {
+    logWarn("No plugins in the chain support double precision processing");
+  }
+
+  if (programOptions->options[OPTION_TAIL]->enabled) {
+    tailTimeInMs = programOptionsGetNumber(programOptions, OPTION_TAIL);
+
+    if (tailTimeInMs <= 0.0) {
+      tailTimeInMs = pluginChainGetMaximumTailTimeInMs(pluginChain);
+    }
+
+    tailInFrames = (unsigned long)(tailTimeInMs * getSampleRate() / 1000.0);
+  }
+
+  if (programOptions->options[OPTION_OFFLINE]->enabled) {
+    if (!pluginChainCanProcessOffline(pluginChain)) {
+      logWarn("Plugin chain cannot process audio offline, processing the "
+              "input in blocks instead");
+    } else if (midiSequence != NULL || presetSweep != NULL ||
+               parameterSweep != NULL || numBenchmarkIterations > 0 ||
+               maxTimeInMs > 0 || tailInFrames > 0 || stageCache != NULL) {
+      logWarn("Offline processing cannot be combined with MIDI, sweeps, "
+              "benchmarks, stage caches, tails or a maximum time, processing "
+              "the input in blocks instead");
+    } else {
+      processOffline = true;
+    }
+  }
 
   // Initialization is finished, we should be able to free this memory now
   freeProgramOptions(programOptions);
@@ -1025,6 +1979,22 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
   processingDelayInFrames = pluginChainGetProcessingDelay(pluginChain);
   pluginChainPrepareForProcessing(pluginChain);
 
+  if (tailInFrames > 0) {
+    logDebug("Rendering up to %lu frames of tail after the input",
+             tailInFrames);
+  }
+
+  // Record per-block timings so that the summary can show tail latency and
+  // which components would have caused a dropout when running in realtime
+  blockBudgetInMs = getBlocksize() * 1000.0 / getSampleRate();
+  taskTimerEnableHistogram(inputTimer, blockBudgetInMs);
+  taskTimerEnableHistogram(outputTimer, blockBudgetInMs);
+
+  for (i = 0; i < pluginChain->numPlugins; i++) {
+    taskTimerEnableHistogram(pluginChain->audioTimers[i], blockBudgetInMs);
+    taskTimerEnableHistogram(pluginChain->midiTimers[i], blockBudgetInMs);
+  }
+
   // Update sample rate on the event logger
   setLoggingZebraSize((const unsigned long)getSampleRate());
   logInfo("Starting processing input source");
@@ -1037,63 +2007,240 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
            getTimeSignatureNoteValue());
   taskTimerStop(initTimer);
 
-  silentSampleOutput = sampleSourceFactory(NULL);
+  delayCompensator = newDelayCompensator(getNumChannels(), getBlocksize(),
+                                         processingDelayInFrames);
+
+  // Main processing loop. When benchmarking, the first pass over the input is
+  // a warm-up which is not recorded.
+  numIterations = numBenchmarkIterations > 0 ? numBenchmarkIterations + 1 : 1;
+  result = RETURN_CODE_SUCCESS;
+
+  if (presetSweep != NULL) {
+    numIterations = presetSweep->numPresets;
+  } else if (parameterSweep != NULL) {
+    numIterations = parameterSweep->numPoints;
+  } else if (renderCacheHit) {
+    numIterations = 0;
+  } else if (processOffline) {
+    numIterations = 0;
+    result = _processOffline(pluginChain, &inputSource, outputSource,
+                             outputSampleBuffer);
+  }
 
-  // Main processing loop
-  while (!finishedReading) {
-    taskTimerStart(inputTimer);
-    finishedReading = (boolByte)!readInput(inputSource, inputSampleBuffer);
+  for (iteration = 0; iteration < numIterations; iteration++) {
+    if (sweepOutputName != NULL) {
+      if (presetSweep != NULL) {
+        logInfo("Rendering preset %lu of %u, '%s'", iteration + 1,
+                presetSweep->numPresets,
+                presetSweep->presetNames[iteration]->data);
+      } else {
+        logInfo("Rendering sweep point %lu of %lu", iteration + 1,
+                parameterSweep->numPoints);
+      }
 
-    // TODO: For streaming MIDI, we would need to read in events from source
-    // here
-    if (midiSequence != NULL) {
-      LinkedList midiEventsForBlock = newLinkedList();
-      // MIDI source overrides the value set to finishedReading by the input
-      // source
-      finishedReading = (boolByte)!fillMidiEventsFromRange(
-          midiSequence, audioClock->currentFrame, getBlocksize(),
-          midiEventsForBlock);
-      linkedListForeach(midiEventsForBlock, _processMidiMetaEvent,
-                        &finishedReading);
-      pluginChainProcessMidi(pluginChain, midiEventsForBlock);
-      freeLinkedList(midiEventsForBlock);
+      if (!_rewindForSweep(presetSweep, parameterSweep, iteration,
+                           sweepOutputName, &inputSource, &outputSource,
+                           delayCompensator, midiSequence, pluginChain)) {
+        logError("Could not prepare sweep point %lu, stopping", iteration + 1);
+        result = RETURN_CODE_INVALID_ARGUMENT;
+        break;
+      }
+    } else if (iteration > 0) {
+      logInfo("Starting benchmark iteration %lu of %lu", iteration,
+              numBenchmarkIterations);
+
+      if (!_rewindForBenchmark(&inputSource, &outputSource, delayCompensator,
+                               midiSequence, pluginChain)) {
+        logError("Could not rewind sources for benchmarking, stopping");
+        result = RETURN_CODE_IO_ERROR;
+        break;
+      }
+
+      pipelineBenchmarkBeginIteration(pipelineBenchmark, pluginChain);
     }
 
-    taskTimerStop(inputTimer);
+    finishedReading = false;
+    inputFramesRead = 0;
+    inputEndFrame = 0;
+    outputFramesWritten = 0;
+    outputEndFrame = ULONG_MAX;
+
+    while (!finishedReading) {
+      taskTimerStart(inputTimer);
+      finishedReadingInput = (boolByte)!readInput(
+          inputSource, inputSampleBuffer, &inputFramesRead);
+      finishedReading = finishedReadingInput;
+
+      if (midiSequence != NULL) {
+        linkedListClear(midiEventsForBlock);
+
+        // Only parse events from a stream as far ahead as the current block,
+        // and drop those already processed, so that the sequence stays small
+        if (midiSource->isStream) {
+          midiSequenceRemoveProcessedEvents(midiSequence);
+
+          if (!midiSource->readMidiEventsUntil(
+                  midiSource, midiSequence,
+                  audioClock->currentFrame + getBlocksize())) {
+            logWarn("Failed reading MIDI events from source '%s'",
+                    midiSource->sourceName->data);
+          }
+        }
+
+        // MIDI source overrides the value set to finishedReading by the input
+        // source
+        finishedReading = (boolByte)!fillMidiEventsFromRange(
+            midiSequence, audioClock->currentFrame, getBlocksize(),
+            midiEventsForBlock);
+
+        if (midiSource->isStream && !midiSource->endOfStream) {
+          finishedReading = false;
+        }
+        linkedListForeach(midiEventsForBlock, _processMidiMetaEvent,
+                          &finishedReading);
+        pluginChainProcessMidi(pluginChain, midiEventsForBlock);
+
+        // A cached stage already contains the delayed end of the MIDI input,
+        // so it runs past the end of the sequence
+        if (stageCache != NULL && stageCache->numCachedStages > 0) {
+          finishedReading = finishedReadingInput;
+        }
+      }
 
-    if (maxTimeInFrames > 0 && audioClock->currentFrame >= maxTimeInFrames) {
-      logInfo("Maximum time reached, stopping processing after this block");
-      finishedReading = true;
+      taskTimerStop(inputTimer);
+
+      if (maxTimeInFrames > 0 &&
+          audioClock->currentFrame >= maxTimeInFrames) {
+        logInfo("Maximum time reached, stopping processing after this block");
+        finishedReading = true;
+      }
+
+      pluginChainProcessAudio(pluginChain, inputSampleBuffer,
+                              outputSampleBuffer);
+
+      taskTimerStart(outputTimer);
+
+      if (finishedReading) {
+        outputSampleBuffer->blocksize =
+            inputSampleBuffer
+                ->blocksize; // The input buffer size has been adjusted.
+        logDebug("Using buffer size of %d for final block",
+                 outputSampleBuffer->blocksize);
+
+        // The output ends exactly where the input ends, plus the length of
+        // the tail. An audio input ends partway through its last block, which
+        // was padded with silence, whereas the end of a MIDI input is only
+        // known in whole blocks.
+        inputEndFrame = midiSequence != NULL
+                            ? audioClock->currentFrame +
+                                  (unsigned long)outputSampleBuffer->blocksize
+                            : inputFramesRead;
+
+        // A cached stage was stored with the delay of the plugins which
+        // rendered it, which is not part of the input
+        if (stageCache != NULL && stageCache->numCachedStages > 0) {
+          cachedStageDelayInFrames = pluginChainGetStageDelay(
+              pluginChain, stageCache->numCachedStages - 1);
+          inputEndFrame = inputFramesRead > cachedStageDelayInFrames
+                              ? inputFramesRead - cachedStageDelayInFrames
+                              : 0;
+        }
+
+        outputEndFrame = inputEndFrame + tailInFrames;
+      }
+
+      // A plugin may report a new initial delay while processing
+      delayCompensatorSetDelay(delayCompensator,
+                               pluginChainGetProcessingDelay(pluginChain));
+      outputFramesWritten +=
+          writeOutput(outputSource, delayCompensator, outputSampleBuffer,
+                      outputEndFrame - outputFramesWritten);
+      taskTimerStop(outputTimer);
+      advanceAudioClock(audioClock, outputSampleBuffer->blocksize);
+
+      if (statsReport != NULL) {
+        statsReport->numBlocks++;
+      }
     }
 
-    pluginChainProcessAudio(pluginChain, inputSampleBuffer, outputSampleBuffer);
+    // Keep processing silence after the end of the input, first to flush the
+    // frames which are still delayed inside the plugins, and then to render
+    // the tails of the plugins if requested. The input buffer is only cleared
+    // once, as the plugin chain does not modify it.
+    flushEndFrame = audioClock->currentFrame + delayCompensator->delayInFrames;
+    silentTailFrames = 0;
+    inputSampleBuffer->blocksize = getBlocksize();
+    sampleBufferClear(inputSampleBuffer);
+
+    while (outputFramesWritten < outputEndFrame &&
+           silentTailFrames < kTailSilenceTimeInMs * getSampleRate() / 1000.0 &&
+           (maxTimeInFrames == 0 ||
+            audioClock->currentFrame < maxTimeInFrames)) {
+      pluginChainProcessAudio(pluginChain, inputSampleBuffer,
+                              outputSampleBuffer);
+
+      if (audioClock->currentFrame >= flushEndFrame) {
+        if (sampleBufferIsSilent(outputSampleBuffer)) {
+          silentTailFrames += outputSampleBuffer->blocksize;
+        } else {
+          silentTailFrames = 0;
+        }
+      }
+
+      taskTimerStart(outputTimer);
+      outputFramesWritten +=
+          writeOutput(outputSource, delayCompensator, outputSampleBuffer,
+                      outputEndFrame - outputFramesWritten);
+      taskTimerStop(outputTimer);
+      advanceAudioClock(audioClock, outputSampleBuffer->blocksize);
 
-    taskTimerStart(outputTimer);
+      if (statsReport != NULL) {
+        statsReport->numBlocks++;
+      }
+    }
 
-    if (finishedReading) {
-      outputSampleBuffer->blocksize =
-          inputSampleBuffer
-              ->blocksize; // The input buffer size has been adjusted.
-      logDebug("Using buffer size of %d for final block",
-               outputSampleBuffer->blocksize);
+    if (tailInFrames > 0 && outputFramesWritten > inputEndFrame) {
+      logDebug("Rendered %lu frames of tail",
+               outputFramesWritten - inputEndFrame);
     }
 
-    writeOutput(outputSource, silentSampleOutput, outputSampleBuffer,
-                processingDelayInFrames);
-    taskTimerStop(outputTimer);
-    advanceAudioClock(audioClock, outputSampleBuffer->blocksize);
+    if (pipelineBenchmark != NULL && iteration > 0) {
+      pipelineBenchmarkEndIteration(pipelineBenchmark, pluginChain,
+                                    audioClock->currentFrame);
+    }
+  }
+
+  // The output is incomplete when a sandboxed plugin had to be restarted, so
+  // this is reported as an error and the output is not cached
+  if (pluginChainGetNumSandboxRestarts(pluginChain) > 0) {
+    logError("Plugins crashed or hung %u times, and their output was replaced "
+             "with silence until they were restarted",
+             pluginChainGetNumSandboxRestarts(pluginChain));
+
+    if (result == RETURN_CODE_SUCCESS) {
+      result = RETURN_CODE_PLUGIN_ERROR;
+    }
   }
 
   // Close file handles for input/output sources
-  silentSampleOutput->closeSampleSource(silentSampleOutput);
   inputSource->closeSampleSource(inputSource);
   outputSource->closeSampleSource(outputSource);
 
+  if (renderCache != NULL && !renderCacheHit && result == RETURN_CODE_SUCCESS) {
+    renderCacheStore(renderCache, outputSource->sourceName);
+  }
+
+  if (stageCache != NULL && result == RETURN_CODE_SUCCESS) {
+    pluginChainSetStageOutputCallback(pluginChain, NULL, NULL);
+
+    for (i = 0; i < stageCache->numStages; i++) {
+      stageDelays[i] = pluginChainGetStageDelay(pluginChain, i);
+    }
+
+    stageCacheFinishWriting(stageCache, inputEndFrame, stageDelays);
+  }
+
   // Print out statistics about each plugin's time usage
-  // TODO: On windows, the total processing time is stored in clocks and not
-  // milliseconds
-  // These values must be converted using the QueryPerformanceFrequency()
-  // function
   audioClockStop(audioClock);
   taskTimerStop(totalTimer);
 
@@ -1118,6 +2265,40 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
             "computer is smokin' fast!");
   }
 
+  if (pipelineBenchmark != NULL) {
+    pipelineBenchmarkPrint(pipelineBenchmark, pluginChain);
+  }
+
+  if (statsReport != NULL) {
+    LinkedList phaseTimers = newLinkedList();
+    linkedListAppend(phaseTimers, initTimer);
+    linkedListAppend(phaseTimers, inputTimer);
+    linkedListAppend(phaseTimers, outputTimer);
+
+    // The sources are reopened for each pass over the input, so these only
+    // count the last one
+    if (iteration > 1) {
+      statsReport->numPasses = iteration;
+    }
+
+    statsReport->framesRead =
+        inputSource->numSamplesProcessed / getNumChannels();
+    statsReport->framesWritten =
+        outputSource->numSamplesProcessed / getNumChannels();
+
+    if (midiSequence != NULL) {
+      statsReport->midiEventsProcessed =
+          (unsigned long)midiSequence->numMidiEventsProcessed;
+    }
+
+    logInfo("Writing statistics to '%s'", statsReport->outputPath->data);
+    statsReportWritten =
+        statsReportWrite(statsReport, totalTimer, phaseTimers, pluginChain);
+    freeLinkedList(phaseTimers);
+    freeStatsReport(statsReport);
+  }
+
+  freePipelineBenchmark(pipelineBenchmark);
   freeTaskTimer(initTimer);
   freeTaskTimer(inputTimer);
   freeTaskTimer(outputTimer);
@@ -1138,26 +2319,42 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
           outputSource->numSamplesProcessed / getNumChannels(),
           outputSource->sourceName->data);
 
+  if (pluginChain->numSkippedBlocks > 0) {
+    logInfo("Skipped processing of %lu silent blocks",
+            pluginChain->numSkippedBlocks);
+  }
+
   // Shut down and free data (will also close open files, plugins, etc)
   logInfo("Shutting down");
   freeSampleSource(inputSource);
   freeSampleSource(outputSource);
-  freeSampleSource(silentSampleOutput);
+  freeDelayCompensator(delayCompensator);
   freeSampleBuffer(inputSampleBuffer);
   freeSampleBuffer(outputSampleBuffer);
+  freeLinkedList(midiEventsForBlock);
   pluginChainShutdown(pluginChain);
   freePluginChain(pluginChain);
   freeMidiSource(midiSource);
   freeMidiSequence(midiSequence);
+  freePresetSweep(presetSweep);
+  freeParameterSweep(parameterSweep);
+  freeCharString(sweepOutputName);
+  freeRenderCache(renderCache);
+  freeStageCache(stageCache);
 
   freeAudioSettings();
   logInfo("Goodbye!");
   freeEventLogger();
+  freeTraceLogger();
   freeAudioClock(getAudioClock());
 
   if (errorReporter->started) {
     errorReporterClose(errorReporter);
   }
 
-  return RETURN_CODE_SUCCESS;
+  if (result == RETURN_CODE_SUCCESS && !statsReportWritten) {
+    result = RETURN_CODE_IO_ERROR;
+  }
+
+  return result;
 }
@@ -28,12 +28,52 @@
 
 #include "audio/AudioSettings.h"
 #include "base/File.h"
+#include "plugin/PluginAutomation.h"
+#include "plugin/PluginSandbox.h"
 
 #include <stdio.h>
 
 ProgramOptions newMrsWatsonOptions(void) {
   ProgramOptions options = newProgramOptions(NUM_OPTIONS);
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_AUTOMATION, "automation",
+          "Automate plugin parameters from a file. Unlike --parameter, any plugin \
+in the chain may be automated. Each line of the file has the form:\n\n\
+\tframe,plugin,parameter,value[,step|linear]\n\n\
+Where frame is the time in sample frames, and plugin is the index of the \
+plugin in the chain, starting from 0. With linear interpolation, the value \
+ramps from the parameter's previous point. Blocks are split at each change, \
+so that parameters are set at exactly the right frame. Binary files with \
+the 'MWAU' header are also supported.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_AUTOMATION_CONTROL_RATE, "automation-control-rate",
+          "Number of sample frames between parameter updates during linear \
+automation ramps.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(options, OPTION_AUTOMATION_CONTROL_RATE,
+                          DEFAULT_AUTOMATION_CONTROL_RATE);
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_BENCHMARK, "benchmark",
+          "Process the input source <argument> times after an initial warm-up pass, \
+and report the mean, standard deviation, and minimum realtime factor for the \
+whole pipeline and for each plugin. Plugins are suspended and resumed between \
+each pass. If no output source is given, then output is discarded. Input and \
+output may not be stdin/stdout in this mode.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -55,6 +95,19 @@ multiple of the blocksize, then empty frames will be added to the last block.",
   programOptionsSetNumber(options, OPTION_BLOCKSIZE,
                           (const float)getBlocksize());
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_CHANNEL_MAP, "channel-map",
+          "Route the input channels to the inputs of the first plugin with a comma \
+separated list of 'input:output[:gain]' routes, where channels start at 0 and \
+the gain is a linear factor. For example, '0:0,0:1,1:0:0.5' sends the first \
+input channel to both plugin inputs and mixes the second channel into the first \
+plugin input at half volume. Without this option, channels are mapped one to \
+one, and are up- or downmixed when the channel counts differ.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -105,6 +158,17 @@ like so:\n\n\
                         NO_SHORT_FORM, kProgramOptionTypeEmpty,
                         kProgramOptionArgumentTypeNone));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_DOUBLE_PRECISION, "double-precision",
+          "Process audio with 64-bit samples in plugins which support it. Audio \
+is passed between such plugins without being converted to 32-bit samples, \
+which reduces rounding errors in long chains. Plugins which only support \
+32-bit samples are processed as usual.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -150,6 +214,17 @@ Otherwise, extended help can be printed for an individual option given by \
           HAS_SHORT_FORM, kProgramOptionTypeString,
           kProgramOptionArgumentTypeOptional));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_INPUT_CACHE, "input-cache",
+          "Directory used to cache decoded input files. The first run decodes the \
+input and stores it in this directory as raw 32-bit float samples, which later \
+runs with the same input file, sample rate and channel count read directly \
+without decoding it again. Cache files are never removed automatically.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -197,10 +272,27 @@ input source length. Mostly useful when using internal plugins as sources.",
   programOptionsAdd(options, newProgramOptionWithName(
                                  OPTION_MIDI_SOURCE, "midi-file",
                                  "MIDI file to read events from. Required if "
-                                 "processing an instrument plugin.",
+                                 "processing an instrument plugin. Use '-' to "
+                                 "read from stdin; stdin and named pipes are "
+                                 "read incrementally while processing, either "
+                                 "as a type 0 MIDI file or as raw events with "
+                                 "delta times in sample frames.",
                                  HAS_SHORT_FORM, kProgramOptionTypeString,
                                  kProgramOptionArgumentTypeRequired));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_OFFLINE, "offline",
+          "Let the plugin process the entire input at once with the VST offline \
+interface, so that it can read the input in any order and in several passes. \
+This requires a single plugin which supports offline processing, and an input \
+file which is read into memory. Otherwise the input is processed in blocks as \
+usual. Plugins are told that they are processed offline whenever --realtime is \
+not given, even without this option.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -212,6 +304,17 @@ Use '-' to write to stdout..",
           kProgramOptionArgumentTypeOptional));
   programOptionsSetCString(options, OPTION_OUTPUT_SOURCE, "out.wav");
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_PARALLEL_BRANCHES, "parallel-branches",
+          "Process the branches of each split in a plugin graph at the same time, \
+with up to one thread per processor. Some plugins may not work correctly when \
+several instances of them are processed on different threads. See --plugin \
+for how to give a plugin graph.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -238,9 +341,14 @@ for the OS. File extensions are added automatically to plugin names. Each plugin
 may be followed by a comma with a program to be loaded, which should be of the \
 corresponding file format for the respective plugin. For shell plugins (like \
 Waves), use --display-info to get a list of sub-plugin ID's and then use a colon \
-to indicate which plugin to load. Examples:\n\n\
+to indicate which plugin to load. Plugins may also be processed in parallel \
+branches, which are put in square brackets and separated by vertical bars. The \
+outputs of the branches are summed, after the branches with less processing \
+delay have been delayed to line up with the others. An empty branch passes the \
+signal through unchanged. Examples:\n\n\
 \t--plugin LFX-1310\n\
 \t--plugin 'AutoTune,KayneWest.fxp;Compressor,SoftKnee.fxp;Limiter'\n\
+\t--plugin '[|Compressor,Squash.fxp];Limiter' (parallel compression)\n\
 \t--plugin 'WavesShell-VST' --display-info (list shell sub-plugins)\n\
 \t--plugin 'WavesShell-VST:IDFX' (load a shell plugins)",
           HAS_SHORT_FORM, kProgramOptionTypeString,
@@ -255,6 +363,20 @@ to indicate which plugin to load. Examples:\n\n\
           NO_SHORT_FORM, kProgramOptionTypeString,
           kProgramOptionArgumentTypeRequired));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_PRESET_SWEEP, "preset-sweep",
+          "Render the input once for each preset, loading the presets into the \
+first plugin in the chain. The argument is either a directory, in which case \
+all FXP presets in it are used in alphabetical order, or a list of presets \
+or program numbers separated by semicolons. The input is decoded only once \
+and the plugins are reset between presets. Each output file is named by \
+replacing '{preset}' in the output name with the preset's name, or by \
+appending the preset's name to the output basename.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
   programOptionsAdd(
       options, newProgramOptionWithName(OPTION_QUIET, "quiet",
                                         "Only log critical errors.",
@@ -271,6 +393,20 @@ option in order to function properly.",
           NO_SHORT_FORM, kProgramOptionTypeEmpty,
           kProgramOptionArgumentTypeNone));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_RENDER_CACHE, "render-cache",
+          "Directory used to cache rendered output files. Each render is identified \
+by the contents of the input, MIDI, preset and automation files, the plugins' \
+paths and modification times, the parameters, the audio settings and the \
+program version. If the same render has been done before, the output file is \
+linked or copied from the cache and no processing is done. This option has no \
+effect for sweeps, benchmarks or streams. Cache entries are never removed \
+automatically.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -284,6 +420,105 @@ using unusual sample rates will probably result in weird behavior from plugins."
   programOptionsSetNumber(options, OPTION_SAMPLE_RATE,
                           (const float)getSampleRate());
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_SANDBOX, "sandbox",
+          "Run each VST plugin in its own process, so that a plugin which crashes or \
+hangs does not take down the host. The argument is the time in milliseconds which \
+a plugin may take to respond before it is considered to be hung. Crashed or hung \
+plugins are restarted, the affected block is replaced with silence, and the \
+program exits with an error. Only supported on Linux.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeOptional));
+  programOptionsSetNumber(options, OPTION_SANDBOX,
+                          (const float)DEFAULT_SANDBOX_TIMEOUT_IN_MS);
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_SKIP_SILENCE, "skip-silence",
+          "Do not process blocks of silent input once the tails of all plugins have \
+passed, or once the output has been silent for that long. Silence is written for \
+these blocks instead, and processing resumes with the next block that has input \
+or MIDI events. This speeds up inputs with long stretches of silence.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_STAGE_CACHE, "stage-cache",
+          "Directory used to cache the output of each plugin in the chain. Later runs \
+whose chain starts with the same plugins, presets and parameters on the same \
+input read the output of the deepest matching plugin from the cache, and only \
+process the plugins after it. This option has no effect for sweeps, benchmarks \
+or streams.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_STAGE_CACHE_SIZE, "stage-cache-size",
+          "Maximum size of the stage cache in megabytes. When the cache grows larger, \
+the least recently used entries are removed. Use 0 for no limit.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(options, OPTION_STAGE_CACHE_SIZE, 1024.0f);
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_STATS_FILE, "stats-file",
+          "Write statistics about the run to the given file in JSON format. \
+This includes timing and per-block latency for each processing phase and \
+plugin, the realtime factor, frame and MIDI event counts, and peak memory \
+usage.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetCString(options, OPTION_STATS_FILE, "stats.json");
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_SWEEP, "sweep",
+          "Render the input once for each combination of parameter values on \
+the first plugin in the chain. Like --parameter, each parameter is given by \
+its index, followed by either a range with a step size or a list of values \
+in braces, for example:\n\n\
+\t3:0..1:0.1,7:{0,0.5,1}\n\n\
+The input is decoded only once and the plugins are reset between renders. \
+Each output file is named by replacing '{point}' in the output name with the \
+point number, or by appending the point number to the output basename. A \
+CSV manifest listing the parameter values of each output is written next to \
+the outputs.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_SWEEP_RANDOM, "sweep-random",
+          "Instead of rendering every combination of values given to --sweep, \
+render this number of randomly chosen points. Parameters given as a range \
+may take any value within the range. The same points are chosen every time \
+for the same sweep.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_TAIL, "tail",
+          "Keep processing silence after the end of the input, so that reverb and delay \
+tails are not cut off. The argument is the maximum length of the tail in \
+milliseconds. If no argument is given, the longest tail time reported by any \
+plugin in the chain is used. Rendering stops early once the output has been \
+silent for 500ms.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeOptional));
+
   programOptionsAdd(
       options, newProgramOptionWithName(OPTION_TEMPO, "tempo",
                                         "Tempo to use when processing.",
@@ -302,6 +537,17 @@ using unusual sample rates will probably result in weird behavior from plugins."
   // hardcoded string is also relatively safe.
   programOptionsSetCString(options, OPTION_TIME_SIGNATURE, "4/4");
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_TRACE_FILE, "trace-file",
+          "Write a timeline of initialization and of each processed block to \
+the given file. The file uses the trace event format, and can be opened with \
+chrome://tracing or https://ui.perfetto.dev.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetCString(options, OPTION_TRACE_FILE, "trace.json");
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
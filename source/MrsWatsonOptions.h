@@ -31,17 +31,23 @@
 
 // Runtime options
 typedef enum {
+  OPTION_AUTOMATION,
+  OPTION_AUTOMATION_CONTROL_RATE,
+  OPTION_BENCHMARK,
   OPTION_BIT_DEPTH,
   OPTION_BLOCKSIZE,
+  OPTION_CHANNEL_MAP,
   OPTION_CHANNELS,
   OPTION_COLOR_LOGGING,
   OPTION_COLOR_TEST,
   OPTION_CONFIG_FILE,
   OPTION_DISPLAY_INFO,
+  OPTION_DOUBLE_PRECISION,
   OPTION_EDITOR,
   OPTION_ENDIAN,
   OPTION_ERROR_REPORT,
   OPTION_HELP,
+  OPTION_INPUT_CACHE,
   OPTION_INPUT_SOURCE,
   OPTION_LIST_FILE_TYPES,
   OPTION_LIST_PLUGINS,
@@ -49,15 +55,28 @@ typedef enum {
   OPTION_LOG_LEVEL,
   OPTION_MAX_TIME,
   OPTION_MIDI_SOURCE,
+  OPTION_OFFLINE,
   OPTION_OUTPUT_SOURCE,
+  OPTION_PARALLEL_BRANCHES,
   OPTION_PARAMETER,
   OPTION_PLUGIN,
   OPTION_PLUGIN_ROOT,
+  OPTION_PRESET_SWEEP,
   OPTION_QUIET,
   OPTION_REALTIME,
+  OPTION_RENDER_CACHE,
   OPTION_SAMPLE_RATE,
+  OPTION_SANDBOX,
+  OPTION_SKIP_SILENCE,
+  OPTION_STAGE_CACHE,
+  OPTION_STAGE_CACHE_SIZE,
+  OPTION_STATS_FILE,
+  OPTION_SWEEP,
+  OPTION_SWEEP_RANDOM,
+  OPTION_TAIL,
   OPTION_TEMPO,
   OPTION_TIME_SIGNATURE,
+  OPTION_TRACE_FILE,
   OPTION_VERBOSE,
   OPTION_VERSION,
   OPTION_ZEBRA_SIZE,
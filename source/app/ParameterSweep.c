@@ -0,0 +1,419 @@
+//
+// ParameterSweep.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "ParameterSweep.h"
+
+#include "app/PresetSweep.h"
+#include "base/File.h"
+#include "logging/EventLogger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+ParameterSweep newParameterSweep(void) {
+  ParameterSweep self = (ParameterSweep)malloc(sizeof(ParameterSweepMembers));
+
+  self->_axesCapacity = 4;
+  self->axes = (ParameterSweepAxisMembers *)malloc(
+      sizeof(ParameterSweepAxisMembers) * self->_axesCapacity);
+  self->numAxes = 0;
+  self->numPoints = 0;
+  self->_randomValues = NULL;
+
+  return self;
+}
+
+static ParameterSweepAxis _parameterSweepAddAxis(ParameterSweep self,
+                                                 unsigned int parameterIndex,
+                                                 unsigned int numValues) {
+  ParameterSweepAxis axis;
+
+  if (self->numAxes == self->_axesCapacity) {
+    self->_axesCapacity *= 2;
+    self->axes = (ParameterSweepAxisMembers *)realloc(
+        self->axes, sizeof(ParameterSweepAxisMembers) * self->_axesCapacity);
+  }
+
+  axis = &(self->axes[self->numAxes]);
+  axis->parameterIndex = parameterIndex;
+  axis->values = (float *)malloc(sizeof(float) * numValues);
+  axis->numValues = numValues;
+  axis->isRange = false;
+  axis->rangeStart = 0.0f;
+  axis->rangeEnd = 0.0f;
+  self->numAxes++;
+  return axis;
+}
+
+// Parse a list of values in braces, such as "{0,0.5,1}"
+static boolByte _parameterSweepParseList(ParameterSweep self,
+                                         unsigned int parameterIndex,
+                                         const char *listString) {
+  ParameterSweepAxis axis;
+  const char *listEnd = strchr(listString, '}');
+  const char *c;
+  char *valueEnd;
+  unsigned int numValues = 1;
+  unsigned int i;
+
+  if (listEnd == NULL || listEnd[1] != '\0' || listEnd == listString + 1) {
+    return false;
+  }
+
+  for (c = listString + 1; c < listEnd; c++) {
+    if (*c == ',') {
+      numValues++;
+    }
+  }
+
+  axis = _parameterSweepAddAxis(self, parameterIndex, numValues);
+  c = listString + 1;
+
+  for (i = 0; i < numValues; i++) {
+    axis->values[i] = (float)strtod(c, &valueEnd);
+
+    if (valueEnd == c || (*valueEnd != ',' && *valueEnd != '}')) {
+      return false;
+    }
+
+    c = valueEnd + 1;
+  }
+
+  return true;
+}
+
+// Parse a range with a step size, such as "0..1:0.1"
+static boolByte _parameterSweepParseRange(ParameterSweep self,
+                                          unsigned int parameterIndex,
+                                          const char *rangeString) {
+  ParameterSweepAxis axis;
+  const char *separator = strstr(rangeString, "..");
+  char *valueEnd;
+  double start, end, step;
+  unsigned long numValues;
+  unsigned int i;
+
+  if (separator == NULL) {
+    return false;
+  }
+
+  // strtod() reads "0..1" as "0." followed by ".1", so the start of the range
+  // may end on either dot of the separator
+  start = strtod(rangeString, &valueEnd);
+
+  if (valueEnd == rangeString ||
+      (valueEnd != separator && valueEnd != separator + 1)) {
+    return false;
+  }
+
+  rangeString = separator + 2;
+  end = strtod(rangeString, &valueEnd);
+
+  if (valueEnd == rangeString || *valueEnd != ':') {
+    return false;
+  }
+
+  rangeString = valueEnd + 1;
+  step = strtod(rangeString, &valueEnd);
+
+  if (valueEnd == rangeString || *valueEnd != '\0' || step <= 0.0 ||
+      end < start) {
+    return false;
+  }
+
+  // Allow for some rounding error, so that the end of the range is included
+  // when the step size divides it evenly
+  numValues = (unsigned long)((end - start) / step + 1.0e-4) + 1;
+
+  if (numValues > PARAMETER_SWEEP_MAX_POINTS) {
+    return false;
+  }
+
+  axis = _parameterSweepAddAxis(self, parameterIndex, (unsigned int)numValues);
+  axis->isRange = true;
+  axis->rangeStart = (float)start;
+  axis->rangeEnd = (float)end;
+
+  for (i = 0; i < axis->numValues; i++) {
+    axis->values[i] = (float)(start + i * step);
+  }
+
+  if (axis->values[axis->numValues - 1] > axis->rangeEnd) {
+    axis->values[axis->numValues - 1] = axis->rangeEnd;
+  }
+
+  return true;
+}
+
+static boolByte _parameterSweepParseAxis(ParameterSweep self,
+                                         const char *axisString) {
+  char *indexEnd;
+  unsigned long parameterIndex = strtoul(axisString, &indexEnd, 10);
+
+  if (indexEnd == axisString || *indexEnd != ':') {
+    return false;
+  } else if (indexEnd[1] == '{') {
+    return _parameterSweepParseList(self, (unsigned int)parameterIndex,
+                                    indexEnd + 1);
+  } else {
+    return _parameterSweepParseRange(self, (unsigned int)parameterIndex,
+                                     indexEnd + 1);
+  }
+}
+
+boolByte parameterSweepParse(ParameterSweep self,
+                             const CharString sweepString) {
+  CharString buffer;
+  char *axisStart;
+  char *c;
+  int braceDepth = 0;
+  boolByte result = true;
+  unsigned int i;
+
+  if (charStringIsEmpty(sweepString)) {
+    return false;
+  }
+
+  // Split the string at commas which are not inside of a list
+  buffer = newCharStringWithCString(sweepString->data);
+  axisStart = buffer->data;
+
+  for (c = buffer->data; result; c++) {
+    if (*c == '{') {
+      braceDepth++;
+    } else if (*c == '}') {
+      braceDepth--;
+    } else if ((*c == ',' && braceDepth == 0) || *c == '\0') {
+      boolByte isLastAxis = (boolByte)(*c == '\0');
+      *c = '\0';
+
+      if (!_parameterSweepParseAxis(self, axisStart)) {
+        logError("Invalid parameter sweep '%s', see --help sweep for usage",
+                 axisStart);
+        result = false;
+      }
+
+      axisStart = c + 1;
+
+      if (isLastAxis) {
+        break;
+      }
+    }
+  }
+
+  freeCharString(buffer);
+
+  if (!result) {
+    return false;
+  }
+
+  self->numPoints = 1;
+
+  for (i = 0; i < self->numAxes; i++) {
+    if (self->numPoints >
+        PARAMETER_SWEEP_MAX_POINTS / self->axes[i].numValues) {
+      logError("Parameter sweep has more than %lu points",
+               PARAMETER_SWEEP_MAX_POINTS);
+      return false;
+    }
+
+    self->numPoints *= self->axes[i].numValues;
+  }
+
+  return true;
+}
+
+// xorshift64*, which is good enough for picking points and gives the same
+// results on every platform, unlike rand()
+static unsigned long long _parameterSweepNextRandom(unsigned long long *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 2685821657736338717ull;
+}
+
+void parameterSweepRandomize(ParameterSweep self, const unsigned long numPoints,
+                             const unsigned long seed) {
+  // A state of zero would only ever produce zeroes
+  unsigned long long state = seed + 0x9e3779b97f4a7c15ull;
+  ParameterSweepAxis axis;
+  unsigned long point;
+  unsigned int i;
+  double random;
+
+  free(self->_randomValues);
+  self->_randomValues =
+      (float *)malloc(sizeof(float) * numPoints * self->numAxes);
+  self->numPoints = numPoints;
+
+  for (point = 0; point < numPoints; point++) {
+    for (i = 0; i < self->numAxes; i++) {
+      axis = &(self->axes[i]);
+      // Use the upper 53 bits, which gives a value in the range [0, 1)
+      random = (_parameterSweepNextRandom(&state) >> 11) *
+               (1.0 / 9007199254740992.0);
+
+      if (axis->isRange) {
+        self->_randomValues[point * self->numAxes + i] =
+            (float)(axis->rangeStart +
+                    random * (axis->rangeEnd - axis->rangeStart));
+      } else {
+        self->_randomValues[point * self->numAxes + i] =
+            axis->values[(unsigned int)(random * axis->numValues)];
+      }
+    }
+  }
+}
+
+float parameterSweepGetValue(const ParameterSweep self,
+                             const unsigned long point,
+                             const unsigned int axis) {
+  unsigned long remainder = point;
+  unsigned int i;
+
+  if (self->_randomValues != NULL) {
+    return self->_randomValues[point * self->numAxes + axis];
+  }
+
+  // The last axis changes fastest, like the digits of a number
+  for (i = self->numAxes - 1; i > axis; i--) {
+    remainder /= self->axes[i].numValues;
+  }
+
+  return self->axes[axis].values[remainder % self->axes[axis].numValues];
+}
+
+boolByte parameterSweepApply(const ParameterSweep self,
+                             const unsigned long point, Plugin plugin) {
+  float value;
+  unsigned int i;
+
+  for (i = 0; i < self->numAxes; i++) {
+    value = parameterSweepGetValue(self, point, i);
+    logDebug("Set parameter %d to %f", self->axes[i].parameterIndex, value);
+
+    if (!plugin->setParameter(plugin, self->axes[i].parameterIndex, value)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+CharString parameterSweepGetOutputName(const ParameterSweep self,
+                                       const CharString outputName,
+                                       const unsigned long point) {
+  char label[24];
+  int numDigits = 1;
+  unsigned long lastPoint;
+
+  if (point >= self->numPoints || outputName == NULL) {
+    return NULL;
+  }
+
+  // Pad the point numbers so that the outputs are listed in order
+  for (lastPoint = self->numPoints - 1; lastPoint >= 10; lastPoint /= 10) {
+    numDigits++;
+  }
+
+  snprintf(label, sizeof(label), "%0*lu", numDigits, point);
+  return presetSweepFormatOutputName(outputName, PARAMETER_SWEEP_NAME_TEMPLATE,
+                                     label);
+}
+
+CharString parameterSweepGetManifestName(const CharString outputName) {
+  CharString result =
+      presetSweepFormatOutputName(outputName, PARAMETER_SWEEP_NAME_TEMPLATE,
+                                  PARAMETER_SWEEP_MANIFEST_LABEL);
+  char *basename = strrchr(result->data, PATH_DELIMITER);
+  char *extension;
+
+  basename = basename != NULL ? basename + 1 : result->data;
+  extension = strrchr(basename, '.');
+
+  if (extension != NULL && extension != basename) {
+    *extension = '\0';
+  }
+
+  charStringAppendCString(result, ".csv");
+  return result;
+}
+
+boolByte parameterSweepWriteManifest(const ParameterSweep self,
+                                     const CharString outputName) {
+  CharString manifestName = parameterSweepGetManifestName(outputName);
+  CharString pointOutputName;
+  FILE *manifestFile = fopen(manifestName->data, "w");
+  unsigned long point;
+  unsigned int i;
+
+  if (manifestFile == NULL) {
+    logError("Could not open sweep manifest '%s' for writing",
+             manifestName->data);
+    freeCharString(manifestName);
+    return false;
+  }
+
+  fprintf(manifestFile, "point,output");
+
+  for (i = 0; i < self->numAxes; i++) {
+    fprintf(manifestFile, ",parameter_%u", self->axes[i].parameterIndex);
+  }
+
+  fprintf(manifestFile, "\n");
+
+  for (point = 0; point < self->numPoints; point++) {
+    pointOutputName = parameterSweepGetOutputName(self, outputName, point);
+    fprintf(manifestFile, "%lu,%s", point, pointOutputName->data);
+    freeCharString(pointOutputName);
+
+    for (i = 0; i < self->numAxes; i++) {
+      fprintf(manifestFile, ",%g", parameterSweepGetValue(self, point, i));
+    }
+
+    fprintf(manifestFile, "\n");
+  }
+
+  fclose(manifestFile);
+  logInfo("Wrote parameter sweep manifest to '%s'", manifestName->data);
+  freeCharString(manifestName);
+  return true;
+}
+
+void freeParameterSweep(ParameterSweep self) {
+  unsigned int i;
+
+  if (self != NULL) {
+    for (i = 0; i < self->numAxes; i++) {
+      free(self->axes[i].values);
+    }
+
+    free(self->axes);
+    free(self->_randomValues);
+    free(self);
+  }
+}
@@ -0,0 +1,168 @@
+//
+// ParameterSweep.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_ParameterSweep_h
+#define MrsWatson_ParameterSweep_h
+
+#include "base/CharString.h"
+#include "base/Types.h"
+#include "plugin/Plugin.h"
+
+/**
+ * Output names containing this string have it replaced with the point number,
+ * otherwise the point number is appended to the output file's basename.
+ */
+#define PARAMETER_SWEEP_NAME_TEMPLATE "{point}"
+/** Label used in place of the point number for the manifest file */
+#define PARAMETER_SWEEP_MANIFEST_LABEL "manifest"
+/** Sweeps with more points than this are most likely a typo */
+#define PARAMETER_SWEEP_MAX_POINTS 10000000ul
+
+/**
+ * One parameter of a sweep, which either steps through a range or through a
+ * list of values.
+ */
+typedef struct {
+  unsigned int parameterIndex;
+  // Values of the grid, in the order that they are rendered
+  float *values;
+  unsigned int numValues;
+  // Set for ranges, where random sweeps may pick any value in between
+  boolByte isRange;
+  float rangeStart;
+  float rangeEnd;
+} ParameterSweepAxisMembers;
+typedef ParameterSweepAxisMembers *ParameterSweepAxis;
+
+/**
+ * Set of parameter values for the first plugin in the chain, which are each
+ * rendered with the same input. By default every combination of values is
+ * rendered, but a number of random points can be chosen instead.
+ */
+typedef struct {
+  ParameterSweepAxisMembers *axes;
+  unsigned int numAxes;
+  unsigned long numPoints;
+
+  // Private fields
+  unsigned int _axesCapacity;
+  // Values for random sweeps, stored with all axes of the first point followed
+  // by those of the second, etc. NULL for grid sweeps.
+  float *_randomValues;
+} ParameterSweepMembers;
+typedef ParameterSweepMembers *ParameterSweep;
+
+/**
+ * Create a new, empty parameter sweep.
+ * @return Initialized ParameterSweep
+ */
+ParameterSweep newParameterSweep(void);
+
+/**
+ * Add parameters to the sweep from a string. The string holds a comma-separated
+ * list of parameters, which are either given as a range with a step size, or a
+ * list of values in braces. For example:
+ *
+ *   3:0..1:0.1,7:{0,0.5,1}
+ *
+ * Sweeps parameter 3 from 0 to 1 in steps of 0.1, and parameter 7 through the
+ * values 0, 0.5 and 1, which is a total of 33 points.
+ * @param self
+ * @param sweepString Sweep specification
+ * @return True if the string could be parsed
+ */
+boolByte parameterSweepParse(ParameterSweep self, const CharString sweepString);
+
+/**
+ * Replace the grid with randomly chosen points. Values for ranges are chosen
+ * uniformly between the start and end of the range, and values for lists are
+ * picked from the list. The same seed always gives the same points.
+ * @param self
+ * @param numPoints Number of points to choose
+ * @param seed Seed for the random number generator
+ */
+void parameterSweepRandomize(ParameterSweep self, const unsigned long numPoints,
+                             const unsigned long seed);
+
+/**
+ * Get the value of a parameter at a point in the sweep.
+ * @param self
+ * @param point Index of the point, which must be less than numPoints
+ * @param axis Index of the parameter in the sweep
+ * @return Parameter value
+ */
+float parameterSweepGetValue(const ParameterSweep self,
+                             const unsigned long point,
+                             const unsigned int axis);
+
+/**
+ * Set all parameters of a point in the sweep on a plugin.
+ * @param self
+ * @param point Index of the point
+ * @param plugin Plugin to set the parameters on
+ * @return True if all parameters were set
+ */
+boolByte parameterSweepApply(const ParameterSweep self,
+                             const unsigned long point, Plugin plugin);
+
+/**
+ * Get the name of the output file to use for a point in the sweep.
+ * @param self
+ * @param outputName Output name given by the user
+ * @param point Index of the point
+ * @return Output name, which must be freed by the caller, or NULL if the point
+ * is out of range
+ */
+CharString parameterSweepGetOutputName(const ParameterSweep self,
+                                       const CharString outputName,
+                                       const unsigned long point);
+
+/**
+ * Get the name of the manifest file for a sweep. The manifest is named after
+ * the outputs, with the point number replaced by PARAMETER_SWEEP_MANIFEST_LABEL
+ * and a csv extension.
+ * @param outputName Output name given by the user
+ * @return Manifest name, which must be freed by the caller
+ */
+CharString parameterSweepGetManifestName(const CharString outputName);
+
+/**
+ * Write a CSV file listing the output file and parameter values for each
+ * point, see parameterSweepGetManifestName().
+ * @param self
+ * @param outputName Output name given by the user
+ * @return True if the manifest was written
+ */
+boolByte parameterSweepWriteManifest(const ParameterSweep self,
+                                     const CharString outputName);
+
+/**
+ * Free a parameter sweep and all associated resources
+ * @param self
+ */
+void freeParameterSweep(ParameterSweep self);
+
+#endif
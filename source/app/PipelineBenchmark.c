@@ -0,0 +1,217 @@
+//
+// PipelineBenchmark.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PipelineBenchmark.h"
+
+#include "audio/AudioSettings.h"
+#include "logging/EventLogger.h"
+#include "time/TaskTimer.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+PipelineBenchmark newPipelineBenchmark(const unsigned long numIterations,
+                                       const PluginChain pluginChain) {
+  PipelineBenchmark pipelineBenchmark =
+      (PipelineBenchmark)malloc(sizeof(PipelineBenchmarkMembers));
+  unsigned int numPlugins = pluginChain->numPlugins;
+
+  pipelineBenchmark->numIterations = numIterations;
+  pipelineBenchmark->numIterationsRecorded = 0;
+  pipelineBenchmark->numPlugins = numPlugins;
+  pipelineBenchmark->pipelineRealtimeFactors =
+      (double *)calloc(numIterations, sizeof(double));
+  pipelineBenchmark->pluginRealtimeFactors =
+      (double *)calloc(numIterations * numPlugins, sizeof(double));
+  pipelineBenchmark->_pluginTimesAtStartInMs =
+      (double *)calloc(numPlugins, sizeof(double));
+  pipelineBenchmark->_iterationStartTimeInNs = 0;
+
+  return pipelineBenchmark;
+}
+
+static double _getPluginTimeInMs(const PluginChain pluginChain,
+                                 unsigned int index) {
+  return pluginChain->audioTimers[index]->totalTaskTime +
+         pluginChain->midiTimers[index]->totalTaskTime;
+}
+
+static double _getRealtimeFactor(const double audioDurationInMs,
+                                 const double timeInMs) {
+  // A zero processing time will produce an infinite factor, which is written
+  // to JSON as null, so it is not worth special-casing here
+  return audioDurationInMs / timeInMs;
+}
+
+void pipelineBenchmarkBeginIteration(PipelineBenchmark self,
+                                     const PluginChain pluginChain) {
+  unsigned int i;
+
+  for (i = 0; i < self->numPlugins; i++) {
+    self->_pluginTimesAtStartInMs[i] = _getPluginTimeInMs(pluginChain, i);
+  }
+
+  self->_iterationStartTimeInNs = taskTimerGetCurrentTimeInNs();
+}
+
+void pipelineBenchmarkEndIteration(PipelineBenchmark self,
+                                   const PluginChain pluginChain,
+                                   const unsigned long numFrames) {
+  double pipelineTimeInMs =
+      (taskTimerGetCurrentTimeInNs() - self->_iterationStartTimeInNs) /
+      1000000.0;
+  double audioDurationInMs = numFrames * 1000.0 / getSampleRate();
+  double *pluginRealtimeFactors;
+  unsigned int i;
+
+  if (self->numIterationsRecorded >= self->numIterations) {
+    return;
+  }
+
+  self->pipelineRealtimeFactors[self->numIterationsRecorded] =
+      _getRealtimeFactor(audioDurationInMs, pipelineTimeInMs);
+  pluginRealtimeFactors = self->pluginRealtimeFactors +
+                          self->numIterationsRecorded * self->numPlugins;
+
+  for (i = 0; i < self->numPlugins; i++) {
+    pluginRealtimeFactors[i] = _getRealtimeFactor(
+        audioDurationInMs, _getPluginTimeInMs(pluginChain, i) -
+                               self->_pluginTimesAtStartInMs[i]);
+  }
+
+  self->numIterationsRecorded++;
+}
+
+boolByte pipelineBenchmarkGetStats(const PipelineBenchmark self,
+                                   const int pluginIndex, double *outMean,
+                                   double *outStddev, double *outMin) {
+  const double *values;
+  size_t stride;
+  double value;
+  double sum = 0.0;
+  double sumOfSquares = 0.0;
+  unsigned long n = self->numIterationsRecorded;
+  unsigned long i;
+
+  if (n == 0) {
+    return false;
+  } else if (pluginIndex == PIPELINE_BENCHMARK_WHOLE_CHAIN) {
+    values = self->pipelineRealtimeFactors;
+    stride = 1;
+  } else if (pluginIndex >= 0 && (unsigned int)pluginIndex < self->numPlugins) {
+    values = self->pluginRealtimeFactors + pluginIndex;
+    stride = self->numPlugins;
+  } else {
+    return false;
+  }
+
+  *outMin = values[0];
+
+  for (i = 0; i < n; i++) {
+    value = values[i * stride];
+    sum += value;
+
+    if (value < *outMin) {
+      *outMin = value;
+    }
+  }
+
+  *outMean = sum / n;
+
+  for (i = 0; i < n; i++) {
+    value = values[i * stride] - *outMean;
+    sumOfSquares += value * value;
+  }
+
+  *outStddev = n > 1 ? sqrt(sumOfSquares / (n - 1)) : 0.0;
+  return true;
+}
+
+static void _printStats(const PipelineBenchmark self, const int pluginIndex,
+                        const char *name) {
+  double mean, stddev, min;
+
+  if (pipelineBenchmarkGetStats(self, pluginIndex, &mean, &stddev, &min)) {
+    logInfo("  %s: %.2fx realtime (stddev %.2f, min %.2fx)", name, mean,
+            stddev, min);
+  }
+}
+
+void pipelineBenchmarkPrint(const PipelineBenchmark self,
+                            const PluginChain pluginChain) {
+  unsigned int i;
+
+  logInfo("Benchmark results over %lu iterations:",
+          self->numIterationsRecorded);
+  _printStats(self, PIPELINE_BENCHMARK_WHOLE_CHAIN, "Pipeline");
+
+  for (i = 0; i < self->numPlugins; i++) {
+    _printStats(self, (int)i, pluginChain->plugins[i]->pluginName->data);
+  }
+}
+
+static void _writeStats(const PipelineBenchmark self, JsonWriter jsonWriter,
+                        const int pluginIndex) {
+  double mean, stddev, min;
+
+  if (pipelineBenchmarkGetStats(self, pluginIndex, &mean, &stddev, &min)) {
+    jsonWriterWriteDouble(jsonWriter, "meanRealtimeFactor", mean);
+    jsonWriterWriteDouble(jsonWriter, "stddevRealtimeFactor", stddev);
+    jsonWriterWriteDouble(jsonWriter, "minRealtimeFactor", min);
+  }
+}
+
+void pipelineBenchmarkWriteJson(const PipelineBenchmark self,
+                                JsonWriter jsonWriter, const char *key,
+                                const PluginChain pluginChain) {
+  unsigned int i;
+
+  jsonWriterBeginObject(jsonWriter, key);
+  jsonWriterWriteUnsignedLong(jsonWriter, "iterations",
+                              self->numIterationsRecorded);
+  _writeStats(self, jsonWriter, PIPELINE_BENCHMARK_WHOLE_CHAIN);
+  jsonWriterBeginArray(jsonWriter, "plugins");
+
+  for (i = 0; i < self->numPlugins; i++) {
+    jsonWriterBeginObject(jsonWriter, NULL);
+    jsonWriterWriteString(jsonWriter, "name",
+                          pluginChain->plugins[i]->pluginName->data);
+    _writeStats(self, jsonWriter, (int)i);
+    jsonWriterEndObject(jsonWriter);
+  }
+
+  jsonWriterEndArray(jsonWriter);
+  jsonWriterEndObject(jsonWriter);
+}
+
+void freePipelineBenchmark(PipelineBenchmark self) {
+  if (self != NULL) {
+    free(self->pipelineRealtimeFactors);
+    free(self->pluginRealtimeFactors);
+    free(self->_pluginTimesAtStartInMs);
+    free(self);
+  }
+}
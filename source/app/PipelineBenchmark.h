@@ -0,0 +1,132 @@
+//
+// PipelineBenchmark.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PipelineBenchmark_h
+#define MrsWatson_PipelineBenchmark_h
+
+#include "base/JsonWriter.h"
+#include "base/Types.h"
+#include "plugin/PluginChain.h"
+
+/**
+ * Pass this value instead of a plugin index to get statistics for the entire
+ * processing pipeline (input source, plugin chain, and output source).
+ */
+#define PIPELINE_BENCHMARK_WHOLE_CHAIN -1
+
+/**
+ * Records the realtime factor of repeated runs over the same input, both for
+ * the entire processing pipeline and for each plugin in the chain. The realtime
+ * factor is the duration of the processed audio divided by the time taken to
+ * process it, so values greater than 1 are faster than realtime.
+ */
+typedef struct {
+  unsigned long numIterations;
+  unsigned long numIterationsRecorded;
+  unsigned int numPlugins;
+  // Realtime factor of the pipeline for each recorded iteration
+  double *pipelineRealtimeFactors;
+  // Realtime factor of each plugin for each recorded iteration, stored with
+  // all plugins of the first iteration followed by those of the second, etc.
+  double *pluginRealtimeFactors;
+
+  // Private fields
+  double *_pluginTimesAtStartInMs;
+  unsigned long long _iterationStartTimeInNs;
+} PipelineBenchmarkMembers;
+typedef PipelineBenchmarkMembers *PipelineBenchmark;
+
+/**
+ * Create a new pipeline benchmark.
+ * @param numIterations Number of iterations which will be recorded
+ * @param pluginChain Plugin chain which is being measured
+ * @return Initialized PipelineBenchmark
+ */
+PipelineBenchmark newPipelineBenchmark(const unsigned long numIterations,
+                                       const PluginChain pluginChain);
+
+/**
+ * Mark the start of an iteration. Should be called after all sources have been
+ * rewound and the plugin chain has been prepared for processing.
+ * @param self
+ * @param pluginChain Plugin chain which is being measured
+ */
+void pipelineBenchmarkBeginIteration(PipelineBenchmark self,
+                                     const PluginChain pluginChain);
+
+/**
+ * Mark the end of an iteration and record its realtime factors. Per-plugin
+ * times are taken from the plugin chain's audio and MIDI timers, which must
+ * not be reset during the iteration. Iterations beyond numIterations are
+ * ignored.
+ * @param self
+ * @param pluginChain Plugin chain which is being measured
+ * @param numFrames Number of sample frames processed during the iteration
+ */
+void pipelineBenchmarkEndIteration(PipelineBenchmark self,
+                                   const PluginChain pluginChain,
+                                   const unsigned long numFrames);
+
+/**
+ * Calculate summary statistics of the realtime factors recorded so far.
+ * @param self
+ * @param pluginIndex Index of the plugin in the chain, or
+ * PIPELINE_BENCHMARK_WHOLE_CHAIN for the entire pipeline
+ * @param outMean Mean realtime factor
+ * @param outStddev Sample standard deviation of the realtime factor
+ * @param outMin Lowest (ie, slowest) realtime factor
+ * @return False if no iterations were recorded or the index is invalid
+ */
+boolByte pipelineBenchmarkGetStats(const PipelineBenchmark self,
+                                   const int pluginIndex, double *outMean,
+                                   double *outStddev, double *outMin);
+
+/**
+ * Print a summary of the benchmark to the log.
+ * @param self
+ * @param pluginChain Plugin chain which was measured
+ */
+void pipelineBenchmarkPrint(const PipelineBenchmark self,
+                            const PluginChain pluginChain);
+
+/**
+ * Write a summary of the benchmark as a JSON object.
+ * @param self
+ * @param jsonWriter Writer to add the object to
+ * @param key Key for the object, or NULL when writing to an array
+ * @param pluginChain Plugin chain which was measured
+ */
+void pipelineBenchmarkWriteJson(const PipelineBenchmark self,
+                                JsonWriter jsonWriter, const char *key,
+                                const PluginChain pluginChain);
+
+/**
+ * Free a pipeline benchmark and its associated resources
+ * @param self
+ */
+void freePipelineBenchmark(PipelineBenchmark self);
+
+#endif
@@ -0,0 +1,224 @@
+//
+// PresetSweep.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PresetSweep.h"
+
+#include "base/File.h"
+#include "logging/EventLogger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+PresetSweep newPresetSweep(void) {
+  PresetSweep self = (PresetSweep)malloc(sizeof(PresetSweepMembers));
+
+  self->_capacity = 8;
+  self->presetNames =
+      (CharString *)malloc(sizeof(CharString) * self->_capacity);
+  self->numPresets = 0;
+
+  return self;
+}
+
+static void _presetSweepAppend(PresetSweep self, const char *presetName) {
+  if (self->numPresets == self->_capacity) {
+    self->_capacity *= 2;
+    self->presetNames = (CharString *)realloc(
+        self->presetNames, sizeof(CharString) * self->_capacity);
+  }
+
+  self->presetNames[self->numPresets] = newCharStringWithCString(presetName);
+  self->numPresets++;
+}
+
+static int _comparePresetNames(const void *a, const void *b) {
+  return strcmp((*(const CharString *)a)->data, (*(const CharString *)b)->data);
+}
+
+static boolByte _presetSweepAddDirectory(PresetSweep self,
+                                         const File directory) {
+  LinkedList items = fileListDirectory(directory);
+  File *files;
+  CharString extension;
+  unsigned int firstPreset = self->numPresets;
+  int numItems;
+  int i;
+
+  if (items == NULL) {
+    logError("Could not list presets in '%s'", directory->absolutePath->data);
+    return false;
+  }
+
+  files = (File *)linkedListToArray(items);
+  numItems = linkedListLength(items);
+
+  for (i = 0; i < numItems; i++) {
+    if (files[i] == NULL) {
+      continue;
+    }
+
+    extension = fileGetExtension(files[i]);
+
+    if (files[i]->fileType == kFileTypeFile && extension != NULL &&
+        charStringIsEqualToCString(extension, "fxp", true)) {
+      _presetSweepAppend(self, files[i]->absolutePath->data);
+    }
+
+    freeCharString(extension);
+  }
+
+  // Directories are not listed in any particular order, so sort the presets
+  // to get the same output on every platform
+  qsort(self->presetNames + firstPreset, self->numPresets - firstPreset,
+        sizeof(CharString), _comparePresetNames);
+
+  free(files);
+  freeLinkedListAndItems(items, (LinkedListFreeItemFunc)freeFile);
+  return (boolByte)(self->numPresets > firstPreset);
+}
+
+boolByte presetSweepAddPresets(PresetSweep self, const CharString presets) {
+  File presetsFile;
+  LinkedList presetNames;
+  CharString *names;
+  unsigned int firstPreset = self->numPresets;
+  boolByte result;
+  int i;
+
+  if (charStringIsEmpty(presets)) {
+    return false;
+  }
+
+  presetsFile = newFileWithPath(presets);
+
+  if (presetsFile != NULL && fileExists(presetsFile) &&
+      presetsFile->fileType == kFileTypeDirectory) {
+    result = _presetSweepAddDirectory(self, presetsFile);
+    freeFile(presetsFile);
+    return result;
+  }
+
+  freeFile(presetsFile);
+  presetNames = charStringSplit(presets, PRESET_SWEEP_LIST_SEPARATOR);
+  names = (CharString *)linkedListToArray(presetNames);
+
+  for (i = 0; i < linkedListLength(presetNames); i++) {
+    if (!charStringIsEmpty(names[i])) {
+      _presetSweepAppend(self, names[i]->data);
+    }
+  }
+
+  free(names);
+  freeLinkedListAndItems(presetNames, (LinkedListFreeItemFunc)freeCharString);
+  return (boolByte)(self->numPresets > firstPreset);
+}
+
+// The name used in output files is the preset's basename without extension
+static CharString _presetSweepGetShortName(const CharString presetName) {
+  File presetFile = newFileWithPath(presetName);
+  CharString result = fileGetBasename(presetFile);
+  char *dot;
+
+  freeFile(presetFile);
+
+  if (result == NULL) {
+    return newCharStringWithCString(presetName->data);
+  }
+
+  dot = strrchr(result->data, '.');
+
+  if (dot != NULL && dot != result->data) {
+    *dot = '\0';
+  }
+
+  return result;
+}
+
+CharString presetSweepFormatOutputName(const CharString outputName,
+                                       const char *nameTemplate,
+                                       const char *label) {
+  CharString result = newCharStringWithCapacity(strlen(outputName->data) +
+                                                strlen(label) + 2);
+  const char *templateStart = strstr(outputName->data, nameTemplate);
+  const char *extension;
+  const char *basename;
+  size_t prefixLength;
+
+  if (templateStart != NULL) {
+    prefixLength = (size_t)(templateStart - outputName->data);
+    strncpy(result->data, outputName->data, prefixLength);
+    charStringAppendCString(result, label);
+    charStringAppendCString(result, templateStart + strlen(nameTemplate));
+  } else {
+    // Only look for the extension in the last path component, otherwise
+    // directories with dots in their name would be split
+    basename = strrchr(outputName->data, PATH_DELIMITER);
+    basename = basename != NULL ? basename + 1 : outputName->data;
+    extension = strrchr(basename, '.');
+
+    if (extension == NULL || extension == basename) {
+      extension = outputName->data + strlen(outputName->data);
+    }
+
+    prefixLength = (size_t)(extension - outputName->data);
+    strncpy(result->data, outputName->data, prefixLength);
+    charStringAppendCString(result, "-");
+    charStringAppendCString(result, label);
+    charStringAppendCString(result, extension);
+  }
+
+  return result;
+}
+
+CharString presetSweepGetOutputName(const PresetSweep self,
+                                    const CharString outputName,
+                                    const unsigned int index) {
+  CharString shortName;
+  CharString result;
+
+  if (index >= self->numPresets || outputName == NULL) {
+    return NULL;
+  }
+
+  shortName = _presetSweepGetShortName(self->presetNames[index]);
+  result = presetSweepFormatOutputName(outputName, PRESET_SWEEP_NAME_TEMPLATE,
+                                       shortName->data);
+  freeCharString(shortName);
+  return result;
+}
+
+void freePresetSweep(PresetSweep self) {
+  unsigned int i;
+
+  if (self != NULL) {
+    for (i = 0; i < self->numPresets; i++) {
+      freeCharString(self->presetNames[i]);
+    }
+
+    free(self->presetNames);
+    free(self);
+  }
+}
@@ -0,0 +1,101 @@
+//
+// PresetSweep.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PresetSweep_h
+#define MrsWatson_PresetSweep_h
+
+#include "base/CharString.h"
+#include "base/Types.h"
+
+/**
+ * Output names containing this string have it replaced with the preset name,
+ * otherwise the preset name is appended to the output file's basename.
+ */
+#define PRESET_SWEEP_NAME_TEMPLATE "{preset}"
+#define PRESET_SWEEP_LIST_SEPARATOR ';'
+
+/**
+ * List of presets which are each loaded into a plugin in turn, so that the
+ * same input can be rendered once for every preset.
+ */
+typedef struct {
+  CharString *presetNames;
+  unsigned int numPresets;
+
+  // Private fields
+  unsigned int _capacity;
+} PresetSweepMembers;
+typedef PresetSweepMembers *PresetSweep;
+
+/**
+ * Create a new, empty preset sweep.
+ * @return Initialized PresetSweep
+ */
+PresetSweep newPresetSweep(void);
+
+/**
+ * Add presets to the sweep.
+ * @param self
+ * @param presets Either a directory, in which case all FXP files in it are
+ * added in alphabetical order, or a list of preset names separated by
+ * PRESET_SWEEP_LIST_SEPARATOR. Like with the plugin chain, a preset name may
+ * also be a program number.
+ * @return True if at least one preset was added
+ */
+boolByte presetSweepAddPresets(PresetSweep self, const CharString presets);
+
+/**
+ * Get the name of the output file to use for a preset in the sweep.
+ * @param self
+ * @param outputName Output name given by the user
+ * @param index Index of the preset in the sweep
+ * @return Output name for the preset, which must be freed by the caller, or
+ * NULL if the index is out of range
+ */
+CharString presetSweepGetOutputName(const PresetSweep self,
+                                    const CharString outputName,
+                                    const unsigned int index);
+
+/**
+ * Build the name of an output file for one render of a sweep. Other kinds of
+ * sweeps use this as well, so that all of their outputs are named alike.
+ * @param outputName Output name given by the user
+ * @param nameTemplate String which is replaced with the label if it is found
+ * in the output name, otherwise the label is appended to the basename
+ * @param label Name of the render
+ * @return Output name, which must be freed by the caller
+ */
+CharString presetSweepFormatOutputName(const CharString outputName,
+                                       const char *nameTemplate,
+                                       const char *label);
+
+/**
+ * Free a preset sweep and all associated resources
+ * @param self
+ */
+void freePresetSweep(PresetSweep self);
+
+#endif
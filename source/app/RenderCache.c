@@ -0,0 +1,277 @@
+//
+// RenderCache.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RenderCache.h"
+
+#include "app/BuildInfo.h"
+#include "base/File.h"
+#include "base/PlatformInfo.h"
+#include "logging/EventLogger.h"
+#include "plugin/PluginPreset.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t kRenderCacheCopyBufferSize = 65536;
+
+RenderCache newRenderCache(const CharString directory) {
+  RenderCache renderCache = (RenderCache)malloc(sizeof(RenderCacheMembers));
+  CharString versionString = buildInfoGetVersionString();
+
+  renderCache->directory = newCharStringWithCString(directory->data);
+  renderCache->key = kHashInitialValue;
+  renderCache->numHits = 0;
+  renderCache->numMisses = 0;
+  renderCache->isKeyValid = true;
+
+  renderCacheAddString(renderCache, "version", versionString->data);
+  freeCharString(versionString);
+  return renderCache;
+}
+
+void renderCacheAddString(RenderCache self, const char *name,
+                          const char *value) {
+  self->key = hashCString(self->key, name);
+  self->key = hashCString(self->key, value);
+}
+
+void renderCacheAddNumber(RenderCache self, const char *name,
+                          const double value) {
+  // Numbers are added as text, so that the key does not depend on the
+  // platform's byte order
+  char valueString[32];
+  snprintf(valueString, sizeof(valueString), "%.17g", value);
+  renderCacheAddString(self, name, valueString);
+}
+
+void renderCacheAddFile(RenderCache self, const char *name,
+                        const CharString path) {
+  self->key = hashCString(self->key, name);
+
+  if (!hashFileContents(&self->key, path)) {
+    logWarn("Could not read '%s', output will not be cached", path->data);
+    self->isKeyValid = false;
+  }
+}
+
+static void _renderCacheAddFileStamp(RenderCache self, const char *name,
+                                     const CharString path) {
+  File file = newFileWithPath(path);
+
+  renderCacheAddString(self, name, file->absolutePath->data);
+  renderCacheAddNumber(self, "size", (double)fileGetSize(file));
+  renderCacheAddNumber(self, "modified",
+                       (double)fileGetModificationTime(file));
+  freeFile(file);
+}
+
+void renderCacheAddPlugin(RenderCache self, const PluginChain pluginChain,
+                          const unsigned int index) {
+  Plugin plugin = pluginChain->plugins[index];
+  PluginPreset preset = pluginChain->presets[index];
+  File presetFile;
+
+  renderCacheAddString(self, "plugin", plugin->pluginName->data);
+
+  // Internal plugins are part of the program, which is already in the key
+  if (!charStringIsEmpty(plugin->pluginAbsolutePath)) {
+    _renderCacheAddFileStamp(self, "binary", plugin->pluginAbsolutePath);
+  }
+
+  if (preset != NULL) {
+    // Presets may also be program numbers rather than files
+    presetFile = newFileWithPath(preset->presetName);
+
+    if (fileExists(presetFile)) {
+      renderCacheAddFile(self, "preset", preset->presetName);
+    } else {
+      renderCacheAddString(self, "preset", preset->presetName->data);
+    }
+
+    freeFile(presetFile);
+  }
+}
+
+CharString renderCacheGetEntryPath(const RenderCache self,
+                                   const CharString outputPath) {
+  File directory = newFileWithPath(self->directory);
+  File outputFile = newFileWithPath(outputPath);
+  CharString extension = fileGetExtension(outputFile);
+  CharString result = newCharStringWithCapacity(kCharStringLengthLong);
+
+  snprintf(result->data, result->capacity, "%s%c%016llx.%s",
+           directory->absolutePath->data, PATH_DELIMITER,
+           (unsigned long long)self->key,
+           extension != NULL ? extension->data : "out");
+
+  freeCharString(extension);
+  freeFile(outputFile);
+  freeFile(directory);
+  return result;
+}
+
+static boolByte _copyFile(const char *sourcePath, const char *destinationPath) {
+  FILE *source = fopen(sourcePath, "rb");
+  FILE *destination;
+  char *buffer;
+  size_t numBytes;
+  boolByte result = true;
+
+  if (source == NULL) {
+    return false;
+  }
+
+  destination = fopen(destinationPath, "wb");
+
+  if (destination == NULL) {
+    fclose(source);
+    return false;
+  }
+
+  buffer = (char *)malloc(kRenderCacheCopyBufferSize);
+
+  while ((numBytes = fread(buffer, 1, kRenderCacheCopyBufferSize, source)) >
+         0) {
+    if (fwrite(buffer, 1, numBytes, destination) != numBytes) {
+      result = false;
+      break;
+    }
+  }
+
+  if (ferror(source)) {
+    result = false;
+  }
+
+  free(buffer);
+  fclose(source);
+
+  if (fclose(destination) != 0) {
+    result = false;
+  }
+
+  return result;
+}
+
+boolByte renderCacheHasEntry(RenderCache self, const CharString outputPath) {
+  CharString entryPath;
+  File entryFile;
+  boolByte result = false;
+
+  if (self->isKeyValid) {
+    entryPath = renderCacheGetEntryPath(self, outputPath);
+    entryFile = newFileWithPath(entryPath);
+    result = fileExists(entryFile);
+    freeFile(entryFile);
+    freeCharString(entryPath);
+  }
+
+  if (!result) {
+    self->numMisses++;
+  }
+
+  return result;
+}
+
+boolByte renderCacheRestore(RenderCache self, const CharString outputPath) {
+  CharString entryPath = renderCacheGetEntryPath(self, outputPath);
+  boolByte result;
+
+  // Output sources overwrite existing files in place, so the output must not
+  // share its data with the entry
+  remove(outputPath->data);
+  result = _copyFile(entryPath->data, outputPath->data);
+
+  if (result) {
+    logInfo("Restored output from render cache entry '%s'", entryPath->data);
+    self->numHits++;
+  } else {
+    logWarn("Could not restore '%s' from render cache entry '%s'",
+            outputPath->data, entryPath->data);
+    self->numMisses++;
+  }
+
+  freeCharString(entryPath);
+  return result;
+}
+
+boolByte renderCacheStore(RenderCache self, const CharString outputPath) {
+  File directory;
+  CharString entryPath;
+  CharString partialPath;
+  char partialSuffix[32];
+  boolByte result;
+
+  if (!self->isKeyValid) {
+    return false;
+  }
+
+  directory = newFileWithPath(self->directory);
+
+  if (!fileExists(directory) && !fileCreate(directory, kFileTypeDirectory)) {
+    logWarn("Could not create render cache directory '%s'",
+            self->directory->data);
+    freeFile(directory);
+    return false;
+  }
+
+  freeFile(directory);
+  entryPath = renderCacheGetEntryPath(self, outputPath);
+
+  // Copy to a temporary file first, so that other processes never restore an
+  // entry which is only partially written. Processes which store the same
+  // entry at once each use their own temporary file.
+  partialPath = newCharStringWithCString(entryPath->data);
+  snprintf(partialSuffix, sizeof(partialSuffix), ".%lu.partial",
+           platformInfoGetProcessId());
+  charStringAppendCString(partialPath, partialSuffix);
+  result = _copyFile(outputPath->data, partialPath->data);
+
+  if (result) {
+    // Windows does not replace existing files when renaming
+    remove(entryPath->data);
+    result = (boolByte)(rename(partialPath->data, entryPath->data) == 0);
+  }
+
+  if (result) {
+    logInfo("Stored output in render cache entry '%s'", entryPath->data);
+  } else {
+    logWarn("Could not store output in render cache entry '%s'",
+            entryPath->data);
+    remove(partialPath->data);
+  }
+
+  freeCharString(partialPath);
+  freeCharString(entryPath);
+  return result;
+}
+
+void freeRenderCache(RenderCache self) {
+  if (self != NULL) {
+    freeCharString(self->directory);
+    free(self);
+  }
+}
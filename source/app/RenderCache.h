@@ -0,0 +1,146 @@
+//
+// RenderCache.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_RenderCache_h
+#define MrsWatson_RenderCache_h
+
+#include "base/CharString.h"
+#include "base/Hash.h"
+#include "base/Types.h"
+#include "plugin/PluginChain.h"
+
+/**
+ * Cache of rendered output files. Each entry is keyed by a hash of everything
+ * which could change the output, such as the input file, plugins, presets and
+ * audio settings. If an entry exists for a render, then the output file can be
+ * restored from the cache instead of processing the input again.
+ */
+typedef struct {
+  CharString directory;
+  HashValue key;
+  unsigned long numHits;
+  unsigned long numMisses;
+  // Cleared when some part of the key could not be read, since the render
+  // could then not be told apart from others
+  boolByte isKeyValid;
+} RenderCacheMembers;
+typedef RenderCacheMembers *RenderCache;
+
+/**
+ * Create a new render cache. The key initially contains only the program
+ * version, so that entries are never shared between different versions.
+ * @param directory Directory which holds the cache entries. It is created when
+ * the first entry is stored.
+ * @return Initialized RenderCache
+ */
+RenderCache newRenderCache(const CharString directory);
+
+/**
+ * Add a string to the cache key.
+ * @param self
+ * @param name Name of the setting
+ * @param value Value of the setting
+ */
+void renderCacheAddString(RenderCache self, const char *name,
+                          const char *value);
+
+/**
+ * Add a number to the cache key.
+ * @param self
+ * @param name Name of the setting
+ * @param value Value of the setting
+ */
+void renderCacheAddNumber(RenderCache self, const char *name,
+                          const double value);
+
+/**
+ * Add the contents of a file to the cache key. If the file can't be read, then
+ * the render will not be cached.
+ * @param self
+ * @param name Name of the file's role, for example "input"
+ * @param path Path to the file
+ */
+void renderCacheAddFile(RenderCache self, const char *name,
+                        const CharString path);
+
+/**
+ * Add a plugin in a chain and its preset to the cache key. Plugin binaries are
+ * identified by their path, size and modification time, since they may be
+ * large bundle directories. Preset files are identified by their contents.
+ * This must be called after the chain has been initialized, since plugins are
+ * not resolved to a path before then.
+ * @param self
+ * @param pluginChain Initialized plugin chain
+ * @param index Index of the plugin in the chain
+ */
+void renderCacheAddPlugin(RenderCache self, const PluginChain pluginChain,
+                          const unsigned int index);
+
+/**
+ * Get the path of the cache entry for the current key.
+ * @param self
+ * @param outputPath Path of the output file, whose extension is also used for
+ * the cache entry
+ * @return Path of the cache entry, which must be freed by the caller
+ */
+CharString renderCacheGetEntryPath(const RenderCache self,
+                                   const CharString outputPath);
+
+/**
+ * Check if there is a cache entry for the current key. If there is none, this
+ * is counted as a miss.
+ * @param self
+ * @param outputPath Path of the output file
+ * @return True if the output can be restored from the cache
+ */
+boolByte renderCacheHasEntry(RenderCache self, const CharString outputPath);
+
+/**
+ * Replace the output file with a copy of the cache entry for the current key.
+ * The output is never linked to the entry, since later runs which write to the
+ * same output path would change the entry as well. This is counted as a hit if
+ * it succeeds, and as a miss otherwise.
+ * @param self
+ * @param outputPath Path of the output file, which must not be open
+ * @return True if the output file was restored from the cache
+ */
+boolByte renderCacheRestore(RenderCache self, const CharString outputPath);
+
+/**
+ * Store a rendered output file in the cache under the current key.
+ * @param self
+ * @param outputPath Path of the output file
+ * @return True if the output was stored
+ */
+boolByte renderCacheStore(RenderCache self, const CharString outputPath);
+
+/**
+ * Free a render cache and all associated resources
+ * @param self
+ */
+void freeRenderCache(RenderCache self);
+
+#endif
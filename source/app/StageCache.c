@@ -0,0 +1,276 @@
+//
+// StageCache.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "StageCache.h"
+
+#include "base/File.h"
+#include "base/LinkedList.h"
+#include "logging/EventLogger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  File file;
+  size_t size;
+  unsigned long modificationTime;
+} _StageCacheEntry;
+
+StageCache newStageCache(const CharString directory,
+                         const unsigned long maxSizeInBytes,
+                         const HashValue *stageKeys,
+                         const unsigned int numStages) {
+  StageCache stageCache = (StageCache)malloc(sizeof(StageCacheMembers));
+  unsigned int i;
+
+  stageCache->directory = newCharStringWithCString(directory->data);
+  stageCache->maxSizeInBytes = maxSizeInBytes;
+  stageCache->stageKeys = (HashValue *)malloc(sizeof(HashValue) * numStages);
+  memcpy(stageCache->stageKeys, stageKeys, sizeof(HashValue) * numStages);
+  stageCache->numStages = numStages;
+  stageCache->numCachedStages = 0;
+  stageCache->numStoredStages = 0;
+  stageCache->_writers = (SampleSourceCacheWriter *)malloc(
+      sizeof(SampleSourceCacheWriter) * numStages);
+
+  for (i = 0; i < numStages; i++) {
+    stageCache->_writers[i] = NULL;
+  }
+
+  return stageCache;
+}
+
+CharString stageCacheGetEntryPath(const StageCache self,
+                                  const unsigned int stage) {
+  File directory = newFileWithPath(self->directory);
+  CharString result = newCharStringWithCapacity(kCharStringLengthLong);
+
+  snprintf(result->data, result->capacity, "%s%c%s%016llx.%s",
+           directory->absolutePath->data, PATH_DELIMITER,
+           STAGE_CACHE_ENTRY_PREFIX,
+           (unsigned long long)self->stageKeys[stage],
+           SAMPLE_SOURCE_CACHE_EXTENSION);
+
+  freeFile(directory);
+  return result;
+}
+
+SampleSource stageCacheOpenDeepestStage(StageCache self) {
+  SampleSource result = NULL;
+  CharString entryPath;
+  File entryFile;
+  unsigned int stage;
+
+  for (stage = self->numStages; stage > 0 && result == NULL; stage--) {
+    entryPath = stageCacheGetEntryPath(self, stage - 1);
+    entryFile = newFileWithPath(entryPath);
+
+    if (fileExists(entryFile)) {
+      result = newSampleSourceMemoryFromCache(entryPath);
+    }
+
+    if (result != NULL) {
+      // Used entries are touched, so that they are evicted last
+      fileTouch(entryFile);
+      self->numCachedStages = stage;
+      logInfo("Starting from cached output of plugin %u", stage - 1);
+    }
+
+    freeFile(entryFile);
+    freeCharString(entryPath);
+  }
+
+  return result;
+}
+
+void stageCacheBeginWriting(StageCache self, const ChannelCount numChannels,
+                            const SampleRate sampleRate) {
+  CharString entryPath;
+  unsigned int stage;
+
+  for (stage = self->numCachedStages; stage < self->numStages; stage++) {
+    entryPath = stageCacheGetEntryPath(self, stage);
+    self->_writers[stage] =
+        newSampleSourceCacheWriter(entryPath, numChannels, sampleRate);
+    freeCharString(entryPath);
+  }
+}
+
+void stageCacheWriteStage(void *stageCachePtr, const unsigned int index,
+                          const SampleBuffer output) {
+  StageCache self = (StageCache)stageCachePtr;
+
+  if (index < self->numStages && self->_writers[index] != NULL) {
+    sampleSourceCacheWriterAppend(self->_writers[index], output);
+  }
+}
+
+void stageCacheFinishWriting(StageCache self, const SampleCount numFrames,
+                             const unsigned long *stageDelaysInFrames) {
+  File directory = newFileWithPath(self->directory);
+  SampleCount stageFrames;
+  unsigned int stage;
+
+  if (!fileExists(directory) && !fileCreate(directory, kFileTypeDirectory)) {
+    logWarn("Could not create stage cache directory '%s'",
+            self->directory->data);
+    freeFile(directory);
+    return;
+  }
+
+  freeFile(directory);
+
+  for (stage = 0; stage < self->numStages; stage++) {
+    if (self->_writers[stage] != NULL) {
+      stageFrames = numFrames;
+
+      if (stageDelaysInFrames != NULL) {
+        stageFrames += stageDelaysInFrames[stage];
+      }
+
+      if (self->_writers[stage]->numFrames > stageFrames) {
+        self->_writers[stage]->numFrames = stageFrames;
+      }
+
+      // Stages which never received any output are not stored
+      if (self->_writers[stage]->numFrames > 0 &&
+          sampleSourceCacheWriterFinish(self->_writers[stage])) {
+        self->numStoredStages++;
+      }
+
+      freeSampleSourceCacheWriter(self->_writers[stage]);
+      self->_writers[stage] = NULL;
+    }
+  }
+
+  logDebug("Stored output of %u plugins in stage cache",
+           self->numStoredStages);
+  stageCacheEvict(self);
+}
+
+static int _compareStageCacheEntries(const void *a, const void *b) {
+  const _StageCacheEntry *first = (const _StageCacheEntry *)a;
+  const _StageCacheEntry *second = (const _StageCacheEntry *)b;
+
+  if (first->modificationTime < second->modificationTime) {
+    return -1;
+  } else if (first->modificationTime > second->modificationTime) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+void stageCacheEvict(StageCache self) {
+  File directory;
+  LinkedList items;
+  File *files;
+  _StageCacheEntry *entries;
+  CharString basename;
+  CharString extension;
+  size_t totalSize = 0;
+  int numItems;
+  int numEntries = 0;
+  int i;
+
+  if (self->maxSizeInBytes == 0) {
+    return;
+  }
+
+  directory = newFileWithPath(self->directory);
+  items = fileListDirectory(directory);
+  freeFile(directory);
+
+  if (items == NULL) {
+    return;
+  }
+
+  files = (File *)linkedListToArray(items);
+  numItems = linkedListLength(items);
+  entries = (_StageCacheEntry *)malloc(sizeof(_StageCacheEntry) *
+                                       (numItems > 0 ? numItems : 1));
+
+  for (i = 0; i < numItems; i++) {
+    if (files[i] == NULL || files[i]->fileType != kFileTypeFile) {
+      continue;
+    }
+
+    basename = fileGetBasename(files[i]);
+
+    extension = fileGetExtension(files[i]);
+
+    // Other files in the directory, such as entries of the input cache or
+    // entries which are still being written, are left alone
+    if (basename != NULL && extension != NULL &&
+        strncmp(basename->data, STAGE_CACHE_ENTRY_PREFIX,
+                strlen(STAGE_CACHE_ENTRY_PREFIX)) == 0 &&
+        charStringIsEqualToCString(extension, SAMPLE_SOURCE_CACHE_EXTENSION,
+                                   false)) {
+      entries[numEntries].file = files[i];
+      entries[numEntries].size = fileGetSize(files[i]);
+      entries[numEntries].modificationTime =
+          fileGetModificationTime(files[i]);
+      totalSize += entries[numEntries].size;
+      numEntries++;
+    }
+
+    freeCharString(extension);
+    freeCharString(basename);
+  }
+
+  // Remove the least recently used entries first
+  qsort(entries, (size_t)numEntries, sizeof(_StageCacheEntry),
+        _compareStageCacheEntries);
+
+  for (i = 0; i < numEntries && totalSize > self->maxSizeInBytes; i++) {
+    logDebug("Evicting stage cache entry '%s'",
+             entries[i].file->absolutePath->data);
+
+    if (fileRemove(entries[i].file)) {
+      totalSize -= entries[i].size;
+    }
+  }
+
+  free(entries);
+  free(files);
+  freeLinkedListAndItems(items, (LinkedListFreeItemFunc)freeFile);
+}
+
+void freeStageCache(StageCache self) {
+  unsigned int i;
+
+  if (self != NULL) {
+    for (i = 0; i < self->numStages; i++) {
+      freeSampleSourceCacheWriter(self->_writers[i]);
+    }
+
+    free(self->_writers);
+    free(self->stageKeys);
+    freeCharString(self->directory);
+    free(self);
+  }
+}
@@ -0,0 +1,145 @@
+//
+// StageCache.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_StageCache_h
+#define MrsWatson_StageCache_h
+
+#include "base/CharString.h"
+#include "base/Hash.h"
+#include "base/Types.h"
+#include "io/SampleSourceMemory.h"
+
+/** Prefix of cache entries, which tells them apart from other cache files */
+#define STAGE_CACHE_ENTRY_PREFIX "stage-"
+
+/**
+ * Cache of the output of each plugin in a chain. A stage is the output of the
+ * chain up to and including one plugin, and each stage is keyed by the input
+ * and the configuration of all plugins up to that one. When a chain shares its
+ * first plugins with an earlier run, processing can start from the deepest
+ * cached stage, so that only the plugins after it need to run.
+ *
+ * Entries are stored in the cache file format of SampleSourceMemory. When the
+ * entries in the cache directory take up more than the maximum size, the least
+ * recently used ones are removed.
+ */
+typedef struct {
+  CharString directory;
+  unsigned long maxSizeInBytes;
+  HashValue *stageKeys;
+  unsigned int numStages;
+  // Number of stages at the start of the chain which were read from the cache
+  unsigned int numCachedStages;
+  // Number of stages which were written to the cache
+  unsigned int numStoredStages;
+
+  // Private fields
+  SampleSourceCacheWriter *_writers;
+} StageCacheMembers;
+typedef StageCacheMembers *StageCache;
+
+/**
+ * Create a new stage cache.
+ * @param directory Directory which holds the cache entries. It is created when
+ * the first entry is stored.
+ * @param maxSizeInBytes Maximum size of all entries in the directory, or 0 for
+ * no limit
+ * @param stageKeys Key of each stage, which is copied
+ * @param numStages Number of stages, which is the number of plugins in the
+ * chain
+ * @return Initialized StageCache
+ */
+StageCache newStageCache(const CharString directory,
+                         const unsigned long maxSizeInBytes,
+                         const HashValue *stageKeys,
+                         const unsigned int numStages);
+
+/**
+ * Get the path of the cache entry for a stage.
+ * @param self
+ * @param stage Index of the stage
+ * @return Path of the cache entry, which must be freed by the caller
+ */
+CharString stageCacheGetEntryPath(const StageCache self,
+                                  const unsigned int stage);
+
+/**
+ * Open the deepest stage which is in the cache, and set numCachedStages
+ * accordingly.
+ * @param self
+ * @return Sample source which reads the output of the deepest cached stage, or
+ * NULL if no stage is cached. In that case, the chain must be processed from
+ * the beginning.
+ */
+SampleSource stageCacheOpenDeepestStage(StageCache self);
+
+/**
+ * Start writing the output of all stages which are not yet cached.
+ * @param self
+ * @param numChannels Number of channels in the output of each plugin
+ * @param sampleRate Sample rate of the output
+ */
+void stageCacheBeginWriting(StageCache self, const ChannelCount numChannels,
+                            const SampleRate sampleRate);
+
+/**
+ * Append the output of a plugin to its stage. This has the signature of a
+ * PluginChainStageOutputFunc, so that the plugin chain can call it directly.
+ * @param stageCachePtr StageCache object
+ * @param index Index of the plugin
+ * @param output Output of the plugin
+ */
+void stageCacheWriteStage(void *stageCachePtr, const unsigned int index,
+                          const SampleBuffer output);
+
+/**
+ * Store all stages which were written in the cache, and then remove the least
+ * recently used entries if the cache is too large.
+ * @param self
+ * @param numFrames Number of frames in the input
+ * @param stageDelaysInFrames Processing delay of each stage, or NULL if no
+ * plugin delays its output. Each stage is stored up to numFrames plus its
+ * delay, so that it ends with the delayed end of the input. Any frames past
+ * this point were only written to pad the last block, and are not stored.
+ */
+void stageCacheFinishWriting(StageCache self, const SampleCount numFrames,
+                             const unsigned long *stageDelaysInFrames);
+
+/**
+ * Remove the least recently used entries until the entries in the cache
+ * directory take up no more than the maximum size.
+ * @param self
+ */
+void stageCacheEvict(StageCache self);
+
+/**
+ * Free a stage cache and all associated resources. Stages which are still
+ * being written are discarded.
+ * @param self
+ */
+void freeStageCache(StageCache self);
+
+#endif
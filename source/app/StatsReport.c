@@ -0,0 +1,228 @@
+//
+// StatsReport.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "StatsReport.h"
+
+#include "app/BuildInfo.h"
+#include "audio/AudioSettings.h"
+#include "base/JsonWriter.h"
+#include "base/PlatformInfo.h"
+#include "plugin/PluginSandbox.h"
+#include "plugin/PluginVst2x.h"
+#include "plugin/PluginVst2xId.h"
+#include "time/AudioClock.h"
+
+#include <stdlib.h>
+
+StatsReport newStatsReport(const CharString outputPath) {
+  StatsReport statsReport = (StatsReport)malloc(sizeof(StatsReportMembers));
+
+  statsReport->outputPath = newCharStringWithCString(outputPath->data);
+  statsReport->numPasses = 1;
+  statsReport->numBlocks = 0;
+  statsReport->framesRead = 0;
+  statsReport->framesWritten = 0;
+  statsReport->midiEventsProcessed = 0;
+  statsReport->benchmark = NULL;
+  statsReport->renderCache = NULL;
+  statsReport->stageCache = NULL;
+
+  return statsReport;
+}
+
+static void _writeTaskTimer(JsonWriter jsonWriter, const char *key,
+                            const TaskTimer taskTimer) {
+  LatencyHistogram histogram = taskTimer->histogram;
+
+  jsonWriterBeginObject(jsonWriter, key);
+  jsonWriterWriteString(jsonWriter, "component", taskTimer->component->data);
+  jsonWriterWriteString(jsonWriter, "subcomponent",
+                        taskTimer->subcomponent->data);
+  jsonWriterWriteDouble(jsonWriter, "totalTimeInMs", taskTimer->totalTaskTime);
+
+  if (histogram != NULL && histogram->numSamples > 0) {
+    jsonWriterBeginObject(jsonWriter, "blocks");
+    jsonWriterWriteUnsignedLong(jsonWriter, "count", histogram->numSamples);
+    jsonWriterWriteUnsignedLong(jsonWriter, "overBudget",
+                                histogram->numOverBudget);
+    jsonWriterWriteDouble(jsonWriter, "budgetInMs",
+                          histogram->budgetInNs / 1000000.0);
+    jsonWriterWriteDouble(jsonWriter, "minInMs",
+                          latencyHistogramGetMin(histogram));
+    jsonWriterWriteDouble(jsonWriter, "p50InMs",
+                          latencyHistogramGetPercentile(histogram, 50.0));
+    jsonWriterWriteDouble(jsonWriter, "p90InMs",
+                          latencyHistogramGetPercentile(histogram, 90.0));
+    jsonWriterWriteDouble(jsonWriter, "p99InMs",
+                          latencyHistogramGetPercentile(histogram, 99.0));
+    jsonWriterWriteDouble(jsonWriter, "p999InMs",
+                          latencyHistogramGetPercentile(histogram, 99.9));
+    jsonWriterWriteDouble(jsonWriter, "maxInMs",
+                          latencyHistogramGetMax(histogram));
+    jsonWriterEndObject(jsonWriter);
+  }
+
+  jsonWriterEndObject(jsonWriter);
+}
+
+static void _writePhaseTimer(void *item, void *userData) {
+  _writeTaskTimer((JsonWriter)userData, NULL, (TaskTimer)item);
+}
+
+static const char *_getPluginInterfaceTypeName(const Plugin plugin) {
+  switch (plugin->interfaceType) {
+  case PLUGIN_TYPE_VST_2X:
+    return "VST2.x";
+
+  case PLUGIN_TYPE_INTERNAL:
+    return "Internal";
+
+  case PLUGIN_TYPE_SANDBOX:
+    return "Sandbox";
+
+  default:
+    return "Unknown";
+  }
+}
+
+static void _writePlugin(JsonWriter jsonWriter, PluginChain pluginChain,
+                         unsigned int index) {
+  Plugin plugin = pluginChain->plugins[index];
+  PluginVst2xId pluginId;
+
+  jsonWriterBeginObject(jsonWriter, NULL);
+  jsonWriterWriteString(jsonWriter, "name", plugin->pluginName->data);
+  jsonWriterWriteString(jsonWriter, "interface",
+                        _getPluginInterfaceTypeName(plugin));
+
+  if (plugin->interfaceType == PLUGIN_TYPE_VST_2X) {
+    pluginId = newPluginVst2xIdWithId(pluginVst2xGetUniqueId(plugin));
+    jsonWriterWriteString(jsonWriter, "uniqueId", pluginId->idString->data);
+    jsonWriterWriteUnsignedLong(jsonWriter, "version",
+                                pluginVst2xGetVersion(plugin));
+    freePluginVst2xId(pluginId);
+  } else if (plugin->interfaceType == PLUGIN_TYPE_SANDBOX) {
+    jsonWriterWriteUnsignedLong(jsonWriter, "restarts",
+                                pluginSandboxGetNumRestarts(plugin));
+  }
+
+  if (pluginChain->presets[index] != NULL) {
+    jsonWriterWriteString(jsonWriter, "preset",
+                          pluginChain->presets[index]->presetName->data);
+  }
+
+  _writeTaskTimer(jsonWriter, "audio", pluginChain->audioTimers[index]);
+  _writeTaskTimer(jsonWriter, "midi", pluginChain->midiTimers[index]);
+  jsonWriterEndObject(jsonWriter);
+}
+
+boolByte statsReportWrite(StatsReport self, const TaskTimer totalTimer,
+                          LinkedList phaseTimers, PluginChain pluginChain) {
+  JsonWriter jsonWriter = newJsonWriterWithPath(self->outputPath);
+  CharString versionString;
+  double audioDurationInMs;
+  unsigned int i;
+
+  if (jsonWriter == NULL) {
+    return false;
+  }
+
+  // The clock is rewound for each pass, so it only covers the last one
+  audioDurationInMs = getAudioClock()->currentFrame * 1000.0 / getSampleRate() *
+                      self->numPasses;
+  versionString = buildInfoGetVersionString();
+
+  jsonWriterBeginObject(jsonWriter, NULL);
+  jsonWriterWriteString(jsonWriter, "version", versionString->data);
+  jsonWriterWriteDouble(jsonWriter, "sampleRate", getSampleRate());
+  jsonWriterWriteUnsignedLong(jsonWriter, "blocksize", getBlocksize());
+  jsonWriterWriteUnsignedLong(jsonWriter, "channels", getNumChannels());
+  jsonWriterWriteUnsignedLong(jsonWriter, "passes", self->numPasses);
+  jsonWriterWriteUnsignedLong(jsonWriter, "numBlocks", self->numBlocks);
+  jsonWriterWriteUnsignedLong(jsonWriter, "skippedBlocks",
+                              pluginChain->numSkippedBlocks);
+  jsonWriterWriteUnsignedLong(jsonWriter, "framesRead",
+                              self->framesRead * self->numPasses);
+  jsonWriterWriteUnsignedLong(jsonWriter, "framesWritten",
+                              self->framesWritten * self->numPasses);
+  jsonWriterWriteUnsignedLong(jsonWriter, "midiEventsProcessed",
+                              self->midiEventsProcessed * self->numPasses);
+  jsonWriterWriteDouble(jsonWriter, "audioDurationInMs", audioDurationInMs);
+  jsonWriterWriteDouble(jsonWriter, "totalTimeInMs", totalTimer->totalTaskTime);
+  // The realtime factor is how many times faster than realtime the audio was
+  // processed, so values greater than 1 are good.
+  jsonWriterWriteDouble(jsonWriter, "realtimeFactor",
+                        audioDurationInMs / totalTimer->totalTaskTime);
+  jsonWriterWriteUnsignedLong(jsonWriter, "peakMemoryInBytes",
+                              platformInfoGetPeakMemoryUsage());
+
+  jsonWriterBeginArray(jsonWriter, "phases");
+  linkedListForeach(phaseTimers, _writePhaseTimer, jsonWriter);
+  jsonWriterEndArray(jsonWriter);
+
+  jsonWriterBeginArray(jsonWriter, "plugins");
+
+  for (i = 0; i < pluginChain->numPlugins; i++) {
+    _writePlugin(jsonWriter, pluginChain, i);
+  }
+
+  jsonWriterEndArray(jsonWriter);
+
+  if (self->benchmark != NULL) {
+    pipelineBenchmarkWriteJson(self->benchmark, jsonWriter, "benchmark",
+                               pluginChain);
+  }
+
+  if (self->renderCache != NULL) {
+    jsonWriterBeginObject(jsonWriter, "renderCache");
+    jsonWriterWriteUnsignedLong(jsonWriter, "hits", self->renderCache->numHits);
+    jsonWriterWriteUnsignedLong(jsonWriter, "misses",
+                                self->renderCache->numMisses);
+    jsonWriterEndObject(jsonWriter);
+  }
+
+  if (self->stageCache != NULL) {
+    jsonWriterBeginObject(jsonWriter, "stageCache");
+    jsonWriterWriteUnsignedLong(jsonWriter, "cachedStages",
+                                self->stageCache->numCachedStages);
+    jsonWriterWriteUnsignedLong(jsonWriter, "storedStages",
+                                self->stageCache->numStoredStages);
+    jsonWriterEndObject(jsonWriter);
+  }
+
+  jsonWriterEndObject(jsonWriter);
+
+  freeJsonWriter(jsonWriter);
+  freeCharString(versionString);
+  return true;
+}
+
+void freeStatsReport(StatsReport self) {
+  if (self != NULL) {
+    freeCharString(self->outputPath);
+    free(self);
+  }
+}
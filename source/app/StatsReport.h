@@ -0,0 +1,89 @@
+//
+// StatsReport.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_StatsReport_h
+#define MrsWatson_StatsReport_h
+
+#include "app/PipelineBenchmark.h"
+#include "app/RenderCache.h"
+#include "app/StageCache.h"
+#include "base/CharString.h"
+#include "base/LinkedList.h"
+#include "plugin/PluginChain.h"
+#include "time/TaskTimer.h"
+
+/**
+ * Collects statistics about a processing run, which are written to a JSON file
+ * when processing has finished. This is intended to be read by scripts which
+ * track performance across builds, so the output format should remain stable.
+ */
+typedef struct {
+  CharString outputPath;
+  // Number of passes over the input, which is more than one when benchmarking
+  // or sweeping. The timers and numBlocks cover all passes, so the per-pass
+  // figures below are multiplied by this number when written.
+  unsigned long numPasses;
+  unsigned long numBlocks;
+  // Frames and events of a single pass
+  unsigned long framesRead;
+  unsigned long framesWritten;
+  unsigned long midiEventsProcessed;
+  // Results of a --benchmark run, or NULL. Not owned by the report.
+  PipelineBenchmark benchmark;
+  // Render cache used for this run, or NULL. Not owned by the report.
+  RenderCache renderCache;
+  // Stage cache used for this run, or NULL. Not owned by the report.
+  StageCache stageCache;
+} StatsReportMembers;
+typedef StatsReportMembers *StatsReport;
+
+/**
+ * Create a new stats report. The output file is not opened until the report is
+ * written.
+ * @param outputPath Path to the JSON file to write
+ * @return Initialized StatsReport
+ */
+StatsReport newStatsReport(const CharString outputPath);
+
+/**
+ * Write all statistics to the output file. Should be called after processing
+ * has finished and all timers have been stopped.
+ * @param self
+ * @param totalTimer Timer for the entire run, including initialization
+ * @param phaseTimers List of TaskTimer objects for each processing phase
+ * @param pluginChain Plugin chain used for processing
+ * @return True on success, false if the file could not be written
+ */
+boolByte statsReportWrite(StatsReport self, const TaskTimer totalTimer,
+                          LinkedList phaseTimers, PluginChain pluginChain);
+
+/**
+ * Free a stats report and its associated resources
+ * @param self
+ */
+void freeStatsReport(StatsReport self);
+
+#endif
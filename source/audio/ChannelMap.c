@@ -0,0 +1,347 @@
+//
+// ChannelMap.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "ChannelMap.h"
+
+#include "base/LinkedList.h"
+#include "logging/EventLogger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHANNEL_MAP_ROUTE_SEPARATOR ','
+
+// Gain for mixing a channel into two channels without changing its power
+static const Sample kChannelMapMinus3dB = 0.70710678f;
+
+// Channels of a 5.1 layout, in the order used by WAVE files and VST plugins
+enum {
+  kSurroundLeft,
+  kSurroundRight,
+  kSurroundCenter,
+  kSurroundLfe,
+  kSurroundLeftRear,
+  kSurroundRightRear,
+  kSurroundNumChannels
+};
+
+// Gain from a 5.1 input channel to one side of a stereo output, where the
+// LFE channel is dropped
+static Sample _getSurroundToStereoGain(const ChannelCount input,
+                                       const ChannelCount side) {
+  if (input == side) {
+    return 1.0f;
+  } else if (input == kSurroundCenter || input == kSurroundLeftRear + side) {
+    return kChannelMapMinus3dB;
+  } else {
+    return 0.0f;
+  }
+}
+
+Sample channelMapGetDefaultGain(const ChannelCount numInputs,
+                                const ChannelCount numOutputs,
+                                const ChannelCount input,
+                                const ChannelCount output) {
+  if (input >= numInputs || output >= numOutputs) {
+    return 0.0f;
+  } else if (numInputs == numOutputs) {
+    return input == output ? 1.0f : 0.0f;
+  } else if (numInputs == 1) {
+    // Mono goes to the center channel of 5.1, and to all channels otherwise
+    if (numOutputs == kSurroundNumChannels) {
+      return output == kSurroundCenter ? 1.0f : 0.0f;
+    }
+
+    return 1.0f;
+  } else if (numInputs == kSurroundNumChannels && numOutputs == 2) {
+    return _getSurroundToStereoGain(input, output);
+  } else if (numInputs == kSurroundNumChannels && numOutputs == 1) {
+    return 0.5f * (_getSurroundToStereoGain(input, 0) +
+                   _getSurroundToStereoGain(input, 1));
+  } else if (numInputs == 2 && numOutputs == kSurroundNumChannels) {
+    // Stereo only goes to the front channels, rather than being repeated in
+    // the center and LFE channels
+    return input == output ? 1.0f : 0.0f;
+  } else if (numOutputs == 1) {
+    return 1.0f / numInputs;
+  } else if (numOutputs > numInputs) {
+    return input == output % numInputs ? 1.0f : 0.0f;
+  } else {
+    return input == output ? 1.0f : 0.0f;
+  }
+}
+
+// Write one input channel to an output channel, or add it to the output. The
+// loops have no branches, so that the compiler can turn them into vectorized
+// multiply-add instructions.
+static void _mixChannel(Sample *destination, const Sample *source,
+                        const Sample gain, const SampleCount numFrames,
+                        const boolByte accumulate) {
+  SampleCount i;
+
+  if (accumulate) {
+    for (i = 0; i < numFrames; i++) {
+      destination[i] += gain * source[i];
+    }
+  } else if (gain == 1.0f) {
+    memcpy(destination, source, sizeof(Sample) * numFrames);
+  } else {
+    for (i = 0; i < numFrames; i++) {
+      destination[i] = gain * source[i];
+    }
+  }
+}
+
+ChannelMap newChannelMap(const ChannelCount numInputs,
+                         const ChannelCount numOutputs) {
+  ChannelMap self = (ChannelMap)malloc(sizeof(ChannelMapMembers));
+  ChannelCount i;
+
+  self->numInputs = numInputs;
+  self->numOutputs = numOutputs;
+  self->_routes =
+      (ChannelMapRoute **)malloc(sizeof(ChannelMapRoute *) * numOutputs);
+  self->_numRoutes = (ChannelCount *)malloc(sizeof(ChannelCount) * numOutputs);
+
+  for (i = 0; i < numOutputs; i++) {
+    self->_routes[i] =
+        (ChannelMapRoute *)malloc(sizeof(ChannelMapRoute) * numInputs);
+    self->_numRoutes[i] = 0;
+  }
+
+  return self;
+}
+
+ChannelMap newChannelMapDefault(const ChannelCount numInputs,
+                                const ChannelCount numOutputs) {
+  ChannelMap self = newChannelMap(numInputs, numOutputs);
+  ChannelCount input;
+  ChannelCount output;
+
+  for (output = 0; output < numOutputs; output++) {
+    for (input = 0; input < numInputs; input++) {
+      channelMapSetGain(
+          self, input, output,
+          channelMapGetDefaultGain(numInputs, numOutputs, input, output));
+    }
+  }
+
+  return self;
+}
+
+ChannelMap newChannelMapWithString(const ChannelCount numInputs,
+                                   const ChannelCount numOutputs,
+                                   const CharString routes) {
+  ChannelMap self = newChannelMap(numInputs, numOutputs);
+  LinkedList routeStrings =
+      charStringSplit(routes, CHANNEL_MAP_ROUTE_SEPARATOR);
+  CharString *routeArray = (CharString *)linkedListToArray(routeStrings);
+  const int numRouteStrings = linkedListLength(routeStrings);
+  unsigned int input;
+  unsigned int output;
+  float gain;
+  int numCharsRead;
+  int numGainCharsRead;
+  int i;
+
+  if (numRouteStrings == 0) {
+    logError("Channel map does not contain any routes");
+    freeChannelMap(self);
+    self = NULL;
+  }
+
+  for (i = 0; self != NULL && i < numRouteStrings; i++) {
+    gain = 1.0f;
+    numCharsRead = 0;
+    numGainCharsRead = 0;
+
+    if (sscanf(routeArray[i]->data, "%u:%u%n", &input, &output,
+               &numCharsRead) != 2 ||
+        (routeArray[i]->data[numCharsRead] == ':' &&
+         sscanf(routeArray[i]->data + numCharsRead, ":%f%n", &gain,
+                &numGainCharsRead) != 1) ||
+        routeArray[i]->data[numCharsRead + numGainCharsRead] != '\0') {
+      logError("Invalid channel map route '%s', expected "
+               "'input:output[:gain]'",
+               routeArray[i]->data);
+      freeChannelMap(self);
+      self = NULL;
+    } else if (!channelMapSetGain(self, (ChannelCount)input,
+                                  (ChannelCount)output, (Sample)gain)) {
+      logError("Channel map route '%s' is out of range, there are %d input "
+               "and %d output channels",
+               routeArray[i]->data, numInputs, numOutputs);
+      freeChannelMap(self);
+      self = NULL;
+    }
+  }
+
+  free(routeArray);
+  freeLinkedListAndItems(routeStrings, (LinkedListFreeItemFunc)freeCharString);
+  return self;
+}
+
+boolByte channelMapSetGain(ChannelMap self, const ChannelCount input,
+                           const ChannelCount output, const Sample gain) {
+  ChannelMapRoute *routes;
+  ChannelCount i;
+
+  if (input >= self->numInputs || output >= self->numOutputs) {
+    return false;
+  }
+
+  routes = self->_routes[output];
+
+  for (i = 0; i < self->_numRoutes[output]; i++) {
+    if (routes[i].input == input) {
+      break;
+    }
+  }
+
+  if (gain == 0.0f) {
+    // Remove the route, so that it is not mixed at all
+    if (i < self->_numRoutes[output]) {
+      self->_numRoutes[output]--;
+      memmove(routes + i, routes + i + 1,
+              sizeof(ChannelMapRoute) * (self->_numRoutes[output] - i));
+    }
+  } else {
+    if (i == self->_numRoutes[output]) {
+      self->_numRoutes[output]++;
+    }
+
+    routes[i].input = input;
+    routes[i].gain = gain;
+  }
+
+  return true;
+}
+
+Sample channelMapGetGain(const ChannelMap self, const ChannelCount input,
+                         const ChannelCount output) {
+  ChannelCount i;
+
+  if (output < self->numOutputs) {
+    for (i = 0; i < self->_numRoutes[output]; i++) {
+      if (self->_routes[output][i].input == input) {
+        return self->_routes[output][i].gain;
+      }
+    }
+  }
+
+  return 0.0f;
+}
+
+boolByte channelMapApply(const ChannelMap self, SampleBuffer destinationBuffer,
+                         const SampleCount destinationOffset,
+                         const SampleBuffer sourceBuffer,
+                         const SampleCount sourceOffset,
+                         const SampleCount numFrames) {
+  ChannelMapRoute *routes;
+  Sample *destination;
+  ChannelCount output;
+  ChannelCount i;
+
+  if (destinationBuffer->numChannels != self->numOutputs ||
+      sourceBuffer->numChannels != self->numInputs) {
+    logInternalError("Channel map is %d -> %d, but buffers are %d -> %d",
+                     self->numInputs, self->numOutputs,
+                     sourceBuffer->numChannels,
+                     destinationBuffer->numChannels);
+    return false;
+  }
+
+  if (destinationBuffer->blocksize < destinationOffset + numFrames ||
+      sourceBuffer->blocksize < sourceOffset + numFrames) {
+    logInternalError("Channel map cannot route %d frames", numFrames);
+    return false;
+  }
+
+  for (output = 0; output < self->numOutputs; output++) {
+    routes = self->_routes[output];
+    destination = destinationBuffer->samples[output] + destinationOffset;
+
+    if (self->_numRoutes[output] == 0) {
+      memset(destination, 0, sizeof(Sample) * numFrames);
+    }
+
+    for (i = 0; i < self->_numRoutes[output]; i++) {
+      _mixChannel(destination,
+                  sourceBuffer->samples[routes[i].input] + sourceOffset,
+                  routes[i].gain, numFrames, (boolByte)(i > 0));
+    }
+  }
+
+  return true;
+}
+
+void channelMapApplyDefault(SampleBuffer destinationBuffer,
+                            const SampleCount destinationOffset,
+                            const SampleBuffer sourceBuffer,
+                            const SampleCount sourceOffset,
+                            const SampleCount numFrames) {
+  Sample *destination;
+  Sample gain;
+  boolByte isMixed;
+  ChannelCount output;
+  ChannelCount input;
+
+  for (output = 0; output < destinationBuffer->numChannels; output++) {
+    destination = destinationBuffer->samples[output] + destinationOffset;
+    isMixed = false;
+
+    for (input = 0; input < sourceBuffer->numChannels; input++) {
+      gain = channelMapGetDefaultGain(sourceBuffer->numChannels,
+                                      destinationBuffer->numChannels, input,
+                                      output);
+
+      if (gain != 0.0f) {
+        _mixChannel(destination, sourceBuffer->samples[input] + sourceOffset,
+                    gain, numFrames, isMixed);
+        isMixed = true;
+      }
+    }
+
+    if (!isMixed) {
+      memset(destination, 0, sizeof(Sample) * numFrames);
+    }
+  }
+}
+
+void freeChannelMap(ChannelMap self) {
+  ChannelCount i;
+
+  if (self != NULL) {
+    for (i = 0; i < self->numOutputs; i++) {
+      free(self->_routes[i]);
+    }
+
+    free(self->_routes);
+    free(self->_numRoutes);
+    free(self);
+  }
+}
@@ -0,0 +1,169 @@
+//
+// ChannelMap.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_ChannelMap_h
+#define MrsWatson_ChannelMap_h
+
+#include "audio/SampleBuffer.h"
+#include "base/CharString.h"
+#include "base/Types.h"
+
+// A route from one input channel to an output channel
+typedef struct {
+  ChannelCount input;
+  Sample gain;
+} ChannelMapRoute;
+
+/**
+ * Routes the channels of one buffer to another with a matrix of gains, where
+ * each output channel is the sum of the input channels multiplied by their
+ * gains. Only routes with a gain other than zero are stored, and outputs with
+ * a single route at unity gain are copied directly.
+ */
+typedef struct {
+  ChannelCount numInputs;
+  ChannelCount numOutputs;
+
+  // Private fields
+  // Routes for each output, where each array has room for all inputs
+  ChannelMapRoute **_routes;
+  ChannelCount *_numRoutes;
+} ChannelMapMembers;
+typedef ChannelMapMembers *ChannelMap;
+
+/**
+ * Get the gain from an input to an output channel when no channel map is
+ * given. The same number of channels is mapped one to one. Mono, stereo and
+ * 5.1 (in the order L, R, C, LFE, Ls, Rs) are up- and downmixed with the usual
+ * gains, for instance the center and surround channels are added to the front
+ * channels at -3dB when mixing 5.1 down to stereo. For other layouts, extra
+ * input channels are dropped, and input channels are repeated to fill extra
+ * output channels.
+ * @param numInputs Number of input channels
+ * @param numOutputs Number of output channels
+ * @param input Input channel
+ * @param output Output channel
+ * @return Gain, or 0 if the input is not routed to the output
+ */
+Sample channelMapGetDefaultGain(const ChannelCount numInputs,
+                                const ChannelCount numOutputs,
+                                const ChannelCount input,
+                                const ChannelCount output);
+
+/**
+ * Create a new channel map where no inputs are routed to any outputs
+ * @param numInputs Number of input channels
+ * @param numOutputs Number of output channels
+ * @return Initialized ChannelMap
+ */
+ChannelMap newChannelMap(const ChannelCount numInputs,
+                         const ChannelCount numOutputs);
+
+/**
+ * Create a new channel map with the default gains, as given by
+ * channelMapGetDefaultGain().
+ * @param numInputs Number of input channels
+ * @param numOutputs Number of output channels
+ * @return Initialized ChannelMap
+ */
+ChannelMap newChannelMapDefault(const ChannelCount numInputs,
+                                const ChannelCount numOutputs);
+
+/**
+ * Create a new channel map from a string with comma-separated routes. Each
+ * route has the form "input:output" or "input:output:gain", with channels
+ * starting at 0 and the gain as a linear factor. For example, "0:0,1:1,2:0:0.5"
+ * routes the first two channels straight through and adds the third channel to
+ * the first at half volume.
+ * @param numInputs Number of input channels
+ * @param numOutputs Number of output channels
+ * @param routes String with the routes
+ * @return Initialized ChannelMap, or NULL if the string is invalid
+ */
+ChannelMap newChannelMapWithString(const ChannelCount numInputs,
+                                   const ChannelCount numOutputs,
+                                   const CharString routes);
+
+/**
+ * Set the gain from an input to an output channel. A gain of 0 removes the
+ * route.
+ * @param self
+ * @param input Input channel
+ * @param output Output channel
+ * @param gain Linear gain
+ * @return False if either channel is out of range
+ */
+boolByte channelMapSetGain(ChannelMap self, const ChannelCount input,
+                           const ChannelCount output, const Sample gain);
+
+/**
+ * Get the gain from an input to an output channel
+ * @param self
+ * @param input Input channel
+ * @param output Output channel
+ * @return Linear gain, or 0 if the input is not routed to the output
+ */
+Sample channelMapGetGain(const ChannelMap self, const ChannelCount input,
+                         const ChannelCount output);
+
+/**
+ * Route frames from one buffer to another. The buffers must not be the same.
+ * @param self
+ * @param destinationBuffer Buffer with numOutputs channels
+ * @param destinationOffset Frame to start writing at
+ * @param sourceBuffer Buffer with numInputs channels
+ * @param sourceOffset Frame to start reading at
+ * @param numFrames Number of frames to route
+ * @return False if the buffers do not match the map
+ */
+boolByte channelMapApply(const ChannelMap self, SampleBuffer destinationBuffer,
+                         const SampleCount destinationOffset,
+                         const SampleBuffer sourceBuffer,
+                         const SampleCount sourceOffset,
+                         const SampleCount numFrames);
+
+/**
+ * Route frames from one buffer to another with the default gains, without
+ * creating a channel map.
+ * @param destinationBuffer Buffer to write to
+ * @param destinationOffset Frame to start writing at
+ * @param sourceBuffer Buffer to read from
+ * @param sourceOffset Frame to start reading at
+ * @param numFrames Number of frames to route
+ */
+void channelMapApplyDefault(SampleBuffer destinationBuffer,
+                            const SampleCount destinationOffset,
+                            const SampleBuffer sourceBuffer,
+                            const SampleCount sourceOffset,
+                            const SampleCount numFrames);
+
+/**
+ * Free a channel map and all associated resources
+ * @param self
+ */
+void freeChannelMap(ChannelMap self);
+
+#endif
@@ -0,0 +1,192 @@
+//
+// DelayCompensator.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "DelayCompensator.h"
+
+#include "logging/EventLogger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+DelayCompensator newDelayCompensator(const ChannelCount numChannels,
+                                     const SampleCount blocksize,
+                                     const unsigned long delayInFrames) {
+  DelayCompensator self =
+      (DelayCompensator)malloc(sizeof(DelayCompensatorMembers));
+
+  self->delayInFrames = delayInFrames;
+  // Less than a block is left over after reading, so there is always enough
+  // space to push the next block
+  self->_ringBuffer = newSampleBuffer(numChannels, blocksize * 2);
+  delayCompensatorReset(self);
+
+  return self;
+}
+
+void delayCompensatorSetDelay(DelayCompensator self,
+                              const unsigned long delayInFrames) {
+  unsigned long difference;
+
+  if (delayInFrames == self->delayInFrames) {
+    return;
+  }
+
+  logInfo("Processing delay changed from %lu to %lu frames",
+          self->delayInFrames, delayInFrames);
+
+  if (delayInFrames > self->delayInFrames) {
+    difference = delayInFrames - self->delayInFrames;
+
+    if (self->_framesToPad >= difference) {
+      self->_framesToPad -= difference;
+    } else {
+      self->_framesToSkip += difference - self->_framesToPad;
+      self->_framesToPad = 0;
+    }
+  } else {
+    difference = self->delayInFrames - delayInFrames;
+
+    if (self->_framesToSkip >= difference) {
+      self->_framesToSkip -= difference;
+    } else {
+      self->_framesToPad += difference - self->_framesToSkip;
+      self->_framesToSkip = 0;
+    }
+  }
+
+  self->delayInFrames = delayInFrames;
+}
+
+// Append frames to the ring buffer, or silence if buffer is NULL
+static void _delayCompensatorAppend(DelayCompensator self,
+                                    const SampleBuffer buffer,
+                                    const SampleCount offset,
+                                    const SampleCount numFrames) {
+  const SampleCount capacity = self->_ringBuffer->blocksize;
+  const SampleCount writePosition =
+      (self->_readPosition + self->numFrames) % capacity;
+  const SampleCount firstPart = writePosition + numFrames > capacity
+                                    ? capacity - writePosition
+                                    : numFrames;
+  ChannelCount i;
+
+  for (i = 0; i < self->_ringBuffer->numChannels; i++) {
+    if (buffer == NULL) {
+      memset(self->_ringBuffer->samples[i] + writePosition, 0,
+             sizeof(Sample) * firstPart);
+      memset(self->_ringBuffer->samples[i], 0,
+             sizeof(Sample) * (numFrames - firstPart));
+    } else {
+      memcpy(self->_ringBuffer->samples[i] + writePosition,
+             buffer->samples[i] + offset, sizeof(Sample) * firstPart);
+      memcpy(self->_ringBuffer->samples[i],
+             buffer->samples[i] + offset + firstPart,
+             sizeof(Sample) * (numFrames - firstPart));
+    }
+  }
+
+  self->numFrames += numFrames;
+}
+
+void delayCompensatorPush(DelayCompensator self, const SampleBuffer buffer) {
+  const SampleCount capacity = self->_ringBuffer->blocksize;
+  SampleCount offset = 0;
+  SampleCount numFrames;
+
+  if (buffer->numChannels != self->_ringBuffer->numChannels) {
+    logInternalError("Delay compensator has %d channels, but got %d",
+                     self->_ringBuffer->numChannels, buffer->numChannels);
+    return;
+  }
+
+  if (self->_framesToSkip > 0) {
+    offset = self->_framesToSkip < buffer->blocksize
+                 ? (SampleCount)self->_framesToSkip
+                 : buffer->blocksize;
+    self->_framesToSkip -= offset;
+  }
+
+  numFrames = buffer->blocksize - offset;
+
+  if (self->numFrames + numFrames > capacity) {
+    logInternalError("Delay compensator overflow, frames were not read");
+    return;
+  }
+
+  // Any silence which does not fit is inserted with the next blocks
+  if (self->_framesToPad > 0) {
+    SampleCount numSilentFrames = capacity - self->numFrames - numFrames;
+
+    if (self->_framesToPad < numSilentFrames) {
+      numSilentFrames = (SampleCount)self->_framesToPad;
+    }
+
+    _delayCompensatorAppend(self, NULL, 0, numSilentFrames);
+    self->_framesToPad -= numSilentFrames;
+  }
+
+  _delayCompensatorAppend(self, buffer, offset, numFrames);
+}
+
+boolByte delayCompensatorRead(DelayCompensator self, SampleBuffer buffer) {
+  const SampleCount capacity = self->_ringBuffer->blocksize;
+  const SampleCount firstPart = self->_readPosition + buffer->blocksize >
+                                        capacity
+                                    ? capacity - self->_readPosition
+                                    : buffer->blocksize;
+  ChannelCount i;
+
+  if (buffer->blocksize > self->numFrames ||
+      buffer->numChannels != self->_ringBuffer->numChannels) {
+    return false;
+  }
+
+  for (i = 0; i < buffer->numChannels; i++) {
+    memcpy(buffer->samples[i],
+           self->_ringBuffer->samples[i] + self->_readPosition,
+           sizeof(Sample) * firstPart);
+    memcpy(buffer->samples[i] + firstPart, self->_ringBuffer->samples[i],
+           sizeof(Sample) * (buffer->blocksize - firstPart));
+  }
+
+  self->_readPosition = (self->_readPosition + buffer->blocksize) % capacity;
+  self->numFrames -= buffer->blocksize;
+  return true;
+}
+
+void delayCompensatorReset(DelayCompensator self) {
+  self->numFrames = 0;
+  self->_readPosition = 0;
+  self->_framesToSkip = self->delayInFrames;
+  self->_framesToPad = 0;
+}
+
+void freeDelayCompensator(DelayCompensator self) {
+  if (self != NULL) {
+    freeSampleBuffer(self->_ringBuffer);
+    free(self);
+  }
+}
@@ -0,0 +1,108 @@
+//
+// DelayCompensator.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_DelayCompensator_h
+#define MrsWatson_DelayCompensator_h
+
+#include "audio/SampleBuffer.h"
+#include "base/Types.h"
+
+/**
+ * Removes the processing delay of the plugin chain from its output, so that
+ * the output lines up exactly with the input. Output of the chain is pushed
+ * into a ring buffer which is allocated once, and read back out in blocks
+ * once enough frames are available.
+ */
+typedef struct {
+  // Number of frames which the pushed output is delayed by
+  unsigned long delayInFrames;
+  // Number of frames which are ready to be read
+  SampleCount numFrames;
+
+  // Private fields
+  SampleBuffer _ringBuffer;
+  SampleCount _readPosition;
+  // Frames still to be dropped from the start of the pushed output
+  unsigned long _framesToSkip;
+  // Frames of silence still to be inserted, after the delay got shorter
+  unsigned long _framesToPad;
+} DelayCompensatorMembers;
+typedef DelayCompensatorMembers *DelayCompensator;
+
+/**
+ * Create a new delay compensator
+ * @param numChannels Number of channels of the output
+ * @param blocksize Largest number of frames which is pushed or read at once
+ * @param delayInFrames Processing delay, in frames
+ * @return Initialized DelayCompensator
+ */
+DelayCompensator newDelayCompensator(const ChannelCount numChannels,
+                                     const SampleCount blocksize,
+                                     const unsigned long delayInFrames);
+
+/**
+ * Change the processing delay while processing, for instance when a plugin
+ * reports a new initial delay. If the delay grew, the extra frames are dropped
+ * from the output, and if it shrank, silence is inserted instead.
+ * @param self
+ * @param delayInFrames New processing delay, in frames
+ */
+void delayCompensatorSetDelay(DelayCompensator self,
+                              const unsigned long delayInFrames);
+
+/**
+ * Push a block of output from the plugin chain. The caller must read all
+ * available blocks before pushing the next one.
+ * @param self
+ * @param buffer Output of the chain, which has no more frames than the
+ * blocksize given when creating the compensator
+ */
+void delayCompensatorPush(DelayCompensator self, const SampleBuffer buffer);
+
+/**
+ * Read frames with the delay removed.
+ * @param self
+ * @param buffer Buffer to fill, with the number of frames to read set as its
+ * blocksize
+ * @return True if the buffer was filled, false if not enough frames are
+ * available yet
+ */
+boolByte delayCompensatorRead(DelayCompensator self, SampleBuffer buffer);
+
+/**
+ * Drop all pushed frames, and start over with the full delay. This should be
+ * called when the plugins are reset to process the input again.
+ * @param self
+ */
+void delayCompensatorReset(DelayCompensator self);
+
+/**
+ * Free a delay compensator and its ring buffer
+ * @param self
+ */
+void freeDelayCompensator(DelayCompensator self);
+
+#endif
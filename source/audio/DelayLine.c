@@ -0,0 +1,104 @@
+//
+// DelayLine.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "DelayLine.h"
+
+#include "logging/EventLogger.h"
+
+#include <stdlib.h>
+
+DelayLine newDelayLine(const ChannelCount numChannels) {
+  DelayLine self = (DelayLine)malloc(sizeof(DelayLineMembers));
+
+  self->numChannels = numChannels;
+  self->delayInFrames = 0;
+  self->_ringBuffer = NULL;
+  self->_position = 0;
+
+  return self;
+}
+
+void delayLineSetDelay(DelayLine self, const unsigned long delayInFrames) {
+  if (delayInFrames == self->delayInFrames) {
+    return;
+  }
+
+  logDebug("Delay line changed from %lu to %lu frames", self->delayInFrames,
+           delayInFrames);
+  freeSampleBuffer(self->_ringBuffer);
+  self->_ringBuffer = delayInFrames > 0
+                          ? newSampleBuffer(self->numChannels,
+                                            (SampleCount)delayInFrames)
+                          : NULL;
+  self->delayInFrames = delayInFrames;
+  self->_position = 0;
+}
+
+void delayLineProcess(DelayLine self, SampleBuffer buffer) {
+  unsigned long position = self->_position;
+  Sample sample;
+  ChannelCount i;
+  SampleCount j;
+
+  if (self->_ringBuffer == NULL) {
+    return;
+  } else if (buffer->numChannels != self->numChannels) {
+    logInternalError("Cannot delay %d channels with a delay line for %d",
+                     buffer->numChannels, self->numChannels);
+    return;
+  }
+
+  for (i = 0; i < self->numChannels; i++) {
+    position = self->_position;
+
+    for (j = 0; j < buffer->blocksize; j++) {
+      sample = self->_ringBuffer->samples[i][position];
+      self->_ringBuffer->samples[i][position] = buffer->samples[i][j];
+      buffer->samples[i][j] = sample;
+
+      if (++position == self->delayInFrames) {
+        position = 0;
+      }
+    }
+  }
+
+  self->_position = position;
+}
+
+void delayLineReset(DelayLine self) {
+  if (self->_ringBuffer != NULL) {
+    sampleBufferClear(self->_ringBuffer);
+  }
+
+  self->_position = 0;
+}
+
+void freeDelayLine(DelayLine self) {
+  if (self != NULL) {
+    freeSampleBuffer(self->_ringBuffer);
+    free(self);
+  }
+}
@@ -0,0 +1,84 @@
+//
+// DelayLine.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_DelayLine_h
+#define MrsWatson_DelayLine_h
+
+#include "audio/SampleBuffer.h"
+#include "base/Types.h"
+
+/**
+ * Delays audio by a fixed number of frames. This is used to line up parallel
+ * paths through the plugin chain which have a shorter processing delay than
+ * others, so that they can be mixed together again.
+ */
+typedef struct {
+  ChannelCount numChannels;
+  unsigned long delayInFrames;
+
+  // Private fields
+  // Holds the last delayInFrames frames, or NULL when there is no delay
+  SampleBuffer _ringBuffer;
+  unsigned long _position;
+} DelayLineMembers;
+typedef DelayLineMembers *DelayLine;
+
+/**
+ * Create a new delay line without any delay
+ * @param numChannels Number of channels to delay
+ * @return Initialized DelayLine
+ */
+DelayLine newDelayLine(const ChannelCount numChannels);
+
+/**
+ * Change the delay. When the delay changes, the delayed audio is dropped and
+ * the delay line starts out with silence again.
+ * @param self
+ * @param delayInFrames New delay, in frames
+ */
+void delayLineSetDelay(DelayLine self, const unsigned long delayInFrames);
+
+/**
+ * Delay a block of audio in place
+ * @param self
+ * @param buffer Audio to delay, which must have as many channels as the delay
+ * line. All frames up to its blocksize are delayed.
+ */
+void delayLineProcess(DelayLine self, SampleBuffer buffer);
+
+/**
+ * Replace the delayed audio with silence
+ * @param self
+ */
+void delayLineReset(DelayLine self);
+
+/**
+ * Free a delay line and its ring buffer
+ * @param self
+ */
+void freeDelayLine(DelayLine self);
+
+#endif
@@ -0,0 +1,131 @@
+//
+// DoubleSampleBuffer.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "DoubleSampleBuffer.h"
+
+#include "logging/EventLogger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+DoubleSampleBuffer newDoubleSampleBuffer(ChannelCount numChannels,
+                                         SampleCount blocksize) {
+  DoubleSampleBuffer self =
+      (DoubleSampleBuffer)malloc(sizeof(DoubleSampleBufferMembers));
+  self->numChannels = numChannels;
+  self->blocksize = blocksize;
+  self->samples = (DoubleSamples *)malloc(sizeof(DoubleSamples) * numChannels);
+
+  for (ChannelCount i = 0; i < numChannels; i++) {
+    self->samples[i] = (DoubleSamples)malloc(sizeof(DoubleSample) * blocksize);
+  }
+
+  doubleSampleBufferClear(self);
+  return self;
+}
+
+void doubleSampleBufferClear(DoubleSampleBuffer self) {
+  for (ChannelCount i = 0; i < self->numChannels; i++) {
+    memset(self->samples[i], 0, sizeof(DoubleSample) * self->blocksize);
+  }
+}
+
+// Check that numFrames frames with numChannels can be copied to or from a
+// buffer with the other channel count and blocksize
+static boolByte _doubleSampleBufferMatches(const ChannelCount numChannels,
+                                           const SampleCount numFrames,
+                                           const ChannelCount otherChannels,
+                                           const SampleCount otherBlocksize) {
+  if (numChannels != otherChannels || numFrames > otherBlocksize) {
+    logInternalError("Cannot copy %d frames of %d channels with a buffer of "
+                     "%d frames and %d channels",
+                     numFrames, numChannels, otherBlocksize, otherChannels);
+    return false;
+  }
+
+  return true;
+}
+
+boolByte doubleSampleBufferCopy(DoubleSampleBuffer self,
+                                const DoubleSampleBuffer buffer) {
+  if (!_doubleSampleBufferMatches(self->numChannels, self->blocksize,
+                                  buffer->numChannels, buffer->blocksize)) {
+    return false;
+  }
+
+  for (ChannelCount i = 0; i < self->numChannels; i++) {
+    memcpy(self->samples[i], buffer->samples[i],
+           sizeof(DoubleSample) * self->blocksize);
+  }
+
+  return true;
+}
+
+// The conversion loops have no branches, so that the compiler can vectorize
+// them
+
+boolByte doubleSampleBufferCopyFromSampleBuffer(DoubleSampleBuffer self,
+                                                const SampleBuffer buffer) {
+  if (!_doubleSampleBufferMatches(self->numChannels, self->blocksize,
+                                  buffer->numChannels, buffer->blocksize)) {
+    return false;
+  }
+
+  for (ChannelCount i = 0; i < self->numChannels; i++) {
+    for (SampleCount j = 0; j < self->blocksize; j++) {
+      self->samples[i][j] = (DoubleSample)buffer->samples[i][j];
+    }
+  }
+
+  return true;
+}
+
+boolByte doubleSampleBufferCopyToSampleBuffer(const DoubleSampleBuffer self,
+                                              SampleBuffer buffer) {
+  if (!_doubleSampleBufferMatches(self->numChannels, self->blocksize,
+                                  buffer->numChannels, buffer->blocksize)) {
+    return false;
+  }
+
+  for (ChannelCount i = 0; i < self->numChannels; i++) {
+    for (SampleCount j = 0; j < self->blocksize; j++) {
+      buffer->samples[i][j] = (Sample)self->samples[i][j];
+    }
+  }
+
+  return true;
+}
+
+void freeDoubleSampleBuffer(DoubleSampleBuffer self) {
+  if (self != NULL) {
+    for (ChannelCount i = 0; i < self->numChannels; i++) {
+      free(self->samples[i]);
+    }
+
+    free(self->samples);
+    free(self);
+  }
+}
@@ -0,0 +1,96 @@
+//
+// DoubleSampleBuffer.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_DoubleSampleBuffer_h
+#define MrsWatson_DoubleSampleBuffer_h
+
+#include "audio/SampleBuffer.h"
+#include "base/Types.h"
+
+/**
+ * Buffer of double precision samples, which is passed between plugins that
+ * can process double precision audio. Samples are only converted to and from
+ * a SampleBuffer where such a plugin meets a plugin which only processes
+ * single precision audio.
+ */
+typedef struct {
+  ChannelCount numChannels;
+  SampleCount blocksize;
+  DoubleSamples *samples;
+} DoubleSampleBufferMembers;
+typedef DoubleSampleBufferMembers *DoubleSampleBuffer;
+
+/**
+ * Create a new DoubleSampleBuffer instance
+ * @param numChannels Number of channels
+ * @param blocksize Processing blocksize to use
+ * @return An initialized DoubleSampleBuffer instance
+ */
+DoubleSampleBuffer newDoubleSampleBuffer(ChannelCount numChannels,
+                                         SampleCount blocksize);
+
+/**
+ * Set all samples to zero
+ * @param self
+ */
+void doubleSampleBufferClear(DoubleSampleBuffer self);
+
+/**
+ * Copy all samples from another buffer with the same number of channels
+ * @param self
+ * @param buffer Other buffer to copy blocksize frames from
+ * @return True on success, false if the buffers do not match
+ */
+boolByte doubleSampleBufferCopy(DoubleSampleBuffer self,
+                                const DoubleSampleBuffer buffer);
+
+/**
+ * Convert all samples from a single precision buffer with the same number of
+ * channels
+ * @param self
+ * @param buffer Buffer to copy blocksize frames from
+ * @return True on success, false if the buffers do not match
+ */
+boolByte doubleSampleBufferCopyFromSampleBuffer(DoubleSampleBuffer self,
+                                                const SampleBuffer buffer);
+
+/**
+ * Convert all samples to a single precision buffer with the same number of
+ * channels
+ * @param self
+ * @param buffer Buffer to copy blocksize frames to
+ * @return True on success, false if the buffers do not match
+ */
+boolByte doubleSampleBufferCopyToSampleBuffer(const DoubleSampleBuffer self,
+                                              SampleBuffer buffer);
+
+/**
+ * Free all memory used by a DoubleSampleBuffer instance
+ * @param self
+ */
+void freeDoubleSampleBuffer(DoubleSampleBuffer self);
+
+#endif
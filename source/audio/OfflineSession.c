@@ -0,0 +1,132 @@
+//
+// OfflineSession.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "OfflineSession.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+OfflineSession newOfflineSession(const CharString name, SampleBuffer input,
+                                 const ChannelCount numOutputChannels) {
+  OfflineSession self = (OfflineSession)malloc(sizeof(OfflineSessionMembers));
+
+  self->name = newCharString();
+  charStringCopy(self->name, name);
+  self->input = input;
+  self->output = newSampleBuffer(numOutputChannels, 0);
+  self->currentPass = 0;
+  self->_outputCapacity = 0;
+
+  return self;
+}
+
+SampleCount offlineSessionRead(const OfflineSession self,
+                               const boolByte fromInput,
+                               const SampleCount position,
+                               const SampleCount numFrames,
+                               const ChannelCount numChannels,
+                               Samples *destination) {
+  const SampleBuffer buffer = fromInput ? self->input : self->output;
+  SampleCount numFramesRead = 0;
+  ChannelCount i;
+
+  if (position < buffer->blocksize) {
+    numFramesRead = buffer->blocksize - position;
+
+    if (numFramesRead > numFrames) {
+      numFramesRead = numFrames;
+    }
+  }
+
+  for (i = 0; i < numChannels; i++) {
+    if (i < buffer->numChannels && numFramesRead > 0) {
+      memcpy(destination[i], buffer->samples[i] + position,
+             sizeof(Sample) * numFramesRead);
+    }
+
+    if (i < buffer->numChannels) {
+      memset(destination[i] + numFramesRead, 0,
+             sizeof(Sample) * (numFrames - numFramesRead));
+    } else {
+      memset(destination[i], 0, sizeof(Sample) * numFrames);
+    }
+  }
+
+  return numFramesRead;
+}
+
+// Make room for at least numFrames frames in the output. The capacity is
+// doubled, so that plugins which write small blocks do not copy the whole
+// output each time.
+static void _offlineSessionReserve(OfflineSession self,
+                                   const SampleCount numFrames) {
+  SampleCount capacity = self->_outputCapacity > 0 ? self->_outputCapacity : 1;
+  Samples samples;
+  ChannelCount i;
+
+  if (numFrames <= self->_outputCapacity) {
+    return;
+  }
+
+  while (capacity < numFrames) {
+    capacity *= 2;
+  }
+
+  for (i = 0; i < self->output->numChannels; i++) {
+    samples = (Samples)realloc(self->output->samples[i],
+                               sizeof(Sample) * capacity);
+    memset(samples + self->output->blocksize, 0,
+           sizeof(Sample) * (capacity - self->output->blocksize));
+    self->output->samples[i] = samples;
+  }
+
+  self->_outputCapacity = capacity;
+}
+
+void offlineSessionWrite(OfflineSession self, const SampleCount position,
+                         const SampleCount numFrames,
+                         const ChannelCount numChannels,
+                         Samples const *source) {
+  ChannelCount i;
+
+  _offlineSessionReserve(self, position + numFrames);
+
+  for (i = 0; i < numChannels && i < self->output->numChannels; i++) {
+    memcpy(self->output->samples[i] + position, source[i],
+           sizeof(Sample) * numFrames);
+  }
+
+  if (position + numFrames > self->output->blocksize) {
+    self->output->blocksize = position + numFrames;
+  }
+}
+
+void freeOfflineSession(OfflineSession self) {
+  if (self != NULL) {
+    freeCharString(self->name);
+    freeSampleBuffer(self->output);
+    free(self);
+  }
+}
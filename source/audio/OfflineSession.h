@@ -0,0 +1,107 @@
+//
+// OfflineSession.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#ifndef MrsWatson_OfflineSession_h
+#define MrsWatson_OfflineSession_h
+
+#include "audio/SampleBuffer.h"
+#include "base/CharString.h"
+#include "base/Types.h"
+
+/**
+ * Holds the entire input and output of a plugin which processes audio offline.
+ * Unlike regular processing, where each block is only seen once, an offline
+ * plugin may read and write frames at any position, and may read its own
+ * output again to process the audio in several passes.
+ */
+typedef struct {
+  // Name of the input, which is shown to the plugin
+  CharString name;
+  // All frames of the input, so its blocksize is the length of the input. This
+  // is owned by the caller which created the session.
+  SampleBuffer input;
+  // Frames written so far, so its blocksize is the length of the output
+  SampleBuffer output;
+  // Number of times the plugin has been asked to process the input
+  unsigned int currentPass;
+
+  // Private fields
+  SampleCount _outputCapacity;
+} OfflineSessionMembers;
+typedef OfflineSessionMembers *OfflineSession;
+
+/**
+ * Create a new offline session
+ * @param name Name of the input
+ * @param input Frames of the input, which must be kept until the session is
+ * freed
+ * @param numOutputChannels Number of channels which the plugin writes
+ * @return Initialized OfflineSession, with an empty output
+ */
+OfflineSession newOfflineSession(const CharString name, SampleBuffer input,
+                                 const ChannelCount numOutputChannels);
+
+/**
+ * Read frames from the input or the output of the session. Frames after the
+ * end and channels which the session does not have are filled with silence.
+ * @param self
+ * @param fromInput True to read from the input, false to read the frames which
+ * have been written to the output so far
+ * @param position Frame to start reading at
+ * @param numFrames Number of frames to read
+ * @param numChannels Number of channels in the destination
+ * @param destination Array of numChannels sample arrays, which each have room
+ * for numFrames samples
+ * @return Number of frames which were read before the end was reached
+ */
+SampleCount offlineSessionRead(const OfflineSession self,
+                               const boolByte fromInput,
+                               const SampleCount position,
+                               const SampleCount numFrames,
+                               const ChannelCount numChannels,
+                               Samples *destination);
+
+/**
+ * Write frames to the output of the session. The output grows as needed, and
+ * any gap before the position is filled with silence. Channels which the
+ * output does not have are ignored.
+ * @param self
+ * @param position Frame to start writing at
+ * @param numFrames Number of frames to write
+ * @param numChannels Number of channels in the source
+ * @param source Array of numChannels sample arrays with numFrames samples
+ */
+void offlineSessionWrite(OfflineSession self, const SampleCount position,
+                         const SampleCount numFrames,
+                         const ChannelCount numChannels,
+                         Samples const *source);
+
+/**
+ * Free an offline session and its output. The input is not freed.
+ * @param self
+ */
+void freeOfflineSession(OfflineSession self);
+
+#endif
@@ -27,6 +27,7 @@
 #include "SampleBuffer.h"
 
 #include "audio/AudioSettings.h"
+#include "audio/ChannelMap.h"
 #include "audio/SampleBuffer.h"
 #include "base/Endian.h"
 #include "logging/EventLogger.h"
@@ -56,6 +57,37 @@ void sampleBufferClear(SampleBuffer self) {
   }
 }
 
+// Number of samples which are scanned before checking for a non-silent sample
+static const SampleCount kSilenceScanChunkSize = 64;
+
+boolByte sampleBufferIsSilent(const SampleBuffer self) {
+  SampleCount chunkStart;
+  SampleCount chunkEnd;
+  SampleCount numLoudSamples;
+
+  for (ChannelCount i = 0; i < self->numChannels; i++) {
+    for (chunkStart = 0; chunkStart < self->blocksize;
+         chunkStart += kSilenceScanChunkSize) {
+      chunkEnd = chunkStart + kSilenceScanChunkSize < self->blocksize
+                     ? chunkStart + kSilenceScanChunkSize
+                     : self->blocksize;
+      numLoudSamples = 0;
+
+      // This loop has no branches, so that the compiler can vectorize it
+      for (SampleCount j = chunkStart; j < chunkEnd; j++) {
+        numLoudSamples +=
+            (fabsf(self->samples[i][j]) > kSampleBufferSilenceThreshold);
+      }
+
+      if (numLoudSamples > 0) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 boolByte sampleBufferCopyAndMapChannelsWithOffset(
     SampleBuffer destinationBuffer, SampleCount destinationOffset,
     const SampleBuffer sourceBuffer, SampleCount sourceOffset,
@@ -80,32 +112,19 @@ boolByte sampleBufferCopyAndMapChannelsWithOffset(
              destinationBuffer->numChannels);
   }
 
-  // If the other buffer is bigger (or the same size) as this buffer, then only
-  // copy up to the channel count of this buffer. Any other data will be lost,
-  // sorry about that!
-  if (sourceBuffer->numChannels >= destinationBuffer->numChannels) {
+  if (sourceBuffer->numChannels == destinationBuffer->numChannels) {
     for (ChannelCount i = 0; i < destinationBuffer->numChannels; ++i) {
       memcpy(destinationBuffer->samples[i] + destinationOffset,
              sourceBuffer->samples[i] + sourceOffset,
              sizeof(Sample) * numberOfFrames);
     }
   }
-  // But if this buffer is bigger than the other buffer, then copy all channels
-  // to this one. For example, if this buffer is 4 channels and the other buffer
-  // is 2 channels, then we copy the stereo pair to this channel (L R L R).
+  // Otherwise up- or downmix with the default gains, so that for example 5.1
+  // input is mixed down to stereo rather than losing the center channel. If
+  // the other buffer has zero channels then this buffer is cleared.
   else {
-    for (ChannelCount i = 0; i < destinationBuffer->numChannels; ++i) {
-      if (sourceBuffer->numChannels > 0) {
-        memcpy(destinationBuffer->samples[i] + destinationOffset,
-               sourceBuffer->samples[i % sourceBuffer->numChannels] +
-                   sourceOffset,
-               sizeof(Sample) * numberOfFrames);
-      } else {
-        // If the other buffer has zero channels just clear this buffer.
-        memset(destinationBuffer->samples[i] + destinationOffset, 0,
-               sizeof(Sample) * numberOfFrames);
-      }
-    }
+    channelMapApplyDefault(destinationBuffer, destinationOffset, sourceBuffer,
+                           sourceOffset, numberOfFrames);
   }
 
   return true;
@@ -36,6 +36,10 @@ typedef struct {
 } SampleBufferMembers;
 typedef SampleBufferMembers *SampleBuffer;
 
+// Samples below -144dBFS are considered to be silent. This is less than the
+// smallest step of a 24-bit sample.
+static const Sample kSampleBufferSilenceThreshold = 6.3e-8f;
+
 /**
  * Create a new SampleBuffer instance
  * @param numChannels Number of channels
@@ -50,6 +54,13 @@ SampleBuffer newSampleBuffer(ChannelCount numChannels, SampleCount blocksize);
  */
 void sampleBufferClear(SampleBuffer self);
 
+/**
+ * Check if all samples are below kSampleBufferSilenceThreshold
+ * @param self
+ * @return True if the buffer is silent
+ */
+boolByte sampleBufferIsSilent(const SampleBuffer self);
+
 /**
  * Copy some samples from another buffer to this one
  * @param destinationBuffer
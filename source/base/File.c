@@ -39,10 +39,14 @@
 #if WINDOWS
 #include <Shellapi.h>
 #include <Windows.h>
+#include <sys/utime.h>
 #elif UNIX
 #include <dirent.h>
+#include <fcntl.h>
 #include <ftw.h>
+#include <sys/mman.h>
 #include <unistd.h>
+#include <utime.h>
 
 #if LINUX
 #include <errno.h>
@@ -297,6 +301,26 @@ boolByte fileExists(File self) {
 #endif
 }
 
+boolByte fileIsNamedPipe(File self) {
+  if (self == NULL || self->absolutePath == NULL) {
+    return false;
+  }
+
+#if UNIX
+  struct stat fileStat;
+
+  if (stat(self->absolutePath->data, &fileStat) != 0) {
+    return false;
+  }
+
+  return (boolByte)S_ISFIFO(fileStat.st_mode);
+#else
+  // Named pipes on Windows live in their own namespace and can be opened like
+  // regular files, but there is no cheap way to tell them apart
+  return false;
+#endif
+}
+
 boolByte fileCreate(File self, const FileType fileType) {
   if (fileExists(self)) {
     return false;
@@ -636,6 +660,35 @@ size_t fileGetSize(File self) {
   return result;
 }
 
+unsigned long fileGetModificationTime(File self) {
+  struct stat fileStat;
+
+  if (self->absolutePath == NULL) {
+    return 0;
+  }
+
+  if (stat(self->absolutePath->data, &fileStat) != 0) {
+    return 0;
+  }
+
+  return (unsigned long)fileStat.st_mtime;
+}
+
+boolByte fileTouch(File self) {
+  if (self->absolutePath == NULL) {
+    return false;
+  }
+
+#if UNIX
+  return (boolByte)(utime(self->absolutePath->data, NULL) == 0);
+#elif WINDOWS
+  return (boolByte)(_utime(self->absolutePath->data, NULL) == 0);
+#else
+  logUnsupportedFeature("Touch file");
+  return false;
+#endif
+}
+
 CharString fileReadContents(File self) {
   CharString result = NULL;
   size_t fileSize = 0;
@@ -736,6 +789,65 @@ LinkedList fileReadLines(File self) {
   return result;
 }
 
+const void *fileMapContents(File self, size_t *outSize) {
+  void *result = NULL;
+  size_t size;
+
+  if (self == NULL || self->fileType != kFileTypeFile) {
+    logError("Attempt to map non-file object");
+    return NULL;
+  }
+
+  size = fileGetSize(self);
+
+  if (size == 0) {
+    logError("Cannot map empty file '%s'", self->absolutePath->data);
+    return NULL;
+  }
+
+#if UNIX
+  int fileDescriptor = open(self->absolutePath->data, O_RDONLY);
+
+  if (fileDescriptor < 0) {
+    logError("Could not open '%s' for reading", self->absolutePath->data);
+    return NULL;
+  }
+
+  result = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  // The mapping stays valid after the descriptor is closed
+  close(fileDescriptor);
+
+  if (result == MAP_FAILED) {
+    logError("Could not map '%s' into memory", self->absolutePath->data);
+    return NULL;
+  }
+
+#else
+  result = fileReadBytes(self, size);
+  fileClose(self);
+
+  if (result == NULL) {
+    return NULL;
+  }
+
+#endif
+
+  *outSize = size;
+  return result;
+}
+
+void fileUnmapContents(const void *contents, size_t size) {
+  if (contents == NULL) {
+    return;
+  }
+
+#if UNIX
+  munmap((void *)contents, size);
+#else
+  free((void *)contents);
+#endif
+}
+
 void *fileReadBytes(File self, size_t numBytes) {
   void *result = NULL;
   size_t itemsRead = 0;
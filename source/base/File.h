@@ -104,6 +104,14 @@ File newFileWithParent(const File parent, const CharString path);
  */
 boolByte fileExists(File self);
 
+/**
+ * Check to see if the path referenced by this object is a named pipe (FIFO).
+ * Such objects can be read from like regular files, but they cannot be seeked.
+ * @param self
+ * @return True if the object exists on disk and is a named pipe
+ */
+boolByte fileIsNamedPipe(File self);
+
 /**
  * Create a file object on disk of the given type. This call will fail if an
  * object already exists on the disk at the path pointed to by this file.
@@ -150,6 +158,21 @@ LinkedList fileListDirectory(File self);
  */
 size_t fileGetSize(File self);
 
+/**
+ * Return the time which a file or directory was last modified.
+ * @param self
+ * @return Modification time in seconds since the epoch, or 0 if this object
+ * does not exist.
+ */
+unsigned long fileGetModificationTime(File self);
+
+/**
+ * Set the modification time of a file or directory to the current time.
+ * @param self
+ * @return True if the modification time was set
+ */
+boolByte fileTouch(File self);
+
 /**
  * Read the contents of an entire file into a string. If the file had previously
  * been opened for writing, then it will be flushed, closed, and reopened for
@@ -184,6 +207,24 @@ LinkedList fileReadLines(File self);
  */
 void *fileReadBytes(File self, size_t numBytes);
 
+/**
+ * Map the entire contents of a file into memory for reading. On platforms where
+ * memory mapping is not supported, the file is read into a buffer instead.
+ * Either way, the contents must be released with fileUnmapContents().
+ * @param self
+ * @param outSize On success, set to the number of bytes in the file
+ * @return Read-only file contents, or NULL if the file is empty or could not be
+ * mapped
+ */
+const void *fileMapContents(File self, size_t *outSize);
+
+/**
+ * Release file contents returned by fileMapContents().
+ * @param contents File contents, may be NULL
+ * @param size Size returned by fileMapContents()
+ */
+void fileUnmapContents(const void *contents, size_t size);
+
 /**
  * Write a string to file. The first time this function is called, the file will
  * be opened for write mode, truncating any data present there if the file
@@ -0,0 +1,75 @@
+//
+// Hash.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Hash.h"
+
+#include "base/File.h"
+
+#include <string.h>
+
+static const HashValue kHashPrime = 1099511628211ull;
+
+HashValue hashBytes(HashValue hash, const void *data, const size_t numBytes) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  size_t i;
+
+  for (i = 0; i < numBytes; i++) {
+    hash ^= bytes[i];
+    hash *= kHashPrime;
+  }
+
+  return hash;
+}
+
+HashValue hashCString(HashValue hash, const char *string) {
+  return hashBytes(hash, string, strlen(string) + 1);
+}
+
+boolByte hashFileContents(HashValue *hash, const CharString path) {
+  File file = newFileWithPath(path);
+  const void *contents = NULL;
+  size_t size = 0;
+
+  if (file == NULL || file->fileType != kFileTypeFile) {
+    freeFile(file);
+    return false;
+  } else if (fileGetSize(file) == 0) {
+    // Empty files cannot be mapped, but they don't change the hash anyways
+    freeFile(file);
+    return true;
+  }
+
+  contents = fileMapContents(file, &size);
+  freeFile(file);
+
+  if (contents == NULL) {
+    return false;
+  }
+
+  *hash = hashBytes(*hash, contents, size);
+  fileUnmapContents(contents, size);
+  return true;
+}
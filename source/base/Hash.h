@@ -0,0 +1,70 @@
+//
+// Hash.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_Hash_h
+#define MrsWatson_Hash_h
+
+#include "base/CharString.h"
+
+#include <stdint.h>
+
+/**
+ * 64-bit FNV-1a hash. This is not a cryptographic hash, but it is fast and good
+ * enough to tell apart files and settings when used as a cache key.
+ */
+typedef uint64_t HashValue;
+
+/** Value to start hashing from */
+static const HashValue kHashInitialValue = 14695981039346656037ull;
+
+/**
+ * Add bytes to a hash.
+ * @param hash Hash of the data before these bytes
+ * @param data Bytes to add
+ * @param numBytes Number of bytes to add
+ * @return New hash value
+ */
+HashValue hashBytes(HashValue hash, const void *data, const size_t numBytes);
+
+/**
+ * Add a string to a hash. The terminating NULL character is also added, so
+ * that "ab" followed by "c" hashes differently than "a" followed by "bc".
+ * @param hash Hash of the data before this string
+ * @param string String to add
+ * @return New hash value
+ */
+HashValue hashCString(HashValue hash, const char *string);
+
+/**
+ * Add the contents of a file to a hash.
+ * @param hash Hash of the data before the file. If the file cannot be read,
+ * this is left untouched.
+ * @param path Path to the file
+ * @return True if the file was read
+ */
+boolByte hashFileContents(HashValue *hash, const CharString path);
+
+#endif
@@ -0,0 +1,223 @@
+//
+// JsonWriter.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "JsonWriter.h"
+
+#include "logging/EventLogger.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+static JsonWriter _newJsonWriter(FILE *outputFile, boolByte closeOnFree) {
+  JsonWriter jsonWriter = (JsonWriter)malloc(sizeof(JsonWriterMembers));
+  int i;
+
+  jsonWriter->outputFile = outputFile;
+  jsonWriter->closeOnFree = closeOnFree;
+  jsonWriter->depth = 0;
+
+  for (i = 0; i < JSON_WRITER_MAX_DEPTH; i++) {
+    jsonWriter->hasItems[i] = false;
+    jsonWriter->closeChars[i] = '\0';
+  }
+
+  return jsonWriter;
+}
+
+JsonWriter newJsonWriterWithPath(const CharString path) {
+  FILE *outputFile = fopen(path->data, "w");
+
+  if (outputFile == NULL) {
+    logError("Could not open '%s' for writing", path->data);
+    return NULL;
+  }
+
+  return _newJsonWriter(outputFile, true);
+}
+
+JsonWriter newJsonWriterWithFile(FILE *outputFile) {
+  return _newJsonWriter(outputFile, false);
+}
+
+static void _writeIndent(JsonWriter self) {
+  int i;
+
+  for (i = 0; i < self->depth; i++) {
+    fputs("  ", self->outputFile);
+  }
+}
+
+static void _writeEscapedString(JsonWriter self, const char *value) {
+  const char *c;
+
+  fputc('"', self->outputFile);
+
+  for (c = value; c != NULL && *c != '\0'; c++) {
+    switch (*c) {
+    case '"':
+      fputs("\\\"", self->outputFile);
+      break;
+
+    case '\\':
+      fputs("\\\\", self->outputFile);
+      break;
+
+    case '\n':
+      fputs("\\n", self->outputFile);
+      break;
+
+    case '\t':
+      fputs("\\t", self->outputFile);
+      break;
+
+    default:
+      if ((unsigned char)*c < 0x20) {
+        fprintf(self->outputFile, "\\u%04x", (unsigned int)*c);
+      } else {
+        fputc(*c, self->outputFile);
+      }
+
+      break;
+    }
+  }
+
+  fputc('"', self->outputFile);
+}
+
+// Write the separator, indentation and key (if any) which precede a value
+static void _beginValue(JsonWriter self, const char *key) {
+  if (self->depth > 0) {
+    if (self->hasItems[self->depth]) {
+      fputc(',', self->outputFile);
+    }
+
+    fputc('\n', self->outputFile);
+    _writeIndent(self);
+  }
+
+  self->hasItems[self->depth] = true;
+
+  if (key != NULL) {
+    _writeEscapedString(self, key);
+    fputs(": ", self->outputFile);
+  }
+}
+
+static void _beginContainer(JsonWriter self, const char *key,
+                            const char openChar, const char closeChar) {
+  _beginValue(self, key);
+  fputc(openChar, self->outputFile);
+
+  if (self->depth + 1 >= JSON_WRITER_MAX_DEPTH) {
+    logInternalError("JSON document is nested too deeply");
+    return;
+  }
+
+  self->depth++;
+  self->hasItems[self->depth] = false;
+  self->closeChars[self->depth] = closeChar;
+}
+
+static void _endContainer(JsonWriter self) {
+  const char closeChar = self->closeChars[self->depth];
+
+  if (self->depth == 0) {
+    logInternalError("Attempt to close JSON container which is not open");
+    return;
+  }
+
+  if (self->hasItems[self->depth]) {
+    fputc('\n', self->outputFile);
+    self->depth--;
+    _writeIndent(self);
+  } else {
+    self->depth--;
+  }
+
+  fputc(closeChar, self->outputFile);
+
+  if (self->depth == 0) {
+    fputc('\n', self->outputFile);
+  }
+}
+
+void jsonWriterBeginObject(JsonWriter self, const char *key) {
+  _beginContainer(self, key, '{', '}');
+}
+
+void jsonWriterEndObject(JsonWriter self) { _endContainer(self); }
+
+void jsonWriterBeginArray(JsonWriter self, const char *key) {
+  _beginContainer(self, key, '[', ']');
+}
+
+void jsonWriterEndArray(JsonWriter self) { _endContainer(self); }
+
+void jsonWriterWriteString(JsonWriter self, const char *key,
+                           const char *value) {
+  _beginValue(self, key);
+  _writeEscapedString(self, value);
+}
+
+void jsonWriterWriteDouble(JsonWriter self, const char *key,
+                           const double value) {
+  _beginValue(self, key);
+
+  // NaN is the only value which is not equal to itself
+  if (value != value || value == HUGE_VAL || value == -HUGE_VAL) {
+    fputs("null", self->outputFile);
+  } else {
+    fprintf(self->outputFile, "%.6f", value);
+  }
+}
+
+void jsonWriterWriteUnsignedLong(JsonWriter self, const char *key,
+                                 const unsigned long value) {
+  _beginValue(self, key);
+  fprintf(self->outputFile, "%lu", value);
+}
+
+void jsonWriterWriteBool(JsonWriter self, const char *key,
+                         const boolByte value) {
+  _beginValue(self, key);
+  fputs(value ? "true" : "false", self->outputFile);
+}
+
+void freeJsonWriter(JsonWriter self) {
+  if (self != NULL) {
+    while (self->depth > 0) {
+      _endContainer(self);
+    }
+
+    if (self->closeOnFree) {
+      fclose(self->outputFile);
+    } else {
+      fflush(self->outputFile);
+    }
+
+    free(self);
+  }
+}
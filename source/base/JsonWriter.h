@@ -0,0 +1,92 @@
+//
+// JsonWriter.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_JsonWriter_h
+#define MrsWatson_JsonWriter_h
+
+#include "base/CharString.h"
+
+#include <stdio.h>
+
+#define JSON_WRITER_MAX_DEPTH 16
+
+/**
+ * Simple streaming writer for JSON documents. Objects and arrays are opened and
+ * closed with the begin/end functions, and values are written one at a time.
+ * The writer keeps track of separators and indentation. Every function takes a
+ * key argument, which is used when the value is written inside of an object,
+ * and must be NULL when writing inside of an array or at the top level.
+ */
+typedef struct {
+  FILE *outputFile;
+  boolByte closeOnFree;
+  int depth;
+  boolByte hasItems[JSON_WRITER_MAX_DEPTH];
+  char closeChars[JSON_WRITER_MAX_DEPTH];
+} JsonWriterMembers;
+typedef JsonWriterMembers *JsonWriter;
+
+/**
+ * Create a JSON writer which writes to a new file
+ * @param path File to write to. Existing files will be overwritten.
+ * @return Initialized instance, or NULL if the file could not be opened
+ */
+JsonWriter newJsonWriterWithPath(const CharString path);
+
+/**
+ * Create a JSON writer which writes to an already open file handle, such as
+ * stdout. The handle is not closed when the writer is freed.
+ * @param outputFile Open file handle
+ * @return Initialized instance
+ */
+JsonWriter newJsonWriterWithFile(FILE *outputFile);
+
+void jsonWriterBeginObject(JsonWriter self, const char *key);
+void jsonWriterEndObject(JsonWriter self);
+void jsonWriterBeginArray(JsonWriter self, const char *key);
+void jsonWriterEndArray(JsonWriter self);
+
+void jsonWriterWriteString(JsonWriter self, const char *key,
+                           const char *value);
+/**
+ * Write a floating point value. Values which cannot be represented in JSON,
+ * such as NaN or infinity, are written as null.
+ */
+void jsonWriterWriteDouble(JsonWriter self, const char *key,
+                           const double value);
+void jsonWriterWriteUnsignedLong(JsonWriter self, const char *key,
+                                 const unsigned long value);
+void jsonWriterWriteBool(JsonWriter self, const char *key,
+                         const boolByte value);
+
+/**
+ * Free the writer, closing its file if it was opened by the writer. Any
+ * objects or arrays which are still open will be closed first.
+ * @param self
+ */
+void freeJsonWriter(JsonWriter self);
+
+#endif
@@ -37,13 +37,13 @@ LinkedList newLinkedList(void) {
   list->item = NULL;
   list->nextItem = NULL;
   list->_numItems = 0;
+  list->_lastItem = NULL;
 
   return list;
 }
 
 void linkedListAppend(LinkedList self, void *item) {
-  LinkedListIterator iterator = self;
-  LinkedListIterator headNode;
+  LinkedListIterator lastItem;
   LinkedList nextItem;
 
   if (self == NULL || item == NULL) {
@@ -51,25 +51,41 @@ void linkedListAppend(LinkedList self, void *item) {
   }
 
   // First item in the list
-  if (iterator->item == NULL) {
-    iterator->item = item;
-    iterator->_numItems = 1;
+  if (self->item == NULL) {
+    self->item = item;
+    self->_numItems = 1;
+    self->_lastItem = self;
     return;
   }
 
-  headNode = self;
+  lastItem = (LinkedListIterator)(self->_lastItem);
+  nextItem = (LinkedList)(lastItem->nextItem);
 
-  while (true) {
-    if (iterator->nextItem == NULL) {
-      nextItem = newLinkedList();
-      nextItem->item = item;
-      iterator->nextItem = nextItem;
-      headNode->_numItems++;
-      break;
-    } else {
-      iterator = (LinkedListIterator)(iterator->nextItem);
-    }
+  // Reuse a node left over from linkedListClear() if there is one
+  if (nextItem == NULL) {
+    nextItem = newLinkedList();
+    lastItem->nextItem = nextItem;
+  }
+
+  nextItem->item = item;
+  self->_lastItem = nextItem;
+  self->_numItems++;
+}
+
+void linkedListClear(LinkedList self) {
+  LinkedListIterator iterator = self;
+
+  if (self == NULL) {
+    return;
   }
+
+  while (iterator != NULL && iterator->item != NULL) {
+    iterator->item = NULL;
+    iterator = (LinkedListIterator)(iterator->nextItem);
+  }
+
+  self->_numItems = 0;
+  self->_lastItem = NULL;
 }
 
 int linkedListLength(LinkedList self) {
@@ -132,17 +148,19 @@ void freeLinkedListAndItems(LinkedList self, LinkedListFreeItemFunc freeItem) {
   LinkedList current;
 
   if (iterator->item == NULL) {
-    free(iterator);
+    freeLinkedList(self);
     return;
   }
 
   while (true) {
-    if (iterator->nextItem == NULL) {
+    if (iterator->item != NULL) {
       freeItem(iterator->item);
+    }
+
+    if (iterator->nextItem == NULL) {
       free(iterator);
       break;
     } else {
-      freeItem(iterator->item);
       current = iterator;
       iterator = (LinkedListIterator)(iterator->nextItem);
       free(current);
@@ -31,9 +31,11 @@ typedef struct {
   void *item;
   void *nextItem;
 
-  // This field should be considered private, and is only valid for the head
+  // These fields should be considered private, and are only valid for the head
   // node
   int _numItems;
+  // Last node holding an item, nodes after this one are free for reuse
+  void *_lastItem;
 } LinkedListMembers;
 
 typedef LinkedListMembers *LinkedList;
@@ -57,6 +59,15 @@ LinkedList newLinkedList(void);
  */
 void linkedListAppend(LinkedList self, void *item);
 
+/**
+ * Remove all items from a list. The list nodes are kept and reused by later
+ * calls to linkedListAppend(), so a list which is cleared and refilled with a
+ * similar number of items does not allocate any memory. The items themselves
+ * are *not* freed.
+ * @param self
+ */
+void linkedListClear(LinkedList self);
+
 /**
  * Get the number of items in a list. Use this function instead of accessing
  * the fields of the list, as the field names or use may change in the future.
@@ -33,13 +33,19 @@
 
 #if LINUX
 #include "base/File.h"
+#include <sys/resource.h>
 #include <sys/utsname.h>
+#include <unistd.h>
 
 #define LSB_FILE_PATH "/etc/lsb-release"
 #define LSB_DISTRIBUTION "DISTRIB_DESCRIPTION"
+#elif MACOSX
+#include <sys/resource.h>
+#include <unistd.h>
 #elif WINDOWS
 #include <VersionHelpers.h>
 #include <ntverp.h>
+#include <psapi.h>
 #endif
 
 static PlatformType _getPlatformType() {
@@ -117,9 +123,11 @@ static CharString _getPlatformName(void) {
   if (fileExists(lsbRelease)) {
     lsbReleaseLines = fileReadLines(lsbRelease);
 
-    if (lsbReleaseLines != NULL && linkedListLength(lsbReleaseLines) > 0) {
+    if (lsbReleaseLines != NULL) {
       linkedListForeach(lsbReleaseLines, _findLsbDistribution,
                         distributionName);
+      freeLinkedListAndItems(lsbReleaseLines,
+                             (LinkedListFreeItemFunc)freeCharString);
     }
   }
 
@@ -129,8 +137,6 @@ static CharString _getPlatformName(void) {
   }
 
   freeCharString(distributionName);
-  freeLinkedListAndItems(lsbReleaseLines,
-                         (LinkedListFreeItemFunc)freeCharString);
   freeFile(lsbRelease);
 #elif WINDOWS
   if (IsWindowsServer()) {
@@ -225,6 +231,72 @@ boolByte platformInfoIsHost64Bit(void) {
   return result;
 }
 
+unsigned long platformInfoGetPeakMemoryUsage(void) {
+  unsigned long result = 0;
+
+#if LINUX || MACOSX
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    logError("Could not get process resource usage");
+  } else {
+#if LINUX
+    // Linux reports the maximum resident set size in kilobytes
+    result = (unsigned long)usage.ru_maxrss * 1024;
+#else
+    result = (unsigned long)usage.ru_maxrss;
+#endif
+  }
+
+#elif WINDOWS
+  PROCESS_MEMORY_COUNTERS counters;
+
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    result = (unsigned long)counters.PeakWorkingSetSize;
+  } else {
+    logError("Could not get process memory info");
+  }
+
+#else
+  logUnsupportedFeature("Get peak memory usage");
+#endif
+
+  return result;
+}
+
+int platformInfoGetNumProcessors(void) {
+  int result = 1;
+
+#if LINUX || MACOSX
+  long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (numProcessors > 0) {
+    result = (int)numProcessors;
+  }
+
+#elif WINDOWS
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+
+  if (systemInfo.dwNumberOfProcessors > 0) {
+    result = (int)systemInfo.dwNumberOfProcessors;
+  }
+
+#endif
+
+  return result;
+}
+
+unsigned long platformInfoGetProcessId(void) {
+#if LINUX || MACOSX
+  return (unsigned long)getpid();
+#elif WINDOWS
+  return (unsigned long)GetCurrentProcessId();
+#else
+  return 0;
+#endif
+}
+
 boolByte platformInfoIsLittleEndian(void) {
   int num = 1;
   return (boolByte)(*(char *)&num == 1);
@@ -63,6 +63,25 @@ boolByte platformInfoIsHost64Bit(void);
  */
 boolByte platformInfoIsRuntime64Bit(void);
 
+/**
+ * @brief Get the peak amount of physical memory used by this process
+ * @return Peak resident set size in bytes, or 0 if this could not be determined
+ */
+unsigned long platformInfoGetPeakMemoryUsage(void);
+
+/**
+ * @brief Get the number of processors which are available to this process
+ * @return Number of online processors, which is at least 1
+ */
+int platformInfoGetNumProcessors(void);
+
+/**
+ * @brief Get the ID of this process, for instance to give files which several
+ * processes may write at once unique names
+ * @return Process ID, or 0 if this could not be determined
+ */
+unsigned long platformInfoGetProcessId(void);
+
 void freePlatformInfo(PlatformInfo self);
 
 #endif
@@ -31,6 +31,9 @@
 typedef int PcmSample; // TODO: int32_t?
 typedef float Sample;
 typedef Sample *Samples;
+// Used by plugins which can process audio in double precision
+typedef double DoubleSample;
+typedef DoubleSample *DoubleSamples;
 
 typedef double SampleRate;
 typedef double Tempo;
@@ -40,6 +40,7 @@ typedef enum {
   SAMPLE_SOURCE_TYPE_MP3,
   SAMPLE_SOURCE_TYPE_OGG,
   SAMPLE_SOURCE_TYPE_WAVE,
+  SAMPLE_SOURCE_TYPE_MEMORY,
   NUM_SAMPLE_SOURCES
 } SampleSourceType;
 
@@ -0,0 +1,505 @@
+//
+// SampleSourceMemory.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "SampleSourceMemory.h"
+
+#include "audio/AudioSettings.h"
+#include "base/File.h"
+#include "base/Hash.h"
+#include "base/PlatformInfo.h"
+#include "logging/EventLogger.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLE_SOURCE_CACHE_MAGIC "MWFC"
+// Also tells whether the file was written with a different byte order
+#define SAMPLE_SOURCE_CACHE_VERSION 1
+
+static const size_t kSampleSourceCacheCopyBufferSize = 65536;
+
+// Header of cache files, which is followed by the samples of each channel.
+// The size is a multiple of 16 bytes, so the samples stay aligned.
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t numChannels;
+  uint32_t reserved;
+  double sampleRate;
+  uint64_t numFrames;
+} SampleSourceCacheHeader;
+
+static boolByte _openSampleSourceMemory(void *sampleSourcePtr,
+                                        const SampleSourceOpenAs openAs) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+
+  if (openAs != SAMPLE_SOURCE_OPEN_READ) {
+    logError("Memory sample sources can only be read from");
+    return false;
+  }
+
+  sampleSource->openedAs = openAs;
+  return true;
+}
+
+static void _closeSampleSourceMemory(void *sampleSourcePtr) {}
+
+static boolByte _readBlockFromMemory(void *sampleSourcePtr,
+                                     SampleBuffer sampleBuffer) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourceMemoryData extraData =
+      (SampleSourceMemoryData)sampleSource->extraData;
+  SampleCount framesLeft = extraData->buffer->blocksize - extraData->position;
+  SampleCount originalBlocksize = sampleBuffer->blocksize;
+  SampleCount framesRead = originalBlocksize;
+
+  if (framesRead > framesLeft) {
+    framesRead = framesLeft;
+  }
+
+  // Like file sources, a short read is signaled by reducing the blocksize
+  sampleBufferCopyAndMapChannelsWithOffset(sampleBuffer, 0, extraData->buffer,
+                                           extraData->position, framesRead);
+  sampleBuffer->blocksize = framesRead;
+  extraData->position += framesRead;
+  sampleSource->numSamplesProcessed += framesRead * sampleBuffer->numChannels;
+  return (boolByte)(framesRead == originalBlocksize);
+}
+
+static boolByte _writeBlockToMemory(void *sampleSourcePtr,
+                                    const SampleBuffer sampleBuffer) {
+  logInternalError("Memory sample sources cannot be written to");
+  return false;
+}
+
+static void _freeSampleSourceDataMemory(void *sampleSourceDataPtr) {
+  SampleSourceMemoryData extraData =
+      (SampleSourceMemoryData)sampleSourceDataPtr;
+
+  if (extraData->_mappedContents != NULL) {
+    // The channels point into the mapped file, so they must not be freed
+    free(extraData->buffer->samples);
+    free(extraData->buffer);
+    fileUnmapContents(extraData->_mappedContents, extraData->_mappedSize);
+  } else {
+    freeSampleBuffer(extraData->buffer);
+  }
+
+  free(extraData);
+}
+
+static void _sampleSourceMemoryAppend(SampleSourceMemoryData self,
+                                      const SampleBuffer sampleBuffer) {
+  SampleBuffer buffer = self->buffer;
+  SampleCount numFrames = buffer->blocksize + sampleBuffer->blocksize;
+  ChannelCount i;
+
+  if (numFrames > self->_capacity) {
+    while (self->_capacity < numFrames) {
+      self->_capacity *= 2;
+    }
+
+    for (i = 0; i < buffer->numChannels; i++) {
+      buffer->samples[i] = (Samples)realloc(buffer->samples[i],
+                                            sizeof(Sample) * self->_capacity);
+    }
+  }
+
+  for (i = 0; i < buffer->numChannels; i++) {
+    memcpy(buffer->samples[i] + buffer->blocksize, sampleBuffer->samples[i],
+           sizeof(Sample) * sampleBuffer->blocksize);
+  }
+
+  buffer->blocksize = numFrames;
+}
+
+static SampleSource
+_newSampleSourceMemoryWithData(const CharString sourceName,
+                               SampleSourceMemoryData extraData) {
+  SampleSource sampleSource = (SampleSource)malloc(sizeof(SampleSourceMembers));
+
+  sampleSource->sampleSourceType = SAMPLE_SOURCE_TYPE_MEMORY;
+  sampleSource->openedAs = SAMPLE_SOURCE_OPEN_READ;
+  sampleSource->sourceName = newCharString();
+  charStringCopy(sampleSource->sourceName, sourceName);
+  sampleSource->numSamplesProcessed = 0;
+
+  sampleSource->openSampleSource = _openSampleSourceMemory;
+  sampleSource->closeSampleSource = _closeSampleSourceMemory;
+  sampleSource->readSampleBlock = _readBlockFromMemory;
+  sampleSource->writeSampleBlock = _writeBlockToMemory;
+  sampleSource->freeSampleSourceData = _freeSampleSourceDataMemory;
+  sampleSource->extraData = extraData;
+
+  return sampleSource;
+}
+
+SampleSource newSampleSourceMemory(SampleSource source) {
+  SampleSourceMemoryData extraData;
+  SampleBuffer readBuffer;
+  boolByte finishedReading = false;
+
+  if (source == NULL || source->openedAs != SAMPLE_SOURCE_OPEN_READ) {
+    return NULL;
+  } else if (source->sampleSourceType == SAMPLE_SOURCE_TYPE_SILENCE) {
+    logError("Silent sample sources cannot be read into memory");
+    return NULL;
+  }
+
+  extraData =
+      (SampleSourceMemoryData)malloc(sizeof(SampleSourceMemoryDataMembers));
+  extraData->_capacity = getBlocksize() > 0 ? getBlocksize() : 1;
+  extraData->buffer = newSampleBuffer(getNumChannels(), extraData->_capacity);
+  extraData->buffer->blocksize = 0;
+  extraData->position = 0;
+  extraData->_mappedContents = NULL;
+  extraData->_mappedSize = 0;
+
+  readBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+
+  while (!finishedReading) {
+    readBuffer->blocksize = getBlocksize();
+    source->readSampleBlock(source, readBuffer);
+    finishedReading = (boolByte)(readBuffer->blocksize < getBlocksize());
+    _sampleSourceMemoryAppend(extraData, readBuffer);
+  }
+
+  freeSampleBuffer(readBuffer);
+  logDebug("Read %lu frames from '%s' into memory",
+           extraData->buffer->blocksize, source->sourceName->data);
+
+  return _newSampleSourceMemoryWithData(source->sourceName, extraData);
+}
+
+SampleSource newSampleSourceMemoryFromCache(const CharString cachePath) {
+  File cacheFile = newFileWithPath(cachePath);
+  SampleSourceMemoryData extraData;
+  const SampleSourceCacheHeader *header;
+  const void *contents = NULL;
+  size_t size = 0;
+  Samples channelData;
+  ChannelCount i;
+
+  if (cacheFile != NULL && fileExists(cacheFile)) {
+    contents = fileMapContents(cacheFile, &size);
+  }
+
+  freeFile(cacheFile);
+
+  if (contents == NULL) {
+    return NULL;
+  }
+
+  // Files written by another version, or on a machine with a different byte
+  // order, are treated like any other missing cache file
+  header = (const SampleSourceCacheHeader *)contents;
+
+  if (size < sizeof(SampleSourceCacheHeader) ||
+      memcmp(header->magic, SAMPLE_SOURCE_CACHE_MAGIC, 4) != 0 ||
+      header->version != SAMPLE_SOURCE_CACHE_VERSION ||
+      header->numChannels == 0 ||
+      size != sizeof(SampleSourceCacheHeader) +
+                  sizeof(Sample) * header->numChannels * header->numFrames) {
+    logWarn("Ignoring invalid cache file '%s'", cachePath->data);
+    fileUnmapContents(contents, size);
+    return NULL;
+  }
+
+  extraData =
+      (SampleSourceMemoryData)malloc(sizeof(SampleSourceMemoryDataMembers));
+  extraData->buffer = (SampleBuffer)malloc(sizeof(SampleBufferMembers));
+  extraData->buffer->numChannels = (ChannelCount)header->numChannels;
+  extraData->buffer->blocksize = (SampleCount)header->numFrames;
+  extraData->buffer->samples =
+      (Samples *)malloc(sizeof(Samples) * header->numChannels);
+  channelData = (Samples)(header + 1);
+
+  for (i = 0; i < extraData->buffer->numChannels; i++) {
+    extraData->buffer->samples[i] = channelData + i * header->numFrames;
+  }
+
+  extraData->position = 0;
+  extraData->_capacity = extraData->buffer->blocksize;
+  extraData->_mappedContents = contents;
+  extraData->_mappedSize = size;
+
+  logDebug("Mapped %lu frames from cache file '%s'",
+           extraData->buffer->blocksize, cachePath->data);
+  return _newSampleSourceMemoryWithData(cachePath, extraData);
+}
+
+CharString sampleSourceMemoryGetCacheName(const CharString sourcePath,
+                                          const SampleRate sampleRate,
+                                          const ChannelCount numChannels) {
+  HashValue hash = kHashInitialValue;
+  CharString result;
+
+  if (!hashFileContents(&hash, sourcePath)) {
+    return NULL;
+  }
+
+  result = newCharStringWithCapacity(kCharStringLengthShort * 2);
+  snprintf(result->data, result->capacity, "%016llx-%lu-%u.%s",
+           (unsigned long long)hash, (unsigned long)sampleRate, numChannels,
+           SAMPLE_SOURCE_CACHE_EXTENSION);
+  return result;
+}
+
+// Cache files are written to a temporary file first, so that other processes
+// never map a cache file which is only partially written
+static FILE *_openPartialCacheFile(const CharString partialPath,
+                                   const ChannelCount numChannels,
+                                   const SampleRate sampleRate,
+                                   const SampleCount numFrames) {
+  SampleSourceCacheHeader header;
+  FILE *cacheFile = fopen(partialPath->data, "wb");
+
+  if (cacheFile == NULL) {
+    logWarn("Could not open cache file '%s' for writing", partialPath->data);
+    return NULL;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SAMPLE_SOURCE_CACHE_MAGIC, 4);
+  header.version = SAMPLE_SOURCE_CACHE_VERSION;
+  header.numChannels = numChannels;
+  header.sampleRate = sampleRate;
+  header.numFrames = numFrames;
+
+  if (fwrite(&header, sizeof(header), 1, cacheFile) != 1) {
+    logWarn("Could not write cache file '%s'", partialPath->data);
+    fclose(cacheFile);
+    remove(partialPath->data);
+    return NULL;
+  }
+
+  return cacheFile;
+}
+
+static boolByte _commitPartialCacheFile(FILE *cacheFile,
+                                        const CharString partialPath,
+                                        const CharString cachePath,
+                                        boolByte result) {
+  if (fclose(cacheFile) != 0) {
+    result = false;
+  }
+
+  if (result) {
+    // Windows does not replace existing files when renaming
+    remove(cachePath->data);
+    result = (boolByte)(rename(partialPath->data, cachePath->data) == 0);
+  }
+
+  if (!result) {
+    logWarn("Could not write cache file '%s'", cachePath->data);
+    remove(partialPath->data);
+  }
+
+  return result;
+}
+
+// Each process writes to its own partial file, so that processes which write
+// the same cache file at once do not truncate each other's data
+static CharString _newPartialCachePath(const CharString cachePath) {
+  CharString result = newCharStringWithCString(cachePath->data);
+  char suffix[32];
+
+  snprintf(suffix, sizeof(suffix), ".%lu.partial", platformInfoGetProcessId());
+  charStringAppendCString(result, suffix);
+  return result;
+}
+
+boolByte sampleSourceMemoryWriteCache(const SampleSource self,
+                                      const CharString cachePath,
+                                      const SampleRate sampleRate) {
+  SampleSourceMemoryData extraData;
+  CharString partialPath;
+  FILE *cacheFile;
+  boolByte result = true;
+  ChannelCount i;
+
+  if (self == NULL || self->sampleSourceType != SAMPLE_SOURCE_TYPE_MEMORY) {
+    return false;
+  }
+
+  extraData = (SampleSourceMemoryData)self->extraData;
+  partialPath = _newPartialCachePath(cachePath);
+  cacheFile =
+      _openPartialCacheFile(partialPath, extraData->buffer->numChannels,
+                            sampleRate, extraData->buffer->blocksize);
+
+  if (cacheFile == NULL) {
+    freeCharString(partialPath);
+    return false;
+  }
+
+  for (i = 0; result && i < extraData->buffer->numChannels; i++) {
+    if (fwrite(extraData->buffer->samples[i], sizeof(Sample),
+               extraData->buffer->blocksize,
+               cacheFile) != extraData->buffer->blocksize) {
+      result = false;
+    }
+  }
+
+  result = _commitPartialCacheFile(cacheFile, partialPath, cachePath, result);
+  freeCharString(partialPath);
+  return result;
+}
+
+SampleSourceCacheWriter
+newSampleSourceCacheWriter(const CharString cachePath,
+                           const ChannelCount numChannels,
+                           const SampleRate sampleRate) {
+  SampleSourceCacheWriter writer =
+      (SampleSourceCacheWriter)malloc(sizeof(SampleSourceCacheWriterMembers));
+  ChannelCount i;
+
+  writer->cachePath = newCharStringWithCString(cachePath->data);
+  writer->numChannels = numChannels;
+  writer->sampleRate = sampleRate;
+  writer->numFrames = 0;
+  writer->_channelFiles = (FILE **)malloc(sizeof(FILE *) * numChannels);
+  writer->_failed = false;
+
+  // The samples of each channel are spooled to their own temporary file, since
+  // the number of frames is not known until the writer is finished
+  for (i = 0; i < numChannels; i++) {
+    writer->_channelFiles[i] = tmpfile();
+
+    if (writer->_channelFiles[i] == NULL) {
+      logWarn("Could not create temporary file for cache file '%s'",
+              cachePath->data);
+      writer->_failed = true;
+    }
+  }
+
+  return writer;
+}
+
+boolByte sampleSourceCacheWriterAppend(SampleSourceCacheWriter self,
+                                       const SampleBuffer sampleBuffer) {
+  ChannelCount i;
+
+  if (self->_failed) {
+    return false;
+  } else if (sampleBuffer->numChannels != self->numChannels) {
+    logInternalError("Cache file '%s' has %d channels, but got %d",
+                     self->cachePath->data, self->numChannels,
+                     sampleBuffer->numChannels);
+    self->_failed = true;
+    return false;
+  }
+
+  for (i = 0; i < self->numChannels; i++) {
+    if (fwrite(sampleBuffer->samples[i], sizeof(Sample),
+               sampleBuffer->blocksize,
+               self->_channelFiles[i]) != sampleBuffer->blocksize) {
+      self->_failed = true;
+      return false;
+    }
+  }
+
+  self->numFrames += sampleBuffer->blocksize;
+  return true;
+}
+
+boolByte sampleSourceCacheWriterFinish(SampleSourceCacheWriter self) {
+  CharString partialPath;
+  FILE *cacheFile;
+  char *copyBuffer;
+  size_t numBytes;
+  size_t numBytesLeft;
+  boolByte result = true;
+  ChannelCount i;
+
+  if (self->_failed) {
+    return false;
+  }
+
+  partialPath = _newPartialCachePath(self->cachePath);
+  cacheFile = _openPartialCacheFile(partialPath, self->numChannels,
+                                    self->sampleRate, self->numFrames);
+
+  if (cacheFile == NULL) {
+    freeCharString(partialPath);
+    return false;
+  }
+
+  copyBuffer = (char *)malloc(kSampleSourceCacheCopyBufferSize);
+
+  for (i = 0; result && i < self->numChannels; i++) {
+    rewind(self->_channelFiles[i]);
+    numBytesLeft = sizeof(Sample) * self->numFrames;
+
+    while (numBytesLeft > 0) {
+      numBytes = numBytesLeft < kSampleSourceCacheCopyBufferSize
+                     ? numBytesLeft
+                     : kSampleSourceCacheCopyBufferSize;
+
+      if (fread(copyBuffer, 1, numBytes, self->_channelFiles[i]) != numBytes ||
+          fwrite(copyBuffer, 1, numBytes, cacheFile) != numBytes) {
+        result = false;
+        break;
+      }
+
+      numBytesLeft -= numBytes;
+    }
+  }
+
+  free(copyBuffer);
+  result = _commitPartialCacheFile(cacheFile, partialPath, self->cachePath,
+                                   result);
+  freeCharString(partialPath);
+  return result;
+}
+
+void freeSampleSourceCacheWriter(SampleSourceCacheWriter self) {
+  ChannelCount i;
+
+  if (self != NULL) {
+    for (i = 0; i < self->numChannels; i++) {
+      if (self->_channelFiles[i] != NULL) {
+        fclose(self->_channelFiles[i]);
+      }
+    }
+
+    free(self->_channelFiles);
+    freeCharString(self->cachePath);
+    free(self);
+  }
+}
+
+void sampleSourceMemoryRewind(SampleSource self) {
+  SampleSourceMemoryData extraData;
+
+  if (self != NULL && self->sampleSourceType == SAMPLE_SOURCE_TYPE_MEMORY) {
+    extraData = (SampleSourceMemoryData)self->extraData;
+    extraData->position = 0;
+    self->numSamplesProcessed = 0;
+  }
+}
@@ -0,0 +1,160 @@
+//
+// SampleSourceMemory.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_SampleSourceMemory_h
+#define MrsWatson_SampleSourceMemory_h
+
+#include "io/SampleSource.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+/** Extension of decoded input cache files */
+#define SAMPLE_SOURCE_CACHE_EXTENSION "f32"
+
+typedef struct {
+  // Holds every decoded frame, so its blocksize is the length of the source
+  SampleBuffer buffer;
+  SampleCount position;
+
+  // Private fields
+  SampleCount _capacity;
+  // Set when the samples are read straight from a mapped cache file
+  const void *_mappedContents;
+  size_t _mappedSize;
+} SampleSourceMemoryDataMembers;
+typedef SampleSourceMemoryDataMembers *SampleSourceMemoryData;
+
+/**
+ * Writes a cache file block by block, for audio which is produced while
+ * processing rather than read into memory up front.
+ */
+typedef struct {
+  CharString cachePath;
+  ChannelCount numChannels;
+  SampleRate sampleRate;
+  SampleCount numFrames;
+
+  // Private fields
+  FILE **_channelFiles;
+  boolByte _failed;
+} SampleSourceCacheWriterMembers;
+typedef SampleSourceCacheWriterMembers *SampleSourceCacheWriter;
+
+/**
+ * Read an entire sample source into memory. This is useful when the same input
+ * is processed several times, since it is only decoded once.
+ * @param source Source to read from, which must already be opened for reading.
+ * The source must have a finite length, so silence cannot be read.
+ * @return A new sample source which has been opened for reading, or NULL if
+ * the source could not be read.
+ */
+SampleSource newSampleSourceMemory(SampleSource source);
+
+/**
+ * Open a cache file written by sampleSourceMemoryWriteCache(). The file is
+ * mapped into memory, so that its samples can be read without any conversion.
+ * @param cachePath Path to the cache file
+ * @return A new sample source which has been opened for reading, or NULL if
+ * the cache file is missing or invalid.
+ */
+SampleSource newSampleSourceMemoryFromCache(const CharString cachePath);
+
+/**
+ * Get the name of the cache file for a decoded sample source. The name is
+ * made from a hash of the source file's contents, along with the sample rate
+ * and channel count which it is decoded with.
+ * @param sourcePath Path to the encoded source file
+ * @param sampleRate Sample rate of the decoded samples
+ * @param numChannels Number of channels of the decoded samples
+ * @return File name of the cache file, which must be freed by the caller, or
+ * NULL if the source file could not be read
+ */
+CharString sampleSourceMemoryGetCacheName(const CharString sourcePath,
+                                          const SampleRate sampleRate,
+                                          const ChannelCount numChannels);
+
+/**
+ * Write the samples of a memory source to a cache file. The samples are stored
+ * as 32-bit floats in native byte order, with all samples of the first channel
+ * followed by those of the second, etc.
+ * @param self
+ * @param cachePath Path to write the cache file to
+ * @param sampleRate Sample rate of the samples, which is stored in the file
+ * @return True if the cache file was written
+ */
+boolByte sampleSourceMemoryWriteCache(const SampleSource self,
+                                      const CharString cachePath,
+                                      const SampleRate sampleRate);
+
+/**
+ * Create a writer for a cache file which can be opened with
+ * newSampleSourceMemoryFromCache(). Nothing is written to the cache path until
+ * the writer is finished.
+ * @param cachePath Path to write the cache file to
+ * @param numChannels Number of channels of the samples to write
+ * @param sampleRate Sample rate of the samples, which is stored in the file
+ * @return Initialized SampleSourceCacheWriter
+ */
+SampleSourceCacheWriter
+newSampleSourceCacheWriter(const CharString cachePath,
+                           const ChannelCount numChannels,
+                           const SampleRate sampleRate);
+
+/**
+ * Append a block of samples to the cache file.
+ * @param self
+ * @param sampleBuffer Samples to append, which must have the writer's number
+ * of channels
+ * @return False if the samples could not be written. Once this happens, the
+ * cache file will not be written either.
+ */
+boolByte sampleSourceCacheWriterAppend(SampleSourceCacheWriter self,
+                                       const SampleBuffer sampleBuffer);
+
+/**
+ * Write the cache file with all samples which have been appended so far. The
+ * numFrames field may be lowered before calling this function, in which case
+ * only that many frames of each channel are written.
+ * @param self
+ * @return True if the cache file was written
+ */
+boolByte sampleSourceCacheWriterFinish(SampleSourceCacheWriter self);
+
+/**
+ * Free a cache file writer and its temporary files. If the writer has not been
+ * finished, then no cache file is written.
+ * @param self
+ */
+void freeSampleSourceCacheWriter(SampleSourceCacheWriter self);
+
+/**
+ * Start reading a memory source from the beginning again.
+ * @param self
+ */
+void sampleSourceMemoryRewind(SampleSource self);
+
+#endif
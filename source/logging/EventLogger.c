@@ -42,6 +42,7 @@
 #include <Windows.h>
 #include <io.h>
 #elif UNIX
+#include <sys/time.h>
 #include <unistd.h>
 #endif
 
@@ -364,6 +365,12 @@ void logUnsupportedFeature(const char *featureName) {
   // to see that this message hasn't been shown before.
   EventLogger eventLogger = _getEventLoggerInstance();
   struct _findData findData;
+
+  // Like other log messages, this is dropped if logging is not initialized
+  if (eventLogger == NULL) {
+    return;
+  }
+
   findData.featureName = featureName;
   findData.found = false;
   linkedListForeach(eventLogger->shownUnsupportedMessages,
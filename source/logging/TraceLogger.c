@@ -0,0 +1,230 @@
+//
+// TraceLogger.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "TraceLogger.h"
+
+#include "app/BuildInfo.h"
+#include "logging/EventLogger.h"
+#include "time/TaskTimer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if UNIX
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+TraceLogger traceLoggerInstance = NULL;
+
+static unsigned long _getCurrentThreadId(void) {
+#if WINDOWS
+  return (unsigned long)GetCurrentThreadId();
+#elif UNIX
+  return (unsigned long)pthread_self();
+#else
+  return 0;
+#endif
+}
+
+static unsigned long _getCurrentProcessId(void) {
+#if WINDOWS
+  return (unsigned long)GetCurrentProcessId();
+#elif UNIX
+  return (unsigned long)getpid();
+#else
+  return 0;
+#endif
+}
+
+// Copy a string into a buffer, escaping any characters which are not allowed
+// to appear unescaped in a JSON string. The result is always null-terminated.
+static void _copyEscapedString(char *destination, const size_t destinationSize,
+                               const char *source) {
+  size_t outIndex = 0;
+  const char *c;
+
+  for (c = source; c != NULL && *c != '\0'; c++) {
+    if (outIndex + 3 >= destinationSize) {
+      break;
+    }
+
+    if (*c == '"' || *c == '\\') {
+      destination[outIndex++] = '\\';
+      destination[outIndex++] = *c;
+    } else if ((unsigned char)*c < 0x20) {
+      destination[outIndex++] = ' ';
+    } else {
+      destination[outIndex++] = *c;
+    }
+  }
+
+  destination[outIndex] = '\0';
+}
+
+boolByte initTraceLogger(const CharString traceFileName) {
+  FILE *outputFile = fopen(traceFileName->data, "w");
+
+  if (outputFile == NULL) {
+    logError("Could not open trace file '%s' for writing", traceFileName->data);
+    return false;
+  }
+
+  freeTraceLogger();
+  traceLoggerInstance = (TraceLogger)malloc(sizeof(TraceLoggerMembers));
+  traceLoggerInstance->outputFile = outputFile;
+  traceLoggerInstance->fileName =
+      newCharStringWithCapacity(kCharStringLengthLong);
+  charStringCopy(traceLoggerInstance->fileName, traceFileName);
+  traceLoggerInstance->processId = _getCurrentProcessId();
+
+  // Every event line ends with a comma, and the metadata event written in
+  // freeTraceLogger() closes the array
+  fprintf(outputFile, "[\n");
+  traceLoggerSetThreadName("Main");
+  logInfo("Writing trace to '%s'", traceFileName->data);
+  return true;
+}
+
+boolByte isTraceLoggerEnabled(void) { return traceLoggerInstance != NULL; }
+
+void traceLoggerBeginEvent(const char *category, const char *name) {
+  char escapedName[kCharStringLengthDefault];
+
+  if (traceLoggerInstance == NULL) {
+    return;
+  }
+
+  _copyEscapedString(escapedName, kCharStringLengthDefault, name);
+  fprintf(traceLoggerInstance->outputFile,
+          "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"B\",\"ts\":%.3f,"
+          "\"pid\":%lu,\"tid\":%lu},\n",
+          escapedName, category,
+          (double)taskTimerGetCurrentTimeInNs() / 1000.0,
+          traceLoggerInstance->processId, _getCurrentThreadId());
+}
+
+void traceLoggerEndEvent(void) {
+  if (traceLoggerInstance == NULL) {
+    return;
+  }
+
+  fprintf(traceLoggerInstance->outputFile,
+          "{\"ph\":\"E\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu},\n",
+          (double)taskTimerGetCurrentTimeInNs() / 1000.0,
+          traceLoggerInstance->processId, _getCurrentThreadId());
+}
+
+void traceLoggerCompleteEvent(const char *category, const char *name,
+                              const unsigned long long startTimeInNs,
+                              const unsigned long long durationInNs) {
+  char escapedName[kCharStringLengthDefault];
+
+  if (traceLoggerInstance == NULL) {
+    return;
+  }
+
+  _copyEscapedString(escapedName, kCharStringLengthDefault, name);
+  fprintf(traceLoggerInstance->outputFile,
+          "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,"
+          "\"dur\":%.3f,\"pid\":%lu,\"tid\":%lu},\n",
+          escapedName, category, (double)startTimeInNs / 1000.0,
+          (double)durationInNs / 1000.0, traceLoggerInstance->processId,
+          _getCurrentThreadId());
+}
+
+void traceLoggerSetThreadName(const char *name) {
+  char escapedName[kCharStringLengthDefault];
+
+  if (traceLoggerInstance == NULL) {
+    return;
+  }
+
+  _copyEscapedString(escapedName, kCharStringLengthDefault, name);
+  fprintf(traceLoggerInstance->outputFile,
+          "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%lu,\"tid\":%lu,"
+          "\"args\":{\"name\":\"%s\"}},\n",
+          traceLoggerInstance->processId, _getCurrentThreadId(), escapedName);
+}
+
+boolByte traceLoggerReopenInChildProcess(void) {
+  CharString childFileName;
+  FILE *outputFile;
+
+  if (traceLoggerInstance == NULL) {
+    return false;
+  }
+
+#if UNIX
+  // Closing the descriptor first makes fclose() discard the buffered events
+  // instead of writing them, since they belong to the parent
+  close(fileno(traceLoggerInstance->outputFile));
+#endif
+  fclose(traceLoggerInstance->outputFile);
+
+  traceLoggerInstance->processId = _getCurrentProcessId();
+  childFileName = newCharStringWithCapacity(kCharStringLengthLong);
+  snprintf(childFileName->data, childFileName->capacity, "%s.%lu",
+           traceLoggerInstance->fileName->data,
+           traceLoggerInstance->processId);
+  outputFile = fopen(childFileName->data, "w");
+
+  if (outputFile == NULL) {
+    logWarn("Could not open trace file '%s', tracing is disabled in process "
+            "%lu",
+            childFileName->data, traceLoggerInstance->processId);
+    freeCharString(childFileName);
+    freeCharString(traceLoggerInstance->fileName);
+    free(traceLoggerInstance);
+    traceLoggerInstance = NULL;
+    return false;
+  }
+
+  // A child process may be killed at any time, so its events are written as
+  // they happen. Trace viewers accept a file which is missing the closing ']'.
+  setvbuf(outputFile, NULL, _IOLBF, 0);
+  traceLoggerInstance->outputFile = outputFile;
+  charStringCopy(traceLoggerInstance->fileName, childFileName);
+  freeCharString(childFileName);
+
+  fprintf(outputFile, "[\n");
+  traceLoggerSetThreadName("Main");
+  return true;
+}
+
+void freeTraceLogger(void) {
+  if (traceLoggerInstance != NULL) {
+    fprintf(traceLoggerInstance->outputFile,
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%lu,"
+            "\"args\":{\"name\":\"%s\"}}\n]\n",
+            traceLoggerInstance->processId, PROGRAM_NAME);
+    fclose(traceLoggerInstance->outputFile);
+    freeCharString(traceLoggerInstance->fileName);
+    free(traceLoggerInstance);
+  }
+
+  traceLoggerInstance = NULL;
+}
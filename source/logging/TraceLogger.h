@@ -0,0 +1,115 @@
+//
+// TraceLogger.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_TraceLogger_h
+#define MrsWatson_TraceLogger_h
+
+#include "base/CharString.h"
+
+#include <stdio.h>
+
+/**
+ * The TraceLogger writes a timeline of the program's activity to a file in the
+ * trace event format, which can be loaded in chrome://tracing or Perfetto.
+ * Like the EventLogger, it is a global singleton so that it can be reached from
+ * plugin callbacks. When tracing has not been enabled, all of the functions
+ * below return immediately, so it is safe to call them in the processing loop.
+ *
+ * Each event is written with a single call to fprintf(), so events from
+ * different threads will not be interleaved within a line. Every thread gets
+ * its own track in the viewer.
+ */
+
+typedef struct {
+  FILE *outputFile;
+  CharString fileName;
+  unsigned long processId;
+} TraceLoggerMembers;
+typedef TraceLoggerMembers *TraceLogger;
+extern TraceLogger traceLoggerInstance;
+
+/**
+ * Open the trace file and enable tracing.
+ * @param traceFileName File to write to. Existing files will be overwritten.
+ * @return True on success, false if the file could not be opened
+ */
+boolByte initTraceLogger(const CharString traceFileName);
+
+/**
+ * @return True if tracing has been enabled with initTraceLogger()
+ */
+boolByte isTraceLoggerEnabled(void);
+
+/**
+ * Mark the start of a span of time on the calling thread. Spans must be
+ * properly nested, and each call must be balanced by traceLoggerEndEvent() on
+ * the same thread.
+ * @param category Category of the event, for filtering in the trace viewer
+ * @param name Name of the event
+ */
+void traceLoggerBeginEvent(const char *category, const char *name);
+
+/**
+ * Mark the end of the most recently started span on the calling thread.
+ */
+void traceLoggerEndEvent(void);
+
+/**
+ * Write a span of time which has already finished, for instance one which was
+ * measured by a TaskTimer.
+ * @param category Category of the event, for filtering in the trace viewer
+ * @param name Name of the event
+ * @param startTimeInNs Start time as given by taskTimerGetCurrentTimeInNs()
+ * @param durationInNs Duration of the event
+ */
+void traceLoggerCompleteEvent(const char *category, const char *name,
+                              const unsigned long long startTimeInNs,
+                              const unsigned long long durationInNs);
+
+/**
+ * Set the name shown for the calling thread's track in the trace viewer.
+ * @param name Thread name
+ */
+void traceLoggerSetThreadName(const char *name);
+
+/**
+ * Called in a child process after fork() to give it a trace file of its own.
+ * Writing to the inherited stream would split lines written by the parent,
+ * and flushing it would write the parent's buffered events twice, so it is
+ * dropped without being flushed. The child's events are written to the
+ * parent's file name with ".<pid>" appended, and tracing is disabled in the
+ * child if that file cannot be opened.
+ * @return True if the child has its own trace file
+ */
+boolByte traceLoggerReopenInChildProcess(void);
+
+/**
+ * Finish writing the trace file and disable tracing. The file will not be
+ * valid JSON until this function is called.
+ */
+void freeTraceLogger(void);
+
+#endif
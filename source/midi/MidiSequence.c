@@ -30,22 +30,168 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+// Initial number of events to allocate space for. The array is doubled in size
+// whenever it fills up, so that appending is amortized constant time.
+static const size_t kMidiSequenceInitialCapacity = 64;
 
 MidiSequence newMidiSequence(void) {
   MidiSequence midiSequence = malloc(sizeof(MidiSequenceMembers));
 
-  midiSequence->midiEvents = newLinkedList();
-  midiSequence->_lastEvent = midiSequence->midiEvents;
-  midiSequence->_lastTimestamp = 0;
+  midiSequence->midiEvents = (MidiEventMembers *)malloc(
+      kMidiSequenceInitialCapacity * sizeof(MidiEventMembers));
+  midiSequence->numMidiEvents = 0;
   midiSequence->numMidiEventsProcessed = 0;
+  midiSequence->tempoMap = NULL;
+  midiSequence->_capacity = kMidiSequenceInitialCapacity;
+  midiSequence->_cursor = 0;
+  midiSequence->_isSorted = true;
 
   return midiSequence;
 }
 
+static void _reserveMidiSequence(MidiSequence self, const size_t capacity) {
+  if (capacity <= self->_capacity) {
+    return;
+  }
+
+  while (self->_capacity < capacity) {
+    self->_capacity *= 2;
+  }
+
+  self->midiEvents = (MidiEventMembers *)realloc(
+      self->midiEvents, self->_capacity * sizeof(MidiEventMembers));
+}
+
 void appendMidiEventToSequence(MidiSequence self, MidiEvent midiEvent) {
-  if (self != NULL && midiEvent != NULL) {
-    linkedListAppend(self->midiEvents, midiEvent);
+  if (self == NULL || midiEvent == NULL) {
+    return;
+  }
+
+  midiSequenceAppendEvents(self, midiEvent, 1);
+  // The sequence now owns the event's extra data, so only free the shell
+  free(midiEvent);
+}
+
+void midiSequenceAppendEvents(MidiSequence self,
+                              const MidiEventMembers *midiEvents,
+                              const size_t numMidiEvents) {
+  size_t i;
+
+  if (self == NULL || numMidiEvents == 0) {
+    return;
+  }
+
+  _reserveMidiSequence(self, self->numMidiEvents + numMidiEvents);
+
+  if (self->numMidiEvents > 0 &&
+      midiEvents[0].timestamp <
+          self->midiEvents[self->numMidiEvents - 1].timestamp) {
+    self->_isSorted = false;
+  }
+
+  for (i = 1; i < numMidiEvents && self->_isSorted; i++) {
+    if (midiEvents[i].timestamp < midiEvents[i - 1].timestamp) {
+      self->_isSorted = false;
+    }
+  }
+
+  memcpy(self->midiEvents + self->numMidiEvents, midiEvents,
+         numMidiEvents * sizeof(MidiEventMembers));
+  self->numMidiEvents += numMidiEvents;
+}
+
+static size_t _findEndOfSortedRun(const MidiEventMembers *midiEvents,
+                                  const size_t start, const size_t end) {
+  size_t i = start + 1;
+
+  while (i < end && midiEvents[i - 1].timestamp <= midiEvents[i].timestamp) {
+    i++;
   }
+
+  return i;
+}
+
+static void _mergeSortedRuns(const MidiEventMembers *source, const size_t start,
+                             const size_t middle, const size_t end,
+                             MidiEventMembers *destination) {
+  size_t left = start;
+  size_t right = middle;
+  size_t i = start;
+
+  while (left < middle && right < end) {
+    // Taking from the left run when timestamps are equal keeps events in the
+    // order that they were appended
+    if (source[right].timestamp < source[left].timestamp) {
+      destination[i++] = source[right++];
+    } else {
+      destination[i++] = source[left++];
+    }
+  }
+
+  while (left < middle) {
+    destination[i++] = source[left++];
+  }
+
+  while (right < end) {
+    destination[i++] = source[right++];
+  }
+}
+
+static void _sortMidiSequence(MidiSequence self) {
+  MidiEventMembers *source = self->midiEvents;
+  MidiEventMembers *destination;
+  MidiEventMembers *swap;
+  size_t start, middle, end;
+  size_t numRuns;
+
+  // Each track is appended in order, so the sequence consists of one sorted run
+  // per track. Merging neighboring runs until only one is left is a stable
+  // k-way merge, which takes O(n log k) time for k tracks.
+  destination =
+      (MidiEventMembers *)malloc(self->_capacity * sizeof(MidiEventMembers));
+
+  do {
+    numRuns = 0;
+
+    for (start = 0; start < self->numMidiEvents; start = end) {
+      middle = _findEndOfSortedRun(source, start, self->numMidiEvents);
+      end = middle < self->numMidiEvents
+                ? _findEndOfSortedRun(source, middle, self->numMidiEvents)
+                : middle;
+      _mergeSortedRuns(source, start, middle, end, destination);
+      numRuns++;
+    }
+
+    swap = source;
+    source = destination;
+    destination = swap;
+  } while (numRuns > 1);
+
+  self->midiEvents = source;
+  free(destination);
+  self->_isSorted = true;
+}
+
+static size_t _findFirstEventAtOrAfter(const MidiSequence self,
+                                       const size_t start,
+                                       const unsigned long timestamp) {
+  size_t low = start;
+  size_t high = self->numMidiEvents;
+  size_t middle;
+
+  while (low < high) {
+    middle = low + (high - low) / 2;
+
+    if (self->midiEvents[middle].timestamp < timestamp) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  return low;
 }
 
 boolByte fillMidiEventsFromRange(MidiSequence self,
@@ -53,52 +199,75 @@ boolByte fillMidiEventsFromRange(MidiSequence self,
                                  const unsigned long blocksize,
                                  LinkedList outMidiEvents) {
   MidiEvent midiEvent;
-  LinkedListIterator iterator = self->_lastEvent;
+  size_t cursor;
   const unsigned long stopTimestamp = startTimestamp + blocksize;
 
-  while (true) {
-    if ((iterator == NULL) || (iterator->item == NULL)) {
-      return false;
-    }
+  if (!self->_isSorted) {
+    _sortMidiSequence(self);
+  }
 
-    midiEvent = iterator->item;
-
-    if (stopTimestamp < midiEvent->timestamp) {
-      // We have not yet reached this event, stop iterating
-      break;
-    } else if (startTimestamp <= midiEvent->timestamp &&
-               stopTimestamp > midiEvent->timestamp) {
-      midiEvent->deltaFrames = midiEvent->timestamp - startTimestamp;
-      logDebug("Scheduling MIDI event 0x%x (%x, %x) in %ld frames",
-               midiEvent->status, midiEvent->data1, midiEvent->data2,
-               midiEvent->deltaFrames);
-      linkedListAppend(outMidiEvents, midiEvent);
-      self->_lastEvent = iterator->nextItem;
-      self->numMidiEventsProcessed++;
-    } else if (startTimestamp > midiEvent->timestamp) {
-      logInternalError("Inconsistent MIDI sequence ordering");
-    }
+  cursor = self->_cursor;
+
+  if (cursor < self->numMidiEvents &&
+      self->midiEvents[cursor].timestamp < startTimestamp) {
+    cursor = _findFirstEventAtOrAfter(self, cursor, startTimestamp);
+    logDebug("Skipped %lu MIDI events before frame %lu",
+             (unsigned long)(cursor - self->_cursor), startTimestamp);
+  }
+
+  while (cursor < self->numMidiEvents &&
+         self->midiEvents[cursor].timestamp < stopTimestamp) {
+    midiEvent = &(self->midiEvents[cursor]);
+    midiEvent->deltaFrames = midiEvent->timestamp - startTimestamp;
+    logDebug("Scheduling MIDI event 0x%x (%x, %x) in %ld frames",
+             midiEvent->status, midiEvent->data1, midiEvent->data2,
+             midiEvent->deltaFrames);
+    linkedListAppend(outMidiEvents, midiEvent);
+    self->numMidiEventsProcessed++;
+    cursor++;
+  }
 
-    // Last item in the list
-    if (iterator->nextItem == NULL) {
-      if (startTimestamp <= midiEvent->timestamp &&
-          stopTimestamp > midiEvent->timestamp) {
-        return false;
-      }
+  self->_cursor = cursor;
+  return (boolByte)(cursor < self->numMidiEvents);
+}
 
-      break;
+void midiSequenceRewind(MidiSequence self) {
+  self->_cursor = 0;
+  self->numMidiEventsProcessed = 0;
+}
+
+static void _freeMidiEventData(MidiSequence self, const size_t start,
+                               const size_t end) {
+  MidiEvent midiEvent;
+  size_t i;
+
+  for (i = start; i < end; i++) {
+    midiEvent = &(self->midiEvents[i]);
+
+    if (midiEvent->eventType == MIDI_TYPE_SYSEX ||
+        midiEvent->eventType == MIDI_TYPE_META) {
+      free(midiEvent->extraData);
     }
+  }
+}
 
-    iterator = iterator->nextItem;
+void midiSequenceRemoveProcessedEvents(MidiSequence self) {
+  if (self->_cursor == 0) {
+    return;
   }
 
-  return true;
+  _freeMidiEventData(self, 0, self->_cursor);
+  memmove(self->midiEvents, self->midiEvents + self->_cursor,
+          (self->numMidiEvents - self->_cursor) * sizeof(MidiEventMembers));
+  self->numMidiEvents -= self->_cursor;
+  self->_cursor = 0;
 }
 
 void freeMidiSequence(MidiSequence self) {
   if (self != NULL) {
-    freeLinkedListAndItems(self->midiEvents,
-                           (LinkedListFreeItemFunc)freeMidiEvent);
+    _freeMidiEventData(self, 0, self->numMidiEvents);
+    free(self->midiEvents);
+    freeTempoMap(self->tempoMap);
     free(self);
   }
 }
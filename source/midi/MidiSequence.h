@@ -29,12 +29,23 @@
 
 #include "base/LinkedList.h"
 #include "midi/MidiEvent.h"
+#include "time/TempoMap.h"
+
+#include <stddef.h>
 
 typedef struct {
-  LinkedList midiEvents;
-  LinkedListIterator _lastEvent;
-  int _lastTimestamp;
+  // Events are stored by value in a single array, sorted by timestamp
+  MidiEventMembers *midiEvents;
+  size_t numMidiEvents;
   int numMidiEventsProcessed;
+  // Tempo and time signature changes of the sequence, or NULL if the source
+  // doesn't know them in advance. This map is owned by the sequence.
+  TempoMap tempoMap;
+
+  // Private fields
+  size_t _capacity;
+  size_t _cursor;
+  boolByte _isSorted;
 } MidiSequenceMembers;
 
 /**
@@ -53,17 +64,38 @@ MidiSequence newMidiSequence(void);
 
 /**
  * Add an event to the end of the sequence. The event's timestamp must be
- * properly set before making this call. Events added into the sequence in this
- * call are not sorted, it is the responsibility of the caller to add the events
- * sequentially in the order which they should be played back.
+ * properly set before making this call. The event is copied into the sequence
+ * and then freed, so the caller must not use it after this call.
+ *
+ * Events are expected to be appended in the order which they should be played
+ * back. If several tracks are appended one after another, the sequence will be
+ * sorted before playback, and events with equal timestamps are kept in the
+ * order that they were appended.
  * @param self
  * @param midiEvent MidiEvent to add
  */
 void appendMidiEventToSequence(MidiSequence self, MidiEvent midiEvent);
 
+/**
+ * Add an array of events to the end of the sequence, in the same way as
+ * appendMidiEventToSequence(). The events are copied into the sequence, which
+ * takes ownership of their extra data.
+ * @param self
+ * @param midiEvents Events to add
+ * @param numMidiEvents Number of events in the array
+ */
+void midiSequenceAppendEvents(MidiSequence self,
+                              const MidiEventMembers *midiEvents,
+                              const size_t numMidiEvents);
+
 /**
  * Populate a linked list with MIDI events for a given block. This method does
- * not return a linked list in order to optimize for memory usage.
+ * not return a linked list in order to optimize for memory usage. The events
+ * added to the list are owned by the sequence and remain valid until the next
+ * event is appended to it.
+ *
+ * Blocks are normally requested in order, but if startTimestamp is past the
+ * next unplayed event, then any events before it are skipped.
  * @param self
  * @param startTimestamp Sample frame that marks the starting point of the block
  * @param blocksize Blocksize, which determines the range of events that will be
@@ -78,6 +110,21 @@ boolByte fillMidiEventsFromRange(MidiSequence self,
                                  const unsigned long blocksize,
                                  LinkedList outMidiEvents);
 
+/**
+ * Move playback back to the start of the sequence, so that the next call to
+ * fillMidiEventsFromRange() will return events from the first one again.
+ * @param self
+ */
+void midiSequenceRewind(MidiSequence self);
+
+/**
+ * Remove all events which have already been returned by
+ * fillMidiEventsFromRange(). This is used to keep the sequence small when
+ * reading events from a stream.
+ * @param self
+ */
+void midiSequenceRemoveProcessedEvents(MidiSequence self);
+
 /**
  * Free a MIDI sequence and its associated resources
  * @param self
@@ -29,17 +29,24 @@
 #include "base/File.h"
 #include "logging/EventLogger.h"
 #include "midi/MidiSourceFile.h"
+#include "midi/MidiSourceStream.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
 MidiSourceType guessMidiSourceType(const CharString midiSourceTypeString) {
-  if (!charStringIsEmpty(midiSourceTypeString)) {
+  if (charStringIsEqualToCString(midiSourceTypeString, "-", false)) {
+    return MIDI_SOURCE_TYPE_STREAM;
+  } else if (!charStringIsEmpty(midiSourceTypeString)) {
     File midiSourceFile = newFileWithPath(midiSourceTypeString);
     CharString fileExtension = fileGetExtension(midiSourceFile);
+    boolByte isNamedPipe = fileIsNamedPipe(midiSourceFile);
     freeFile(midiSourceFile);
 
-    if (fileExtension == NULL) {
+    if (isNamedPipe) {
+      freeCharString(fileExtension);
+      return MIDI_SOURCE_TYPE_STREAM;
+    } else if (fileExtension == NULL) {
       return MIDI_SOURCE_TYPE_INVALID;
     } else if (charStringIsEqualToCString(fileExtension, "mid", true) ||
                charStringIsEqualToCString(fileExtension, "midi", true)) {
@@ -62,6 +69,9 @@ MidiSource newMidiSource(MidiSourceType midiSourceType,
   case MIDI_SOURCE_TYPE_FILE:
     return newMidiSourceFile(midiSourceName);
 
+  case MIDI_SOURCE_TYPE_STREAM:
+    return newMidiSourceStream(midiSourceName);
+
   default:
     return NULL;
   }
@@ -34,19 +34,37 @@
 typedef enum {
   MIDI_SOURCE_TYPE_INVALID,
   MIDI_SOURCE_TYPE_FILE,
+  MIDI_SOURCE_TYPE_STREAM,
   NUM_MIDI_SOURCE_TYPES
 } MidiSourceType;
 
 typedef boolByte (*OpenMidiSourceFunc)(void *);
 typedef boolByte (*ReadMidiEventsFunc)(void *, MidiSequence);
+/**
+ * Read events from the source and append them to a sequence, until an event at
+ * or after the given timestamp has been read or the source has ended.
+ * @param midiSourcePtr self
+ * @param midiSequence Sequence to append events to
+ * @param stopTimestamp Sample frame to read events up to
+ * @return False if an error occurred while reading
+ */
+typedef boolByte (*ReadMidiEventsUntilFunc)(void *midiSourcePtr,
+                                            MidiSequence midiSequence,
+                                            const unsigned long stopTimestamp);
 typedef void (*FreeMidiSourceDataFunc)(void *);
 
 typedef struct {
   MidiSourceType midiSourceType;
   CharString sourceName;
+  // Streaming sources are read block by block with readMidiEventsUntil rather
+  // than all at once with readMidiEvents
+  boolByte isStream;
+  // Set by streaming sources once no more events can be read
+  boolByte endOfStream;
 
   OpenMidiSourceFunc openMidiSource;
   ReadMidiEventsFunc readMidiEvents;
+  ReadMidiEventsUntilFunc readMidiEventsUntil;
   FreeMidiSourceDataFunc freeMidiSourceData;
 
   void *extraData;
@@ -68,7 +86,8 @@ MidiSource newMidiSource(MidiSourceType midiSourceType,
                          const CharString midiSourceName);
 
 /**
- * Determine an appropriate source type based on a file name.
+ * Determine an appropriate source type based on a file name. Standard input
+ * ("-") and named pipes are read as streams.
  * @param midiSourceTypeString Source name
  * @return Source type
  */
@@ -27,20 +27,59 @@
 #include "MidiSourceFile.h"
 
 #include "audio/AudioSettings.h"
-#include "base/Endian.h"
+#include "base/File.h"
+#include "base/PlatformInfo.h"
 #include "logging/EventLogger.h"
+#include "time/TempoMap.h"
 
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if UNIX
+#include <pthread.h>
+#elif WINDOWS
+#include <Windows.h>
+#endif
+
+// Upper limit on threads used to parse tracks, more than this doesn't help
+// since the merge step is single-threaded anyway
+static const int kMidiFileMaxParserThreads = 16;
+
+// Events parsed from a single MTrk chunk. Timestamps are stored in ticks until
+// all tracks have been parsed and the tempo map is known.
+typedef struct {
+  const byte *data;
+  size_t numBytes;
+  MidiEventMembers *midiEvents;
+  size_t numMidiEvents;
+  size_t capacity;
+  // Parser threads don't log, so errors are kept here and logged afterwards
+  const char *errorMessage;
+} MidiFileTrackMembers;
+typedef MidiFileTrackMembers *MidiFileTrack;
+
+// Each parser thread handles every Nth track, starting with firstTrack
+typedef struct {
+  MidiFileTrack tracks;
+  int numTracks;
+  int firstTrack;
+  int trackStride;
+} MidiFileParserTaskMembers;
+typedef MidiFileParserTaskMembers *MidiFileParserTask;
+
 static boolByte _openMidiSourceFile(void *midiSourcePtr) {
   MidiSource midiSource = midiSourcePtr;
   MidiSourceFileData extraData = midiSource->extraData;
+  File midiFile = newFileWithPath(midiSource->sourceName);
+
+  if (fileExists(midiFile)) {
+    extraData->fileData =
+        (const byte *)fileMapContents(midiFile, &extraData->fileSize);
+  }
 
-  extraData->fileHandle = fopen(midiSource->sourceName->data, "rb");
+  freeFile(midiFile);
 
-  if (extraData->fileHandle == NULL) {
+  if (extraData->fileData == NULL) {
     logError("MIDI file '%s' could not be opened for reading",
              midiSource->sourceName->data);
     return false;
@@ -49,244 +88,409 @@ static boolByte _openMidiSourceFile(void *midiSourcePtr) {
   return true;
 }
 
-static boolByte _readMidiFileChunkHeader(FILE *midiFile,
-                                         const char *expectedChunkId) {
-  byte chunkId[5];
-  size_t itemsRead;
+static unsigned long _readBigEndian(const byte *bytes, const int numBytes) {
+  unsigned long result = 0;
+  int i;
 
-  memset(chunkId, 0, 5);
-  itemsRead = fread(chunkId, sizeof(byte), 4, midiFile);
-
-  if (itemsRead < 4) {
-    logError("Short read of MIDI file (at chunk ID)");
-    return false;
-  } else if (strncmp((char *)chunkId, expectedChunkId, 4)) {
-    logError("MIDI file does not have valid chunk ID");
-    return false;
-  } else {
-    return true;
+  for (i = 0; i < numBytes; i++) {
+    result = (result << 8) | bytes[i];
   }
+
+  return result;
 }
 
-static boolByte _readMidiFileHeader(FILE *midiFile, unsigned short *formatType,
+static boolByte _readMidiFileHeader(const byte *fileData, const size_t fileSize,
+                                    unsigned short *formatType,
                                     unsigned short *numTracks,
                                     unsigned short *timeDivision) {
-  unsigned int numBytesBuffer;
-  size_t itemsRead;
-  unsigned int numBytes;
-  unsigned short wordBuffer;
+  unsigned long numBytes;
 
-  if (!_readMidiFileChunkHeader(midiFile, "MThd")) {
+  if (fileSize < 14) {
+    logError("Short read of MIDI file (at header)");
     return false;
-  }
-
-  itemsRead = fread(&numBytesBuffer, sizeof(unsigned int), 1, midiFile);
-
-  if (itemsRead < 1) {
-    logError("Short read of MIDI file (at header, num items)");
+  } else if (memcmp(fileData, "MThd", 4)) {
+    logError("MIDI file does not have valid chunk ID");
     return false;
   }
 
-  numBytes = convertBigEndianIntToPlatform(numBytesBuffer);
+  numBytes = _readBigEndian(fileData + 4, 4);
 
   if (numBytes != 6) {
-    logError("MIDI file has %d bytes in header chunk, expected 6", numBytes);
+    logError("MIDI file has %lu bytes in header chunk, expected 6", numBytes);
     return false;
   }
 
-  itemsRead = fread(&wordBuffer, sizeof(unsigned short), 1, midiFile);
-
-  if (itemsRead != 1) {
-    logError("Short read of MIDI file (at header, format type)");
-    return false;
-  }
+  *formatType = (unsigned short)_readBigEndian(fileData + 8, 2);
+  *numTracks = (unsigned short)_readBigEndian(fileData + 10, 2);
+  *timeDivision = (unsigned short)_readBigEndian(fileData + 12, 2);
+  logDebug("Time division is %d", *timeDivision);
 
-  *formatType = convertBigEndianShortToPlatform(wordBuffer);
+  return true;
+}
 
-  itemsRead = fread(&wordBuffer, sizeof(unsigned short), 1, midiFile);
+// Find the start and length of each MTrk chunk, skipping over any unknown
+// chunk types as required by the MIDI file specification
+static boolByte _findMidiFileTracks(const byte *fileData, const size_t fileSize,
+                                    MidiFileTrack tracks,
+                                    const unsigned short numTracks) {
+  size_t position = 14;
+  unsigned long numBytes;
+  unsigned short numTracksFound = 0;
+
+  while (numTracksFound < numTracks) {
+    if (position + 8 > fileSize) {
+      logError("Short read of MIDI file (at track %d header)", numTracksFound);
+      return false;
+    }
 
-  if (itemsRead != 1) {
-    logError("Short read of MIDI file (at header, num tracks)");
-    return false;
-  }
+    numBytes = _readBigEndian(fileData + position + 4, 4);
 
-  *numTracks = convertBigEndianShortToPlatform(wordBuffer);
+    if (numBytes > fileSize - position - 8) {
+      logError("Short read of MIDI file (at track %d)", numTracksFound);
+      return false;
+    }
 
-  itemsRead = fread(&wordBuffer, sizeof(unsigned short), 1, midiFile);
+    if (!memcmp(fileData + position, "MTrk", 4)) {
+      tracks[numTracksFound].data = fileData + position + 8;
+      tracks[numTracksFound].numBytes = (size_t)numBytes;
+      numTracksFound++;
+    } else {
+      logDebug("Skipping unknown MIDI file chunk at offset %lu",
+               (unsigned long)position);
+    }
 
-  if (itemsRead != 1) {
-    logError("Short read of MIDI file (at header, time division)");
-    return false;
+    position += 8 + numBytes;
   }
 
-  *timeDivision = convertBigEndianShortToPlatform(wordBuffer);
-  logDebug("Time division is %d", *timeDivision);
-
   return true;
 }
 
-static boolByte _readMidiFileTrack(FILE *midiFile, const int trackNumber,
-                                   const int timeDivision,
-                                   const MidiFileTimeDivisionType divisionType,
-                                   MidiSequence midiSequence) {
-  unsigned int numBytesBuffer;
-  byte *trackData, *currentByte, *endByte;
-  size_t itemsRead, numBytes;
-  unsigned long currentTimeInSampleFrames = 0;
-  unsigned long unpackedVariableLength;
-  MidiEvent midiEvent = NULL;
-  unsigned int i;
-
-  if (!_readMidiFileChunkHeader(midiFile, "MTrk")) {
-    return false;
+static MidiEvent _nextTrackEvent(MidiFileTrack track) {
+  MidiEvent midiEvent;
+
+  if (track->numMidiEvents == track->capacity) {
+    track->capacity *= 2;
+    track->midiEvents = (MidiEventMembers *)realloc(
+        track->midiEvents, track->capacity * sizeof(MidiEventMembers));
   }
 
-  itemsRead = fread(&numBytesBuffer, sizeof(unsigned int), 1, midiFile);
+  midiEvent = &(track->midiEvents[track->numMidiEvents]);
+  memset(midiEvent, 0, sizeof(MidiEventMembers));
+  return midiEvent;
+}
 
-  if (itemsRead < 1) {
-    logError("Short read of MIDI file (at track %d header, num items)",
-             trackNumber);
-    return false;
-  }
+static boolByte _readVariableLength(const byte **currentByte,
+                                    const byte *endByte,
+                                    unsigned long *outValue) {
+  unsigned long value = 0;
+  int i;
 
-  // Read in the entire track in one pass and parse the events from the buffer
-  // data. Much easier
-  // than having to call fread() for each event.
-  numBytes = (size_t)convertBigEndianIntToPlatform(numBytesBuffer);
-  trackData = (byte *)malloc(numBytes);
-  itemsRead = fread(trackData, 1, numBytes, midiFile);
+  // Variable length quantities in MIDI files are at most 4 bytes long
+  for (i = 0; i < 4 && *currentByte < endByte; i++) {
+    value = (value << 7) | (**currentByte & 0x7f);
 
-  if (itemsRead != numBytes) {
-    logError("Short read of MIDI file (at track %d)", trackNumber);
-    free(trackData);
-    return false;
+    if (!(*((*currentByte)++) & 0x80)) {
+      *outValue = value;
+      return true;
+    }
   }
 
-  currentByte = trackData;
-  endByte = trackData + numBytes;
+  return false;
+}
 
-  while (currentByte < endByte) {
-    // Unpack variable length timestamp
-    unpackedVariableLength = *currentByte;
+static boolByte _parseMidiFileTrack(MidiFileTrack track) {
+  const byte *currentByte = track->data;
+  const byte *endByte = track->data + track->numBytes;
+  unsigned long currentTimeInTicks = 0;
+  unsigned long delta, numBytes;
+  byte runningStatus = 0;
+  MidiEvent midiEvent;
 
-    if (unpackedVariableLength & 0x80) {
-      unpackedVariableLength &= 0x7f;
+  // Most events take 3-4 bytes, so this avoids reallocating in most tracks
+  track->capacity = track->numBytes / 3 + 1;
+  track->midiEvents =
+      (MidiEventMembers *)malloc(track->capacity * sizeof(MidiEventMembers));
+  track->numMidiEvents = 0;
 
-      do {
-        unpackedVariableLength =
-            (unpackedVariableLength << 7) + (*(++currentByte) & 0x7f);
-      } while (*currentByte & 0x80);
+  while (currentByte < endByte) {
+    if (!_readVariableLength(&currentByte, endByte, &delta) ||
+        currentByte >= endByte) {
+      track->errorMessage = "Invalid delta time in MIDI file";
+      return false;
     }
 
-    currentByte++;
-    freeMidiEvent(midiEvent);
-    midiEvent = newMidiEvent();
+    currentTimeInTicks += delta;
+    midiEvent = _nextTrackEvent(track);
+    midiEvent->timestamp = currentTimeInTicks;
+
+    if (*currentByte == 0xff) {
+      if (endByte - currentByte < 2) {
+        track->errorMessage = "Short read of MIDI file (at meta event)";
+        return false;
+      }
 
-    switch (*currentByte) {
-    case 0xff:
       midiEvent->eventType = MIDI_TYPE_META;
-      currentByte++;
-      midiEvent->status = *(currentByte++);
-      numBytes = *(currentByte++);
-      midiEvent->extraData = (byte *)malloc(numBytes);
+      midiEvent->status = currentByte[1];
+      currentByte += 2;
+
+      if (!_readVariableLength(&currentByte, endByte, &numBytes) ||
+          numBytes > (unsigned long)(endByte - currentByte)) {
+        track->errorMessage = "Short read of MIDI file (at meta event)";
+        return false;
+      }
 
-      for (i = 0; i < numBytes; i++) {
-        midiEvent->extraData[i] = *(currentByte++);
+      // Only events which are used during playback are kept, and tempo or
+      // time signature events without the expected data can't be used
+      if ((midiEvent->status == MIDI_META_TYPE_TIME_SIGNATURE &&
+           numBytes >= 2) ||
+          midiEvent->status == MIDI_META_TYPE_TRACK_END ||
+          (midiEvent->status == MIDI_META_TYPE_TEMPO && numBytes == 3)) {
+        midiEvent->extraData = (byte *)malloc(numBytes > 0 ? numBytes : 1);
+        memcpy(midiEvent->extraData, currentByte, numBytes);
+        track->numMidiEvents++;
       }
 
-      break;
+      currentByte += numBytes;
 
-    case 0x7f:
-      logUnsupportedFeature("MIDI files containing sysex events");
-      free(trackData);
-      freeMidiEvent(midiEvent);
-      return false;
+      if (midiEvent->status == MIDI_META_TYPE_TRACK_END) {
+        break;
+      }
+    } else if (*currentByte == 0xf0 || *currentByte == 0xf7) {
+      // Sysex events are not passed on to plugins, so just skip their data
+      currentByte++;
+
+      if (!_readVariableLength(&currentByte, endByte, &numBytes) ||
+          numBytes > (unsigned long)(endByte - currentByte)) {
+        track->errorMessage = "Short read of MIDI file (at sysex event)";
+        return false;
+      }
+
+      currentByte += numBytes;
+    } else {
+      if (*currentByte & 0x80) {
+        if (*currentByte >= 0xf0) {
+          track->errorMessage = "Invalid MIDI event status in MIDI file";
+          return false;
+        }
+
+        runningStatus = *currentByte++;
+      } else if (runningStatus == 0) {
+        track->errorMessage = "MIDI file has data byte without a status byte";
+        return false;
+      }
 
-    default:
       midiEvent->eventType = MIDI_TYPE_REGULAR;
-      midiEvent->status = *currentByte++;
-      midiEvent->data1 = *currentByte++;
+      midiEvent->status = runningStatus;
 
       // All regular MIDI events have 3 bytes except for program change and
       // channel aftertouch
-      if (!((midiEvent->status & 0xf0) == 0xc0 ||
-            (midiEvent->status & 0xf0) == 0xd0)) {
+      numBytes = ((runningStatus & 0xf0) == 0xc0 ||
+                  (runningStatus & 0xf0) == 0xd0)
+                     ? 1
+                     : 2;
+
+      if ((unsigned long)(endByte - currentByte) < numBytes) {
+        track->errorMessage = "Short read of MIDI file (at MIDI event)";
+        return false;
+      }
+
+      midiEvent->data1 = *currentByte++;
+
+      if (numBytes == 2) {
         midiEvent->data2 = *currentByte++;
       }
 
-      break;
+      track->numMidiEvents++;
     }
+  }
 
-    switch (divisionType) {
-    case TIME_DIVISION_TYPE_TICKS_PER_BEAT: {
-      double ticksPerSecond = (double)timeDivision * getTempo() / 60.0;
-      double sampleFramesPerTick = getSampleRate() / ticksPerSecond;
-      currentTimeInSampleFrames +=
-          (long)(unpackedVariableLength * sampleFramesPerTick);
-    } break;
-
-    case TIME_DIVISION_TYPE_FRAMES_PER_SECOND:
-      // Actually, this should be caught when parsing the file type
-      logUnsupportedFeature("Time division frames/sec");
-      free(trackData);
-      freeMidiEvent(midiEvent);
-      return false;
+  return true;
+}
 
-    case TIME_DIVISION_TYPE_INVALID:
-    default:
-      logInternalError("Invalid time division type");
-      free(trackData);
-      freeMidiEvent(midiEvent);
-      return false;
+static void _parseMidiFileTracksForTask(MidiFileParserTask task) {
+  int i;
+
+  for (i = task->firstTrack; i < task->numTracks; i += task->trackStride) {
+    _parseMidiFileTrack(&(task->tracks[i]));
+  }
+}
+
+#if UNIX
+static void *_midiFileParserThread(void *taskPtr) {
+  _parseMidiFileTracksForTask((MidiFileParserTask)taskPtr);
+  return NULL;
+}
+#elif WINDOWS
+static DWORD WINAPI _midiFileParserThread(LPVOID taskPtr) {
+  _parseMidiFileTracksForTask((MidiFileParserTask)taskPtr);
+  return 0;
+}
+#endif
+
+static int _parseMidiFileTracks(MidiFileTrack tracks, const int numTracks) {
+  int numThreads = platformInfoGetNumProcessors();
+  MidiFileParserTask tasks;
+  int i;
+
+  if (numThreads > numTracks) {
+    numThreads = numTracks;
+  }
+
+  if (numThreads > kMidiFileMaxParserThreads) {
+    numThreads = kMidiFileMaxParserThreads;
+  }
+
+  tasks = (MidiFileParserTask)malloc(numThreads *
+                                     sizeof(MidiFileParserTaskMembers));
+
+  for (i = 0; i < numThreads; i++) {
+    tasks[i].tracks = tracks;
+    tasks[i].numTracks = numTracks;
+    tasks[i].firstTrack = i;
+    tasks[i].trackStride = numThreads;
+  }
+
+#if UNIX
+  pthread_t *threads = (pthread_t *)malloc(numThreads * sizeof(pthread_t));
+  boolByte *threadStarted = (boolByte *)malloc(numThreads * sizeof(boolByte));
+
+  // The calling thread takes the first task, and any task which could not be
+  // started on a new thread
+  for (i = 1; i < numThreads; i++) {
+    threadStarted[i] = (boolByte)(pthread_create(&threads[i], NULL,
+                                                 _midiFileParserThread,
+                                                 &tasks[i]) == 0);
+  }
+
+  _parseMidiFileTracksForTask(&tasks[0]);
+
+  for (i = 1; i < numThreads; i++) {
+    if (threadStarted[i]) {
+      pthread_join(threads[i], NULL);
+    } else {
+      _parseMidiFileTracksForTask(&tasks[i]);
     }
+  }
 
-    midiEvent->timestamp = currentTimeInSampleFrames;
-
-    if (midiEvent->eventType == MIDI_TYPE_META) {
-      switch (midiEvent->status) {
-      case MIDI_META_TYPE_TEXT:
-      case MIDI_META_TYPE_COPYRIGHT:
-      case MIDI_META_TYPE_SEQUENCE_NAME:
-      case MIDI_META_TYPE_INSTRUMENT:
-      case MIDI_META_TYPE_LYRIC:
-      case MIDI_META_TYPE_MARKER:
-      case MIDI_META_TYPE_CUE_POINT:
-
-      // This event type could theoretically be supported, as long as the
-      // plugin supports it
-      case MIDI_META_TYPE_PROGRAM_NAME:
-      case MIDI_META_TYPE_DEVICE_NAME:
-      case MIDI_META_TYPE_KEY_SIGNATURE:
-      case MIDI_META_TYPE_PROPRIETARY:
-        logDebug("Ignoring MIDI meta event of type 0x%x at %ld",
-                 midiEvent->status, midiEvent->timestamp);
-        break;
+  free(threads);
+  free(threadStarted);
+#elif WINDOWS
+  HANDLE *threads = (HANDLE *)malloc(numThreads * sizeof(HANDLE));
 
-      case MIDI_META_TYPE_TEMPO:
-      case MIDI_META_TYPE_TIME_SIGNATURE:
-      case MIDI_META_TYPE_TRACK_END:
-        logDebug("Parsed MIDI meta event of type 0x%02x at %ld",
-                 midiEvent->status, midiEvent->timestamp);
-        appendMidiEventToSequence(midiSequence, midiEvent);
-        midiEvent = NULL;
-        break;
+  for (i = 1; i < numThreads; i++) {
+    threads[i] =
+        CreateThread(NULL, 0, _midiFileParserThread, &tasks[i], 0, NULL);
+  }
 
-      default:
-        logWarn("Ignoring MIDI meta event of type 0x%x at %ld",
-                midiEvent->status, midiEvent->timestamp);
-        break;
-      }
+  _parseMidiFileTracksForTask(&tasks[0]);
+
+  for (i = 1; i < numThreads; i++) {
+    if (threads[i] != NULL) {
+      WaitForSingleObject(threads[i], INFINITE);
+      CloseHandle(threads[i]);
     } else {
-      logDebug("MIDI event of type 0x%02x parsed at %ld", midiEvent->status,
-               midiEvent->timestamp);
-      appendMidiEventToSequence(midiSequence, midiEvent);
-      midiEvent = NULL;
+      _parseMidiFileTracksForTask(&tasks[i]);
     }
   }
 
-  free(trackData);
-  freeMidiEvent(midiEvent);
-  return true;
+  free(threads);
+#else
+  for (i = 0; i < numThreads; i++) {
+    _parseMidiFileTracksForTask(&tasks[i]);
+  }
+#endif
+
+  free(tasks);
+  return numThreads;
+}
+
+static void _mergeMidiFileTracks(MidiFileTrack tracks, const int numTracks,
+                                 const unsigned short timeDivision,
+                                 MidiSequence midiSequence) {
+  TempoMap tempoMap = newTempoMap(timeDivision, getTempo(), getSampleRate());
+  MidiEventMembers trackEnd;
+  boolByte hasTrackEnd = false;
+  MidiEvent midiEvent;
+  size_t i, numEventsKept;
+  int track;
+
+  tempoMapAddTimeSignatureChange(tempoMap, 0,
+                                 getTimeSignatureBeatsPerMeasure(),
+                                 getTimeSignatureNoteValue());
+
+  // Tempo changes may be in any track, though usually they are all in the
+  // first one, so they must all be known before converting any timestamps
+  for (track = 0; track < numTracks; track++) {
+    for (i = 0; i < tracks[track].numMidiEvents; i++) {
+      midiEvent = &(tracks[track].midiEvents[i]);
+
+      if (midiEvent->eventType != MIDI_TYPE_META) {
+        continue;
+      } else if (midiEvent->status == MIDI_META_TYPE_TEMPO) {
+        tempoMapAddTempoChangeFromMidiBytes(tempoMap, midiEvent->timestamp,
+                                            midiEvent->extraData);
+      } else if (midiEvent->status == MIDI_META_TYPE_TIME_SIGNATURE) {
+        tempoMapAddTimeSignatureChangeFromMidiBytes(
+            tempoMap, midiEvent->timestamp, midiEvent->extraData);
+      }
+    }
+  }
+
+  for (track = 0; track < numTracks; track++) {
+    numEventsKept = 0;
+
+    for (i = 0; i < tracks[track].numMidiEvents; i++) {
+      midiEvent = &(tracks[track].midiEvents[i]);
+      midiEvent->timestamp =
+          tempoMapTicksToFrames(tempoMap, midiEvent->timestamp);
+
+      // Every track has its own end event, but processing stops at the first
+      // one it sees, so only the last one is kept and added after all others
+      if (midiEvent->eventType == MIDI_TYPE_META &&
+          midiEvent->status == MIDI_META_TYPE_TRACK_END) {
+        if (!hasTrackEnd) {
+          trackEnd = *midiEvent;
+          hasTrackEnd = true;
+        } else if (midiEvent->timestamp >= trackEnd.timestamp) {
+          free(trackEnd.extraData);
+          trackEnd = *midiEvent;
+        } else {
+          free(midiEvent->extraData);
+        }
+      } else {
+        tracks[track].midiEvents[numEventsKept++] = *midiEvent;
+      }
+    }
+
+    midiSequenceAppendEvents(midiSequence, tracks[track].midiEvents,
+                             numEventsKept);
+  }
+
+  if (hasTrackEnd) {
+    midiSequenceAppendEvents(midiSequence, &trackEnd, 1);
+  }
+
+  // The map is kept so that transport queries don't need to walk the events
+  freeTempoMap(midiSequence->tempoMap);
+  midiSequence->tempoMap = tempoMap;
+}
+
+static void _freeMidiFileTracks(MidiFileTrack tracks, const int numTracks,
+                                const boolByte freeEventData) {
+  size_t i;
+  int track;
+
+  for (track = 0; track < numTracks; track++) {
+    if (freeEventData) {
+      for (i = 0; i < tracks[track].numMidiEvents; i++) {
+        free(tracks[track].midiEvents[i].extraData);
+      }
+    }
+
+    free(tracks[track].midiEvents);
+  }
+
+  free(tracks);
 }
 
 static boolByte _readMidiEventsFile(void *midiSourcePtr,
@@ -294,52 +498,82 @@ static boolByte _readMidiEventsFile(void *midiSourcePtr,
   MidiSource midiSource = (MidiSource)midiSourcePtr;
   MidiSourceFileData extraData = (MidiSourceFileData)(midiSource->extraData);
   unsigned short formatType, numTracks, timeDivision = 0;
+  MidiFileTrack tracks;
+  boolByte result = true;
+  int numThreads;
   int track;
 
-  if (!_readMidiFileHeader(extraData->fileHandle, &formatType, &numTracks,
-                           &timeDivision)) {
+  if (!_readMidiFileHeader(extraData->fileData, extraData->fileSize,
+                           &formatType, &numTracks, &timeDivision)) {
     return false;
   }
 
-  if (formatType != 0) {
-    logUnsupportedFeature("MIDI file types other than 0");
+  if (formatType > 1) {
+    logUnsupportedFeature("MIDI file types other than 0 or 1");
     return false;
   } else if (formatType == 0 && numTracks != 1) {
     logError("MIDI file '%s' is of type 0, but contains %d tracks",
              midiSource->sourceName->data, numTracks);
     return false;
+  } else if (numTracks == 0) {
+    logError("MIDI file '%s' does not contain any tracks",
+             midiSource->sourceName->data);
+    return false;
   }
 
   // Determine time division type
-  if (timeDivision & 0x7fff) {
-    extraData->divisionType = TIME_DIVISION_TYPE_TICKS_PER_BEAT;
-  } else {
+  if (timeDivision & 0x8000 || timeDivision == 0) {
     extraData->divisionType = TIME_DIVISION_TYPE_FRAMES_PER_SECOND;
     logUnsupportedFeature("MIDI file with time division in frames/second");
     return false;
+  } else {
+    extraData->divisionType = TIME_DIVISION_TYPE_TICKS_PER_BEAT;
   }
 
   logDebug(
       "MIDI file is type %d, has %d tracks, and time division %d (type %d)",
       formatType, numTracks, timeDivision, extraData->divisionType);
 
+  tracks = (MidiFileTrack)calloc(numTracks, sizeof(MidiFileTrackMembers));
+
+  if (!_findMidiFileTracks(extraData->fileData, extraData->fileSize, tracks,
+                           numTracks)) {
+    _freeMidiFileTracks(tracks, numTracks, true);
+    return false;
+  }
+
+  numThreads = _parseMidiFileTracks(tracks, numTracks);
+
   for (track = 0; track < numTracks; track++) {
-    if (!_readMidiFileTrack(extraData->fileHandle, track, timeDivision,
-                            extraData->divisionType, midiSequence)) {
-      return false;
+    if (tracks[track].errorMessage != NULL) {
+      logError("%s (track %d)", tracks[track].errorMessage, track);
+      result = false;
     }
   }
 
+  if (!result) {
+    _freeMidiFileTracks(tracks, numTracks, true);
+    return false;
+  }
+
+  _mergeMidiFileTracks(tracks, numTracks, timeDivision, midiSequence);
+  logDebug("Parsed %lu MIDI events from %d tracks using %d threads",
+           (unsigned long)midiSequence->numMidiEvents, numTracks, numThreads);
+  // The sequence owns the event data now
+  _freeMidiFileTracks(tracks, numTracks, false);
+  return true;
+}
+
+static boolByte _readMidiEventsUntilFile(void *midiSourcePtr,
+                                         MidiSequence midiSequence,
+                                         const unsigned long stopTimestamp) {
+  // All events are read up front by _readMidiEventsFile()
   return true;
 }
 
 static void _freeMidiEventsFile(void *midiSourceDataPtr) {
   MidiSourceFileData extraData = midiSourceDataPtr;
-
-  if (extraData->fileHandle != NULL) {
-    fclose(extraData->fileHandle);
-  }
-
+  fileUnmapContents(extraData->fileData, extraData->fileSize);
   free(extraData);
 }
 
@@ -351,13 +585,17 @@ MidiSource newMidiSourceFile(const CharString midiSourceName) {
   midiSource->midiSourceType = MIDI_SOURCE_TYPE_FILE;
   midiSource->sourceName = newCharString();
   charStringCopy(midiSource->sourceName, midiSourceName);
+  midiSource->isStream = false;
+  midiSource->endOfStream = false;
 
   midiSource->openMidiSource = _openMidiSourceFile;
   midiSource->readMidiEvents = _readMidiEventsFile;
+  midiSource->readMidiEventsUntil = _readMidiEventsUntilFile;
   midiSource->freeMidiSourceData = _freeMidiEventsFile;
 
   extraData->divisionType = TIME_DIVISION_TYPE_INVALID;
-  extraData->fileHandle = NULL;
+  extraData->fileData = NULL;
+  extraData->fileSize = 0;
   midiSource->extraData = extraData;
 
   return midiSource;
@@ -29,7 +29,7 @@
 
 #include "midi/MidiSource.h"
 
-#include <stdio.h>
+#include <stddef.h>
 
 typedef enum {
   TIME_DIVISION_TYPE_INVALID,
@@ -39,11 +39,21 @@ typedef enum {
 } MidiFileTimeDivisionType;
 
 typedef struct {
-  FILE *fileHandle;
+  // Contents of the MIDI file, mapped into memory when the source is opened
+  const byte *fileData;
+  size_t fileSize;
   MidiFileTimeDivisionType divisionType;
 } MidiSourceFileDataMembers;
 typedef MidiSourceFileDataMembers *MidiSourceFileData;
 
+/**
+ * Create a MIDI source which reads a type 0 or type 1 Standard MIDI file. The
+ * file is mapped into memory, and the tracks of type 1 files are parsed in
+ * parallel and then merged into a single sequence. Tick positions are converted
+ * to sample frames using the tempo changes found in all tracks.
+ * @param midiSourceName Path to the MIDI file
+ * @return MidiSource object
+ */
 MidiSource newMidiSourceFile(const CharString midiSourceName);
 
 #endif
@@ -0,0 +1,420 @@
+//
+// MidiSourceStream.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "MidiSourceStream.h"
+
+#include "audio/AudioSettings.h"
+#include "logging/EventLogger.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Result codes for reading a single event from the stream
+typedef enum {
+  MIDI_STREAM_READ_OK,
+  MIDI_STREAM_READ_EOF,
+  MIDI_STREAM_READ_ERROR
+} MidiStreamReadResult;
+
+static boolByte _openMidiSourceStream(void *midiSourcePtr) {
+  MidiSource midiSource = midiSourcePtr;
+  MidiSourceStreamData extraData = midiSource->extraData;
+
+  if (!strcmp(midiSource->sourceName->data, "-")) {
+    extraData->fileHandle = stdin;
+    charStringCopyCString(midiSource->sourceName, "stdin");
+  } else {
+    extraData->fileHandle = fopen(midiSource->sourceName->data, "rb");
+  }
+
+  if (extraData->fileHandle == NULL) {
+    logError("MIDI stream '%s' could not be opened for reading",
+             midiSource->sourceName->data);
+    return false;
+  }
+
+  return true;
+}
+
+static int _readByte(MidiSourceStreamData extraData) {
+  if (extraData->_numPushback > 0) {
+    return extraData->_pushback[--extraData->_numPushback];
+  }
+
+  return fgetc(extraData->fileHandle);
+}
+
+static boolByte _readBytes(MidiSourceStreamData extraData, byte *outBytes,
+                           const size_t numBytes) {
+  size_t i;
+  int c;
+
+  for (i = 0; i < numBytes; i++) {
+    c = _readByte(extraData);
+
+    if (c == EOF) {
+      return false;
+    }
+
+    outBytes[i] = (byte)c;
+  }
+
+  return true;
+}
+
+static boolByte _readVariableLength(MidiSourceStreamData extraData,
+                                    unsigned long *outValue) {
+  unsigned long value = 0;
+  int c;
+  int i;
+
+  // Variable length quantities in MIDI files are at most 4 bytes long
+  for (i = 0; i < 4; i++) {
+    c = _readByte(extraData);
+
+    if (c == EOF) {
+      return false;
+    }
+
+    value = (value << 7) | (c & 0x7f);
+
+    if (!(c & 0x80)) {
+      *outValue = value;
+      return true;
+    }
+  }
+
+  logError("Invalid variable length value in MIDI stream");
+  return false;
+}
+
+static unsigned long _readBigEndian(const byte *bytes, const int numBytes) {
+  unsigned long result = 0;
+  int i;
+
+  for (i = 0; i < numBytes; i++) {
+    result = (result << 8) | bytes[i];
+  }
+
+  return result;
+}
+
+static boolByte _readStreamHeader(MidiSource midiSource) {
+  MidiSourceStreamData extraData = midiSource->extraData;
+  byte chunk[8];
+  byte header[6];
+  int i;
+
+  // A stream which starts with a MIDI file header is parsed as a MIDI file,
+  // otherwise it is assumed to contain raw delta/event pairs.
+  for (i = 0; i < 4; i++) {
+    int c = _readByte(extraData);
+
+    if (c == EOF) {
+      break;
+    }
+
+    chunk[i] = (byte)c;
+  }
+
+  if (i < 4 || memcmp(chunk, "MThd", 4)) {
+    // Push back in reverse order so that _readByte() returns them in order
+    while (i > 0) {
+      extraData->_pushback[extraData->_numPushback++] = chunk[--i];
+    }
+
+    extraData->format = MIDI_STREAM_FORMAT_RAW;
+    logDebug("MIDI stream '%s' has no file header, reading raw events",
+             midiSource->sourceName->data);
+    return true;
+  }
+
+  if (!_readBytes(extraData, chunk, 4) || _readBigEndian(chunk, 4) != 6 ||
+      !_readBytes(extraData, header, 6)) {
+    logError("MIDI stream '%s' has an invalid file header",
+             midiSource->sourceName->data);
+    return false;
+  }
+
+  if (_readBigEndian(header, 2) != 0 || _readBigEndian(header + 2, 2) != 1) {
+    logUnsupportedFeature("Streaming MIDI file types other than 0");
+    return false;
+  }
+
+  extraData->ticksPerBeat = (unsigned short)_readBigEndian(header + 4, 2);
+
+  if (extraData->ticksPerBeat == 0 || extraData->ticksPerBeat & 0x8000) {
+    logUnsupportedFeature("MIDI file with time division in frames/second");
+    return false;
+  }
+
+  // The track length is ignored, since a stream generator may not know it in
+  // advance. The track is read until a track end event or EOF instead.
+  if (!_readBytes(extraData, chunk, 8) || memcmp(chunk, "MTrk", 4)) {
+    logError("MIDI stream '%s' does not have a valid track header",
+             midiSource->sourceName->data);
+    return false;
+  }
+
+  extraData->format = MIDI_STREAM_FORMAT_SMF;
+  logDebug("MIDI stream '%s' is a type 0 file with time division %d",
+           midiSource->sourceName->data, extraData->ticksPerBeat);
+  return true;
+}
+
+static double _deltaToFrames(MidiSourceStreamData extraData,
+                             const unsigned long delta) {
+  double ticksPerSecond;
+
+  if (extraData->format == MIDI_STREAM_FORMAT_RAW) {
+    return (double)delta;
+  }
+
+  ticksPerSecond = (double)extraData->ticksPerBeat * extraData->tempo / 60.0;
+  return (double)delta * getSampleRate() / ticksPerSecond;
+}
+
+static MidiStreamReadResult _readMeta(MidiSource midiSource,
+                                      MidiEvent midiEvent) {
+  MidiSourceStreamData extraData = midiSource->extraData;
+  unsigned long numBytes;
+  int type = _readByte(extraData);
+
+  if (type == EOF || !_readVariableLength(extraData, &numBytes)) {
+    return MIDI_STREAM_READ_ERROR;
+  }
+
+  midiEvent->eventType = MIDI_TYPE_META;
+  midiEvent->status = (byte)type;
+  midiEvent->extraData = (byte *)malloc(numBytes > 0 ? numBytes : 1);
+
+  if (!_readBytes(extraData, midiEvent->extraData, numBytes)) {
+    return MIDI_STREAM_READ_ERROR;
+  }
+
+  if (midiEvent->status == MIDI_META_TYPE_TEMPO && numBytes == 3) {
+    // Later events are converted using the new tempo
+    extraData->tempo =
+        60000000.0 / (double)_readBigEndian(midiEvent->extraData, 3);
+  }
+
+  return MIDI_STREAM_READ_OK;
+}
+
+static MidiStreamReadResult _readEvent(MidiSource midiSource,
+                                       MidiSequence midiSequence) {
+  MidiSourceStreamData extraData = midiSource->extraData;
+  MidiStreamReadResult result = MIDI_STREAM_READ_OK;
+  MidiEvent midiEvent;
+  unsigned long delta;
+  unsigned long numBytes;
+  byte skipBuffer[64];
+  int c;
+
+  // EOF before the delta time is a clean end of stream, anywhere else it is a
+  // truncated event
+  c = _readByte(extraData);
+
+  if (c == EOF) {
+    return MIDI_STREAM_READ_EOF;
+  }
+
+  extraData->_pushback[extraData->_numPushback++] = (byte)c;
+
+  if (!_readVariableLength(extraData, &delta) ||
+      (c = _readByte(extraData)) == EOF) {
+    return MIDI_STREAM_READ_ERROR;
+  }
+
+  extraData->currentTimeInFrames += _deltaToFrames(extraData, delta);
+  midiEvent = newMidiEvent();
+  midiEvent->timestamp = (unsigned long)extraData->currentTimeInFrames;
+
+  if (c == 0xff) {
+    result = _readMeta(midiSource, midiEvent);
+  } else if (c == 0xf0 || c == 0xf7) {
+    // Sysex events are not passed on to plugins, so just skip their data
+    if (!_readVariableLength(extraData, &numBytes)) {
+      result = MIDI_STREAM_READ_ERROR;
+    }
+
+    while (result == MIDI_STREAM_READ_OK && numBytes > 0) {
+      size_t chunkSize =
+          numBytes > sizeof(skipBuffer) ? sizeof(skipBuffer) : numBytes;
+
+      if (!_readBytes(extraData, skipBuffer, chunkSize)) {
+        result = MIDI_STREAM_READ_ERROR;
+      }
+
+      numBytes -= chunkSize;
+    }
+
+    freeMidiEvent(midiEvent);
+    return result;
+  } else {
+    midiEvent->eventType = MIDI_TYPE_REGULAR;
+
+    if (c & 0x80) {
+      extraData->runningStatus = (byte)c;
+
+      if ((c = _readByte(extraData)) == EOF) {
+        freeMidiEvent(midiEvent);
+        return MIDI_STREAM_READ_ERROR;
+      }
+    } else if (extraData->runningStatus == 0) {
+      logError("MIDI stream has data byte 0x%02x without a status byte", c);
+      freeMidiEvent(midiEvent);
+      return MIDI_STREAM_READ_ERROR;
+    }
+
+    midiEvent->status = extraData->runningStatus;
+    midiEvent->data1 = (byte)c;
+
+    // All regular MIDI events have 3 bytes except for program change and
+    // channel aftertouch
+    if (!((midiEvent->status & 0xf0) == 0xc0 ||
+          (midiEvent->status & 0xf0) == 0xd0)) {
+      midiEvent->data2 = (byte)(c = _readByte(extraData));
+    }
+
+    if (c == EOF) {
+      result = MIDI_STREAM_READ_ERROR;
+    }
+  }
+
+  if (result != MIDI_STREAM_READ_OK) {
+    freeMidiEvent(midiEvent);
+    return result;
+  }
+
+  if (midiEvent->eventType == MIDI_TYPE_META) {
+    switch (midiEvent->status) {
+    case MIDI_META_TYPE_TRACK_END:
+      midiSource->endOfStream = true;
+
+    // Fall through
+    case MIDI_META_TYPE_TEMPO:
+    case MIDI_META_TYPE_TIME_SIGNATURE:
+      logDebug("Parsed MIDI meta event of type 0x%02x at %ld",
+               midiEvent->status, midiEvent->timestamp);
+      appendMidiEventToSequence(midiSequence, midiEvent);
+      break;
+
+    default:
+      logDebug("Ignoring MIDI meta event of type 0x%x at %ld",
+               midiEvent->status, midiEvent->timestamp);
+      freeMidiEvent(midiEvent);
+      break;
+    }
+  } else {
+    logDebug("MIDI event of type 0x%02x parsed at %ld", midiEvent->status,
+             midiEvent->timestamp);
+    appendMidiEventToSequence(midiSequence, midiEvent);
+  }
+
+  return MIDI_STREAM_READ_OK;
+}
+
+static boolByte _readMidiEventsUntilStream(void *midiSourcePtr,
+                                           MidiSequence midiSequence,
+                                           const unsigned long stopTimestamp) {
+  MidiSource midiSource = midiSourcePtr;
+  MidiSourceStreamData extraData = midiSource->extraData;
+
+  if (extraData->format == MIDI_STREAM_FORMAT_UNKNOWN) {
+    if (!_readStreamHeader(midiSource)) {
+      midiSource->endOfStream = true;
+      return false;
+    }
+  }
+
+  while (!midiSource->endOfStream &&
+         extraData->currentTimeInFrames < (double)stopTimestamp) {
+    switch (_readEvent(midiSource, midiSequence)) {
+    case MIDI_STREAM_READ_OK:
+      break;
+
+    case MIDI_STREAM_READ_EOF:
+      logDebug("Reached end of MIDI stream '%s'",
+               midiSource->sourceName->data);
+      midiSource->endOfStream = true;
+      break;
+
+    case MIDI_STREAM_READ_ERROR:
+    default:
+      logError("Error reading from MIDI stream '%s'",
+               midiSource->sourceName->data);
+      midiSource->endOfStream = true;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static boolByte _readMidiEventsStream(void *midiSourcePtr,
+                                      MidiSequence midiSequence) {
+  return _readMidiEventsUntilStream(midiSourcePtr, midiSequence, ULONG_MAX);
+}
+
+static void _freeMidiSourceDataStream(void *midiSourceDataPtr) {
+  MidiSourceStreamData extraData = midiSourceDataPtr;
+
+  if (extraData->fileHandle != NULL && extraData->fileHandle != stdin) {
+    fclose(extraData->fileHandle);
+  }
+
+  free(extraData);
+}
+
+MidiSource newMidiSourceStream(const CharString midiSourceName) {
+  MidiSource midiSource = (MidiSource)malloc(sizeof(MidiSourceMembers));
+  MidiSourceStreamData extraData =
+      (MidiSourceStreamData)malloc(sizeof(MidiSourceStreamDataMembers));
+
+  midiSource->midiSourceType = MIDI_SOURCE_TYPE_STREAM;
+  midiSource->sourceName = newCharString();
+  charStringCopy(midiSource->sourceName, midiSourceName);
+  midiSource->isStream = true;
+  midiSource->endOfStream = false;
+
+  midiSource->openMidiSource = _openMidiSourceStream;
+  midiSource->readMidiEvents = _readMidiEventsStream;
+  midiSource->readMidiEventsUntil = _readMidiEventsUntilStream;
+  midiSource->freeMidiSourceData = _freeMidiSourceDataStream;
+
+  extraData->fileHandle = NULL;
+  extraData->format = MIDI_STREAM_FORMAT_UNKNOWN;
+  extraData->ticksPerBeat = 0;
+  extraData->tempo = getTempo();
+  extraData->currentTimeInFrames = 0.0;
+  extraData->runningStatus = 0;
+  extraData->_numPushback = 0;
+  midiSource->extraData = extraData;
+
+  return midiSource;
+}
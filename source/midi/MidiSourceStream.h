@@ -0,0 +1,74 @@
+//
+// MidiSourceStream.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_MidiSourceStream_h
+#define MrsWatson_MidiSourceStream_h
+
+#include "midi/MidiSource.h"
+
+#include <stdio.h>
+
+typedef enum {
+  MIDI_STREAM_FORMAT_UNKNOWN,
+  // Standard MIDI file with a single track, timestamps are in ticks
+  MIDI_STREAM_FORMAT_SMF,
+  // Delta time and event pairs like in a MIDI file track, but with no headers.
+  // Delta times are in sample frames.
+  MIDI_STREAM_FORMAT_RAW,
+  NUM_MIDI_STREAM_FORMATS
+} MidiStreamFormat;
+
+#define MIDI_STREAM_MAX_PUSHBACK 4
+
+typedef struct {
+  FILE *fileHandle;
+  MidiStreamFormat format;
+  unsigned short ticksPerBeat;
+  // Tempo used to convert ticks to frames, updated by tempo events as they are
+  // read from the stream
+  double tempo;
+  // Time of the last event read from the stream, in sample frames
+  double currentTimeInFrames;
+  byte runningStatus;
+
+  // Private fields
+  byte _pushback[MIDI_STREAM_MAX_PUSHBACK];
+  int _numPushback;
+} MidiSourceStreamDataMembers;
+typedef MidiSourceStreamDataMembers *MidiSourceStreamData;
+
+/**
+ * Create a MIDI source which parses events incrementally from stdin or a named
+ * pipe. The stream may either be a type 0 Standard MIDI file, or a raw stream
+ * of MIDI events with delta times in sample frames. Events are only read as
+ * far ahead as needed for the block being processed, so that generated MIDI
+ * may be rendered while it is still being produced.
+ * @param midiSourceName Name of the pipe to read from, or "-" for stdin
+ * @return MidiSource object
+ */
+MidiSource newMidiSourceStream(const CharString midiSourceName);
+
+#endif
@@ -169,10 +169,48 @@ boolByte closePlugin(Plugin self) {
   self->inputBuffer = NULL;
   freeSampleBuffer(self->outputBuffer);
   self->outputBuffer = NULL;
+  freeDoubleSampleBuffer(self->inputBufferDouble);
+  self->inputBufferDouble = NULL;
+  freeDoubleSampleBuffer(self->outputBufferDouble);
+  self->outputBufferDouble = NULL;
   self->isOpen = false;
   return true;
 }
 
+boolByte pluginSetDoublePrecision(Plugin self, boolByte doublePrecision) {
+  if (!doublePrecision) {
+    freeDoubleSampleBuffer(self->inputBufferDouble);
+    self->inputBufferDouble = NULL;
+    freeDoubleSampleBuffer(self->outputBufferDouble);
+    self->outputBufferDouble = NULL;
+    return true;
+  } else if (self->processAudioDouble == NULL || !self->isOpen) {
+    return false;
+  } else if (pluginIsDoublePrecision(self)) {
+    return true;
+  }
+
+  self->inputBufferDouble = newDoubleSampleBuffer(
+      self->inputBuffer->numChannels, self->inputBuffer->blocksize);
+  self->outputBufferDouble = newDoubleSampleBuffer(
+      self->outputBuffer->numChannels, self->outputBuffer->blocksize);
+  return true;
+}
+
+boolByte pluginIsDoublePrecision(const Plugin self) {
+  return (boolByte)(self->inputBufferDouble != NULL &&
+                    self->outputBufferDouble != NULL);
+}
+
+boolByte pluginSetParameterQuietly(Plugin self, const unsigned int index,
+                                   const float value) {
+  if (self->setParameterQuietly != NULL) {
+    return self->setParameterQuietly(self, index, value);
+  }
+
+  return self->setParameter(self, index, value);
+}
+
 Plugin _newPlugin(PluginInterfaceType interfaceType, PluginType pluginType) {
   Plugin plugin = (Plugin)malloc(sizeof(PluginMembers));
 
@@ -182,8 +220,13 @@ Plugin _newPlugin(PluginInterfaceType interfaceType, PluginType pluginType) {
   plugin->pluginLocation = newCharString();
   plugin->pluginAbsolutePath = newCharString();
 
+  plugin->processAudioDouble = NULL;
+  plugin->processOffline = NULL;
+  plugin->setParameterQuietly = NULL;
   plugin->inputBuffer = NULL;
   plugin->outputBuffer = NULL;
+  plugin->inputBufferDouble = NULL;
+  plugin->outputBufferDouble = NULL;
   plugin->isOpen = false;
 
   return plugin;
@@ -204,6 +247,9 @@ void freePlugin(Plugin self) {
       freeSampleBuffer(self->outputBuffer);
     }
 
+    freeDoubleSampleBuffer(self->inputBufferDouble);
+    freeDoubleSampleBuffer(self->outputBufferDouble);
+
     freeCharString(self->pluginName);
     freeCharString(self->pluginLocation);
     freeCharString(self->pluginAbsolutePath);
@@ -27,6 +27,8 @@
 #ifndef MrsWatson_Plugin_h
 #define MrsWatson_Plugin_h
 
+#include "audio/DoubleSampleBuffer.h"
+#include "audio/OfflineSession.h"
 #include "audio/SampleBuffer.h"
 #include "base/CharString.h"
 #include "base/LinkedList.h"
@@ -38,6 +40,7 @@ typedef enum {
   PLUGIN_TYPE_INVALID,
   PLUGIN_TYPE_VST_2X,
   PLUGIN_TYPE_INTERNAL,
+  PLUGIN_TYPE_SANDBOX,
   NUM_PLUGIN_INTERFACE_TYPES
 } PluginInterfaceType;
 
@@ -97,6 +100,28 @@ typedef int (*PluginGetSettingFunc)(void *pluginPtr,
 typedef void (*PluginProcessAudioFunc)(void *pluginPtr, SampleBuffer inputs,
                                        SampleBuffer outputs);
 
+/**
+ * Called when the host wants to process a block of audio samples in double
+ * precision. Only plugins which can natively process 64-bit samples provide
+ * this function.
+ * @param pluginPtr self
+ * @param inputs Block of input samples to process
+ * @param outputs Block where output samples shall be written
+ */
+typedef void (*PluginProcessAudioDoubleFunc)(void *pluginPtr,
+                                             DoubleSampleBuffer inputs,
+                                             DoubleSampleBuffer outputs);
+
+/**
+ * Called when the host wants the plugin to process an entire input offline.
+ * Only plugins which support offline processing provide this function.
+ * @param pluginPtr self
+ * @param session Session with the input, where the output shall be written
+ * @return True if the input was processed
+ */
+typedef boolByte (*PluginProcessOfflineFunc)(void *pluginPtr,
+                                             OfflineSession session);
+
 /**
  * Called the host wants to process MIDI events. This will be called directly
  * before the call to process audio.
@@ -123,6 +148,13 @@ typedef boolByte (*PluginSetParameterFunc)(void *pluginPtr, unsigned int index,
  */
 typedef void (*PluginPrepareForProcessingFunc)(void *pluginPtr);
 
+/**
+ * Called to stop audio processing, for instance to reset the plugin's internal
+ * state. Processing is resumed again by calling prepareForProcessing.
+ * @param pluginPtr self
+ */
+typedef void (*PluginSuspendFunc)(void *pluginPtr);
+
 /**
  * Called when the plugin should show its GUI editor.
  * @param pluginPtr self
@@ -152,14 +184,25 @@ typedef struct {
   PluginDisplayInfoFunc displayInfo;
   PluginGetSettingFunc getSetting;
   PluginProcessAudioFunc processAudio;
+  // NULL for plugins which can only process single precision audio
+  PluginProcessAudioDoubleFunc processAudioDouble;
+  // NULL for plugins which cannot process audio offline
+  PluginProcessOfflineFunc processOffline;
   PluginProcessMidiEventsFunc processMidiEvents;
   PluginSetParameterFunc setParameter;
+  // Sets a parameter without logging or allocating, for use during processing.
+  // NULL for plugins whose setParameter already does neither.
+  PluginSetParameterFunc setParameterQuietly;
   PluginPrepareForProcessingFunc prepareForProcessing;
+  PluginSuspendFunc suspend;
   PluginShowEditorFunc showEditor;
   PluginCloseFunc closePlugin;
   FreePluginDataFunc freePluginData;
   SampleBuffer inputBuffer;
   SampleBuffer outputBuffer;
+  // Only allocated when double precision processing is enabled
+  DoubleSampleBuffer inputBufferDouble;
+  DoubleSampleBuffer outputBufferDouble;
   boolByte isOpen;
 
   void *extraData;
@@ -199,6 +242,36 @@ boolByte openPlugin(Plugin self);
  */
 boolByte closePlugin(Plugin self);
 
+/**
+ * Enable or disable double precision processing for a plugin. When enabled,
+ * the host should call processAudioDouble with the plugin's double buffers
+ * instead of processAudio. This must be called after the plugin is opened and
+ * before processing is (re)started.
+ * @param self
+ * @param doublePrecision True to process audio with 64-bit samples
+ * @return False if the plugin does not support double precision processing or
+ * is not open
+ */
+boolByte pluginSetDoublePrecision(Plugin self, boolByte doublePrecision);
+
+/**
+ * Check if double precision processing is enabled for a plugin
+ * @param self
+ * @return True if the plugin processes audio with 64-bit samples
+ */
+boolByte pluginIsDoublePrecision(const Plugin self);
+
+/**
+ * Set a parameter while audio is being processed, for instance by automation.
+ * Unlike setParameter, this does not log the new value or allocate memory.
+ * @param self
+ * @param index Parameter index
+ * @param value New value
+ * @return True if the parameter was set
+ */
+boolByte pluginSetParameterQuietly(Plugin self, const unsigned int index,
+                                   const float value);
+
 /**
 * Create a new plugin. Considered "protected", only subclasses of Plugin should
 * directly call this.
@@ -0,0 +1,397 @@
+//
+// PluginAutomation.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PluginAutomation.h"
+
+#include "base/Endian.h"
+#include "base/File.h"
+#include "logging/EventLogger.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t kAutomationInitialCapacity = 16;
+
+// Binary automation files start with this magic number, followed by records
+// of big-endian values: frame (32 bits), plugin index (16 bits), parameter
+// index (16 bits), value (32 bit float), interpolation (8 bits), and 3 bytes
+// of padding.
+static const char kAutomationBinaryMagic[4] = {'M', 'W', 'A', 'U'};
+static const size_t kAutomationBinaryRecordSize = 16;
+
+// Longest line which will be read from text automation files
+#define AUTOMATION_TEXT_LINE_LENGTH 256
+
+PluginAutomation newPluginAutomation(void) {
+  PluginAutomation automation =
+      (PluginAutomation)malloc(sizeof(PluginAutomationMembers));
+
+  automation->lanes = NULL;
+  automation->numLanes = 0;
+  automation->controlRate = DEFAULT_AUTOMATION_CONTROL_RATE;
+  automation->_lanesCapacity = 0;
+
+  return automation;
+}
+
+static AutomationLane _getLane(PluginAutomation self,
+                               const unsigned int pluginIndex,
+                               const unsigned int parameterIndex) {
+  AutomationLane lane;
+  size_t i;
+
+  for (i = 0; i < self->numLanes; i++) {
+    if (self->lanes[i].pluginIndex == pluginIndex &&
+        self->lanes[i].parameterIndex == parameterIndex) {
+      return &(self->lanes[i]);
+    }
+  }
+
+  if (self->numLanes == self->_lanesCapacity) {
+    self->_lanesCapacity = self->_lanesCapacity > 0
+                               ? self->_lanesCapacity * 2
+                               : kAutomationInitialCapacity;
+    self->lanes = (AutomationLaneMembers *)realloc(
+        self->lanes, self->_lanesCapacity * sizeof(AutomationLaneMembers));
+  }
+
+  lane = &(self->lanes[self->numLanes++]);
+  lane->pluginIndex = pluginIndex;
+  lane->parameterIndex = parameterIndex;
+  lane->points = (AutomationPoint *)malloc(kAutomationInitialCapacity *
+                                           sizeof(AutomationPoint));
+  lane->numPoints = 0;
+  lane->_capacity = kAutomationInitialCapacity;
+  lane->_cursor = 0;
+  lane->_lastValue = 0.0f;
+  lane->_hasLastValue = false;
+  return lane;
+}
+
+void pluginAutomationAddPoint(PluginAutomation self,
+                              const unsigned int pluginIndex,
+                              const unsigned int parameterIndex,
+                              const unsigned long frame, const float value,
+                              const AutomationInterpolation interpolation) {
+  AutomationLane lane = _getLane(self, pluginIndex, parameterIndex);
+  size_t index = lane->numPoints;
+
+  if (lane->numPoints == lane->_capacity) {
+    lane->_capacity *= 2;
+    lane->points = (AutomationPoint *)realloc(
+        lane->points, lane->_capacity * sizeof(AutomationPoint));
+  }
+
+  // Points at the same frame are kept in the order they were added
+  while (index > 0 && lane->points[index - 1].frame > frame) {
+    index--;
+  }
+
+  memmove(lane->points + index + 1, lane->points + index,
+          (lane->numPoints - index) * sizeof(AutomationPoint));
+  lane->points[index].frame = frame;
+  lane->points[index].value = value;
+  lane->points[index].interpolation = interpolation;
+  lane->numPoints++;
+}
+
+static boolByte _readBinaryAutomation(PluginAutomation self, const byte *data,
+                                      const size_t size) {
+  const byte *record;
+  unsigned int frame;
+  unsigned short pluginIndex;
+  unsigned short parameterIndex;
+  float value;
+  size_t i, numRecords;
+
+  if ((size - sizeof(kAutomationBinaryMagic)) % kAutomationBinaryRecordSize !=
+      0) {
+    logError("Binary automation file has a partial record");
+    return false;
+  }
+
+  numRecords =
+      (size - sizeof(kAutomationBinaryMagic)) / kAutomationBinaryRecordSize;
+
+  for (i = 0; i < numRecords; i++) {
+    record = data + sizeof(kAutomationBinaryMagic) +
+             i * kAutomationBinaryRecordSize;
+    memcpy(&frame, record, sizeof(frame));
+    memcpy(&pluginIndex, record + 4, sizeof(pluginIndex));
+    memcpy(&parameterIndex, record + 6, sizeof(parameterIndex));
+    memcpy(&value, record + 8, sizeof(value));
+
+    if (record[12] > AUTOMATION_INTERPOLATION_LINEAR) {
+      logError("Automation record %lu has invalid interpolation type %d",
+               (unsigned long)i, record[12]);
+      return false;
+    }
+
+    pluginAutomationAddPoint(
+        self, convertBigEndianShortToPlatform(pluginIndex),
+        convertBigEndianShortToPlatform(parameterIndex),
+        convertBigEndianIntToPlatform(frame),
+        convertBigEndianFloatToPlatform(value),
+        (AutomationInterpolation)record[12]);
+  }
+
+  return true;
+}
+
+static boolByte _readTextAutomationLine(PluginAutomation self, char *line,
+                                        const unsigned long lineNumber) {
+  unsigned long frame;
+  unsigned int pluginIndex;
+  unsigned int parameterIndex;
+  float value;
+  char interpolationName[16] = "step";
+  AutomationInterpolation interpolation;
+  int numFields;
+  char *start = line;
+
+  while (*start == ' ' || *start == '\t') {
+    start++;
+  }
+
+  if (*start == '\0' || *start == '#') {
+    return true;
+  }
+
+  numFields = sscanf(start, "%lu,%u,%u,%f,%15s", &frame, &pluginIndex,
+                     &parameterIndex, &value, interpolationName);
+
+  if (numFields < 4) {
+    logError("Malformed automation on line %lu, expected "
+             "'frame,plugin,parameter,value[,step|linear]'",
+             lineNumber);
+    return false;
+  }
+
+  if (!strcmp(interpolationName, "step")) {
+    interpolation = AUTOMATION_INTERPOLATION_STEP;
+  } else if (!strcmp(interpolationName, "linear")) {
+    interpolation = AUTOMATION_INTERPOLATION_LINEAR;
+  } else {
+    logError("Unknown automation interpolation '%s' on line %lu",
+             interpolationName, lineNumber);
+    return false;
+  }
+
+  pluginAutomationAddPoint(self, pluginIndex, parameterIndex, frame, value,
+                           interpolation);
+  return true;
+}
+
+static boolByte _readTextAutomation(PluginAutomation self, const byte *data,
+                                    const size_t size) {
+  char line[AUTOMATION_TEXT_LINE_LENGTH];
+  unsigned long lineNumber = 0;
+  size_t lineStart = 0;
+  size_t lineEnd;
+  size_t lineLength;
+
+  while (lineStart < size) {
+    lineNumber++;
+    lineEnd = lineStart;
+
+    while (lineEnd < size && data[lineEnd] != '\n') {
+      lineEnd++;
+    }
+
+    lineLength = lineEnd - lineStart;
+
+    if (lineLength > 0 && data[lineEnd - 1] == '\r') {
+      lineLength--;
+    }
+
+    if (lineLength >= AUTOMATION_TEXT_LINE_LENGTH) {
+      logError("Automation line %lu is too long", lineNumber);
+      return false;
+    }
+
+    memcpy(line, data + lineStart, lineLength);
+    line[lineLength] = '\0';
+
+    if (!_readTextAutomationLine(self, line, lineNumber)) {
+      return false;
+    }
+
+    lineStart = lineEnd + 1;
+  }
+
+  return true;
+}
+
+boolByte pluginAutomationReadFile(PluginAutomation self,
+                                  const CharString filename) {
+  File file = newFileWithPath(filename);
+  const byte *data;
+  size_t size = 0;
+  boolByte result;
+
+  if (!fileExists(file)) {
+    logError("Automation file '%s' does not exist", filename->data);
+    freeFile(file);
+    return false;
+  }
+
+  data = (const byte *)fileMapContents(file, &size);
+
+  if (data == NULL) {
+    if (fileGetSize(file) > 0) {
+      logError("Could not read automation file '%s'", filename->data);
+      freeFile(file);
+      return false;
+    }
+
+    // An empty file is valid, it just doesn't automate anything
+    freeFile(file);
+    return true;
+  }
+
+  if (size >= sizeof(kAutomationBinaryMagic) &&
+      !memcmp(data, kAutomationBinaryMagic, sizeof(kAutomationBinaryMagic))) {
+    result = _readBinaryAutomation(self, data, size);
+  } else {
+    result = _readTextAutomation(self, data, size);
+  }
+
+  fileUnmapContents(data, size);
+  freeFile(file);
+
+  if (result) {
+    logInfo("Read %lu automation lanes from '%s'",
+            (unsigned long)self->numLanes, filename->data);
+  }
+
+  return result;
+}
+
+// Returns true if the lane is ramping from the point before its cursor to the
+// one at the cursor
+static boolByte _isRamping(const AutomationLane lane) {
+  return (boolByte)(lane->_cursor > 0 && lane->_cursor < lane->numPoints &&
+                    lane->points[lane->_cursor].interpolation ==
+                        AUTOMATION_INTERPOLATION_LINEAR);
+}
+
+void pluginAutomationApply(PluginAutomation self, const unsigned long frame,
+                           Plugin *plugins, const unsigned int numPlugins) {
+  AutomationLane lane;
+  const AutomationPoint *previous;
+  const AutomationPoint *next;
+  Plugin plugin;
+  float value;
+  size_t i;
+
+  for (i = 0; i < self->numLanes; i++) {
+    lane = &(self->lanes[i]);
+
+    while (lane->_cursor < lane->numPoints &&
+           lane->points[lane->_cursor].frame <= frame) {
+      lane->_cursor++;
+    }
+
+    // Nothing to do until the first point is reached
+    if (lane->_cursor == 0 || lane->pluginIndex >= numPlugins) {
+      continue;
+    }
+
+    previous = &(lane->points[lane->_cursor - 1]);
+
+    if (_isRamping(lane)) {
+      next = &(lane->points[lane->_cursor]);
+      value = previous->value +
+              (next->value - previous->value) *
+                  (float)((double)(frame - previous->frame) /
+                          (double)(next->frame - previous->frame));
+    } else {
+      value = previous->value;
+    }
+
+    if (!lane->_hasLastValue || value != lane->_lastValue) {
+      plugin = plugins[lane->pluginIndex];
+      pluginSetParameterQuietly(plugin, lane->parameterIndex, value);
+      lane->_lastValue = value;
+      lane->_hasLastValue = true;
+    }
+  }
+}
+
+unsigned long pluginAutomationGetNextChangeFrame(PluginAutomation self,
+                                                 const unsigned long frame) {
+  unsigned long nextFrame = ULONG_MAX;
+  unsigned long laneFrame;
+  AutomationLane lane;
+  size_t i;
+
+  for (i = 0; i < self->numLanes; i++) {
+    lane = &(self->lanes[i]);
+
+    if (lane->_cursor >= lane->numPoints) {
+      continue;
+    }
+
+    laneFrame = lane->points[lane->_cursor].frame;
+
+    if (_isRamping(lane) && self->controlRate > 0) {
+      // Ramps are updated on a fixed grid, independent of the blocksize
+      if ((frame / self->controlRate + 1) * self->controlRate < laneFrame) {
+        laneFrame = (frame / self->controlRate + 1) * self->controlRate;
+      }
+    }
+
+    if (laneFrame < nextFrame) {
+      nextFrame = laneFrame;
+    }
+  }
+
+  return nextFrame;
+}
+
+void pluginAutomationRewind(PluginAutomation self) {
+  size_t i;
+
+  for (i = 0; i < self->numLanes; i++) {
+    self->lanes[i]._cursor = 0;
+    self->lanes[i]._hasLastValue = false;
+  }
+}
+
+void freePluginAutomation(PluginAutomation self) {
+  size_t i;
+
+  if (self != NULL) {
+    for (i = 0; i < self->numLanes; i++) {
+      free(self->lanes[i].points);
+    }
+
+    free(self->lanes);
+    free(self);
+  }
+}
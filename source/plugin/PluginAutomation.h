@@ -0,0 +1,153 @@
+//
+// PluginAutomation.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginAutomation_h
+#define MrsWatson_PluginAutomation_h
+
+#include "base/CharString.h"
+#include "plugin/Plugin.h"
+
+#include <stddef.h>
+
+// Number of frames between parameter updates while a linear ramp is active
+#define DEFAULT_AUTOMATION_CONTROL_RATE 64
+
+typedef enum {
+  // Jump to the point's value at its frame
+  AUTOMATION_INTERPOLATION_STEP,
+  // Ramp linearly from the previous point's value to this one
+  AUTOMATION_INTERPOLATION_LINEAR
+} AutomationInterpolation;
+
+typedef struct {
+  unsigned long frame;
+  float value;
+  AutomationInterpolation interpolation;
+} AutomationPoint;
+
+typedef struct {
+  unsigned int pluginIndex;
+  unsigned int parameterIndex;
+  // Points are kept sorted by frame
+  AutomationPoint *points;
+  size_t numPoints;
+
+  // Private fields
+  size_t _capacity;
+  size_t _cursor;
+  float _lastValue;
+  boolByte _hasLastValue;
+} AutomationLaneMembers;
+typedef AutomationLaneMembers *AutomationLane;
+
+/**
+ * Holds time-stamped parameter changes for any plugins in a chain, with one
+ * lane for each automated parameter. During processing, the chain asks for the
+ * next frame where a parameter changes, and splits the block there so that
+ * changes are applied with sample accuracy.
+ */
+typedef struct {
+  AutomationLaneMembers *lanes;
+  size_t numLanes;
+  unsigned long controlRate;
+
+  // Private fields
+  size_t _lanesCapacity;
+} PluginAutomationMembers;
+typedef PluginAutomationMembers *PluginAutomation;
+
+/**
+ * Create a new automation object with no lanes
+ * @return PluginAutomation object
+ */
+PluginAutomation newPluginAutomation(void);
+
+/**
+ * Add a point to the lane for a given parameter, creating the lane if needed.
+ * Points may be added in any order, though adding them in order is fastest.
+ * @param self
+ * @param pluginIndex Index of the plugin in the chain
+ * @param parameterIndex Index of the parameter in the plugin
+ * @param frame Position of the point, in sample frames
+ * @param value Parameter value, which is usually between 0.0 and 1.0
+ * @param interpolation How the value is reached from the previous point
+ */
+void pluginAutomationAddPoint(PluginAutomation self,
+                              const unsigned int pluginIndex,
+                              const unsigned int parameterIndex,
+                              const unsigned long frame, const float value,
+                              const AutomationInterpolation interpolation);
+
+/**
+ * Read automation points from a file. Files starting with the binary magic
+ * number are read as binary records, otherwise the file is read as text with
+ * one point per line, in the form:
+ *
+ * frame,plugin,parameter,value[,step|linear]
+ *
+ * Blank lines and lines starting with '#' are ignored.
+ * @param self
+ * @param filename Path to the automation file
+ * @return True if the file was read, false otherwise
+ */
+boolByte pluginAutomationReadFile(PluginAutomation self,
+                                  const CharString filename);
+
+/**
+ * Set the parameters of each plugin to their values at a given frame. Only
+ * values which have changed since the last call are sent to the plugins.
+ * @param self
+ * @param frame Position in sample frames, which must not be before the
+ * position given in the last call
+ * @param plugins Plugins in the chain
+ * @param numPlugins Number of plugins in the chain
+ */
+void pluginAutomationApply(PluginAutomation self, const unsigned long frame,
+                           Plugin *plugins, const unsigned int numPlugins);
+
+/**
+ * Get the next frame after the one last passed to pluginAutomationApply() at
+ * which any parameter changes.
+ * @param self
+ * @param frame Frame passed to the last call to pluginAutomationApply()
+ * @return Position of the next change, or ULONG_MAX if there are no more
+ */
+unsigned long pluginAutomationGetNextChangeFrame(PluginAutomation self,
+                                                 const unsigned long frame);
+
+/**
+ * Move back to the start of the automation, so that it can be applied again
+ * @param self
+ */
+void pluginAutomationRewind(PluginAutomation self);
+
+/**
+ * Free an automation object and all of its lanes
+ * @param self
+ */
+void freePluginAutomation(PluginAutomation self);
+
+#endif
@@ -27,12 +27,30 @@
 #include "PluginChain.h"
 
 #include "audio/AudioSettings.h"
+#include "base/PlatformInfo.h"
 #include "logging/EventLogger.h"
+#include "logging/TraceLogger.h"
+#include "midi/MidiEvent.h"
+#include "plugin/PluginSandbox.h"
+#include "time/AudioClock.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if UNIX
+#include <pthread.h>
+#elif WINDOWS
+#include <Windows.h>
+#endif
+
+// Most threads which may process the branches of a split at once
+#define MAX_BRANCH_THREADS 16
+
+// Defined along with the processing of the graph below
+static void *_newPluginChainBranchWorkers(const int numThreads);
+static void _freePluginChainBranchWorkers(void *workersPtr);
+
 PluginChain pluginChainInstance = NULL;
 
 PluginChain getPluginChain(void) { return pluginChainInstance; }
@@ -41,6 +59,8 @@ void initPluginChain(void) {
   pluginChainInstance = (PluginChain)malloc(sizeof(PluginChainMembers));
 
   pluginChainInstance->numPlugins = 0;
+  pluginChainInstance->numSkippedBlocks = 0;
+  pluginChainInstance->graph = NULL;
   pluginChainInstance->plugins = (Plugin *)malloc(sizeof(Plugin) * MAX_PLUGINS);
   pluginChainInstance->presets =
       (PluginPreset *)malloc(sizeof(PluginPreset) * MAX_PLUGINS);
@@ -51,17 +71,52 @@ void initPluginChain(void) {
 
   pluginChainInstance->_realtime = false;
   pluginChainInstance->_realtimeTimer = NULL;
+  pluginChainInstance->_automation = NULL;
+  pluginChainInstance->_pendingMidiEvents = NULL;
+  pluginChainInstance->_segmentMidiEvents = NULL;
+  pluginChainInstance->_firstPlugin = 0;
+  pluginChainInstance->_stageOutputFunc = NULL;
+  pluginChainInstance->_stageOutputUserData = NULL;
+  pluginChainInstance->_skipSilence = false;
+  pluginChainInstance->_hasTailTime = false;
+  pluginChainInstance->_silenceWindowInFrames = 0;
+  pluginChainInstance->_silentInputFrames = 0;
+  pluginChainInstance->_silentOutputFrames = 0;
+  pluginChainInstance->_receivedMidi = false;
+  pluginChainInstance->_channelMaps =
+      (ChannelMap *)calloc(MAX_PLUGINS + 1, sizeof(ChannelMap));
+  pluginChainInstance->_sandboxTimeoutInMs = 0;
+  pluginChainInstance->_branchWorkers = NULL;
 }
 
 boolByte pluginChainAppend(PluginChain self, Plugin plugin,
                            PluginPreset preset) {
+  boolByte result;
+
   if (plugin == NULL) {
     return false;
+  } else if (self->graph != NULL) {
+    logError("Could not add plugin '%s', the chain already has a graph",
+             plugin->pluginName->data);
+    return false;
   } else if (self->numPlugins + 1 >= MAX_PLUGINS) {
     logError("Could not add plugin '%s', maximum number reached",
              plugin->pluginName->data);
     return false;
-  } else if (!openPlugin(plugin)) {
+  }
+
+  // Only VST plugins are sandboxed, since internal plugins are part of the
+  // host anyways
+  if (self->_sandboxTimeoutInMs > 0 &&
+      plugin->interfaceType == PLUGIN_TYPE_VST_2X) {
+    plugin = newPluginSandbox(plugin, self->_sandboxTimeoutInMs);
+  }
+
+  traceLoggerBeginEvent("init", plugin->pluginName->data);
+  result = openPlugin(plugin);
+  traceLoggerEndEvent();
+
+  if (!result) {
     return false;
   } else {
     self->plugins[self->numPlugins] = plugin;
@@ -75,6 +130,67 @@ boolByte pluginChainAppend(PluginChain self, Plugin plugin,
   }
 }
 
+// Parse a graph string, and append its plugins in the order of their indexes
+static boolByte
+_pluginChainAddGraphFromArgumentString(PluginChain self,
+                                       const CharString argumentString,
+                                       const CharString userSearchPath) {
+  LinkedList pluginStrings = newLinkedList();
+  PluginGraph graph = newPluginGraph(argumentString, pluginStrings);
+  LinkedListIterator iterator;
+  CharString pluginString;
+  char *presetSeparator;
+  CharString presetName;
+  PluginPreset preset;
+  Plugin plugin;
+  boolByte result = (boolByte)(graph != NULL);
+
+  if (result && self->numPlugins > 0) {
+    logError("A plugin graph cannot be added to a chain with other plugins");
+    result = false;
+  }
+
+  for (iterator = pluginStrings; result && iterator != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    pluginString = (CharString)iterator->item;
+    preset = NULL;
+    presetSeparator =
+        strchr(pluginString->data, CHAIN_STRING_PROGRAM_SEPARATOR);
+
+    if (presetSeparator != NULL) {
+      *presetSeparator = '\0';
+      presetName = newCharStringWithCString(presetSeparator + 1);
+      logInfo("Opening preset '%s' for plugin", presetName->data);
+      preset = pluginPresetFactory(presetName);
+      freeCharString(presetName);
+    }
+
+    traceLoggerBeginEvent("init", "Find plugin");
+    plugin = pluginFactory(pluginString, userSearchPath);
+    traceLoggerEndEvent();
+
+    // Unlike in serial chains, plugins which are not found cannot be left out
+    // since the graph refers to the others by their index
+    if (plugin == NULL || !pluginChainAppend(self, plugin, preset)) {
+      logError("Plugin '%s' could not be added to the graph",
+               pluginString->data);
+      freePluginPreset(preset);
+      result = false;
+    }
+  }
+
+  if (result && !pluginChainSetGraph(self, graph)) {
+    result = false;
+  }
+
+  if (!result) {
+    freePluginGraph(graph);
+  }
+
+  freeLinkedListAndItems(pluginStrings, (LinkedListFreeItemFunc)freeCharString);
+  return result;
+}
+
 boolByte pluginChainAddFromArgumentString(PluginChain pluginChain,
                                           const CharString argumentString,
                                           const CharString userSearchPath) {
@@ -94,6 +210,9 @@ boolByte pluginChainAddFromArgumentString(PluginChain pluginChain,
   if (charStringIsEmpty(argumentString)) {
     logWarn("Plugin chain string is empty");
     return false;
+  } else if (pluginGraphIsGraphString(argumentString)) {
+    return _pluginChainAddGraphFromArgumentString(pluginChain, argumentString,
+                                                  userSearchPath);
   }
 
   substringStart = argumentString->data;
@@ -134,7 +253,9 @@ boolByte pluginChainAddFromArgumentString(PluginChain pluginChain,
     }
 
     // Guess the plugin type from the file extension, search root, etc.
+    traceLoggerBeginEvent("init", "Find plugin");
     plugin = pluginFactory(pluginNameBuffer, userSearchPath);
+    traceLoggerEndEvent();
 
     if (plugin != NULL) {
       if (!pluginChainAppend(pluginChain, plugin, preset)) {
@@ -161,7 +282,10 @@ boolByte pluginChainAddFromArgumentString(PluginChain pluginChain,
 }
 
 static boolByte _loadPresetForPlugin(Plugin plugin, PluginPreset preset) {
-  if (pluginPresetIsCompatibleWith(preset, plugin)) {
+  // The preset must be loaded by the process which holds the plugin
+  if (plugin->interfaceType == PLUGIN_TYPE_SANDBOX) {
+    return pluginSandboxLoadPreset(plugin, preset);
+  } else if (pluginPresetIsCompatibleWith(preset, plugin)) {
     if (!preset->openPreset(preset)) {
       logError("Could not open preset '%s'", preset->presetName->data);
       return false;
@@ -186,6 +310,7 @@ static boolByte _loadPresetForPlugin(Plugin plugin, PluginPreset preset) {
 ReturnCode pluginChainInitialize(PluginChain pluginChain) {
   Plugin plugin;
   PluginPreset preset;
+  boolByte presetLoaded;
   unsigned int i;
 
   for (i = 0; i < pluginChain->numPlugins; i++) {
@@ -212,7 +337,11 @@ ReturnCode pluginChainInitialize(PluginChain pluginChain) {
       preset = pluginChain->presets[i];
 
       if (preset != NULL) {
-        if (!_loadPresetForPlugin(plugin, preset)) {
+        traceLoggerBeginEvent("init", "Load preset");
+        presetLoaded = _loadPresetForPlugin(plugin, preset);
+        traceLoggerEndEvent();
+
+        if (!presetLoaded) {
           return RETURN_CODE_INVALID_ARGUMENT;
         }
       }
@@ -222,6 +351,28 @@ ReturnCode pluginChainInitialize(PluginChain pluginChain) {
   return RETURN_CODE_SUCCESS;
 }
 
+boolByte pluginChainLoadPreset(PluginChain self, const unsigned int index,
+                               PluginPreset preset) {
+  boolByte result;
+
+  if (preset == NULL) {
+    return false;
+  } else if (index >= self->numPlugins) {
+    logError("Cannot load preset into plugin %u, chain only has %u plugins",
+             index, self->numPlugins);
+    freePluginPreset(preset);
+    return false;
+  }
+
+  freePluginPreset(self->presets[index]);
+  self->presets[index] = preset;
+
+  traceLoggerBeginEvent("process", "Load preset");
+  result = _loadPresetForPlugin(self->plugins[index], preset);
+  traceLoggerEndEvent();
+  return result;
+}
+
 void pluginChainInspect(PluginChain pluginChain) {
   Plugin plugin;
   unsigned int i;
@@ -240,6 +391,27 @@ void pluginChainPrepareForProcessing(PluginChain self) {
     plugin = self->plugins[i];
     plugin->prepareForProcessing(plugin);
   }
+
+  if (self->_automation != NULL) {
+    pluginAutomationRewind(self->_automation);
+  }
+
+  if (self->graph != NULL) {
+    pluginGraphReset(self->graph);
+  }
+
+  self->_silentInputFrames = 0;
+  self->_silentOutputFrames = 0;
+}
+
+void pluginChainSuspend(PluginChain self) {
+  Plugin plugin;
+  unsigned int i;
+
+  for (i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+    plugin->suspend(plugin);
+  }
 }
 
 int pluginChainGetMaximumTailTimeInMs(PluginChain pluginChain) {
@@ -264,6 +436,10 @@ unsigned long pluginChainGetProcessingDelay(PluginChain self) {
   unsigned long processingDelay = 0;
   unsigned int i;
 
+  if (self->graph != NULL) {
+    return pluginGraphGetDelay(self->graph, self->plugins);
+  }
+
   for (i = 0; i < self->numPlugins; i++) {
     Plugin plugin = self->plugins[i];
     processingDelay += plugin->getSetting(plugin, PLUGIN_INITIAL_DELAY);
@@ -272,6 +448,19 @@ unsigned long pluginChainGetProcessingDelay(PluginChain self) {
   return processingDelay;
 }
 
+unsigned long pluginChainGetStageDelay(PluginChain self,
+                                       const unsigned int index) {
+  unsigned long stageDelay = 0;
+  unsigned int i;
+
+  for (i = 0; i <= index && i < self->numPlugins; i++) {
+    Plugin plugin = self->plugins[i];
+    stageDelay += plugin->getSetting(plugin, PLUGIN_INITIAL_DELAY);
+  }
+
+  return stageDelay;
+}
+
 typedef struct {
   Plugin plugin;
   boolByte success;
@@ -303,7 +492,8 @@ void _pluginChainSetParameter(void *item, void *userData) {
     return;
   }
 
-  *comma = '\0';
+  // Parsing the index stops at the comma, so the string is left untouched for
+  // anything else which reads the parameters
   index = (int)strtod(parameterValue, NULL);
   value = (float)strtod(comma + 1, NULL);
   logDebug("Set parameter %d to %f", index, value);
@@ -320,6 +510,112 @@ boolByte pluginChainSetParameters(PluginChain self,
   return passData.success;
 }
 
+boolByte pluginChainSetAutomation(PluginChain self,
+                                  PluginAutomation automation) {
+  size_t i;
+
+  for (i = 0; i < automation->numLanes; i++) {
+    if (automation->lanes[i].pluginIndex >= self->numPlugins) {
+      logError("Automation refers to plugin %d, but the chain only has %d "
+               "plugins",
+               automation->lanes[i].pluginIndex, self->numPlugins);
+      return false;
+    }
+  }
+
+  freePluginAutomation(self->_automation);
+  self->_automation = automation;
+
+  if (self->_segmentMidiEvents == NULL) {
+    self->_segmentMidiEvents = newLinkedList();
+  }
+
+  return true;
+}
+
+boolByte pluginChainSetGraph(PluginChain self, PluginGraph graph) {
+  CharString description;
+
+  if (graph->numPlugins != self->numPlugins) {
+    logError("Plugin graph has %d plugins, but the chain has %d",
+             graph->numPlugins, self->numPlugins);
+    return false;
+  }
+
+  description = pluginGraphDescribe(graph);
+  logDebug("Processing plugins along the graph '%s'", description->data);
+  freeCharString(description);
+
+  freePluginGraph(self->graph);
+  self->graph = graph;
+  return true;
+}
+
+void pluginChainSetParallelBranches(PluginChain self,
+                                    const boolByte parallelBranches) {
+  int numThreads = parallelBranches ? platformInfoGetNumProcessors() : 1;
+
+  if (numThreads > MAX_BRANCH_THREADS) {
+    numThreads = MAX_BRANCH_THREADS;
+  }
+
+  _freePluginChainBranchWorkers(self->_branchWorkers);
+  self->_branchWorkers = NULL;
+
+  if (numThreads > 1) {
+    self->_branchWorkers = _newPluginChainBranchWorkers(numThreads);
+  }
+}
+
+void pluginChainSetFirstPlugin(PluginChain self, const unsigned int index) {
+  self->_firstPlugin = index < self->numPlugins ? index : self->numPlugins;
+}
+
+void pluginChainSetStageOutputCallback(
+    PluginChain self, PluginChainStageOutputFunc stageOutputFunc,
+    void *userData) {
+  self->_stageOutputFunc = stageOutputFunc;
+  self->_stageOutputUserData = userData;
+}
+
+void pluginChainSetSkipSilence(PluginChain self, const boolByte skipSilence) {
+  const int tailTimeInMs = pluginChainGetMaximumTailTimeInMs(self);
+  const unsigned long tailTimeInFrames =
+      (unsigned long)(tailTimeInMs * getSampleRate() / 1000.0);
+
+  self->_skipSilence = skipSilence;
+  self->_hasTailTime = (boolByte)(tailTimeInMs > 0);
+  self->_silenceWindowInFrames =
+      tailTimeInFrames + pluginChainGetProcessingDelay(self);
+
+  // Otherwise a single silent block would be enough to skip the next one
+  if (self->_silenceWindowInFrames < getBlocksize()) {
+    self->_silenceWindowInFrames = getBlocksize();
+  }
+
+  if (skipSilence) {
+    logDebug("Skipping blocks after %lu frames of silence",
+             self->_silenceWindowInFrames);
+  }
+}
+
+unsigned int pluginChainSetDoublePrecision(PluginChain self,
+                                           const boolByte doublePrecision) {
+  unsigned int result = 0;
+  unsigned int i;
+
+  for (i = 0; i < self->numPlugins; i++) {
+    if (pluginSetDoublePrecision(self->plugins[i], doublePrecision) &&
+        doublePrecision) {
+      logDebug("Plugin '%s' processes audio in double precision",
+               self->plugins[i]->pluginName->data);
+      result++;
+    }
+  }
+
+  return result;
+}
+
 void pluginChainSetRealtime(PluginChain self, boolByte realtime) {
   self->_realtime = realtime;
 
@@ -330,32 +626,793 @@ void pluginChainSetRealtime(PluginChain self, boolByte realtime) {
   }
 }
 
-void pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer,
-                             SampleBuffer outBuffer) {
-  Plugin plugin;
+boolByte pluginChainSetSandbox(PluginChain self,
+                               const unsigned long timeoutInMs) {
+  if (!pluginSandboxIsSupported()) {
+    logUnsupportedFeature("Plugin sandboxes");
+    return false;
+  }
+
+  self->_sandboxTimeoutInMs = timeoutInMs;
+  return true;
+}
+
+unsigned int pluginChainGetNumSandboxRestarts(const PluginChain self) {
+  unsigned int result = 0;
   unsigned int i;
-  double processingTimeInMs;
-  double totalProcessingTimeInMs;
-  const double maxProcessingTimeInMs =
-      inBuffer->blocksize * 1000.0 / getSampleRate();
 
-  if (pluginChain->_realtime) {
-    taskTimerStart(pluginChain->_realtimeTimer);
+  for (i = 0; i < self->numPlugins; i++) {
+    if (self->plugins[i]->interfaceType == PLUGIN_TYPE_SANDBOX) {
+      result += pluginSandboxGetNumRestarts(self->plugins[i]);
+    }
+  }
+
+  return result;
+}
+
+boolByte pluginChainSetChannelMap(PluginChain self, const unsigned int index,
+                                  ChannelMap channelMap) {
+  // The map for the output of the chain is kept after the plugin maps, so
+  // that it stays the same when plugins are appended
+  const unsigned int mapIndex = index == self->numPlugins ? MAX_PLUGINS : index;
+  ChannelCount numOutputs;
+
+  if (index > self->numPlugins) {
+    logError("Cannot set channel map for plugin %d, chain only has %d plugins",
+             index, self->numPlugins);
+    return false;
+  }
+
+  if (channelMap != NULL) {
+    numOutputs = index == self->numPlugins
+                     ? getNumChannels()
+                     : self->plugins[index]->inputBuffer->numChannels;
+
+    if (channelMap->numOutputs != numOutputs) {
+      logError("Channel map has %d outputs, but %d channels are needed",
+               channelMap->numOutputs, numOutputs);
+      return false;
+    }
+  }
+
+  freeChannelMap(self->_channelMaps[mapIndex]);
+  self->_channelMaps[mapIndex] = channelMap;
+  return true;
+}
+
+// Copy frames from one buffer to another with the channel map at the given
+// index, or with the default mapping if the map does not fit the buffers
+static void _pluginChainMapChannels(PluginChain self, const unsigned int index,
+                                    SampleBuffer destination,
+                                    const SampleCount destinationOffset,
+                                    const SampleBuffer source,
+                                    const SampleCount sourceOffset,
+                                    const SampleCount numFrames) {
+  ChannelMap channelMap = self->_channelMaps[index];
+
+  if (channelMap == NULL || channelMap->numInputs != source->numChannels ||
+      !channelMapApply(channelMap, destination, destinationOffset, source,
+                       sourceOffset, numFrames)) {
+    sampleBufferCopyAndMapChannelsWithOffset(destination, destinationOffset,
+                                             source, sourceOffset, numFrames);
+  }
+}
+
+// Audio is passed between plugins which both process double precision audio
+// without converting it, unless its channels need to be mapped
+static boolByte _pluginChainCanPassDouble(PluginChain self,
+                                          const unsigned int index,
+                                          const DoubleSampleBuffer source) {
+  return (boolByte)(source != NULL && self->_channelMaps[index] == NULL &&
+                    source->numChannels ==
+                        self->plugins[index]->inputBufferDouble->numChannels);
+}
+
+// Process part of a block with one plugin of a graph, and return the buffer
+// which holds its output
+static SampleBuffer
+_pluginChainProcessGraphPlugin(PluginChain self, const unsigned int index,
+                               const SampleBuffer input,
+                               const SampleCount offset,
+                               const SampleCount numFrames) {
+  Plugin plugin = self->plugins[index];
+
+  plugin->inputBuffer->blocksize = numFrames;
+  plugin->outputBuffer->blocksize = numFrames;
+  _pluginChainMapChannels(self, index, plugin->inputBuffer, 0, input, offset,
+                          numFrames);
+
+  if (pluginIsDoublePrecision(plugin)) {
+    plugin->inputBufferDouble->blocksize = numFrames;
+    plugin->outputBufferDouble->blocksize = numFrames;
+    doubleSampleBufferCopyFromSampleBuffer(plugin->inputBufferDouble,
+                                           plugin->inputBuffer);
+    taskTimerStart(self->audioTimers[index]);
+    plugin->processAudioDouble(plugin, plugin->inputBufferDouble,
+                               plugin->outputBufferDouble);
+    taskTimerStop(self->audioTimers[index]);
+    doubleSampleBufferCopyToSampleBuffer(plugin->outputBufferDouble,
+                                         plugin->outputBuffer);
+  } else {
+    taskTimerStart(self->audioTimers[index]);
+    plugin->processAudio(plugin, plugin->inputBuffer, plugin->outputBuffer);
+    taskTimerStop(self->audioTimers[index]);
+  }
+
+  return plugin->outputBuffer;
+}
+
+static SampleBuffer _pluginChainProcessGraphSplit(PluginChain self,
+                                                  PluginGraphNode split,
+                                                  const SampleBuffer input,
+                                                  const SampleCount offset,
+                                                  const SampleCount numFrames);
+
+// Process part of a block with each node of a branch in turn, and return the
+// buffer which holds the output of the branch, starting at outOffset
+static SampleBuffer
+_pluginChainProcessGraphBranch(PluginChain self, PluginGraphBranch branch,
+                               SampleBuffer input, SampleCount *outOffset,
+                               const SampleCount numFrames) {
+  PluginGraphNode node;
+  unsigned int i;
+
+  for (i = 0; i < branch->numNodes; i++) {
+    node = branch->nodes[i];
+
+    if (node->numBranches == 0) {
+      input = _pluginChainProcessGraphPlugin(self, node->pluginIndex, input,
+                                             *outOffset, numFrames);
+    } else {
+      input = _pluginChainProcessGraphSplit(self, node, input, *outOffset,
+                                            numFrames);
+    }
+
+    *outOffset = 0;
+  }
+
+  return input;
+}
+
+typedef struct {
+  PluginChain chain;
+  PluginGraphNode split;
+  SampleBuffer input;
+  SampleCount offset;
+  SampleCount numFrames;
+  unsigned int firstBranch;
+  unsigned int branchStride;
+} PluginChainBranchTaskMembers;
+typedef PluginChainBranchTaskMembers *PluginChainBranchTask;
+
+// Process the branches of a task, leaving the delayed output of each branch
+// in its output buffer
+static void _pluginChainProcessBranchesForTask(PluginChainBranchTask task) {
+  PluginGraphBranch branch;
+  SampleBuffer branchOutput;
+  SampleCount branchOffset;
+  unsigned int i;
+
+  for (i = task->firstBranch; i < task->split->numBranches;
+       i += task->branchStride) {
+    branch = task->split->branches[i];
+    branchOffset = task->offset;
+    branchOutput = _pluginChainProcessGraphBranch(
+        task->chain, branch, task->input, &branchOffset, task->numFrames);
+    branch->output->blocksize = task->numFrames;
+    sampleBufferCopyAndMapChannelsWithOffset(branch->output, 0, branchOutput,
+                                             branchOffset, task->numFrames);
+    delayLineProcess(branch->delayLine, branch->output);
+  }
+}
+
+// Passed to each worker thread when it is started
+typedef struct {
+  void *workers;
+  int index;
+} PluginChainBranchWorkerArgsMembers;
+
+// Threads which wait for the tasks of each split, and process them along with
+// the thread which processes the graph. They are started once by
+// pluginChainSetParallelBranches(), rather than for every split of every
+// block, which would cost more than processing a small block takes.
+typedef struct {
+  // Number of threads besides the calling thread
+  int numWorkers;
+  PluginChainBranchTaskMembers tasks[MAX_BRANCH_THREADS];
+  // Number of tasks in the current batch, including the caller's task 0
+  int numTasks;
+  // Tasks of the current batch which the workers have not finished yet
+  int numPendingTasks;
+  // Incremented for every batch, so that workers can tell a new one apart
+  unsigned long batch;
+  // Set while a batch is being processed. Splits inside of the branches are
+  // then processed by the thread which reaches them.
+  boolByte isBusy;
+  boolByte isStopping;
+  PluginChainBranchWorkerArgsMembers args[MAX_BRANCH_THREADS];
+#if UNIX
+  pthread_t threads[MAX_BRANCH_THREADS];
+  pthread_mutex_t mutex;
+  pthread_cond_t batchReady;
+  pthread_cond_t batchDone;
+#elif WINDOWS
+  HANDLE threads[MAX_BRANCH_THREADS];
+  CRITICAL_SECTION mutex;
+  CONDITION_VARIABLE batchReady;
+  CONDITION_VARIABLE batchDone;
+#endif
+} PluginChainBranchWorkersMembers;
+typedef PluginChainBranchWorkersMembers *PluginChainBranchWorkers;
+
+#if UNIX
+static void _pluginChainLockWorkers(PluginChainBranchWorkers self) {
+  pthread_mutex_lock(&self->mutex);
+}
+
+static void _pluginChainUnlockWorkers(PluginChainBranchWorkers self) {
+  pthread_mutex_unlock(&self->mutex);
+}
+#elif WINDOWS
+static void _pluginChainLockWorkers(PluginChainBranchWorkers self) {
+  EnterCriticalSection(&self->mutex);
+}
+
+static void _pluginChainUnlockWorkers(PluginChainBranchWorkers self) {
+  LeaveCriticalSection(&self->mutex);
+}
+#endif
+
+#if UNIX || WINDOWS
+// Wait for a new batch, and process the worker's task in it if there is one
+static void _pluginChainRunBranchWorker(PluginChainBranchWorkers self,
+                                        const int index) {
+  unsigned long lastBatch = 0;
+  char threadName[kCharStringLengthShort];
+
+  snprintf(threadName, kCharStringLengthShort, "Branch worker %d", index);
+  traceLoggerSetThreadName(threadName);
+  _pluginChainLockWorkers(self);
+
+  while (true) {
+    while (!self->isStopping && self->batch == lastBatch) {
+#if UNIX
+      pthread_cond_wait(&self->batchReady, &self->mutex);
+#elif WINDOWS
+      SleepConditionVariableCS(&self->batchReady, &self->mutex, INFINITE);
+#endif
+    }
+
+    if (self->isStopping) {
+      break;
+    }
+
+    lastBatch = self->batch;
+
+    if (index < self->numTasks) {
+      _pluginChainUnlockWorkers(self);
+      _pluginChainProcessBranchesForTask(&self->tasks[index]);
+      _pluginChainLockWorkers(self);
+
+      if (--self->numPendingTasks == 0) {
+#if UNIX
+        pthread_cond_signal(&self->batchDone);
+#elif WINDOWS
+        WakeConditionVariable(&self->batchDone);
+#endif
+      }
+    }
+  }
+
+  _pluginChainUnlockWorkers(self);
+}
+#endif
+
+#if UNIX
+static void *_pluginChainBranchThread(void *argsPtr) {
+  PluginChainBranchWorkerArgsMembers *args =
+      (PluginChainBranchWorkerArgsMembers *)argsPtr;
+  _pluginChainRunBranchWorker((PluginChainBranchWorkers)args->workers,
+                              args->index);
+  return NULL;
+}
+#elif WINDOWS
+static DWORD WINAPI _pluginChainBranchThread(LPVOID argsPtr) {
+  PluginChainBranchWorkerArgsMembers *args =
+      (PluginChainBranchWorkerArgsMembers *)argsPtr;
+  _pluginChainRunBranchWorker((PluginChainBranchWorkers)args->workers,
+                              args->index);
+  return 0;
+}
+#endif
+
+// Start up to numThreads - 1 workers. Returns NULL if none could be started,
+// in which case the branches are processed one after another.
+static void *_newPluginChainBranchWorkers(const int numThreads) {
+#if UNIX || WINDOWS
+  PluginChainBranchWorkers self = (PluginChainBranchWorkers)malloc(
+      sizeof(PluginChainBranchWorkersMembers));
+  int t;
+
+  self->numWorkers = 0;
+  self->numTasks = 0;
+  self->numPendingTasks = 0;
+  self->batch = 0;
+  self->isBusy = false;
+  self->isStopping = false;
+#if UNIX
+  pthread_mutex_init(&self->mutex, NULL);
+  pthread_cond_init(&self->batchReady, NULL);
+  pthread_cond_init(&self->batchDone, NULL);
+#elif WINDOWS
+  InitializeCriticalSection(&self->mutex);
+  InitializeConditionVariable(&self->batchReady);
+  InitializeConditionVariable(&self->batchDone);
+#endif
+
+  // Task 0 belongs to the calling thread, so worker t takes task t
+  for (t = 1; t < numThreads; t++) {
+    self->args[t].workers = self;
+    self->args[t].index = t;
+#if UNIX
+    if (pthread_create(&self->threads[t], NULL, _pluginChainBranchThread,
+                       &self->args[t]) != 0) {
+      break;
+    }
+#elif WINDOWS
+    self->threads[t] = CreateThread(NULL, 0, _pluginChainBranchThread,
+                                    &self->args[t], 0, NULL);
+
+    if (self->threads[t] == NULL) {
+      break;
+    }
+#endif
+    self->numWorkers++;
+  }
+
+  if (self->numWorkers < numThreads - 1) {
+    logWarn("Could only start %d of %d threads to process branches",
+            self->numWorkers + 1, numThreads);
+  }
+
+  return self;
+#else
+  return NULL;
+#endif
+}
+
+static void _freePluginChainBranchWorkers(void *workersPtr) {
+#if UNIX || WINDOWS
+  PluginChainBranchWorkers self = (PluginChainBranchWorkers)workersPtr;
+  int t;
+
+  if (self == NULL) {
+    return;
+  }
+
+  _pluginChainLockWorkers(self);
+  self->isStopping = true;
+#if UNIX
+  pthread_cond_broadcast(&self->batchReady);
+#elif WINDOWS
+  WakeAllConditionVariable(&self->batchReady);
+#endif
+  _pluginChainUnlockWorkers(self);
+
+  for (t = 1; t <= self->numWorkers; t++) {
+#if UNIX
+    pthread_join(self->threads[t], NULL);
+#elif WINDOWS
+    WaitForSingleObject(self->threads[t], INFINITE);
+    CloseHandle(self->threads[t]);
+#endif
+  }
+
+#if UNIX
+  pthread_cond_destroy(&self->batchDone);
+  pthread_cond_destroy(&self->batchReady);
+  pthread_mutex_destroy(&self->mutex);
+#elif WINDOWS
+  DeleteCriticalSection(&self->mutex);
+#endif
+  free(self);
+#endif
+}
+
+// Process the tasks of a split with the workers, where the calling thread
+// takes task 0 and then waits for the others to be finished
+static void _pluginChainRunBranchTasks(PluginChainBranchWorkers self,
+                                       const int numTasks) {
+#if UNIX || WINDOWS
+  _pluginChainLockWorkers(self);
+  self->numTasks = numTasks;
+  self->numPendingTasks = numTasks - 1;
+  self->isBusy = true;
+  self->batch++;
+#if UNIX
+  pthread_cond_broadcast(&self->batchReady);
+#elif WINDOWS
+  WakeAllConditionVariable(&self->batchReady);
+#endif
+  _pluginChainUnlockWorkers(self);
+
+  _pluginChainProcessBranchesForTask(&self->tasks[0]);
+
+  _pluginChainLockWorkers(self);
+
+  while (self->numPendingTasks > 0) {
+#if UNIX
+    pthread_cond_wait(&self->batchDone, &self->mutex);
+#elif WINDOWS
+    SleepConditionVariableCS(&self->batchDone, &self->mutex, INFINITE);
+#endif
+  }
+
+  self->isBusy = false;
+  _pluginChainUnlockWorkers(self);
+#endif
+}
+
+// Process part of a block with each branch of a split, and return the buffer
+// which holds the sum of their outputs
+static SampleBuffer _pluginChainProcessGraphSplit(PluginChain self,
+                                                  PluginGraphNode split,
+                                                  const SampleBuffer input,
+                                                  const SampleCount offset,
+                                                  const SampleCount numFrames) {
+  PluginChainBranchWorkers workers =
+      (PluginChainBranchWorkers)self->_branchWorkers;
+  PluginChainBranchTaskMembers serialTask;
+  PluginChainBranchTask tasks = &serialTask;
+  int numThreads = 1;
+  unsigned long splitDelay = 0;
+  unsigned long branchDelay;
+  Samples branchSamples;
+  Samples mixSamples;
+  unsigned int i;
+  ChannelCount j;
+  SampleCount k;
+  int t;
+
+  // Branches which are shorter than the longest one are delayed by the
+  // difference, so that all of them line up when they are summed
+  for (i = 0; i < split->numBranches; i++) {
+    branchDelay = pluginGraphGetBranchDelay(split->branches[i], self->plugins);
+
+    if (branchDelay > splitDelay) {
+      splitDelay = branchDelay;
+    }
   }
 
+  for (i = 0; i < split->numBranches; i++) {
+    delayLineSetDelay(split->branches[i]->delayLine,
+                      splitDelay - pluginGraphGetBranchDelay(
+                                       split->branches[i], self->plugins));
+  }
+
+  // Splits inside of a branch which is being processed in parallel are
+  // processed by the thread which reaches them
+  if (workers != NULL && !workers->isBusy) {
+    tasks = workers->tasks;
+    numThreads = workers->numWorkers + 1;
+  }
+
+  if (numThreads > (int)split->numBranches) {
+    numThreads = (int)split->numBranches;
+  }
+
+  for (t = 0; t < numThreads; t++) {
+    tasks[t].chain = self;
+    tasks[t].split = split;
+    tasks[t].input = input;
+    tasks[t].offset = offset;
+    tasks[t].numFrames = numFrames;
+    tasks[t].firstBranch = (unsigned int)t;
+    tasks[t].branchStride = (unsigned int)numThreads;
+  }
+
+  if (numThreads > 1) {
+    _pluginChainRunBranchTasks(workers, numThreads);
+  } else {
+    _pluginChainProcessBranchesForTask(&tasks[0]);
+  }
+
+  split->mixBuffer->blocksize = numFrames;
+  sampleBufferClear(split->mixBuffer);
+
+  for (i = 0; i < split->numBranches; i++) {
+    for (j = 0; j < split->mixBuffer->numChannels; j++) {
+      branchSamples = split->branches[i]->output->samples[j];
+      mixSamples = split->mixBuffer->samples[j];
+
+      for (k = 0; k < numFrames; k++) {
+        mixSamples[k] += branchSamples[k];
+      }
+    }
+  }
+
+  return split->mixBuffer;
+}
+
+// Process part of a block along the graph of the chain
+static void _pluginChainProcessGraph(PluginChain self, SampleBuffer inBuffer,
+                                     SampleBuffer outBuffer,
+                                     const SampleCount offset,
+                                     const SampleCount numFrames) {
+  SampleCount graphOffset = offset;
+  SampleBuffer graphOutput = _pluginChainProcessGraphBranch(
+      self, self->graph->root, inBuffer, &graphOffset, numFrames);
+
+  _pluginChainMapChannels(self, MAX_PLUGINS, outBuffer, offset, graphOutput,
+                          graphOffset, numFrames);
+}
+
+// Process part of a block through each plugin in the chain. Each plugin
+// receives the frames starting at offset in its own buffers, starting at 0.
+static void _pluginChainProcessFrames(PluginChain pluginChain,
+                                      SampleBuffer inBuffer,
+                                      SampleBuffer outBuffer,
+                                      const SampleCount offset,
+                                      const SampleCount numFrames) {
+  Plugin plugin;
+  unsigned int i;
+
   SampleBuffer formerOutputBuffer = inBuffer;
+  SampleCount formerOffset = offset;
   SampleBuffer nextInputBuffer = NULL;
+  // Output of the former plugin if it processed double precision audio. Its
+  // single precision output is only filled in when it is needed.
+  DoubleSampleBuffer formerDoubleBuffer = NULL;
+  boolByte formerOutputIsStale = false;
+
+  if (pluginChain->graph != NULL) {
+    _pluginChainProcessGraph(pluginChain, inBuffer, outBuffer, offset,
+                             numFrames);
+    return;
+  }
 
-  for (i = 0; i < pluginChain->numPlugins; i++) {
+  for (i = pluginChain->_firstPlugin; i < pluginChain->numPlugins; i++) {
     plugin = pluginChain->plugins[i];
     logDebug("Processing audio with plugin '%s'", plugin->pluginName->data);
     nextInputBuffer = plugin->inputBuffer;
-    nextInputBuffer->blocksize = formerOutputBuffer->blocksize;
-    sampleBufferCopyAndMapChannels(nextInputBuffer, formerOutputBuffer);
+    nextInputBuffer->blocksize = numFrames;
     plugin->outputBuffer->blocksize = plugin->inputBuffer->blocksize;
-    taskTimerStart(pluginChain->audioTimers[i]);
-    plugin->processAudio(plugin, plugin->inputBuffer, plugin->outputBuffer);
-    processingTimeInMs = taskTimerStop(pluginChain->audioTimers[i]);
+
+    if (pluginIsDoublePrecision(plugin)) {
+      plugin->inputBufferDouble->blocksize = numFrames;
+      plugin->outputBufferDouble->blocksize = numFrames;
+
+      if (_pluginChainCanPassDouble(pluginChain, i, formerDoubleBuffer)) {
+        doubleSampleBufferCopy(plugin->inputBufferDouble, formerDoubleBuffer);
+      } else {
+        if (formerOutputIsStale) {
+          doubleSampleBufferCopyToSampleBuffer(formerDoubleBuffer,
+                                               formerOutputBuffer);
+        }
+
+        _pluginChainMapChannels(pluginChain, i, nextInputBuffer, 0,
+                                formerOutputBuffer, formerOffset, numFrames);
+        doubleSampleBufferCopyFromSampleBuffer(plugin->inputBufferDouble,
+                                               nextInputBuffer);
+      }
+
+      taskTimerStart(pluginChain->audioTimers[i]);
+      plugin->processAudioDouble(plugin, plugin->inputBufferDouble,
+                                 plugin->outputBufferDouble);
+      taskTimerStop(pluginChain->audioTimers[i]);
+      formerDoubleBuffer = plugin->outputBufferDouble;
+      formerOutputIsStale = true;
+    } else {
+      if (formerOutputIsStale) {
+        doubleSampleBufferCopyToSampleBuffer(formerDoubleBuffer,
+                                             formerOutputBuffer);
+      }
+
+      _pluginChainMapChannels(pluginChain, i, nextInputBuffer, 0,
+                              formerOutputBuffer, formerOffset, numFrames);
+      taskTimerStart(pluginChain->audioTimers[i]);
+      plugin->processAudio(plugin, plugin->inputBuffer, plugin->outputBuffer);
+      taskTimerStop(pluginChain->audioTimers[i]);
+      formerDoubleBuffer = NULL;
+      formerOutputIsStale = false;
+    }
+
+    formerOutputBuffer = plugin->outputBuffer;
+    formerOffset = 0;
+
+    if (pluginChain->_stageOutputFunc != NULL) {
+      if (formerOutputIsStale) {
+        doubleSampleBufferCopyToSampleBuffer(formerDoubleBuffer,
+                                             formerOutputBuffer);
+        formerOutputIsStale = false;
+      }
+
+      pluginChain->_stageOutputFunc(pluginChain->_stageOutputUserData, i,
+                                    plugin->outputBuffer);
+    }
+  }
+
+  if (formerOutputIsStale) {
+    doubleSampleBufferCopyToSampleBuffer(formerDoubleBuffer,
+                                         formerOutputBuffer);
+  }
+
+  _pluginChainMapChannels(pluginChain, MAX_PLUGINS, outBuffer, offset,
+                          formerOutputBuffer, formerOffset, numFrames);
+}
+
+static void _pluginChainSendMidi(PluginChain pluginChain,
+                                 LinkedList midiEvents) {
+  Plugin plugin;
+
+  // The output of a skipped head plugin is already in the input
+  if (midiEvents->item != NULL && pluginChain->_firstPlugin == 0) {
+    logDebug("Processing plugin chain MIDI events");
+    // Right now, we only process MIDI in the first plugin in the chain
+    // TODO: Is this really the correct behavior? How do other sequencers do it?
+    plugin = pluginChain->plugins[0];
+    taskTimerStart(pluginChain->midiTimers[0]);
+    plugin->processMidiEvents(plugin, midiEvents);
+    taskTimerStop(pluginChain->midiTimers[0]);
+  }
+}
+
+// Send the pending MIDI events which fall in part of a block, with their
+// offsets made relative to the start of that part
+static void _pluginChainSendSegmentMidi(PluginChain pluginChain,
+                                        const SampleCount offset,
+                                        const SampleCount numFrames) {
+  LinkedListIterator iterator;
+  MidiEvent midiEvent;
+
+  linkedListClear(pluginChain->_segmentMidiEvents);
+
+  for (iterator = pluginChain->_pendingMidiEvents; iterator != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    midiEvent = (MidiEvent)iterator->item;
+
+    if (midiEvent != NULL && midiEvent->deltaFrames >= offset &&
+        midiEvent->deltaFrames < offset + numFrames) {
+      midiEvent->deltaFrames -= offset;
+      linkedListAppend(pluginChain->_segmentMidiEvents, midiEvent);
+    }
+  }
+
+  _pluginChainSendMidi(pluginChain, pluginChain->_segmentMidiEvents);
+
+  for (iterator = pluginChain->_segmentMidiEvents; iterator != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    if (iterator->item != NULL) {
+      ((MidiEvent)iterator->item)->deltaFrames += offset;
+    }
+  }
+}
+
+// Process a block in parts, splitting it wherever an automated parameter
+// changes. Blocks without any changes are processed in one piece.
+static void _pluginChainProcessAutomated(PluginChain pluginChain,
+                                         SampleBuffer inBuffer,
+                                         SampleBuffer outBuffer) {
+  PluginAutomation automation = pluginChain->_automation;
+  AudioClock audioClock = getAudioClock();
+  const unsigned long blockStart = audioClock->currentFrame;
+  const SampleCount blocksize = inBuffer->blocksize;
+  SampleCount offset = 0;
+  SampleCount numFrames;
+  unsigned long nextChange;
+
+  outBuffer->blocksize = blocksize;
+
+  while (offset < blocksize) {
+    pluginAutomationApply(automation, blockStart + offset,
+                          pluginChain->plugins, pluginChain->numPlugins);
+    nextChange =
+        pluginAutomationGetNextChangeFrame(automation, blockStart + offset);
+
+    if (nextChange < blockStart + blocksize) {
+      numFrames = (SampleCount)(nextChange - blockStart) - offset;
+    } else {
+      numFrames = blocksize - offset;
+    }
+
+    // Plugins which ask for the transport position during a part of the block
+    // should see the position of that part, rather than the block's start
+    if (offset > 0) {
+      audioClock->currentFrame = blockStart + offset;
+      audioClockUpdateTransport(audioClock);
+    }
+
+    if (pluginChain->_pendingMidiEvents != NULL) {
+      if (offset == 0 && numFrames == blocksize) {
+        _pluginChainSendMidi(pluginChain, pluginChain->_pendingMidiEvents);
+      } else {
+        _pluginChainSendSegmentMidi(pluginChain, offset, numFrames);
+      }
+    }
+
+    _pluginChainProcessFrames(pluginChain, inBuffer, outBuffer, offset,
+                              numFrames);
+    offset += numFrames;
+  }
+
+  // The clock is advanced by whole blocks after the chain has processed them
+  if (audioClock->currentFrame != blockStart) {
+    audioClock->currentFrame = blockStart;
+    audioClockUpdateTransport(audioClock);
+  }
+
+  pluginChain->_pendingMidiEvents = NULL;
+}
+
+// Called for blocks with silent input, to check if the chain's output is
+// known to be silent as well
+static boolByte _pluginChainCanSkipBlock(PluginChain pluginChain) {
+  if (pluginChain->_silentOutputFrames >= pluginChain->_silenceWindowInFrames) {
+    return true;
+  }
+
+  // Without a reported tail time, it is unknown when the tail has passed
+  if (!pluginChain->_hasTailTime) {
+    return false;
+  }
+
+  // An instrument makes sound without any input, so only its output counts
+  if (pluginChain->_firstPlugin < pluginChain->numPlugins &&
+      pluginChain->plugins[pluginChain->_firstPlugin]->pluginType ==
+          PLUGIN_TYPE_INSTRUMENT) {
+    return false;
+  }
+
+  return (boolByte)(pluginChain->_silentInputFrames >=
+                    pluginChain->_silenceWindowInFrames);
+}
+
+// Produce silence for a block without calling any plugins. Stages receive
+// silence as well, so that their output stays aligned with the input.
+static void _pluginChainSkipBlock(PluginChain pluginChain,
+                                  const SampleBuffer inBuffer,
+                                  SampleBuffer outBuffer) {
+  unsigned int i;
+
+  outBuffer->blocksize = inBuffer->blocksize;
+  sampleBufferClear(outBuffer);
+  pluginChain->_pendingMidiEvents = NULL;
+  pluginChain->numSkippedBlocks++;
+
+  if (pluginChain->_stageOutputFunc != NULL) {
+    for (i = pluginChain->_firstPlugin; i < pluginChain->numPlugins; i++) {
+      pluginChain->_stageOutputFunc(pluginChain->_stageOutputUserData, i,
+                                    outBuffer);
+    }
+  }
+}
+
+// Group the timing of each plugin's processing, so that a block which is split
+// into several parts is still measured as a whole
+static void _pluginChainBeginBlockTiming(PluginChain pluginChain) {
+  unsigned int i;
+
+  for (i = 0; i < pluginChain->numPlugins; i++) {
+    taskTimerBeginGroup(pluginChain->audioTimers[i]);
+  }
+}
+
+// Compare the time each plugin spent on the whole block against the time
+// which the block lasts
+static void _pluginChainEndBlockTiming(PluginChain pluginChain,
+                                       const SampleCount blocksize) {
+  Plugin plugin;
+  unsigned int i;
+  double processingTimeInMs;
+  const double maxProcessingTimeInMs = blocksize * 1000.0 / getSampleRate();
+
+  for (i = 0; i < pluginChain->numPlugins; i++) {
+    plugin = pluginChain->plugins[i];
+    processingTimeInMs = taskTimerEndGroup(pluginChain->audioTimers[i]);
+
+    if (i < pluginChain->_firstPlugin) {
+      continue;
+    }
 
     if (processingTimeInMs > maxProcessingTimeInMs && pluginChain->_realtime) {
       logWarn(
@@ -367,13 +1424,55 @@ void pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer,
                plugin->pluginName->data, (int)processingTimeInMs,
                (int)(processingTimeInMs / maxProcessingTimeInMs));
     }
+  }
+}
 
-    formerOutputBuffer = plugin->outputBuffer;
+void pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer,
+                             SampleBuffer outBuffer) {
+  double totalProcessingTimeInMs;
+  const double maxProcessingTimeInMs =
+      inBuffer->blocksize * 1000.0 / getSampleRate();
+  boolByte isInputSilent = false;
+
+  if (pluginChain->_realtime) {
+    taskTimerStart(pluginChain->_realtimeTimer);
+  }
+
+  if (pluginChain->_skipSilence) {
+    isInputSilent = (boolByte)(!pluginChain->_receivedMidi &&
+                               sampleBufferIsSilent(inBuffer));
+    pluginChain->_receivedMidi = false;
+  }
+
+  if (isInputSilent && _pluginChainCanSkipBlock(pluginChain)) {
+    _pluginChainSkipBlock(pluginChain, inBuffer, outBuffer);
+  } else {
+    _pluginChainBeginBlockTiming(pluginChain);
+
+    if (pluginChain->_automation != NULL) {
+      _pluginChainProcessAutomated(pluginChain, inBuffer, outBuffer);
+    } else {
+      outBuffer->blocksize = inBuffer->blocksize;
+      _pluginChainProcessFrames(pluginChain, inBuffer, outBuffer, 0,
+                                inBuffer->blocksize);
+    }
+
+    _pluginChainEndBlockTiming(pluginChain, inBuffer->blocksize);
   }
 
-  nextInputBuffer = outBuffer;
-  nextInputBuffer->blocksize = formerOutputBuffer->blocksize;
-  sampleBufferCopyAndMapChannels(nextInputBuffer, formerOutputBuffer);
+  if (pluginChain->_skipSilence) {
+    if (isInputSilent) {
+      pluginChain->_silentInputFrames += inBuffer->blocksize;
+    } else {
+      pluginChain->_silentInputFrames = 0;
+    }
+
+    if (sampleBufferIsSilent(outBuffer)) {
+      pluginChain->_silentOutputFrames += outBuffer->blocksize;
+    } else {
+      pluginChain->_silentOutputFrames = 0;
+    }
+  }
 
   if (pluginChain->_realtime) {
     totalProcessingTimeInMs = taskTimerStop(pluginChain->_realtimeTimer);
@@ -384,17 +1483,45 @@ void pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer,
   }
 }
 
-void pluginChainProcessMidi(PluginChain pluginChain, LinkedList midiEvents) {
+boolByte pluginChainCanProcessOffline(const PluginChain self) {
+  // Offline plugins read the input themselves, so nothing may need to happen
+  // to the audio between them and the chain's input and output
+  return (boolByte)(self->numPlugins == 1 && self->graph == NULL &&
+                    self->_firstPlugin == 0 &&
+                    self->plugins[0]->processOffline != NULL &&
+                    !self->_realtime && self->_automation == NULL &&
+                    self->_channelMaps[0] == NULL &&
+                    self->_channelMaps[MAX_PLUGINS] == NULL);
+}
+
+boolByte pluginChainProcessOffline(PluginChain self, OfflineSession session) {
   Plugin plugin;
+  boolByte result;
+
+  if (!pluginChainCanProcessOffline(self)) {
+    logInternalError("Plugin chain cannot process audio offline");
+    return false;
+  }
+
+  plugin = self->plugins[0];
+  logDebug("Processing audio offline with plugin '%s'",
+           plugin->pluginName->data);
+  taskTimerStart(self->audioTimers[0]);
+  result = plugin->processOffline(plugin, session);
+  taskTimerStop(self->audioTimers[0]);
+  return result;
+}
 
+void pluginChainProcessMidi(PluginChain pluginChain, LinkedList midiEvents) {
   if (midiEvents->item != NULL) {
-    logDebug("Processing plugin chain MIDI events");
-    // Right now, we only process MIDI in the first plugin in the chain
-    // TODO: Is this really the correct behavior? How do other sequencers do it?
-    plugin = pluginChain->plugins[0];
-    taskTimerStart(pluginChain->midiTimers[0]);
-    plugin->processMidiEvents(plugin, midiEvents);
-    taskTimerStop(pluginChain->midiTimers[0]);
+    pluginChain->_receivedMidi = true;
+  }
+
+  if (pluginChain->_automation != NULL) {
+    // Sent in pluginChainProcessAudio(), once the block has been split
+    pluginChain->_pendingMidiEvents = midiEvents;
+  } else {
+    _pluginChainSendMidi(pluginChain, midiEvents);
   }
 }
 
@@ -425,10 +1552,25 @@ void freePluginChain(PluginChain pluginChain) {
     free(pluginChain->audioTimers);
     free(pluginChain->midiTimers);
 
+    for (i = 0; i <= MAX_PLUGINS; i++) {
+      freeChannelMap(pluginChain->_channelMaps[i]);
+    }
+
+    free(pluginChain->_channelMaps);
+
     if (pluginChain->_realtime) {
       freeTaskTimer(pluginChain->_realtimeTimer);
     }
 
+    _freePluginChainBranchWorkers(pluginChain->_branchWorkers);
+    freePluginAutomation(pluginChain->_automation);
+    freeLinkedList(pluginChain->_segmentMidiEvents);
+    freePluginGraph(pluginChain->graph);
+
+    if (pluginChain == pluginChainInstance) {
+      pluginChainInstance = NULL;
+    }
+
     free(pluginChain);
   }
 }
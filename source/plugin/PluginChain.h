@@ -28,8 +28,11 @@
 #define MrsWatson_PluginChain_h
 
 #include "app/ReturnCodes.h"
+#include "audio/ChannelMap.h"
 #include "base/LinkedList.h"
 #include "plugin/Plugin.h"
+#include "plugin/PluginAutomation.h"
+#include "plugin/PluginGraph.h"
 #include "plugin/PluginPreset.h"
 #include "time/TaskTimer.h"
 
@@ -37,21 +40,64 @@
 #define CHAIN_STRING_PLUGIN_SEPARATOR ';'
 #define CHAIN_STRING_PROGRAM_SEPARATOR ','
 
+/**
+ * Called with the output of a plugin each time it has processed audio.
+ * @param userData User data given when setting the callback
+ * @param index Index of the plugin in the chain
+ * @param output Output of the plugin. When automation splits a block, this is
+ * called once for each part of the block.
+ */
+typedef void (*PluginChainStageOutputFunc)(void *userData,
+                                           const unsigned int index,
+                                           const SampleBuffer output);
+
 typedef struct {
   unsigned int numPlugins;
   Plugin *plugins;
   PluginPreset *presets;
   TaskTimer *audioTimers;
   TaskTimer *midiTimers;
+  // Number of blocks which were not processed because they were silent
+  unsigned long numSkippedBlocks;
+  // Routing of audio between the plugins, or NULL to process them in serial
+  PluginGraph graph;
 
   // Private fields
   boolByte _realtime;
   TaskTimer _realtimeTimer;
+  PluginAutomation _automation;
+  // With automation, MIDI events are held until the block is processed so
+  // that they can be sent along with the part of the block they belong to
+  LinkedList _pendingMidiEvents;
+  LinkedList _segmentMidiEvents;
+  // Plugins before this index are not processed, because the input already
+  // contains their output
+  unsigned int _firstPlugin;
+  PluginChainStageOutputFunc _stageOutputFunc;
+  void *_stageOutputUserData;
+  boolByte _skipSilence;
+  boolByte _hasTailTime;
+  // Number of frames which silent input or output must last for before a
+  // block may be skipped
+  unsigned long _silenceWindowInFrames;
+  unsigned long _silentInputFrames;
+  unsigned long _silentOutputFrames;
+  boolByte _receivedMidi;
+  // Channel maps for the input of each plugin, where the last one is for the
+  // output of the chain. NULL entries use the default channel mapping.
+  ChannelMap *_channelMaps;
+  // Time which sandboxed plugins may take to respond, or 0 if VST plugins are
+  // loaded in this process
+  unsigned long _sandboxTimeoutInMs;
+  // Threads which process the branches of a split along with the calling
+  // thread, or NULL to process them one after another
+  void *_branchWorkers;
 } PluginChainMembers;
 
 /**
- * Class which holds multiple plugins which process audio in serial. Only one
- * instrument may be present in a plugin chain.
+ * Class which holds multiple plugins which process audio in serial, or along
+ * the branches of a plugin graph. Only one instrument may be present in a
+ * plugin chain.
  */
 typedef PluginChainMembers *PluginChain;
 
@@ -74,16 +120,43 @@ void initPluginChain(void);
  * @param plugin Plugin to add
  * @param preset Preset to be loaded into the plugin. If no preset is desired,
  * passed NULL here.
- * @return True if the plugin could be added to the end of the chain
+ * @return True if the plugin could be added to the end of the chain, false if
+ * it could not be opened or the chain already has a graph
  */
 boolByte pluginChainAppend(PluginChain self, Plugin plugin,
                            PluginPreset preset);
 
 // TODO: Deprecate and remove this function
+// Strings with splits are parsed as a graph, see newPluginGraph()
 boolByte pluginChainAddFromArgumentString(PluginChain self,
                                           const CharString argumentString,
                                           const CharString userSearchPath);
 
+/**
+ * Process the plugins in the chain along the branches of a graph, instead of
+ * one after another. All plugins must have been appended to the chain before,
+ * in the order of the plugin indexes in the graph. Plugins which are first in
+ * the chain, stage output callbacks and offline processing are not supported
+ * for graphs, and are ignored.
+ * @param self
+ * @param graph Graph to use, which will be freed with the chain
+ * @return False if the graph does not have as many plugins as the chain, in
+ * which case the caller still owns the graph
+ */
+boolByte pluginChainSetGraph(PluginChain self, PluginGraph graph);
+
+/**
+ * Process the branches of each split in the plugin graph at the same time on
+ * separate threads, with up to one thread per processor. Note that some
+ * plugins may not be safe to use from several threads at once, even when each
+ * thread uses its own instance.
+ * @param self
+ * @param parallelBranches True to process branches in parallel, false to
+ * process them one after another (default)
+ */
+void pluginChainSetParallelBranches(PluginChain self,
+                                    const boolByte parallelBranches);
+
 /**
  * Open and initialize all plugins in the chain.
  * @param self
@@ -91,6 +164,19 @@ boolByte pluginChainAddFromArgumentString(PluginChain self,
  */
 ReturnCode pluginChainInitialize(PluginChain self);
 
+/**
+ * Load a preset into a plugin which is already in an initialized chain,
+ * replacing any preset which was loaded before. This should be called while
+ * the plugin is suspended, so that it starts with a clean state afterwards.
+ * @param self
+ * @param index Index of the plugin in the chain
+ * @param preset Preset to load. The chain takes ownership of the preset, even
+ * if it could not be loaded.
+ * @return True if the preset was loaded
+ */
+boolByte pluginChainLoadPreset(PluginChain self, const unsigned int index,
+                               PluginPreset preset);
+
 /**
  * Inspect each plugin in the chain
  * @param self
@@ -107,12 +193,24 @@ void pluginChainInspect(PluginChain self);
 int pluginChainGetMaximumTailTimeInMs(PluginChain self);
 
 /**
- * Get the total processing delay in frames.
+ * Get the total processing delay in frames. For a graph, this is the delay of
+ * its longest path, which the other paths are delayed to line up with.
  * @param self
  * @return Total processing delay, in frames.
  */
 unsigned long pluginChainGetProcessingDelay(PluginChain self);
 
+/**
+ * Get the processing delay of the output of one plugin, which is the sum of
+ * the initial delays of that plugin and all plugins before it. This is only
+ * meaningful for chains which process their plugins in serial.
+ * @param self
+ * @param index Index of the plugin
+ * @return Processing delay of the plugin's output, in frames
+ */
+unsigned long pluginChainGetStageDelay(PluginChain self,
+                                       const unsigned int index);
+
 /**
  * Set parameters on the first plugin in a chain.
  * @param self
@@ -122,6 +220,104 @@ unsigned long pluginChainGetProcessingDelay(PluginChain self);
 boolByte pluginChainSetParameters(PluginChain self,
                                   const LinkedList parameters);
 
+/**
+ * Set parameter automation to apply while processing. Blocks are split at
+ * each change, so that parameters are set at exactly the right frame.
+ * @param self
+ * @param automation Automation to apply, which will be freed with the chain
+ * @return True if the automation was set, false if it refers to a plugin which
+ * is not in the chain
+ */
+boolByte pluginChainSetAutomation(PluginChain self,
+                                  PluginAutomation automation);
+
+/**
+ * Skip the first plugins in the chain when processing. This is used when the
+ * input has already been processed by these plugins, so only the rest of the
+ * chain needs to run. The skipped plugins receive neither audio nor MIDI, but
+ * they still count towards the chain's processing delay, since the input
+ * includes their delay.
+ * @param self
+ * @param index Index of the first plugin to process. If this is the number of
+ * plugins in the chain, the input is passed through unchanged.
+ */
+void pluginChainSetFirstPlugin(PluginChain self, const unsigned int index);
+
+/**
+ * Set a function which receives the output of each plugin while processing.
+ * @param self
+ * @param stageOutputFunc Function to call, or NULL to stop calling it
+ * @param userData User data to pass to the function
+ */
+void pluginChainSetStageOutputCallback(
+    PluginChain self, PluginChainStageOutputFunc stageOutputFunc,
+    void *userData);
+
+/**
+ * Skip processing of silent blocks. A block is skipped when its input is
+ * silent, no MIDI events were sent for it, and either the tail time of the
+ * chain has passed since the last block with input, or the output of the
+ * chain has been silent for that long. Skipped blocks produce silent output
+ * without calling any plugins. Plugins which report no tail time are only
+ * skipped once their output is silent, since many plugins do not report it.
+ * This should be called after the chain is initialized.
+ * @param self
+ * @param skipSilence True to skip silent blocks, false to disable (default)
+ */
+void pluginChainSetSkipSilence(PluginChain self, const boolByte skipSilence);
+
+/**
+ * Load VST plugins which are added to the chain in a sandbox process, so that
+ * a crashing plugin does not take down the host. This must be called before
+ * any plugins are added to the chain.
+ * @param self
+ * @param timeoutInMs Time which the plugins may take for any call before they
+ * are considered to be hung and restarted
+ * @return False if sandboxes are not supported on this platform
+ */
+boolByte pluginChainSetSandbox(PluginChain self,
+                               const unsigned long timeoutInMs);
+
+/**
+ * Get the number of times that sandboxed plugins in the chain crashed or hung
+ * and had to be restarted. Each of these means that some of the output was
+ * replaced with silence.
+ * @param self
+ * @return Number of restarts for all plugins in the chain
+ */
+unsigned int pluginChainGetNumSandboxRestarts(const PluginChain self);
+
+/**
+ * Set the channel map used to route audio into a plugin. The map must have as
+ * many outputs as the plugin has inputs, and is used whenever the audio which
+ * the plugin receives has as many channels as the map has inputs. Otherwise
+ * the channels are up- or downmixed with the default gains. This should be
+ * called after the chain is initialized.
+ * @param self
+ * @param index Index of the plugin in the chain, or the number of plugins to
+ * set the map used for the output of the chain
+ * @param channelMap Channel map, which the chain takes ownership of. Pass NULL
+ * to return to the default mapping.
+ * @return False if the index is out of range or the map does not have the
+ * right number of outputs, in which case the caller still owns the map
+ */
+boolByte pluginChainSetChannelMap(PluginChain self, const unsigned int index,
+                                  ChannelMap channelMap);
+
+/**
+ * Process audio in double precision with each plugin in the chain which
+ * supports it. Audio is passed between such plugins without being converted
+ * to single precision, unless it needs to be channel mapped. This should be
+ * called after the chain is initialized and before it is prepared for
+ * processing.
+ * @param self
+ * @param doublePrecision True to enable double precision, false to disable
+ * (default)
+ * @return Number of plugins which process audio in double precision
+ */
+unsigned int pluginChainSetDoublePrecision(PluginChain self,
+                                           const boolByte doublePrecision);
+
 /**
  * Set realtime mode for the plugin chain. When set, calls to
  * pluginChainProcessAudio()
@@ -138,6 +334,14 @@ void pluginChainSetRealtime(PluginChain self, boolByte realtime);
  */
 void pluginChainPrepareForProcessing(PluginChain self);
 
+/**
+ * Suspend processing for each plugin in the chain. This resets the internal
+ * state of plugins which support it, and pluginChainPrepareForProcessing()
+ * must be called again before sending further blocks to the chain.
+ * @param self
+ */
+void pluginChainSuspend(PluginChain self);
+
 /**
  * Process a single block of samples through each plugin in the chain.
  * @param self
@@ -147,6 +351,26 @@ void pluginChainPrepareForProcessing(PluginChain self);
 void pluginChainProcessAudio(PluginChain self, SampleBuffer inBuffer,
                              SampleBuffer outBuffer);
 
+/**
+ * Check if the chain can process an entire input at once with
+ * pluginChainProcessOffline(). This is only possible for a chain with a single
+ * plugin which supports offline processing, when no automation, channel maps
+ * or graph are set and the chain is not in realtime mode.
+ * @param self
+ * @return True if the chain can process audio offline
+ */
+boolByte pluginChainCanProcessOffline(const PluginChain self);
+
+/**
+ * Let the plugin in the chain process an entire input offline, so that it may
+ * read the input in any order and as many times as it needs. The plugin must
+ * have been prepared for processing.
+ * @param self
+ * @param session Session which holds the input, and receives the output
+ * @return True if the input was processed
+ */
+boolByte pluginChainProcessOffline(PluginChain self, OfflineSession session);
+
 /**
  * Send a list of MIDI events to be processed by the chain. Currently, only the
  * first plugin in the chain will receive these events.
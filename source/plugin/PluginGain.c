@@ -74,6 +74,21 @@ static void _pluginGainProcessAudio(void *pluginPtr, SampleBuffer inputs,
   }
 }
 
+static void _pluginGainProcessAudioDouble(void *pluginPtr,
+                                          DoubleSampleBuffer inputs,
+                                          DoubleSampleBuffer outputs) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginGainSettings settings = (PluginGainSettings)plugin->extraData;
+  unsigned long channel, sample;
+
+  for (channel = 0; channel < outputs->numChannels; ++channel) {
+    for (sample = 0; sample < outputs->blocksize; ++sample) {
+      outputs->samples[channel][sample] =
+          inputs->samples[channel][sample] * settings->gain;
+    }
+  }
+}
+
 static void _pluginGainProcessMidiEvents(void *pluginPtr,
                                          LinkedList midiEvents) {
   // Nothing to do here
@@ -107,8 +122,10 @@ Plugin newPluginGain(const CharString pluginName) {
   plugin->displayInfo = _pluginGainDisplayInfo;
   plugin->getSetting = _pluginGainGetSetting;
   plugin->prepareForProcessing = _pluginGainEmpty;
+  plugin->suspend = _pluginGainEmpty;
   plugin->showEditor = _pluginGainEmpty;
   plugin->processAudio = _pluginGainProcessAudio;
+  plugin->processAudioDouble = _pluginGainProcessAudioDouble;
   plugin->processMidiEvents = _pluginGainProcessMidiEvents;
   plugin->setParameter = _pluginGainSetParameter;
   plugin->closePlugin = _pluginGainEmpty;
@@ -0,0 +1,331 @@
+//
+// PluginGraph.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PluginGraph.h"
+
+#include "audio/AudioSettings.h"
+#include "logging/EventLogger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Characters which end a plugin name in a graph string
+static const char kPluginGraphNameTerminators[] = {
+    GRAPH_STRING_PLUGIN_SEPARATOR, GRAPH_STRING_SPLIT_START,
+    GRAPH_STRING_SPLIT_END, GRAPH_STRING_BRANCH_SEPARATOR, '\0'};
+
+typedef struct {
+  const char *start;
+  const char *position;
+  LinkedList pluginStrings;
+  unsigned int numPlugins;
+} PluginGraphParserMembers;
+typedef PluginGraphParserMembers *PluginGraphParser;
+
+static PluginGraphNode _newPluginGraphNode(const unsigned int pluginIndex) {
+  PluginGraphNode self =
+      (PluginGraphNode)malloc(sizeof(PluginGraphNodeMembers));
+
+  self->pluginIndex = pluginIndex;
+  self->numBranches = 0;
+  self->branches = NULL;
+  self->mixBuffer = NULL;
+
+  return self;
+}
+
+static PluginGraphBranch _newPluginGraphBranch(void) {
+  PluginGraphBranch self =
+      (PluginGraphBranch)malloc(sizeof(PluginGraphBranchMembers));
+
+  self->numNodes = 0;
+  self->nodes = NULL;
+  self->output = newSampleBuffer(getNumChannels(), getBlocksize());
+  self->delayLine = newDelayLine(getNumChannels());
+
+  return self;
+}
+
+static void _freePluginGraphBranch(PluginGraphBranch self);
+
+static void _freePluginGraphNode(PluginGraphNode self) {
+  unsigned int i;
+
+  for (i = 0; i < self->numBranches; i++) {
+    _freePluginGraphBranch(self->branches[i]);
+  }
+
+  free(self->branches);
+  freeSampleBuffer(self->mixBuffer);
+  free(self);
+}
+
+static void _freePluginGraphBranch(PluginGraphBranch self) {
+  unsigned int i;
+
+  for (i = 0; i < self->numNodes; i++) {
+    _freePluginGraphNode(self->nodes[i]);
+  }
+
+  free(self->nodes);
+  freeSampleBuffer(self->output);
+  freeDelayLine(self->delayLine);
+  free(self);
+}
+
+static void _pluginGraphParserError(PluginGraphParser parser,
+                                    const char *message) {
+  logError("Malformed plugin graph at character %d: %s",
+           (int)(parser->position - parser->start) + 1, message);
+}
+
+static PluginGraphBranch _parsePluginGraphBranch(PluginGraphParser parser,
+                                                 const boolByte isNested);
+
+static PluginGraphNode _parsePluginGraphPlugin(PluginGraphParser parser) {
+  const size_t length = strcspn(parser->position, kPluginGraphNameTerminators);
+  CharString pluginString;
+
+  if (length == 0) {
+    _pluginGraphParserError(parser, *parser->position == '\0'
+                                        ? "Unexpected end of the graph"
+                                        : "Expected a plugin name");
+    return NULL;
+  }
+
+  if (parser->pluginStrings != NULL) {
+    pluginString = newCharStringWithCapacity(length + 1);
+    strncpy(pluginString->data, parser->position, length);
+    linkedListAppend(parser->pluginStrings, pluginString);
+  }
+
+  parser->position += length;
+  return _newPluginGraphNode(parser->numPlugins++);
+}
+
+// Parse the branches of a split, after its opening bracket
+static PluginGraphNode _parsePluginGraphSplit(PluginGraphParser parser) {
+  PluginGraphNode node = _newPluginGraphNode(0);
+  PluginGraphBranch branch;
+  char separator;
+
+  node->mixBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+
+  do {
+    branch = _parsePluginGraphBranch(parser, true);
+
+    if (branch == NULL) {
+      _freePluginGraphNode(node);
+      return NULL;
+    }
+
+    node->branches = (PluginGraphBranch *)realloc(
+        node->branches, sizeof(PluginGraphBranch) * (node->numBranches + 1));
+    node->branches[node->numBranches++] = branch;
+    // Nested branches always end at a branch separator or the end of the split
+    separator = *parser->position++;
+  } while (separator == GRAPH_STRING_BRANCH_SEPARATOR);
+
+  return node;
+}
+
+static PluginGraphBranch _parsePluginGraphBranch(PluginGraphParser parser,
+                                                 const boolByte isNested) {
+  PluginGraphBranch branch = _newPluginGraphBranch();
+  PluginGraphNode node;
+  char nextChar = *parser->position;
+
+  if (isNested && (nextChar == GRAPH_STRING_BRANCH_SEPARATOR ||
+                   nextChar == GRAPH_STRING_SPLIT_END)) {
+    return branch;
+  }
+
+  while (true) {
+    if (*parser->position == GRAPH_STRING_SPLIT_START) {
+      parser->position++;
+      node = _parsePluginGraphSplit(parser);
+    } else {
+      node = _parsePluginGraphPlugin(parser);
+    }
+
+    if (node == NULL) {
+      _freePluginGraphBranch(branch);
+      return NULL;
+    }
+
+    branch->nodes = (PluginGraphNode *)realloc(
+        branch->nodes, sizeof(PluginGraphNode) * (branch->numNodes + 1));
+    branch->nodes[branch->numNodes++] = node;
+    nextChar = *parser->position;
+
+    if (nextChar == GRAPH_STRING_PLUGIN_SEPARATOR) {
+      parser->position++;
+    } else if (isNested ? (nextChar == GRAPH_STRING_BRANCH_SEPARATOR ||
+                           nextChar == GRAPH_STRING_SPLIT_END)
+                        : nextChar == '\0') {
+      return branch;
+    } else {
+      _pluginGraphParserError(parser, nextChar == '\0'
+                                          ? "Split is not closed"
+                                          : "Expected a plugin separator");
+      _freePluginGraphBranch(branch);
+      return NULL;
+    }
+  }
+}
+
+boolByte pluginGraphIsGraphString(const CharString chainString) {
+  return (boolByte)(chainString != NULL &&
+                    strchr(chainString->data, GRAPH_STRING_SPLIT_START) !=
+                        NULL);
+}
+
+PluginGraph newPluginGraph(const CharString graphString,
+                           LinkedList outPluginStrings) {
+  PluginGraphParserMembers parser;
+  PluginGraphBranch root;
+  PluginGraph self;
+
+  parser.start = graphString->data;
+  parser.position = graphString->data;
+  parser.pluginStrings = outPluginStrings;
+  parser.numPlugins = 0;
+  root = _parsePluginGraphBranch(&parser, false);
+
+  if (root == NULL) {
+    return NULL;
+  }
+
+  self = (PluginGraph)malloc(sizeof(PluginGraphMembers));
+  self->root = root;
+  self->numPlugins = parser.numPlugins;
+  return self;
+}
+
+unsigned long pluginGraphGetBranchDelay(const PluginGraphBranch branch,
+                                        Plugin *plugins) {
+  unsigned long result = 0;
+  unsigned long splitDelay;
+  unsigned long branchDelay;
+  PluginGraphNode node;
+  Plugin plugin;
+  unsigned int i;
+  unsigned int j;
+
+  for (i = 0; i < branch->numNodes; i++) {
+    node = branch->nodes[i];
+
+    if (node->numBranches == 0) {
+      plugin = plugins[node->pluginIndex];
+      result += plugin->getSetting(plugin, PLUGIN_INITIAL_DELAY);
+    } else {
+      splitDelay = 0;
+
+      for (j = 0; j < node->numBranches; j++) {
+        branchDelay = pluginGraphGetBranchDelay(node->branches[j], plugins);
+
+        if (branchDelay > splitDelay) {
+          splitDelay = branchDelay;
+        }
+      }
+
+      result += splitDelay;
+    }
+  }
+
+  return result;
+}
+
+unsigned long pluginGraphGetDelay(const PluginGraph self, Plugin *plugins) {
+  return pluginGraphGetBranchDelay(self->root, plugins);
+}
+
+static void _pluginGraphDescribeBranch(const PluginGraphBranch branch,
+                                       CharString outString) {
+  char separator[2] = {'\0', '\0'};
+  char pluginIndex[16];
+  PluginGraphNode node;
+  unsigned int i;
+  unsigned int j;
+
+  for (i = 0; i < branch->numNodes; i++) {
+    node = branch->nodes[i];
+
+    if (i > 0) {
+      separator[0] = GRAPH_STRING_PLUGIN_SEPARATOR;
+      charStringAppendCString(outString, separator);
+    }
+
+    if (node->numBranches == 0) {
+      snprintf(pluginIndex, sizeof(pluginIndex), "%u", node->pluginIndex);
+      charStringAppendCString(outString, pluginIndex);
+    } else {
+      separator[0] = GRAPH_STRING_SPLIT_START;
+      charStringAppendCString(outString, separator);
+
+      for (j = 0; j < node->numBranches; j++) {
+        if (j > 0) {
+          separator[0] = GRAPH_STRING_BRANCH_SEPARATOR;
+          charStringAppendCString(outString, separator);
+        }
+
+        _pluginGraphDescribeBranch(node->branches[j], outString);
+      }
+
+      separator[0] = GRAPH_STRING_SPLIT_END;
+      charStringAppendCString(outString, separator);
+    }
+  }
+}
+
+CharString pluginGraphDescribe(const PluginGraph self) {
+  CharString result = newCharStringWithCapacity(kCharStringLengthShort);
+  _pluginGraphDescribeBranch(self->root, result);
+  return result;
+}
+
+static void _pluginGraphResetBranch(PluginGraphBranch branch) {
+  unsigned int i;
+  unsigned int j;
+
+  delayLineReset(branch->delayLine);
+
+  for (i = 0; i < branch->numNodes; i++) {
+    for (j = 0; j < branch->nodes[i]->numBranches; j++) {
+      _pluginGraphResetBranch(branch->nodes[i]->branches[j]);
+    }
+  }
+}
+
+void pluginGraphReset(PluginGraph self) { _pluginGraphResetBranch(self->root); }
+
+void freePluginGraph(PluginGraph self) {
+  if (self != NULL) {
+    _freePluginGraphBranch(self->root);
+    free(self);
+  }
+}
@@ -0,0 +1,150 @@
+//
+// PluginGraph.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginGraph_h
+#define MrsWatson_PluginGraph_h
+
+#include "audio/DelayLine.h"
+#include "audio/SampleBuffer.h"
+#include "base/CharString.h"
+#include "base/LinkedList.h"
+#include "plugin/Plugin.h"
+
+// Same as the plugin separator of serial plugin chains
+#define GRAPH_STRING_PLUGIN_SEPARATOR ';'
+#define GRAPH_STRING_SPLIT_START '['
+#define GRAPH_STRING_SPLIT_END ']'
+#define GRAPH_STRING_BRANCH_SEPARATOR '|'
+
+struct PluginGraphBranchMembers;
+
+typedef struct {
+  // Index of the plugin in the chain, only used when the node is not a split
+  unsigned int pluginIndex;
+  // Branches which all receive the input of the node, and whose outputs are
+  // summed together. Nodes without any branches are plugins.
+  unsigned int numBranches;
+  struct PluginGraphBranchMembers **branches;
+  // Receives the sum of the branch outputs while processing
+  SampleBuffer mixBuffer;
+} PluginGraphNodeMembers;
+typedef PluginGraphNodeMembers *PluginGraphNode;
+
+typedef struct PluginGraphBranchMembers {
+  // Nodes which are processed one after another. A branch without nodes
+  // passes its input through unchanged.
+  unsigned int numNodes;
+  PluginGraphNode *nodes;
+  // Receives the output of the branch while processing, after it has been
+  // delayed to line up with the other branches of the split
+  SampleBuffer output;
+  DelayLine delayLine;
+} PluginGraphBranchMembers;
+typedef PluginGraphBranchMembers *PluginGraphBranch;
+
+/**
+ * Describes how audio flows through the plugins of a chain, when it is not
+ * simply processed by each plugin in turn. The input may be split into
+ * several branches, each of them processed by its own plugins, and then
+ * summed back together. Branches with a shorter processing delay than the
+ * others are delayed before they are summed, so that all of them line up.
+ */
+typedef struct {
+  PluginGraphBranch root;
+  // Number of plugin nodes in the graph, which are numbered in the order in
+  // which they appear in the graph string
+  unsigned int numPlugins;
+} PluginGraphMembers;
+typedef PluginGraphMembers *PluginGraph;
+
+/**
+ * Check if a plugin chain string describes a graph, rather than a list of
+ * plugins which are processed in serial
+ * @param chainString Plugin chain string
+ * @return True if the string contains any splits
+ */
+boolByte pluginGraphIsGraphString(const CharString chainString);
+
+/**
+ * Create a plugin graph from a string. Plugins are separated by semicolons as
+ * in a regular plugin chain, and parallel branches are put in square brackets
+ * and separated by vertical bars. An empty branch passes the dry signal
+ * through, and branches may contain further splits. For example, a chain with
+ * a compressor in parallel to the dry signal followed by a limiter would be:
+ *
+ *   [|compressor,preset.fxp];limiter
+ *
+ * Buffers for processing are allocated with the current channel count and
+ * blocksize.
+ * @param graphString Graph string to parse
+ * @param outPluginStrings If not NULL, receives a newly allocated CharString
+ * for each plugin in the graph, in the order of their indexes. These are
+ * the plugin names, followed by the preset name if one was given.
+ * @return Initialized PluginGraph, or NULL if the string is malformed
+ */
+PluginGraph newPluginGraph(const CharString graphString,
+                           LinkedList outPluginStrings);
+
+/**
+ * Get the processing delay of a branch, which is the sum of the delays of its
+ * nodes. The delay of a split is the largest delay of its branches.
+ * @param branch Branch to check
+ * @param plugins Plugins of the chain, indexed by the plugin nodes
+ * @return Processing delay, in frames
+ */
+unsigned long pluginGraphGetBranchDelay(const PluginGraphBranch branch,
+                                        Plugin *plugins);
+
+/**
+ * Get the processing delay of the whole graph
+ * @param self
+ * @param plugins Plugins of the chain, indexed by the plugin nodes
+ * @return Processing delay, in frames
+ */
+unsigned long pluginGraphGetDelay(const PluginGraph self, Plugin *plugins);
+
+/**
+ * Describe the graph with the plugin indexes in place of the plugin names,
+ * for instance "0;[|1];2".
+ * @param self
+ * @return Newly allocated string
+ */
+CharString pluginGraphDescribe(const PluginGraph self);
+
+/**
+ * Replace the audio which is held by the delay lines of the graph with
+ * silence. This should be called when processing starts over.
+ * @param self
+ */
+void pluginGraphReset(PluginGraph self);
+
+/**
+ * Free a plugin graph and all of its buffers
+ * @param self
+ */
+void freePluginGraph(PluginGraph self);
+
+#endif
@@ -89,6 +89,7 @@ Plugin newPluginPassthru(const CharString pluginName) {
   plugin->displayInfo = _pluginPassthruDisplayInfo;
   plugin->getSetting = _pluginPassthruGetSetting;
   plugin->prepareForProcessing = _pluginPassthruEmpty;
+  plugin->suspend = _pluginPassthruEmpty;
   plugin->showEditor = _pluginPassthruEmpty;
   plugin->processAudio = _pluginPassthruProcessAudio;
   plugin->processMidiEvents = _pluginPassthruProcessMidiEvents;
@@ -0,0 +1,806 @@
+//
+// PluginSandbox.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+// Must be declared before stdlib for anonymous shared memory mappings,
+// shouldn't have any effect on other platforms
+#define _DEFAULT_SOURCE
+
+#include "PluginSandbox.h"
+
+#include "audio/AudioSettings.h"
+#include "logging/EventLogger.h"
+#include "logging/TraceLogger.h"
+#include "midi/MidiEvent.h"
+#include "time/AudioClock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if LINUX
+#include <errno.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SANDBOX_MAX_CHANNELS 32
+#define SANDBOX_MAX_MIDI_EVENTS 1024
+#define SANDBOX_MAX_PRESET_NAME_LENGTH 1024
+
+// Interval at which a waiting host checks whether the sandbox process exited
+static const long kPluginSandboxPollIntervalInMs = 50;
+// After this many restarts the plugin is considered broken, and only produces
+// silence for the rest of the run
+static const unsigned int kPluginSandboxMaxRestarts = 3;
+
+// Plugin which is run by this process, which is only set in sandbox processes
+static Plugin sandboxChildPlugin = NULL;
+
+typedef enum {
+  kPluginSandboxCommandOpen,
+  kPluginSandboxCommandDisplayInfo,
+  kPluginSandboxCommandGetSetting,
+  kPluginSandboxCommandProcessAudio,
+  kPluginSandboxCommandProcessMidiEvents,
+  kPluginSandboxCommandSetParameter,
+  kPluginSandboxCommandSetParameterQuietly,
+  kPluginSandboxCommandPrepareForProcessing,
+  kPluginSandboxCommandSuspend,
+  kPluginSandboxCommandLoadPreset,
+  kPluginSandboxCommandClose
+} PluginSandboxCommand;
+
+// Memory which is shared between the host and the sandbox process. Each call
+// fills in the command and its arguments, and posts the request semaphore.
+// The sandbox process then runs the command and posts the response semaphore.
+// Since the semaphores are futexes on Linux, neither side enters the kernel
+// unless it actually has to wait.
+typedef struct {
+  sem_t requestSemaphore;
+  sem_t responseSemaphore;
+  PluginSandboxCommand command;
+  // Setting or parameter index
+  int argument;
+  float value;
+  int result;
+
+  // Plugin properties, which are filled in when the plugin is opened
+  PluginType pluginType;
+  ChannelCount numInputs;
+  ChannelCount numOutputs;
+
+  // Copies of the host's settings and transport for the current block
+  AudioSettingsMembers audioSettings;
+  AudioClockMembers audioClock;
+  SampleCount numFrames;
+
+  unsigned int numMidiEvents;
+  MidiEventMembers midiEvents[SANDBOX_MAX_MIDI_EVENTS];
+  char presetName[SANDBOX_MAX_PRESET_NAME_LENGTH];
+} PluginSandboxSharedMembers;
+typedef PluginSandboxSharedMembers *PluginSandboxShared;
+
+typedef struct {
+  unsigned int index;
+  float value;
+} PluginSandboxParameterMembers;
+typedef PluginSandboxParameterMembers *PluginSandboxParameter;
+
+typedef struct {
+  Plugin plugin;
+  unsigned long timeoutInMs;
+  unsigned int numRestarts;
+  // Set when the plugin has failed too often to be restarted again
+  boolByte isStopped;
+  pid_t processId;
+
+  // Shared memory, where the samples follow the shared struct. There is room
+  // for SANDBOX_MAX_CHANNELS input and output channels of blocksize frames.
+  PluginSandboxShared shared;
+  size_t sharedSize;
+  SampleCount blocksize;
+  int settings[NUM_PLUGIN_SETTINGS];
+
+  // State which is restored when the plugin is restarted
+  CharString presetName;
+  LinkedList parameters;
+  boolByte isPrepared;
+} PluginSandboxDataMembers;
+typedef PluginSandboxDataMembers *PluginSandboxData;
+
+static Sample *_pluginSandboxGetSamples(PluginSandboxData data,
+                                        const boolByte isOutput,
+                                        const ChannelCount channel) {
+  Sample *samples = (Sample *)(data->shared + 1);
+  return samples +
+         ((isOutput ? SANDBOX_MAX_CHANNELS : 0) + channel) * data->blocksize;
+}
+
+// Point a buffer at the samples in shared memory, without copying them
+static void _pluginSandboxMapBuffer(PluginSandboxData data,
+                                    SampleBuffer buffer, Samples *samples,
+                                    const boolByte isOutput,
+                                    const ChannelCount numChannels) {
+  ChannelCount i;
+
+  for (i = 0; i < numChannels; i++) {
+    samples[i] = _pluginSandboxGetSamples(data, isOutput, i);
+  }
+
+  buffer->numChannels = numChannels;
+  buffer->blocksize = data->shared->numFrames;
+  buffer->samples = samples;
+}
+
+static boolByte _pluginSandboxChildLoadPreset(Plugin plugin,
+                                              const char *presetName) {
+  CharString presetNameString = newCharStringWithCString(presetName);
+  PluginPreset preset = pluginPresetFactory(presetNameString);
+  boolByte result = false;
+
+  if (preset != NULL && preset->openPreset(preset)) {
+    result = preset->loadPreset(preset, plugin);
+  }
+
+  freePluginPreset(preset);
+  freeCharString(presetNameString);
+  return result;
+}
+
+static void _pluginSandboxChildProcessMidi(Plugin plugin,
+                                           PluginSandboxShared shared) {
+  LinkedList midiEvents = newLinkedList();
+  unsigned int i;
+
+  for (i = 0; i < shared->numMidiEvents; i++) {
+    linkedListAppend(midiEvents, &shared->midiEvents[i]);
+  }
+
+  plugin->processMidiEvents(plugin, midiEvents);
+  freeLinkedList(midiEvents);
+}
+
+static void _pluginSandboxChildProcessAudio(PluginSandboxData data) {
+  Plugin plugin = data->plugin;
+  PluginSandboxShared shared = data->shared;
+  AudioClock audioClock = getAudioClock();
+  TempoMap tempoMap = audioClock->_tempoMap;
+  Samples inputSamples[SANDBOX_MAX_CHANNELS];
+  Samples outputSamples[SANDBOX_MAX_CHANNELS];
+  SampleBufferMembers inputs;
+  SampleBufferMembers outputs;
+
+  // The host callback reads the transport from the globals in this process
+  *audioSettingsInstance = shared->audioSettings;
+  *audioClock = shared->audioClock;
+  audioClock->_tempoMap = tempoMap;
+
+  _pluginSandboxMapBuffer(data, &inputs, inputSamples, false,
+                          shared->numInputs);
+  _pluginSandboxMapBuffer(data, &outputs, outputSamples, true,
+                          shared->numOutputs);
+  plugin->processAudio(plugin, &inputs, &outputs);
+}
+
+// Main loop of the sandbox process, which never returns
+static void _pluginSandboxRunChild(PluginSandboxData data) {
+  Plugin plugin = data->plugin;
+  PluginSandboxShared shared = data->shared;
+  PluginSandboxCommand command;
+
+  // Exit along with the host, rather than waiting for requests forever
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+  traceLoggerReopenInChildProcess();
+
+  sandboxChildPlugin = plugin;
+
+  do {
+    while (sem_wait(&shared->requestSemaphore) != 0) {
+      // Interrupted by a signal, so try again
+    }
+
+    command = shared->command;
+
+    switch (command) {
+    case kPluginSandboxCommandOpen:
+      shared->result = openPlugin(plugin);
+
+      if (shared->result) {
+        shared->pluginType = plugin->pluginType;
+        shared->numInputs = plugin->inputBuffer->numChannels;
+        shared->numOutputs = plugin->outputBuffer->numChannels;
+      }
+
+      break;
+
+    case kPluginSandboxCommandDisplayInfo:
+      plugin->displayInfo(plugin);
+      break;
+
+    case kPluginSandboxCommandGetSetting:
+      shared->result =
+          plugin->getSetting(plugin, (PluginSetting)shared->argument);
+      break;
+
+    case kPluginSandboxCommandProcessAudio:
+      _pluginSandboxChildProcessAudio(data);
+      break;
+
+    case kPluginSandboxCommandProcessMidiEvents:
+      _pluginSandboxChildProcessMidi(plugin, shared);
+      break;
+
+    case kPluginSandboxCommandSetParameter:
+      shared->result = plugin->setParameter(
+          plugin, (unsigned int)shared->argument, shared->value);
+      break;
+
+    case kPluginSandboxCommandSetParameterQuietly:
+      shared->result = pluginSetParameterQuietly(
+          plugin, (unsigned int)shared->argument, shared->value);
+      break;
+
+    case kPluginSandboxCommandPrepareForProcessing:
+      plugin->prepareForProcessing(plugin);
+      break;
+
+    case kPluginSandboxCommandSuspend:
+      plugin->suspend(plugin);
+      break;
+
+    case kPluginSandboxCommandLoadPreset:
+      shared->result =
+          _pluginSandboxChildLoadPreset(plugin, shared->presetName);
+      break;
+
+    case kPluginSandboxCommandClose:
+      closePlugin(plugin);
+      break;
+
+    default:
+      break;
+    }
+
+    sem_post(&shared->responseSemaphore);
+  } while (command != kPluginSandboxCommandClose);
+
+  freeTraceLogger();
+  fflush(NULL);
+  _exit(0);
+}
+
+static void _pluginSandboxStopProcess(PluginSandboxData data) {
+  int status;
+
+  if (data->processId > 0) {
+    kill(data->processId, SIGKILL);
+    waitpid(data->processId, &status, 0);
+    data->processId = 0;
+  }
+}
+
+// Send a command to the sandbox process and wait for it to finish. If the
+// process has crashed or does not respond in time, it is stopped and false is
+// returned.
+static boolByte _pluginSandboxCall(Plugin self,
+                                   const PluginSandboxCommand command) {
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+  struct timespec deadline;
+  unsigned long waitedInMs = 0;
+  int status;
+
+  if (data->processId <= 0) {
+    return false;
+  }
+
+  data->shared->command = command;
+  sem_post(&data->shared->requestSemaphore);
+
+  while (true) {
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += kPluginSandboxPollIntervalInMs * 1000000l;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000l;
+    deadline.tv_nsec %= 1000000000l;
+
+    if (sem_timedwait(&data->shared->responseSemaphore, &deadline) == 0) {
+      return true;
+    } else if (errno == EINTR) {
+      continue;
+    }
+
+    waitedInMs += kPluginSandboxPollIntervalInMs;
+
+    if (waitpid(data->processId, &status, WNOHANG) == data->processId) {
+      data->processId = 0;
+
+      if (WIFSIGNALED(status)) {
+        logError("Plugin '%s' crashed with signal %d",
+                 self->pluginName->data, WTERMSIG(status));
+      } else {
+        logError("Plugin '%s' exited unexpectedly with code %d",
+                 self->pluginName->data, WEXITSTATUS(status));
+      }
+
+      return false;
+    } else if (waitedInMs >= data->timeoutInMs) {
+      logError("Plugin '%s' did not respond within %lums, stopping it",
+               self->pluginName->data, data->timeoutInMs);
+      _pluginSandboxStopProcess(data);
+      return false;
+    }
+  }
+}
+
+static boolByte _pluginSandboxStart(Plugin self) {
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+  pid_t processId;
+
+  // Otherwise buffered output would be written by both processes
+  fflush(NULL);
+  processId = fork();
+
+  if (processId < 0) {
+    logError("Could not start sandbox process for plugin '%s'",
+             self->pluginName->data);
+    return false;
+  } else if (processId == 0) {
+    _pluginSandboxRunChild(data);
+  }
+
+  data->processId = processId;
+  logDebug("Started sandbox process %d for plugin '%s'", (int)processId,
+           self->pluginName->data);
+
+  if (!_pluginSandboxCall(self, kPluginSandboxCommandOpen) ||
+      !data->shared->result) {
+    logError("Plugin '%s' could not be opened in the sandbox",
+             self->pluginName->data);
+    _pluginSandboxStopProcess(data);
+    return false;
+  }
+
+  return true;
+}
+
+// Restart the sandbox process after a crash or hang, and bring the plugin
+// back to the state it was in
+static void _pluginSandboxRestart(Plugin self) {
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+  LinkedListIterator iterator;
+  PluginSandboxParameter parameter;
+
+  if (data->isStopped) {
+    return;
+  }
+
+  data->numRestarts++;
+
+  if (data->numRestarts > kPluginSandboxMaxRestarts) {
+    logError("Plugin '%s' failed too many times, it will not be restarted",
+             self->pluginName->data);
+    data->isStopped = true;
+    return;
+  }
+
+  logWarn("Restarting plugin '%s'", self->pluginName->data);
+
+  // The semaphores may have been left in any state by the old process
+  sem_destroy(&data->shared->requestSemaphore);
+  sem_destroy(&data->shared->responseSemaphore);
+  sem_init(&data->shared->requestSemaphore, 1, 0);
+  sem_init(&data->shared->responseSemaphore, 1, 0);
+
+  if (!_pluginSandboxStart(self)) {
+    return;
+  }
+
+  if (!charStringIsEmpty(data->presetName)) {
+    strncpy(data->shared->presetName, data->presetName->data,
+            SANDBOX_MAX_PRESET_NAME_LENGTH);
+    _pluginSandboxCall(self, kPluginSandboxCommandLoadPreset);
+  }
+
+  for (iterator = data->parameters; iterator != NULL;
+       iterator = iterator->nextItem) {
+    parameter = (PluginSandboxParameter)iterator->item;
+
+    if (parameter != NULL) {
+      data->shared->argument = (int)parameter->index;
+      data->shared->value = parameter->value;
+      _pluginSandboxCall(self, kPluginSandboxCommandSetParameter);
+    }
+  }
+
+  if (data->isPrepared) {
+    _pluginSandboxCall(self, kPluginSandboxCommandPrepareForProcessing);
+  }
+}
+
+static boolByte _pluginSandboxOpen(void *pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+  void *shared;
+
+  data->blocksize = getBlocksize();
+  data->sharedSize =
+      sizeof(PluginSandboxSharedMembers) +
+      2 * SANDBOX_MAX_CHANNELS * data->blocksize * sizeof(Sample);
+  shared = mmap(NULL, data->sharedSize, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+  if (shared == MAP_FAILED) {
+    logError("Could not allocate shared memory for plugin '%s'",
+             self->pluginName->data);
+    return false;
+  }
+
+  data->shared = (PluginSandboxShared)shared;
+  memset(data->shared, 0, sizeof(PluginSandboxSharedMembers));
+  sem_init(&data->shared->requestSemaphore, 1, 0);
+  sem_init(&data->shared->responseSemaphore, 1, 0);
+
+  if (!_pluginSandboxStart(self)) {
+    return false;
+  } else if (data->shared->numInputs > SANDBOX_MAX_CHANNELS ||
+             data->shared->numOutputs > SANDBOX_MAX_CHANNELS) {
+    logError("Plugin '%s' has more than %d channels, which is not supported "
+             "in a sandbox",
+             self->pluginName->data, SANDBOX_MAX_CHANNELS);
+    _pluginSandboxStopProcess(data);
+    return false;
+  }
+
+  self->pluginType = data->shared->pluginType;
+  data->settings[PLUGIN_NUM_INPUTS] = data->shared->numInputs;
+  data->settings[PLUGIN_NUM_OUTPUTS] = data->shared->numOutputs;
+  logInfo("Plugin '%s' is running in sandbox process %d",
+          self->pluginName->data, (int)data->processId);
+  return true;
+}
+
+static void _pluginSandboxDisplayInfo(void *pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+
+  if (!_pluginSandboxCall(self, kPluginSandboxCommandDisplayInfo)) {
+    _pluginSandboxRestart(self);
+  }
+}
+
+static int _pluginSandboxGetSetting(void *pluginPtr,
+                                    PluginSetting pluginSetting) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+
+  // The channel counts are fixed when the plugin is opened, since they are
+  // used to size the shared memory
+  if (pluginSetting == PLUGIN_NUM_INPUTS ||
+      pluginSetting == PLUGIN_NUM_OUTPUTS) {
+    return data->settings[pluginSetting];
+  }
+
+  data->shared->argument = (int)pluginSetting;
+
+  if (_pluginSandboxCall(self, kPluginSandboxCommandGetSetting)) {
+    data->settings[pluginSetting] = data->shared->result;
+  }
+
+  // Otherwise the last known value is used until the next block restarts it
+  return data->settings[pluginSetting];
+}
+
+static void _pluginSandboxProcessAudio(void *pluginPtr, SampleBuffer inputs,
+                                       SampleBuffer outputs) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+  PluginSandboxShared shared = data->shared;
+  ChannelCount i;
+
+  if (outputs->blocksize > data->blocksize) {
+    logInternalError("Sandbox cannot process %d frames", outputs->blocksize);
+    sampleBufferClear(outputs);
+    return;
+  }
+
+  shared->audioSettings = *audioSettingsInstance;
+  shared->audioClock = *getAudioClock();
+  shared->numFrames = outputs->blocksize;
+
+  for (i = 0; i < shared->numInputs; i++) {
+    if (i < inputs->numChannels) {
+      memcpy(_pluginSandboxGetSamples(data, false, i), inputs->samples[i],
+             sizeof(Sample) * shared->numFrames);
+    } else {
+      memset(_pluginSandboxGetSamples(data, false, i), 0,
+             sizeof(Sample) * shared->numFrames);
+    }
+  }
+
+  if (!_pluginSandboxCall(self, kPluginSandboxCommandProcessAudio)) {
+    sampleBufferClear(outputs);
+    _pluginSandboxRestart(self);
+    return;
+  }
+
+  for (i = 0; i < outputs->numChannels; i++) {
+    if (i < shared->numOutputs) {
+      memcpy(outputs->samples[i], _pluginSandboxGetSamples(data, true, i),
+             sizeof(Sample) * shared->numFrames);
+    } else {
+      memset(outputs->samples[i], 0, sizeof(Sample) * shared->numFrames);
+    }
+  }
+}
+
+static void _pluginSandboxProcessMidiEvents(void *pluginPtr,
+                                            LinkedList midiEvents) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+  PluginSandboxShared shared = data->shared;
+  LinkedListIterator iterator;
+  MidiEvent midiEvent;
+
+  shared->numMidiEvents = 0;
+
+  for (iterator = midiEvents; iterator != NULL;
+       iterator = iterator->nextItem) {
+    midiEvent = (MidiEvent)iterator->item;
+
+    // Events with extra data point into this process, and are not supported
+    // by VST2.x plugins anyways
+    if (midiEvent == NULL || midiEvent->eventType != MIDI_TYPE_REGULAR) {
+      continue;
+    } else if (shared->numMidiEvents == SANDBOX_MAX_MIDI_EVENTS) {
+      logWarn("Too many MIDI events for plugin '%s', dropping the rest",
+              self->pluginName->data);
+      break;
+    }
+
+    shared->midiEvents[shared->numMidiEvents] = *midiEvent;
+    shared->midiEvents[shared->numMidiEvents].extraData = NULL;
+    shared->numMidiEvents++;
+  }
+
+  if (shared->numMidiEvents > 0 &&
+      !_pluginSandboxCall(self, kPluginSandboxCommandProcessMidiEvents)) {
+    _pluginSandboxRestart(self);
+  }
+}
+
+static boolByte _pluginSandboxSendParameter(Plugin self, unsigned int i,
+                                            float value,
+                                            PluginSandboxCommand command) {
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+  PluginSandboxParameter parameter = NULL;
+  LinkedListIterator iterator;
+
+  data->shared->argument = (int)i;
+  data->shared->value = value;
+
+  if (!_pluginSandboxCall(self, command)) {
+    _pluginSandboxRestart(self);
+    return false;
+  } else if (!data->shared->result) {
+    return false;
+  }
+
+  // Remember the last value of each parameter, to set it again on restart
+  for (iterator = data->parameters; iterator != NULL;
+       iterator = iterator->nextItem) {
+    if (iterator->item != NULL &&
+        ((PluginSandboxParameter)iterator->item)->index == i) {
+      parameter = (PluginSandboxParameter)iterator->item;
+      break;
+    }
+  }
+
+  if (parameter == NULL) {
+    parameter = (PluginSandboxParameter)malloc(
+        sizeof(PluginSandboxParameterMembers));
+    parameter->index = i;
+    linkedListAppend(data->parameters, parameter);
+  }
+
+  parameter->value = value;
+  return true;
+}
+
+static boolByte _pluginSandboxSetParameter(void *pluginPtr, unsigned int i,
+                                           float value) {
+  return _pluginSandboxSendParameter((Plugin)pluginPtr, i, value,
+                                     kPluginSandboxCommandSetParameter);
+}
+
+static boolByte _pluginSandboxSetParameterQuietly(void *pluginPtr,
+                                                  unsigned int i,
+                                                  float value) {
+  return _pluginSandboxSendParameter((Plugin)pluginPtr, i, value,
+                                     kPluginSandboxCommandSetParameterQuietly);
+}
+
+static void _pluginSandboxPrepareForProcessing(void *pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+
+  data->isPrepared = true;
+
+  if (!_pluginSandboxCall(self, kPluginSandboxCommandPrepareForProcessing)) {
+    _pluginSandboxRestart(self);
+  }
+}
+
+static void _pluginSandboxSuspend(void *pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+
+  data->isPrepared = false;
+
+  if (!_pluginSandboxCall(self, kPluginSandboxCommandSuspend)) {
+    _pluginSandboxRestart(self);
+  }
+}
+
+static void _pluginSandboxShowEditor(void *pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  logError("Cannot show the editor of plugin '%s' while it is in a sandbox",
+           self->pluginName->data);
+}
+
+static void _pluginSandboxClose(void *pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+  int status;
+
+  if (_pluginSandboxCall(self, kPluginSandboxCommandClose)) {
+    waitpid(data->processId, &status, 0);
+    data->processId = 0;
+  } else {
+    _pluginSandboxStopProcess(data);
+  }
+
+  if (data->shared != NULL) {
+    munmap(data->shared, data->sharedSize);
+    data->shared = NULL;
+  }
+}
+
+static void _pluginSandboxFreeData(void *pluginDataPtr) {
+  PluginSandboxData data = (PluginSandboxData)pluginDataPtr;
+
+  _pluginSandboxStopProcess(data);
+
+  if (data->shared != NULL) {
+    munmap(data->shared, data->sharedSize);
+  }
+
+  freePlugin(data->plugin);
+  freeCharString(data->presetName);
+  freeLinkedListAndItems(data->parameters, (LinkedListFreeItemFunc)free);
+}
+
+boolByte pluginSandboxIsSupported(void) { return true; }
+
+Plugin newPluginSandbox(Plugin plugin, const unsigned long timeoutInMs) {
+  Plugin self = _newPlugin(PLUGIN_TYPE_SANDBOX, plugin->pluginType);
+  PluginSandboxData data =
+      (PluginSandboxData)malloc(sizeof(PluginSandboxDataMembers));
+
+  charStringCopy(self->pluginName, plugin->pluginName);
+  charStringCopy(self->pluginLocation, plugin->pluginLocation);
+  charStringCopy(self->pluginAbsolutePath, plugin->pluginAbsolutePath);
+
+  self->openPlugin = _pluginSandboxOpen;
+  self->displayInfo = _pluginSandboxDisplayInfo;
+  self->getSetting = _pluginSandboxGetSetting;
+  self->prepareForProcessing = _pluginSandboxPrepareForProcessing;
+  self->suspend = _pluginSandboxSuspend;
+  self->showEditor = _pluginSandboxShowEditor;
+  self->processAudio = _pluginSandboxProcessAudio;
+  self->processMidiEvents = _pluginSandboxProcessMidiEvents;
+  self->setParameter = _pluginSandboxSetParameter;
+  self->setParameterQuietly = _pluginSandboxSetParameterQuietly;
+  self->closePlugin = _pluginSandboxClose;
+  self->freePluginData = _pluginSandboxFreeData;
+
+  data->plugin = plugin;
+  data->timeoutInMs = timeoutInMs;
+  data->numRestarts = 0;
+  data->isStopped = false;
+  data->processId = 0;
+  data->shared = NULL;
+  data->sharedSize = 0;
+  data->blocksize = 0;
+  memset(data->settings, 0, sizeof(data->settings));
+  data->presetName = newCharString();
+  data->parameters = newLinkedList();
+  data->isPrepared = false;
+
+  self->extraData = data;
+  return self;
+}
+
+boolByte pluginSandboxLoadPreset(Plugin self, PluginPreset preset) {
+  PluginSandboxData data = (PluginSandboxData)self->extraData;
+
+  if (!pluginPresetIsCompatibleWith(preset, data->plugin)) {
+    logError("Preset '%s' is not a compatible format for plugin",
+             preset->presetName->data);
+    return false;
+  } else if (strlen(preset->presetName->data) >=
+             SANDBOX_MAX_PRESET_NAME_LENGTH) {
+    logError("Preset name '%s' is too long", preset->presetName->data);
+    return false;
+  }
+
+  strncpy(data->shared->presetName, preset->presetName->data,
+          SANDBOX_MAX_PRESET_NAME_LENGTH);
+
+  if (!_pluginSandboxCall(self, kPluginSandboxCommandLoadPreset)) {
+    _pluginSandboxRestart(self);
+    return false;
+  } else if (!data->shared->result) {
+    logError("Could not load preset '%s' in plugin '%s'",
+             preset->presetName->data, self->pluginName->data);
+    return false;
+  }
+
+  // Parameters which were set before are overridden by the preset
+  charStringCopy(data->presetName, preset->presetName);
+  freeLinkedListAndItems(data->parameters, (LinkedListFreeItemFunc)free);
+  data->parameters = newLinkedList();
+  logInfo("Loaded preset '%s' in plugin '%s'", preset->presetName->data,
+          self->pluginName->data);
+  return true;
+}
+
+unsigned int pluginSandboxGetNumRestarts(const Plugin self) {
+  return ((PluginSandboxData)self->extraData)->numRestarts;
+}
+
+Plugin pluginSandboxGetChildPlugin(void) { return sandboxChildPlugin; }
+
+#else
+
+boolByte pluginSandboxIsSupported(void) { return false; }
+
+Plugin newPluginSandbox(Plugin plugin, const unsigned long timeoutInMs) {
+  logUnsupportedFeature("Plugin sandboxes");
+  return NULL;
+}
+
+boolByte pluginSandboxLoadPreset(Plugin self, PluginPreset preset) {
+  return false;
+}
+
+unsigned int pluginSandboxGetNumRestarts(const Plugin self) { return 0; }
+
+Plugin pluginSandboxGetChildPlugin(void) { return NULL; }
+
+#endif
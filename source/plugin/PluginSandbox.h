@@ -0,0 +1,81 @@
+//
+// PluginSandbox.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginSandbox_h
+#define MrsWatson_PluginSandbox_h
+
+#include "plugin/Plugin.h"
+#include "plugin/PluginPreset.h"
+
+#define DEFAULT_SANDBOX_TIMEOUT_IN_MS 10000
+
+/**
+ * Check if plugins can be run in a sandbox on this platform. Sandboxes are
+ * currently only supported on Linux.
+ * @return True if newPluginSandbox() may be used
+ */
+boolByte pluginSandboxIsSupported(void);
+
+/**
+ * Create a plugin which runs another plugin in a separate process, so that a
+ * crash or hang in that plugin does not take down the host. Audio, MIDI events
+ * and the transport are passed to the process through shared memory. When the
+ * process crashes or does not respond in time, the block is replaced with
+ * silence and the plugin is restarted with its last preset and parameters.
+ * @param plugin Plugin to run in the sandbox, which must not be open yet. The
+ * sandbox takes ownership of this plugin.
+ * @param timeoutInMs Time which the plugin may take for any call before it is
+ * considered to be hung
+ * @return Initialized Plugin object, or NULL if sandboxes are not supported
+ */
+Plugin newPluginSandbox(Plugin plugin, const unsigned long timeoutInMs);
+
+/**
+ * Load a preset in a sandboxed plugin. This is used in place of the preset's
+ * own load function, which cannot reach the plugin in the other process.
+ * @param self
+ * @param preset Preset to load, which is opened again by the sandbox process
+ * @return True if the preset was loaded
+ */
+boolByte pluginSandboxLoadPreset(Plugin self, PluginPreset preset);
+
+/**
+ * Get the number of times that the sandboxed plugin has crashed or hung, and
+ * had to be restarted.
+ * @param self
+ * @return Number of restarts
+ */
+unsigned int pluginSandboxGetNumRestarts(const Plugin self);
+
+/**
+ * Get the plugin which is run by this process, if this is a sandbox process.
+ * The host callback uses this instead of the plugin chain, which in a sandbox
+ * process is only a stale copy of the host's chain.
+ * @return Sandboxed plugin, or NULL if this is not a sandbox process
+ */
+Plugin pluginSandboxGetChildPlugin(void);
+
+#endif
@@ -88,6 +88,7 @@ Plugin newPluginSilence(const CharString pluginName) {
   plugin->displayInfo = _pluginSilenceDisplayInfo;
   plugin->getSetting = _pluginSilenceGetSetting;
   plugin->prepareForProcessing = _pluginSilenceEmpty;
+  plugin->suspend = _pluginSilenceEmpty;
   plugin->showEditor = _pluginSilenceEmpty;
   plugin->processAudio = _pluginSilenceProcessAudio;
   plugin->processMidiEvents = _pluginSilenceProcessMidiEvents;
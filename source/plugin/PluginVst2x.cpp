@@ -39,9 +39,11 @@ extern "C" {
 #include "base/PlatformInfo.h"
 #include "base/Types.h"
 #include "logging/EventLogger.h"
+#include "logging/TraceLogger.h"
 #include "midi/MidiEvent.h"
 #include "plugin/Plugin.h"
 #include "plugin/PluginVst2xId.h"
+#include "time/AudioClock.h"
 
 extern LinkedList getVst2xPluginLocations(CharString currentDirectory);
 extern LibraryHandle
@@ -64,9 +66,26 @@ typedef struct {
   // Must be retained until processReplacing() is called, so best to keep a
   // reference in the plugin's data storage.
   struct VstEvents *vstEvents;
+  // Storage for the events pointed to by vstEvents. Both arrays are reused
+  // for each block and only grow when a block has more events than any before.
+  VstMidiEvent *vstMidiEvents;
+  int vstEventsCapacity;
+  // Transport snapshot returned to the plugin by audioMasterGetTime, which is
+  // only refilled when the audio clock changes, usually once per block.
+  VstTimeInfo vstTimeInfo;
+  VstInt32 vstTimeInfoValidFlags;
+  unsigned long vstTimeInfoVersion;
+  // Session which the offline opcodes read from and write to while the plugin
+  // processes audio offline, otherwise NULL
+  OfflineSession offlineSession;
+  boolByte isOfflineTaskRunning;
 } PluginVst2xDataMembers;
 typedef PluginVst2xDataMembers *PluginVst2xData;
 
+// Number of events which can be sent to a plugin in one block before the event
+// buffers need to be reallocated
+static const int kPluginVst2xInitialEventCapacity = 64;
+
 // Implementation body starts here
 extern "C" {
 
@@ -313,6 +332,15 @@ static void _resumePlugin(Plugin plugin) {
              plugin->pluginName->data);
   }
 
+  // The processing precision may only be changed while the plugin is suspended
+  if (plugin->processAudioDouble != NULL) {
+    VstIntPtr precision = pluginIsDoublePrecision(plugin)
+                              ? kVstProcessPrecision64
+                              : kVstProcessPrecision32;
+    data->dispatcher(data->pluginHandle, effSetProcessPrecision, 0, precision,
+                     NULL, 0.0f);
+  }
+
   data->dispatcher(data->pluginHandle, effMainsChanged, 0, 1, NULL, 0.0f);
   data->dispatcher(data->pluginHandle, effStartProcess, 0, 0, NULL, 0.0f);
 }
@@ -388,6 +416,101 @@ static void _setSpeakers(struct VstSpeakerArrangement *speakerArrangement,
   }
 }
 
+static void _processAudioDoubleVst2xPlugin(void *pluginPtr,
+                                           DoubleSampleBuffer inputs,
+                                           DoubleSampleBuffer outputs) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginVst2xData data = (PluginVst2xData)plugin->extraData;
+  data->pluginHandle->processDoubleReplacing(data->pluginHandle,
+                                             inputs->samples, outputs->samples,
+                                             (VstInt32)outputs->blocksize);
+}
+
+// Let the plugin process the whole input of the offline session in one task.
+// The plugin reads and writes the audio itself with the offline opcodes, which
+// end up in pluginVst2xOfflineRead() and pluginVst2xOfflineWrite().
+static boolByte _runOfflineTaskVst2x(PluginVst2xData data) {
+  OfflineSession session = data->offlineSession;
+  // The input buffer is also used to read back the output
+  const ChannelCount numInputChannels =
+      session->input->numChannels > session->output->numChannels
+          ? session->input->numChannels
+          : session->output->numChannels;
+  SampleBuffer inputBuffer = newSampleBuffer(numInputChannels, getBlocksize());
+  SampleBuffer outputBuffer =
+      newSampleBuffer(session->output->numChannels, getBlocksize());
+  VstOfflineTask task;
+  boolByte result;
+
+  memset(&task, 0, sizeof(VstOfflineTask));
+  task.sizeInputBuffer = (VstInt32)inputBuffer->blocksize;
+  task.sizeOutputBuffer = (VstInt32)outputBuffer->blocksize;
+  task.inputBuffer = inputBuffer->samples;
+  task.outputBuffer = outputBuffer->samples;
+  task.positionToProcessFrom = 0.0;
+  task.numFramesToProcess = (double)session->input->blocksize;
+  task.numFramesInSourceFile = (double)session->input->blocksize;
+  task.sourceSampleRate = getSampleRate();
+  task.destinationSampleRate = getSampleRate();
+  task.numSourceChannels = (VstInt32)session->input->numChannels;
+  task.numDestinationChannels = (VstInt32)session->output->numChannels;
+
+  logDebug("Running offline pass %d of plugin '%s'", session->currentPass + 1,
+           data->pluginId->idString->data);
+  data->isOfflineTaskRunning = true;
+  data->dispatcher(data->pluginHandle, effOfflinePrepare, 0, 1, &task, 0.0f);
+
+  if ((task.flags & kVstOfflinePlugError) == 0) {
+    data->dispatcher(data->pluginHandle, effOfflineRun, 0, 1, &task, 0.0f);
+  }
+
+  data->isOfflineTaskRunning = false;
+  session->currentPass++;
+  result = (boolByte)((task.flags & kVstOfflinePlugError) == 0);
+
+  if (!result) {
+    task.outputText[sizeof(task.outputText) - 1] = '\0';
+    logError("Plugin '%s' failed to process audio offline: %s",
+             data->pluginId->idString->data, task.outputText);
+  }
+
+  freeSampleBuffer(inputBuffer);
+  freeSampleBuffer(outputBuffer);
+  return result;
+}
+
+static boolByte _processOfflineVst2xPlugin(void *pluginPtr,
+                                           OfflineSession session) {
+  PluginVst2xData data = (PluginVst2xData)((Plugin)pluginPtr)->extraData;
+  VstAudioFile audioFile;
+  boolByte result = true;
+
+  memset(&audioFile, 0, sizeof(VstAudioFile));
+  audioFile.flags = kVstOfflineNoRateConversion | kVstOfflineNoChannelChange;
+  strncpy(audioFile.name, session->name->data, sizeof(audioFile.name) - 1);
+  audioFile.sampleRate = getSampleRate();
+  audioFile.numChannels = (VstInt32)session->input->numChannels;
+  audioFile.numFrames = (double)session->input->blocksize;
+  audioFile.selectionSize = audioFile.numFrames;
+  audioFile.tempo = getTempo();
+  audioFile.timeSigNumerator = (VstInt32)getTimeSignatureBeatsPerMeasure();
+  audioFile.timeSigDenominator = (VstInt32)getTimeSignatureNoteValue();
+
+  // Plugins usually start processing by calling audioMasterOfflineStart when
+  // they are notified about a file. Otherwise the host starts it, since there
+  // is no user to ask the plugin to do so.
+  data->offlineSession = session;
+  data->dispatcher(data->pluginHandle, effOfflineNotify, 1, 1, &audioFile,
+                   0.0f);
+
+  if (session->currentPass == 0) {
+    result = _runOfflineTaskVst2x(data);
+  }
+
+  data->offlineSession = NULL;
+  return result;
+}
+
 static boolByte _initVst2xPlugin(Plugin plugin) {
   PluginVst2xData data = (PluginVst2xData)plugin->extraData;
   PluginVst2xId subpluginId;
@@ -409,7 +532,17 @@ static boolByte _initVst2xPlugin(Plugin plugin) {
     data->isPluginShell = true;
   }
 
+  if (data->pluginHandle->flags & effFlagsCanDoubleReplacing) {
+    plugin->processAudioDouble = _processAudioDoubleVst2xPlugin;
+  }
+
+  if (_canPluginDo(plugin, "offline") > 0) {
+    plugin->processOffline = _processOfflineVst2xPlugin;
+  }
+
+  traceLoggerBeginEvent("init", "effOpen");
   data->dispatcher(data->pluginHandle, effOpen, 0, 0, NULL, 0.0f);
+  traceLoggerEndEvent();
   data->dispatcher(data->pluginHandle, effSetSampleRate, 0, 0, NULL,
                    (float)getSampleRate());
   data->dispatcher(data->pluginHandle, effSetBlockSize, 0,
@@ -516,12 +649,16 @@ static boolByte _openVst2xPlugin(void *pluginPtr) {
     freeFile(pluginPath);
   }
 
+  traceLoggerBeginEvent("init", "Load library");
   data->libraryHandle = getLibraryHandleForPlugin(plugin->pluginAbsolutePath);
+  traceLoggerEndEvent();
   if (data->libraryHandle == NULL) {
     return false;
   }
 
+  traceLoggerBeginEvent("init", "Call plugin entry point");
   pluginHandle = loadVst2xPlugin(data->libraryHandle);
+  traceLoggerEndEvent();
   if (pluginHandle == NULL) {
     logError("Could not load VST2.x plugin '%s'",
              plugin->pluginAbsolutePath->data);
@@ -550,6 +687,8 @@ static boolByte _openVst2xPlugin(void *pluginPtr) {
   } else {
     data->dispatcher = (Vst2xPluginDispatcherFunc)(pluginHandle->dispatcher);
     data->pluginHandle = pluginHandle;
+    // Lets the host callback find this plugin's time info snapshot
+    pluginHandle->resvd1 = (VstIntPtr)data;
     result = _initVst2xPlugin(plugin);
 
     if (result) {
@@ -721,7 +860,7 @@ static int _getVst2xPluginSetting(void *pluginPtr,
       return 0;
     } else {
       // If tailSize is not 0 or 1, then it is assumed to be in samples
-      return (int)((double)tailSize * getSampleRate() / 1000.0f);
+      return (int)((double)tailSize * 1000.0 / getSampleRate());
     }
   }
 
@@ -755,8 +894,189 @@ static void _processAudioVst2xPlugin(void *pluginPtr, SampleBuffer inputs,
                                        (VstInt32)outputs->blocksize);
 }
 
-static void _fillVstMidiEvent(const MidiEvent midiEvent,
-                              VstMidiEvent *vstMidiEvent) {
+// Fill in every value which the host can provide, returning the flags for the
+// values which are valid
+static VstInt32 _fillVstTimeInfo(VstTimeInfo *vstTimeInfo,
+                                 const AudioClock audioClock) {
+  VstInt32 validFlags = kVstPpqPosValid | kVstTempoValid | kVstBarsValid |
+                        kVstTimeSigValid | kVstSmpteValid | kVstClockValid;
+
+  memset(vstTimeInfo, 0, sizeof(VstTimeInfo));
+  vstTimeInfo->samplePos = (double)audioClock->currentFrame;
+  vstTimeInfo->sampleRate = getSampleRate();
+
+  // When running offline, the system time has nothing to do with the position,
+  // and any plugin calculating something from it would probably get it wrong
+  if (audioClock->isRealtime) {
+    vstTimeInfo->nanoSeconds = (double)audioClock->nanoseconds;
+    validFlags |= kVstNanosValid;
+  }
+
+  // Musical time starts with 1, not 0
+  vstTimeInfo->ppqPos = audioClock->ppqPosition + 1.0;
+  vstTimeInfo->tempo = audioClock->tempo;
+  vstTimeInfo->barStartPos = audioClock->barStartPpqPosition + 1.0;
+  // We don't support cycling, so cycleStartPos and cycleEndPos are always 0
+  vstTimeInfo->timeSigNumerator = audioClock->timeSignatureNumerator;
+  vstTimeInfo->timeSigDenominator = audioClock->timeSignatureDenominator;
+
+  // The sequence always starts at 00:00:00:00, so the SMPTE position can be
+  // calculated from the sample position alone
+  vstTimeInfo->smpteOffset = 0;
+  vstTimeInfo->smpteFrameRate = kVstSmpte24fps;
+  vstTimeInfo->samplesToNextClock = (VstInt32)audioClock->samplesToNextClock;
+
+  return validFlags;
+}
+
+VstTimeInfo *pluginVst2xGetTimeInfo(AEffect *effect,
+                                    const VstIntPtr requestedFlags) {
+  // Plugins may ask for the time before they are fully opened, in which case
+  // there is no plugin data yet and a shared snapshot is used instead. Either
+  // way, plugins expect a pointer which they do not own and must not free.
+  static VstTimeInfo sharedVstTimeInfo;
+  AudioClock audioClock = getAudioClock();
+  PluginVst2xData data = NULL;
+  VstTimeInfo *vstTimeInfo;
+  VstInt32 validFlags;
+
+  if (effect != NULL) {
+    data = (PluginVst2xData)effect->resvd1;
+  }
+
+  if (data == NULL) {
+    vstTimeInfo = &sharedVstTimeInfo;
+    validFlags = _fillVstTimeInfo(vstTimeInfo, audioClock);
+  } else {
+    vstTimeInfo = &(data->vstTimeInfo);
+
+    if (data->vstTimeInfoVersion != audioClock->transportVersion) {
+      data->vstTimeInfoValidFlags = _fillVstTimeInfo(vstTimeInfo, audioClock);
+      data->vstTimeInfoVersion = audioClock->transportVersion;
+    }
+
+    validFlags = data->vstTimeInfoValidFlags;
+  }
+
+  // Only the requested values are marked as valid, but the transport state is
+  // always included
+  vstTimeInfo->flags = validFlags & (VstInt32)requestedFlags;
+  vstTimeInfo->flags |= audioClock->transportChanged ? kVstTransportChanged : 0;
+  vstTimeInfo->flags |= audioClock->isPlaying ? kVstTransportPlaying : 0;
+
+  return vstTimeInfo;
+}
+
+// Find the offline session of the plugin which called the host, or NULL if
+// the plugin is not processing audio offline
+static PluginVst2xData _getOfflineVst2xData(AEffect *effect,
+                                            const VstOfflineTask *task,
+                                            const VstIntPtr option) {
+  PluginVst2xData data =
+      effect != NULL ? (PluginVst2xData)effect->resvd1 : NULL;
+
+  if (data == NULL || data->offlineSession == NULL || task == NULL) {
+    logWarn("Plugin asked for offline data outside of an offline task");
+    return NULL;
+  } else if (option != kVstOfflineAudio) {
+    logUnsupportedFeature("Offline data other than audio");
+    return NULL;
+  } else if (task->flags & kVstOfflineInterleavedAudio) {
+    logUnsupportedFeature("Interleaved offline audio");
+    return NULL;
+  }
+
+  return data;
+}
+
+// Clamp the number of frames which a plugin asked for to its buffer size
+static SampleCount _getOfflineVst2xFrames(const VstInt32 count,
+                                          const VstInt32 bufferSize) {
+  if (count <= 0 || bufferSize <= 0) {
+    return 0;
+  }
+
+  return (SampleCount)(count < bufferSize ? count : bufferSize);
+}
+
+VstIntPtr pluginVst2xOfflineStart(AEffect *effect) {
+  PluginVst2xData data =
+      effect != NULL ? (PluginVst2xData)effect->resvd1 : NULL;
+
+  if (data == NULL || data->offlineSession == NULL ||
+      data->isOfflineTaskRunning) {
+    logWarn("Plugin asked to start offline processing, but there is no input "
+            "to process offline");
+    return 0;
+  }
+
+  return _runOfflineTaskVst2x(data);
+}
+
+VstIntPtr pluginVst2xOfflineRead(AEffect *effect, VstOfflineTask *task,
+                                 const VstIntPtr option,
+                                 const boolByte fromInput) {
+  PluginVst2xData data = _getOfflineVst2xData(effect, task, option);
+  OfflineSession session;
+  SampleCount numFrames;
+
+  if (data == NULL) {
+    return 0;
+  }
+
+  session = data->offlineSession;
+  numFrames = _getOfflineVst2xFrames(task->readCount, task->sizeInputBuffer);
+
+  if (task->readPosition < 0.0) {
+    task->readPosition = 0.0;
+  }
+
+  // Reading continues after the frames which were read, unless the plugin
+  // sets the position itself
+  numFrames = offlineSessionRead(
+      session, fromInput, (SampleCount)task->readPosition, numFrames,
+      fromInput ? session->input->numChannels : session->output->numChannels,
+      (Samples *)task->inputBuffer);
+  task->readCount = (VstInt32)numFrames;
+  task->readPosition += numFrames;
+  return (VstIntPtr)(numFrames > 0);
+}
+
+VstIntPtr pluginVst2xOfflineWrite(AEffect *effect, VstOfflineTask *task,
+                                  const VstIntPtr option) {
+  PluginVst2xData data = _getOfflineVst2xData(effect, task, option);
+  SampleCount numFrames;
+
+  if (data == NULL) {
+    return 0;
+  }
+
+  numFrames = _getOfflineVst2xFrames(task->writeCount, task->sizeOutputBuffer);
+
+  if (task->writePosition < 0.0) {
+    task->writePosition = 0.0;
+  }
+
+  offlineSessionWrite(data->offlineSession, (SampleCount)task->writePosition,
+                      numFrames, data->offlineSession->output->numChannels,
+                      (Samples *)task->outputBuffer);
+  task->writePosition += numFrames;
+  return 1;
+}
+
+VstIntPtr pluginVst2xOfflineGetCurrentPass(AEffect *effect) {
+  PluginVst2xData data =
+      effect != NULL ? (PluginVst2xData)effect->resvd1 : NULL;
+
+  if (data == NULL || data->offlineSession == NULL) {
+    return 0;
+  }
+
+  return (VstIntPtr)data->offlineSession->currentPass;
+}
+
+static boolByte _fillVstMidiEvent(const MidiEvent midiEvent,
+                                  VstMidiEvent *vstMidiEvent) {
   switch (midiEvent->eventType) {
   case MIDI_TYPE_REGULAR:
     vstMidiEvent->type = kVstMidiType;
@@ -768,76 +1088,90 @@ static void _fillVstMidiEvent(const MidiEvent midiEvent,
     vstMidiEvent->flags = 0;
     vstMidiEvent->reserved1 = 0;
     vstMidiEvent->reserved2 = 0;
-    break;
+    return true;
 
   case MIDI_TYPE_SYSEX:
     logUnsupportedFeature("VST2.x plugin sysex messages");
-    break;
+    return false;
 
   case MIDI_TYPE_META:
     // Ignore, don't care
-    break;
+    return false;
 
   default:
     logInternalError("Cannot convert MIDI event type '%d' to VstMidiEvent",
                      midiEvent->eventType);
-    break;
+    return false;
   }
 }
 
-static void _processMidiEventsVst2xPlugin(void *pluginPtr,
-                                          LinkedList midiEvents) {
-  Plugin plugin = (Plugin)pluginPtr;
-  PluginVst2xData data = (PluginVst2xData)(plugin->extraData);
-  int numEvents = linkedListLength(midiEvents);
+static void _ensureVstEventsCapacity(PluginVst2xData data,
+                                     const int numEvents) {
+  int capacity = data->vstEventsCapacity > 0 ? data->vstEventsCapacity
+                                             : kPluginVst2xInitialEventCapacity;
 
-  // Free events from the previous call
-  if (data->vstEvents != NULL) {
-    for (int i = 0; i < data->vstEvents->numEvents; i++) {
-      free(data->vstEvents->events[i]);
-    }
+  if (data->vstEvents != NULL && numEvents <= data->vstEventsCapacity) {
+    return;
+  }
 
-    free(data->vstEvents);
+  while (capacity < numEvents) {
+    capacity *= 2;
   }
 
+  logDebug("Growing VST event buffer to %d events", capacity);
+  free(data->vstEvents);
+  free(data->vstMidiEvents);
+  // VstEvents is declared with a 2-element array of event pointers at the end,
+  // so this allocates a bit more than is needed
   data->vstEvents = (struct VstEvents *)malloc(
-      sizeof(struct VstEvent) + (numEvents * sizeof(struct VstEvent *)));
-  data->vstEvents->numEvents = numEvents;
+      sizeof(struct VstEvents) + (capacity * sizeof(struct VstEvent *)));
+  data->vstEvents->numEvents = 0;
+  data->vstEvents->reserved = 0;
+  data->vstMidiEvents = (VstMidiEvent *)malloc(capacity * sizeof(VstMidiEvent));
+  data->vstEventsCapacity = capacity;
+}
 
-  // Some monophonic instruments have problems dealing with the order of MIDI
-  // events, so send them all note off events *first* followed by any other
-  // event types.
-  LinkedListIterator iterator = midiEvents;
-  int outIndex = 0;
+static void _processMidiEventsVst2xPlugin(void *pluginPtr,
+                                          LinkedList midiEvents) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginVst2xData data = (PluginVst2xData)(plugin->extraData);
+  _ensureVstEventsCapacity(data, linkedListLength(midiEvents));
+
+  // Convert the events in a single pass, counting the note offs as we go
+  int numEvents = 0;
+  int numNoteOffs = 0;
 
-  while (iterator != NULL && outIndex < numEvents) {
+  for (LinkedListIterator iterator = midiEvents; iterator != NULL;
+       iterator = (LinkedListIterator)(iterator->nextItem)) {
     MidiEvent midiEvent = (MidiEvent)(iterator->item);
 
-    if (midiEvent != NULL && (midiEvent->status >> 4) == 0x08) {
-      VstMidiEvent *vstMidiEvent = (VstMidiEvent *)malloc(sizeof(VstMidiEvent));
-      _fillVstMidiEvent(midiEvent, vstMidiEvent);
-      data->vstEvents->events[outIndex] = (VstEvent *)vstMidiEvent;
-      outIndex++;
-    }
+    if (midiEvent != NULL && numEvents < data->vstEventsCapacity &&
+        _fillVstMidiEvent(midiEvent, &(data->vstMidiEvents[numEvents]))) {
+      if ((midiEvent->status >> 4) == 0x08) {
+        numNoteOffs++;
+      }
 
-    iterator = (LinkedListIterator)(iterator->nextItem);
+      numEvents++;
+    }
   }
 
-  iterator = midiEvents;
+  // Some monophonic instruments have problems dealing with the order of MIDI
+  // events, so send them all note off events *first* followed by any other
+  // event types. Both groups keep their original order.
+  int noteOffIndex = 0;
+  int otherIndex = numNoteOffs;
 
-  while (iterator != NULL && outIndex < numEvents) {
-    MidiEvent midiEvent = (MidiEvent)(iterator->item);
+  for (int i = 0; i < numEvents; i++) {
+    VstMidiEvent *vstMidiEvent = &(data->vstMidiEvents[i]);
 
-    if (midiEvent != NULL && (midiEvent->status >> 4) != 0x08) {
-      VstMidiEvent *vstMidiEvent = (VstMidiEvent *)malloc(sizeof(VstMidiEvent));
-      _fillVstMidiEvent(midiEvent, vstMidiEvent);
-      data->vstEvents->events[outIndex] = (VstEvent *)vstMidiEvent;
-      outIndex++;
+    if ((vstMidiEvent->midiData[0] >> 4) == 0x08) {
+      data->vstEvents->events[noteOffIndex++] = (VstEvent *)vstMidiEvent;
+    } else {
+      data->vstEvents->events[otherIndex++] = (VstEvent *)vstMidiEvent;
     }
-
-    iterator = (LinkedListIterator)(iterator->nextItem);
   }
 
+  data->vstEvents->numEvents = numEvents;
   data->dispatcher(data->pluginHandle, effProcessEvents, 0, 0, data->vstEvents,
                    0.0f);
 }
@@ -901,11 +1235,30 @@ static boolByte _setParameterVst2xPlugin(void *pluginPtr, unsigned int index,
   }
 }
 
+static boolByte _setParameterQuietlyVst2xPlugin(void *pluginPtr,
+                                                unsigned int index,
+                                                float value) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginVst2xData data = (PluginVst2xData)(plugin->extraData);
+
+  if (index < (unsigned int)data->pluginHandle->numParams) {
+    data->pluginHandle->setParameter(data->pluginHandle, index, value);
+    return true;
+  }
+
+  return false;
+}
+
 static void _prepareForProcessingVst2xPlugin(void *pluginPtr) {
   Plugin plugin = (Plugin)pluginPtr;
   _resumePlugin(plugin);
 }
 
+static void _suspendVst2xPlugin(void *pluginPtr) {
+  Plugin plugin = (Plugin)pluginPtr;
+  _suspendPlugin(plugin);
+}
+
 static boolByte _pluginVst2xGetWindowRect(Plugin self,
                                           PluginWindowSize *outRect) {
   PluginVst2xData data = (PluginVst2xData)(self->extraData);
@@ -959,13 +1312,8 @@ static void _freeVst2xPluginData(void *pluginDataPtr) {
   freePluginVst2xId(data->pluginId);
   closeLibraryHandle(data->libraryHandle);
 
-  if (data->vstEvents != NULL) {
-    for (int i = 0; i < data->vstEvents->numEvents; i++) {
-      free(data->vstEvents->events[i]);
-    }
-
-    free(data->vstEvents);
-  }
+  free(data->vstEvents);
+  free(data->vstMidiEvents);
 }
 
 Plugin newPluginVst2x(const CharString pluginName,
@@ -981,7 +1329,9 @@ Plugin newPluginVst2x(const CharString pluginName,
   plugin->processAudio = _processAudioVst2xPlugin;
   plugin->processMidiEvents = _processMidiEventsVst2xPlugin;
   plugin->setParameter = _setParameterVst2xPlugin;
+  plugin->setParameterQuietly = _setParameterQuietlyVst2xPlugin;
   plugin->prepareForProcessing = _prepareForProcessingVst2xPlugin;
+  plugin->suspend = _suspendVst2xPlugin;
   plugin->showEditor = _showVst2xEditor;
   plugin->closePlugin = _closeVst2xPlugin;
   plugin->freePluginData = _freeVst2xPluginData;
@@ -997,6 +1347,13 @@ Plugin newPluginVst2x(const CharString pluginName,
   extraData->isPluginShell = (boolByte)(shellPluginDelimiter != NULL);
   extraData->shellPluginId = 0;
   extraData->vstEvents = NULL;
+  extraData->vstMidiEvents = NULL;
+  extraData->vstEventsCapacity = 0;
+  extraData->vstTimeInfoValidFlags = 0;
+  extraData->vstTimeInfoVersion = 0;
+  extraData->offlineSession = NULL;
+  extraData->isOfflineTaskRunning = false;
+  _ensureVstEventsCapacity(extraData, kPluginVst2xInitialEventCapacity);
   plugin->extraData = extraData;
 
   return plugin;
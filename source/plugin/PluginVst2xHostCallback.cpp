@@ -36,29 +36,30 @@ extern "C" {
 #include "audio/AudioSettings.h"
 #include "base/CharString.h"
 #include "logging/EventLogger.h"
+#include "logging/TraceLogger.h"
 #include "plugin/PluginChain.h"
+#include "plugin/PluginSandbox.h"
 #include "plugin/PluginVst2x.h"
 #include "plugin/PluginVst2xId.h"
 #include "time/AudioClock.h"
+#include "time/TaskTimer.h"
 
-#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
 void pluginVst2xAudioMasterIOChanged(const Plugin self,
                                      AEffect const *const newValues);
+VstTimeInfo *pluginVst2xGetTimeInfo(AEffect *effect,
+                                    const VstIntPtr requestedFlags);
+VstIntPtr pluginVst2xOfflineStart(AEffect *effect);
+VstIntPtr pluginVst2xOfflineRead(AEffect *effect, VstOfflineTask *task,
+                                 const VstIntPtr option,
+                                 const boolByte fromInput);
+VstIntPtr pluginVst2xOfflineWrite(AEffect *effect, VstOfflineTask *task,
+                                  const VstIntPtr option);
+VstIntPtr pluginVst2xOfflineGetCurrentPass(AEffect *effect);
 }
 
-// Global variables (sigh, unfortunately yes). When plugins ask for the time,
-// they expect that the host will pass them a pointer to a VstTimeInfo struct, a
-// pointer to which they are not the owner of and are not expected to free
-// afterwards... which is actually the correct thing to do, given that if this
-// were the case, a huge number of plugins would probably fail to do this and
-// leak memory all over the place. Anyways, since we cannot scope this variable
-// intelligently, we instead keep one instance of it as a static variable, so it
-// is always available to plugins when they ask for the time.
-static VstTimeInfo vstTimeInfo;
-
 extern "C" {
 
 // Current plugin ID, which is mostly used by shell plugins during
@@ -92,7 +93,7 @@ static int _canHostDo(const char *pluginName, const char *canDoString) {
   } else if (!strcmp(canDoString, "sizeWindow")) {
     supported = false;
   } else if (!strcmp(canDoString, "offline")) {
-    supported = false;
+    supported = true;
   } else if (!strcmp(canDoString, "openFileSelector")) {
     supported = false;
   } else if (!strcmp(canDoString, "closeFileSelector")) {
@@ -111,9 +112,56 @@ static int _canHostDo(const char *pluginName, const char *canDoString) {
   return supported;
 }
 
+// Name used for host callbacks in the trace file. Only the opcodes which are
+// likely to be called during processing are named here.
+static const char *_getHostCallbackTraceName(VstInt32 opcode) {
+  switch (opcode) {
+  case audioMasterAutomate:
+    return "audioMasterAutomate";
+  case audioMasterIdle:
+    return "audioMasterIdle";
+  case audioMasterGetTime:
+    return "audioMasterGetTime";
+  case audioMasterProcessEvents:
+    return "audioMasterProcessEvents";
+  case audioMasterIOChanged:
+    return "audioMasterIOChanged";
+  case audioMasterGetSampleRate:
+    return "audioMasterGetSampleRate";
+  case audioMasterGetBlockSize:
+    return "audioMasterGetBlockSize";
+  case audioMasterGetCurrentProcessLevel:
+    return "audioMasterGetCurrentProcessLevel";
+  case audioMasterOfflineRead:
+    return "audioMasterOfflineRead";
+  case audioMasterOfflineWrite:
+    return "audioMasterOfflineWrite";
+  case audioMasterCanDo:
+    return "audioMasterCanDo";
+  default:
+    return "audioMaster";
+  }
+}
+
 VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
                                               VstInt32 index, VstIntPtr value,
                                               void *dataPtr, float opt) {
+  // Plugins may ask for the time many times per block, so this is answered
+  // before the plugin ID is built and the call is logged. The transport
+  // values are calculated once when the audio clock changes.
+  if (opcode == audioMasterGetTime) {
+    if (isTraceLoggerEnabled()) {
+      unsigned long long startTime = taskTimerGetCurrentTimeInNs();
+      VstIntPtr timeInfo = (VstIntPtr)pluginVst2xGetTimeInfo(effect, value);
+      traceLoggerCompleteEvent("host", _getHostCallbackTraceName(opcode),
+                               startTime,
+                               taskTimerGetCurrentTimeInNs() - startTime);
+      return timeInfo;
+    }
+
+    return (VstIntPtr)pluginVst2xGetTimeInfo(effect, value);
+  }
+
   // This string is used in a bunch of logging calls below
   PluginVst2xId pluginId;
 
@@ -128,6 +176,11 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
 
   const char *pluginIdString = pluginId->idString->data;
   VstIntPtr result = 0;
+  unsigned long long traceStartTime = 0;
+
+  if (isTraceLoggerEnabled()) {
+    traceStartTime = taskTimerGetCurrentTimeInNs();
+  }
 
   logDebug("Plugin '%s' called host dispatcher with %d, %d, %d", pluginIdString,
            opcode, index, value);
@@ -166,80 +219,6 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
     result = 1;
     break;
 
-  case audioMasterGetTime: {
-    AudioClock audioClock = getAudioClock();
-
-    // These values are always valid
-    vstTimeInfo.samplePos = audioClock->currentFrame;
-    vstTimeInfo.sampleRate = getSampleRate();
-
-    // Set flags for transport state
-    vstTimeInfo.flags = 0;
-    vstTimeInfo.flags |=
-        audioClock->transportChanged ? kVstTransportChanged : 0;
-    vstTimeInfo.flags |= audioClock->isPlaying ? kVstTransportPlaying : 0;
-
-    // Fill values based on other flags which may have been requested
-    if (value & kVstNanosValid) {
-      // It doesn't make sense to return this value, as the plugin may try to
-      // calculate something based on the current system time. As we are running
-      // offline, anything the plugin calculates here will probably be wrong
-      // given the way we are running.  However, for real-time mode, this flag
-      // should be implemented in that case.
-      logWarn("Plugin '%s' asked for time in nanoseconds (unsupported)",
-              pluginIdString);
-    }
-
-    if (value & kVstPpqPosValid) {
-      // TODO: Move calculations to AudioClock
-      double samplesPerBeat = (60.0 / getTempo()) * getSampleRate();
-      // Musical time starts with 1, not 0
-      vstTimeInfo.ppqPos = (vstTimeInfo.samplePos / samplesPerBeat) + 1.0;
-      logDebug("Current PPQ position is %g", vstTimeInfo.ppqPos);
-      vstTimeInfo.flags |= kVstPpqPosValid;
-    }
-
-    if (value & kVstTempoValid) {
-      vstTimeInfo.tempo = getTempo();
-      vstTimeInfo.flags |= kVstTempoValid;
-    }
-
-    if (value & kVstBarsValid) {
-      if (!(value & kVstPpqPosValid)) {
-        logError("Plugin requested position in bars, but not PPQ");
-      }
-
-      // TODO: Move calculations to AudioClock
-      double currentBarPos =
-          floor(vstTimeInfo.ppqPos / (double)getTimeSignatureBeatsPerMeasure());
-      vstTimeInfo.barStartPos =
-          currentBarPos * (double)getTimeSignatureBeatsPerMeasure() + 1.0;
-      logDebug("Current bar is %g", vstTimeInfo.barStartPos);
-      vstTimeInfo.flags |= kVstBarsValid;
-    }
-
-    if (value & kVstCyclePosValid) {
-      // We don't support cycling, so this is always 0
-    }
-
-    if (value & kVstTimeSigValid) {
-      vstTimeInfo.timeSigNumerator = getTimeSignatureBeatsPerMeasure();
-      vstTimeInfo.timeSigDenominator = getTimeSignatureNoteValue();
-      vstTimeInfo.flags |= kVstTimeSigValid;
-    }
-
-    if (value & kVstSmpteValid) {
-      logUnsupportedFeature("Current time in SMPTE format");
-    }
-
-    if (value & kVstClockValid) {
-      logUnsupportedFeature("Sample frames until next clock");
-    }
-
-    result = (VstIntPtr)&vstTimeInfo;
-    break;
-  }
-
   case audioMasterProcessEvents:
     logUnsupportedFeature("VST master opcode audioMasterProcessEvents");
     break;
@@ -263,13 +242,28 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
   case audioMasterIOChanged: {
     if (effect != NULL) {
       PluginChain pluginChain = getPluginChain();
+      Plugin sandboxPlugin = pluginSandboxGetChildPlugin();
       logDebug("Number of inputs: %d", effect->numInputs);
       logDebug("Number of outputs: %d", effect->numOutputs);
       logDebug("Number of parameters: %d", effect->numParams);
       logDebug("Initial Delay: %d", effect->initialDelay);
       result = -1;
 
-      for (unsigned int i = 0; i < pluginChain->numPlugins; ++i) {
+      // A sandbox process only hosts one plugin, and its copy of the chain
+      // belongs to the host
+      if (sandboxPlugin != NULL) {
+        if ((unsigned long)effect->uniqueID ==
+            pluginVst2xGetUniqueId(sandboxPlugin)) {
+          logDebug("Updating plugin");
+          pluginVst2xAudioMasterIOChanged(sandboxPlugin, effect);
+          result = 0;
+        }
+
+        break;
+      }
+
+      for (unsigned int i = 0;
+           pluginChain != NULL && i < pluginChain->numPlugins; ++i) {
         if ((unsigned long)effect->uniqueID ==
             pluginVst2xGetUniqueId(pluginChain->plugins[i])) {
           logDebug("Updating plugin");
@@ -323,8 +317,11 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
     break;
 
   case audioMasterGetCurrentProcessLevel:
-    // We are not a multi-threaded app and have no GUI, so this is unsupported
-    result = kVstProcessLevelUnknown;
+    // We have no GUI or separate audio thread, so plugins are only told
+    // whether they must keep up with realtime or may take as long as they need
+    result = getAudioClock() != NULL && getAudioClock()->isRealtime
+                 ? kVstProcessLevelRealtime
+                 : kVstProcessLevelOffline;
     break;
 
   case audioMasterGetAutomationState:
@@ -333,28 +330,25 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
     break;
 
   case audioMasterOfflineStart:
-    logWarn("Plugin '%s' asked us to start offline processing (unsupported)",
-            pluginIdString);
+    result = pluginVst2xOfflineStart(effect);
     break;
 
   case audioMasterOfflineRead:
-    logWarn("Plugin '%s' asked to read offline data (unsupported)",
-            pluginIdString);
+    result = pluginVst2xOfflineRead(effect, (VstOfflineTask *)dataPtr, value,
+                                    (boolByte)(index != 0));
     break;
 
   case audioMasterOfflineWrite:
-    logWarn("Plugin '%s' asked to write offline data (unsupported)",
-            pluginIdString);
+    result = pluginVst2xOfflineWrite(effect, (VstOfflineTask *)dataPtr, value);
     break;
 
   case audioMasterOfflineGetCurrentPass:
-    logWarn("Plugin '%s' asked for current offline pass (unsupported)",
-            pluginIdString);
+    result = pluginVst2xOfflineGetCurrentPass(effect);
     break;
 
   case audioMasterOfflineGetCurrentMetaPass:
-    logWarn("Plugin '%s' asked for current offline meta pass (unsupported)",
-            pluginIdString);
+    // Passes are never grouped together
+    result = 0;
     break;
 
   case audioMasterSetOutputSampleRate:
@@ -456,6 +450,12 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
     break;
   }
 
+  if (isTraceLoggerEnabled()) {
+    traceLoggerCompleteEvent("host", _getHostCallbackTraceName(opcode),
+                             traceStartTime,
+                             taskTimerGetCurrentTimeInNs() - traceStartTime);
+  }
+
   freePluginVst2xId(pluginId);
   return result;
 }
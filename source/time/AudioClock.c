@@ -26,16 +26,28 @@
 
 #include "AudioClock.h"
 
+#include "audio/AudioSettings.h"
+#include "time/TaskTimer.h"
+
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 AudioClock audioClockInstance = NULL;
 
+// Resolution of MIDI clock messages, in pulses per quarter note
+static const double kAudioClockMidiClocksPerBeat = 24.0;
+
 void initAudioClock(void) {
   audioClockInstance = (AudioClock)malloc(sizeof(AudioClockMembers));
   audioClockInstance->currentFrame = 0;
   audioClockInstance->transportChanged = false;
   audioClockInstance->isPlaying = false;
+  audioClockInstance->nanoseconds = 0;
+  audioClockInstance->isRealtime = false;
+  audioClockInstance->transportVersion = 0;
+  audioClockInstance->_tempoMap = NULL;
+  audioClockUpdateTransport(audioClockInstance);
 }
 
 AudioClock getAudioClock(void) { return audioClockInstance; }
@@ -49,11 +61,67 @@ void advanceAudioClock(AudioClock self, const unsigned long blocksize) {
   }
 
   self->currentFrame += blocksize;
+  audioClockUpdateTransport(self);
+}
+
+void audioClockSetTempoMap(AudioClock self, TempoMap tempoMap) {
+  self->_tempoMap = tempoMap;
+  audioClockUpdateTransport(self);
+}
+
+void audioClockUpdateTransport(AudioClock self) {
+  const TempoMapTimeSignature *timeSignature;
+  double samplesPerBeat;
+  double quarterNotesPerBar;
+  double midiClocks;
+
+  if (self->_tempoMap != NULL) {
+    self->ppqPosition =
+        tempoMapFramesToPpq(self->_tempoMap, self->currentFrame);
+    self->barStartPpqPosition =
+        tempoMapGetBarStartPpq(self->_tempoMap, self->ppqPosition);
+    self->tempo = tempoMapGetTempoAtFrame(self->_tempoMap, self->currentFrame);
+    samplesPerBeat = (60.0 / self->tempo) * getSampleRate();
+    timeSignature =
+        tempoMapGetTimeSignatureAtPpq(self->_tempoMap, self->ppqPosition);
+    self->timeSignatureNumerator = timeSignature->numerator;
+    self->timeSignatureDenominator = timeSignature->denominator;
+  } else {
+    self->tempo = getTempo();
+    self->timeSignatureNumerator = getTimeSignatureBeatsPerMeasure();
+    self->timeSignatureDenominator = getTimeSignatureNoteValue();
+    samplesPerBeat = (60.0 / self->tempo) * getSampleRate();
+    quarterNotesPerBar = (double)self->timeSignatureNumerator * 4.0 /
+                         (double)self->timeSignatureDenominator;
+    self->ppqPosition = (double)self->currentFrame / samplesPerBeat;
+    self->barStartPpqPosition =
+        floor(self->ppqPosition / quarterNotesPerBar) * quarterNotesPerBar;
+  }
+
+  // Distance to the nearest clock in beats, rounded to the nearest frame
+  midiClocks = self->ppqPosition * kAudioClockMidiClocksPerBeat;
+  self->samplesToNextClock = (long)floor(
+      (floor(midiClocks + 0.5) - midiClocks) / kAudioClockMidiClocksPerBeat *
+          samplesPerBeat +
+      0.5);
+
+  if (self->isRealtime) {
+    self->nanoseconds = taskTimerGetCurrentTimeInNs();
+  }
+
+  self->transportVersion++;
 }
 
 void audioClockStop(AudioClock self) {
   self->isPlaying = false;
   self->transportChanged = true;
+  self->transportVersion++;
+}
+
+void audioClockRewind(AudioClock self) {
+  audioClockStop(self);
+  self->currentFrame = 0;
+  audioClockUpdateTransport(self);
 }
 
 void freeAudioClock(AudioClock self) {
@@ -28,6 +28,7 @@
 #define MrsWatson_AudioClock_h
 
 #include "base/Types.h"
+#include "time/TempoMap.h"
 
 /**
  * The AudioClock class keeps track of the sequence time and delivers the
@@ -40,6 +41,27 @@ typedef struct {
   boolByte transportChanged;
   boolByte isPlaying;
   unsigned long currentFrame;
+
+  // Musical position at currentFrame, which is updated whenever the clock
+  // moves. Positions are in quarter notes, starting from 0.
+  double ppqPosition;
+  double barStartPpqPosition;
+  Tempo tempo;
+  unsigned short timeSignatureNumerator;
+  unsigned short timeSignatureDenominator;
+  // Sample frames until the nearest MIDI clock (24 per quarter note), which is
+  // negative if the nearest clock has already passed
+  long samplesToNextClock;
+  // System time when the clock last moved. This is only set in realtime mode,
+  // since otherwise the processing time has nothing to do with the position.
+  unsigned long long nanoseconds;
+  boolByte isRealtime;
+  // Incremented whenever any of the above values change, so that callers may
+  // cache anything derived from them until the next change
+  unsigned long transportVersion;
+
+  // Private fields
+  TempoMap _tempoMap;
 } AudioClockMembers;
 typedef AudioClockMembers *AudioClock;
 extern AudioClock audioClockInstance;
@@ -66,12 +88,34 @@ AudioClock getAudioClock(void);
  */
 void advanceAudioClock(AudioClock self, const unsigned long blocksize);
 
+/**
+ * Set the tempo map used to calculate the musical position. When no map is set,
+ * the clock uses the current tempo and time signature from AudioSettings.
+ * @param self
+ * @param tempoMap Tempo map, which is not owned by the clock, or NULL
+ */
+void audioClockSetTempoMap(AudioClock self, TempoMap tempoMap);
+
+/**
+ * Recalculate the musical position for the current frame. This is done
+ * automatically when the clock moves, but must also be called after changing
+ * the tempo or time signature in AudioSettings.
+ * @param self
+ */
+void audioClockUpdateTransport(AudioClock self);
+
 /**
  * Indicate that playback is stopped.
  * @param self
  */
 void audioClockStop(AudioClock self);
 
+/**
+ * Stop playback and move the clock back to the first frame.
+ * @param self
+ */
+void audioClockRewind(AudioClock self);
+
 /**
  * Free an audio clock instance and its associated resources.
  * @param self
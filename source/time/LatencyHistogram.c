@@ -0,0 +1,216 @@
+//
+// LatencyHistogram.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "LatencyHistogram.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NS_PER_MS 1000000.0
+
+LatencyHistogram newLatencyHistogram(const double budgetInMs) {
+  LatencyHistogram histogram =
+      (LatencyHistogram)malloc(sizeof(LatencyHistogramMembers));
+
+  histogram->buckets = (unsigned long *)calloc(LATENCY_HISTOGRAM_NUM_BUCKETS,
+                                               sizeof(unsigned long));
+  histogram->budgetInNs =
+      budgetInMs > 0.0 ? (unsigned long long)(budgetInMs * NS_PER_MS) : 0;
+  latencyHistogramClear(histogram);
+
+  return histogram;
+}
+
+static unsigned int _getBucketIndex(const unsigned long long value) {
+  unsigned long long remaining = value;
+  unsigned int highestBit = 0;
+  unsigned int shift;
+
+  if (value < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+    return (unsigned int)value;
+  }
+
+  while (remaining >>= 1) {
+    highestBit++;
+  }
+
+  shift = highestBit - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+  return LATENCY_HISTOGRAM_SUB_BUCKETS + shift * LATENCY_HISTOGRAM_SUB_BUCKETS +
+         (unsigned int)((value >> shift) & (LATENCY_HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+static double _getBucketMidpoint(const unsigned int index) {
+  unsigned int shift;
+  unsigned int subBucket;
+  unsigned long long lowerBound;
+
+  if (index < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+    return (double)index;
+  }
+
+  shift =
+      (index - LATENCY_HISTOGRAM_SUB_BUCKETS) / LATENCY_HISTOGRAM_SUB_BUCKETS;
+  subBucket =
+      (index - LATENCY_HISTOGRAM_SUB_BUCKETS) % LATENCY_HISTOGRAM_SUB_BUCKETS;
+  lowerBound = (unsigned long long)(LATENCY_HISTOGRAM_SUB_BUCKETS + subBucket)
+               << shift;
+  return (double)lowerBound + (double)(1ull << shift) / 2.0;
+}
+
+void latencyHistogramAdd(LatencyHistogram self,
+                         const unsigned long long timeInNs) {
+  self->buckets[_getBucketIndex(timeInNs)]++;
+
+  if (self->numSamples == 0 || timeInNs < self->minTimeInNs) {
+    self->minTimeInNs = timeInNs;
+  }
+
+  if (timeInNs > self->maxTimeInNs) {
+    self->maxTimeInNs = timeInNs;
+  }
+
+  if (self->budgetInNs > 0 && timeInNs > self->budgetInNs) {
+    self->numOverBudget++;
+  }
+
+  self->numSamples++;
+}
+
+double latencyHistogramGetPercentile(const LatencyHistogram self,
+                                     const double percentile) {
+  unsigned long targetCount;
+  unsigned long count = 0;
+  unsigned int i;
+  double result;
+
+  if (self->numSamples == 0) {
+    return 0.0;
+  } else if (percentile <= 0.0) {
+    return latencyHistogramGetMin(self);
+  } else if (percentile >= 100.0) {
+    return latencyHistogramGetMax(self);
+  }
+
+  targetCount = (unsigned long)(percentile * self->numSamples / 100.0 + 0.5);
+
+  if (targetCount == 0) {
+    targetCount = 1;
+  }
+
+  for (i = 0; i < LATENCY_HISTOGRAM_NUM_BUCKETS; i++) {
+    count += self->buckets[i];
+
+    if (count >= targetCount) {
+      break;
+    }
+  }
+
+  // The bucket midpoint may lie outside of the actual recorded range when only
+  // a handful of samples have landed in the first or last bucket
+  result = _getBucketMidpoint(i);
+
+  if (result < (double)self->minTimeInNs) {
+    result = (double)self->minTimeInNs;
+  } else if (result > (double)self->maxTimeInNs) {
+    result = (double)self->maxTimeInNs;
+  }
+
+  return result / NS_PER_MS;
+}
+
+double latencyHistogramGetMin(const LatencyHistogram self) {
+  return (double)self->minTimeInNs / NS_PER_MS;
+}
+
+double latencyHistogramGetMax(const LatencyHistogram self) {
+  return (double)self->maxTimeInNs / NS_PER_MS;
+}
+
+void latencyHistogramClear(LatencyHistogram self) {
+  memset(self->buckets, 0,
+         sizeof(unsigned long) * LATENCY_HISTOGRAM_NUM_BUCKETS);
+  self->numSamples = 0;
+  self->minTimeInNs = 0;
+  self->maxTimeInNs = 0;
+  self->numOverBudget = 0;
+}
+
+static void _formatTime(const double timeInMs, char *outString,
+                        const size_t outStringSize) {
+  if (timeInMs < 1.0) {
+    snprintf(outString, outStringSize, "%.1fus", timeInMs * 1000.0);
+  } else if (timeInMs < 1000.0) {
+    snprintf(outString, outStringSize, "%.2fms", timeInMs);
+  } else {
+    snprintf(outString, outStringSize, "%.2fsec", timeInMs / 1000.0);
+  }
+}
+
+CharString latencyHistogramToString(const LatencyHistogram self) {
+  CharString outString = newCharString();
+  const double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+  const char *percentileNames[] = {"p50", "p90", "p99", "p99.9"};
+  char timeString[kCharStringLengthShort];
+  char itemString[kCharStringLengthShort];
+  size_t i;
+
+  if (self->numSamples == 0) {
+    charStringCopyCString(outString, "no samples");
+    return outString;
+  }
+
+  _formatTime(latencyHistogramGetMin(self), timeString, kCharStringLengthShort);
+  snprintf(itemString, kCharStringLengthShort, "min %s", timeString);
+  charStringAppendCString(outString, itemString);
+
+  for (i = 0; i < sizeof(percentiles) / sizeof(double); i++) {
+    _formatTime(latencyHistogramGetPercentile(self, percentiles[i]),
+                timeString, kCharStringLengthShort);
+    snprintf(itemString, kCharStringLengthShort, ", %s %s", percentileNames[i],
+             timeString);
+    charStringAppendCString(outString, itemString);
+  }
+
+  _formatTime(latencyHistogramGetMax(self), timeString, kCharStringLengthShort);
+  snprintf(itemString, kCharStringLengthShort, ", max %s", timeString);
+  charStringAppendCString(outString, itemString);
+
+  if (self->budgetInNs > 0) {
+    snprintf(itemString, kCharStringLengthShort, ", %lu/%lu over budget",
+             self->numOverBudget, self->numSamples);
+    charStringAppendCString(outString, itemString);
+  }
+
+  return outString;
+}
+
+void freeLatencyHistogram(LatencyHistogram self) {
+  if (self != NULL) {
+    free(self->buckets);
+    free(self);
+  }
+}
@@ -0,0 +1,117 @@
+//
+// LatencyHistogram.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_LatencyHistogram_h
+#define MrsWatson_LatencyHistogram_h
+
+#include "base/CharString.h"
+
+/**
+ * A LatencyHistogram records the distribution of many short durations, such as
+ * the time spent processing each block of audio. Values are stored in
+ * log-linear buckets, with each power of two divided into a number of linear
+ * sub-buckets. This keeps the relative error of any reported percentile under
+ * 1 / LATENCY_HISTOGRAM_SUB_BUCKETS regardless of the magnitude of the value,
+ * while using a fixed amount of memory and constant time per sample.
+ */
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 4
+#define LATENCY_HISTOGRAM_SUB_BUCKETS (1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+#define LATENCY_HISTOGRAM_NUM_BUCKETS                                          \
+  (LATENCY_HISTOGRAM_SUB_BUCKETS +                                             \
+   (64 - LATENCY_HISTOGRAM_SUB_BUCKET_BITS) * LATENCY_HISTOGRAM_SUB_BUCKETS)
+
+typedef struct {
+  unsigned long *buckets;
+  unsigned long numSamples;
+  unsigned long long minTimeInNs;
+  unsigned long long maxTimeInNs;
+  unsigned long long budgetInNs;
+  unsigned long numOverBudget;
+} LatencyHistogramMembers;
+typedef LatencyHistogramMembers *LatencyHistogram;
+
+/**
+ * Create a new latency histogram
+ * @param budgetInMs Maximum amount of time which a single sample may take
+ * before it is counted as being over budget, for instance the duration of one
+ * block of audio at the current sample rate. Pass 0 to disable the budget.
+ * @return Initialized instance
+ */
+LatencyHistogram newLatencyHistogram(const double budgetInMs);
+
+/**
+ * Record a single duration.
+ * @param self
+ * @param timeInNs Duration in nanoseconds
+ */
+void latencyHistogramAdd(LatencyHistogram self,
+                         const unsigned long long timeInNs);
+
+/**
+ * Get the approximate duration below which a given percentage of all recorded
+ * samples fall.
+ * @param self
+ * @param percentile Percentile to query, in the range 0.0 - 100.0
+ * @return Duration in milliseconds, or 0 if no samples have been recorded
+ */
+double latencyHistogramGetPercentile(const LatencyHistogram self,
+                                     const double percentile);
+
+/**
+ * @param self
+ * @return Shortest recorded duration in milliseconds
+ */
+double latencyHistogramGetMin(const LatencyHistogram self);
+
+/**
+ * @param self
+ * @return Longest recorded duration in milliseconds
+ */
+double latencyHistogramGetMax(const LatencyHistogram self);
+
+/**
+ * Discard all recorded samples. The budget is left unchanged.
+ * @param self
+ */
+void latencyHistogramClear(LatencyHistogram self);
+
+/**
+ * Get a summary of the histogram suitable for printing in the log, in the form
+ * "min 1.2us, p50 3.4us, ..., max 2.1ms, 3/862 over budget". The number of
+ * samples over budget is only given when a budget is set.
+ * @param self
+ * @return Formatted string, which the caller must free themselves when finished
+ */
+CharString latencyHistogramToString(const LatencyHistogram self);
+
+/**
+ * Free a latency histogram and its associated resources
+ * @param self
+ */
+void freeLatencyHistogram(LatencyHistogram self);
+
+#endif
@@ -26,6 +26,8 @@
 
 #include "TaskTimer.h"
 
+#include "logging/TraceLogger.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -33,6 +35,48 @@
 #include <time.h>
 #endif
 
+#if MACOSX
+#include <mach/mach_time.h>
+#endif
+
+unsigned long long taskTimerGetCurrentTimeInNs(void) {
+#if WINDOWS
+  // Counter ticks per nanosecond
+  static double counterFrequency = 0.0;
+  LARGE_INTEGER currentTime;
+
+  if (counterFrequency == 0.0) {
+    LARGE_INTEGER queryFrequency;
+    QueryPerformanceFrequency(&queryFrequency);
+    counterFrequency = (double)(queryFrequency.QuadPart) / 1000000000.0;
+  }
+
+  QueryPerformanceCounter(&currentTime);
+  return (unsigned long long)((double)currentTime.QuadPart / counterFrequency);
+#elif MACOSX
+  static mach_timebase_info_data_t timebaseInfo;
+
+  if (timebaseInfo.denom == 0) {
+    mach_timebase_info(&timebaseInfo);
+  }
+
+  return mach_absolute_time() * timebaseInfo.numer / timebaseInfo.denom;
+#elif UNIX
+  struct timespec currentTime;
+// The raw monotonic clock is not subject to NTP slewing, which otherwise can
+// stretch or shrink very short intervals
+#if defined(CLOCK_MONOTONIC_RAW)
+  clock_gettime(CLOCK_MONOTONIC_RAW, &currentTime);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &currentTime);
+#endif
+  return (unsigned long long)currentTime.tv_sec * 1000000000ull +
+         (unsigned long long)currentTime.tv_nsec;
+#else
+  return 0;
+#endif
+}
+
 TaskTimer newTaskTimer(const CharString component, const char *subcomponent) {
   const char *componentCString = component != NULL ? component->data : NULL;
   return newTaskTimerWithCString(componentCString, subcomponent);
@@ -41,20 +85,17 @@ TaskTimer newTaskTimer(const CharString component, const char *subcomponent) {
 TaskTimer newTaskTimerWithCString(const char *component,
                                   const char *subcomponent) {
   TaskTimer taskTimer = (TaskTimer)malloc(sizeof(TaskTimerMembers));
-#if WINDOWS
-  LARGE_INTEGER queryFrequency;
-#endif
 
   taskTimer->component = newCharStringWithCString(component);
   taskTimer->subcomponent = newCharStringWithCString(subcomponent);
   taskTimer->enabled = true;
   taskTimer->_running = false;
   taskTimer->totalTaskTime = 0.0;
-
-#if WINDOWS
-  QueryPerformanceFrequency(&queryFrequency);
-  taskTimer->counterFrequency = (double)(queryFrequency.QuadPart) / 1000.0;
-#endif
+  taskTimer->histogram = NULL;
+  taskTimer->startTimeInNs = 0;
+  taskTimer->_inGroup = false;
+  taskTimer->_groupIntervals = 0;
+  taskTimer->_groupTimeInNs = 0;
 
   return taskTimer;
 }
@@ -64,58 +105,66 @@ void taskTimerStart(TaskTimer self) {
     taskTimerStop(self);
   }
 
-#if WINDOWS
-  QueryPerformanceCounter(&(self->startTime));
-#elif UNIX
-  gettimeofday(&self->startTime, NULL);
-#endif
+  self->startTimeInNs = taskTimerGetCurrentTimeInNs();
   self->_running = true;
 }
 
 double taskTimerStop(TaskTimer self) {
-  double elapsedTimeInMs = 0.0;
-#if UNIX
-  double elapsedFullSeconds;
-  double elapsedMicroseconds;
-  struct timeval currentTime;
-#elif WINDOWS
-  LONGLONG elapsedTimeInClocks;
-  LARGE_INTEGER stopTime;
-#endif
+  unsigned long long elapsedTimeInNs;
+  double elapsedTimeInMs;
+  char traceEventName[kCharStringLengthDefault];
 
   if (!self->_running) {
     return 0.0;
   }
 
-#if UNIX
-
-  if (gettimeofday(&currentTime, NULL) == 0) {
-    if (currentTime.tv_sec == self->startTime.tv_sec) {
-      elapsedTimeInMs =
-          (double)(currentTime.tv_usec - self->startTime.tv_usec) / 1000.0;
-    } else {
-      elapsedFullSeconds =
-          (double)(currentTime.tv_sec - self->startTime.tv_sec - 1);
-      elapsedMicroseconds =
-          (double)(currentTime.tv_usec + (1000000l - self->startTime.tv_usec));
-      elapsedTimeInMs =
-          (elapsedFullSeconds * 1000.0) + (elapsedMicroseconds / 1000.0);
-    }
+  elapsedTimeInNs = taskTimerGetCurrentTimeInNs() - self->startTimeInNs;
+  elapsedTimeInMs = (double)elapsedTimeInNs / 1000000.0;
+  self->totalTaskTime += elapsedTimeInMs;
 
-    self->totalTaskTime += elapsedTimeInMs;
+  if (self->_inGroup) {
+    self->_groupIntervals++;
+    self->_groupTimeInNs += elapsedTimeInNs;
+  } else if (self->histogram != NULL) {
+    latencyHistogramAdd(self->histogram, elapsedTimeInNs);
   }
 
-#elif WINDOWS
-  QueryPerformanceCounter(&stopTime);
-  elapsedTimeInClocks = stopTime.QuadPart - self->startTime.QuadPart;
-  elapsedTimeInMs = (double)(elapsedTimeInClocks) / self->counterFrequency;
-  self->totalTaskTime += elapsedTimeInMs;
-#endif
+  if (isTraceLoggerEnabled()) {
+    snprintf(traceEventName, kCharStringLengthDefault, "%s %s",
+             self->component->data, self->subcomponent->data);
+    traceLoggerCompleteEvent("timer", traceEventName, self->startTimeInNs,
+                             elapsedTimeInNs);
+  }
 
   self->_running = false;
   return elapsedTimeInMs;
 }
 
+void taskTimerEnableHistogram(TaskTimer self, const double budgetInMs) {
+  freeLatencyHistogram(self->histogram);
+  self->histogram = newLatencyHistogram(budgetInMs);
+}
+
+void taskTimerBeginGroup(TaskTimer self) {
+  self->_inGroup = true;
+  self->_groupIntervals = 0;
+  self->_groupTimeInNs = 0;
+}
+
+double taskTimerEndGroup(TaskTimer self) {
+  if (!self->_inGroup) {
+    return 0.0;
+  }
+
+  self->_inGroup = false;
+
+  if (self->_groupIntervals > 0 && self->histogram != NULL) {
+    latencyHistogramAdd(self->histogram, self->_groupTimeInNs);
+  }
+
+  return (double)self->_groupTimeInNs / 1000000.0;
+}
+
 CharString taskTimerHumanReadbleString(TaskTimer self) {
   int hours, minutes, seconds;
   CharString outString = newCharStringWithCapacity(kCharStringLengthShort);
@@ -159,6 +208,7 @@ void freeTaskTimer(TaskTimer self) {
   if (self != NULL) {
     freeCharString(self->component);
     freeCharString(self->subcomponent);
+    freeLatencyHistogram(self->histogram);
     free(self);
   }
 }
@@ -28,24 +28,25 @@
 #define MrsWatson_TaskTimer_h
 
 #include "base/CharString.h"
-
-#if UNIX
-#include <sys/time.h>
-#endif
+#include "time/LatencyHistogram.h"
 
 typedef struct {
   CharString component;
   CharString subcomponent;
   boolByte enabled;
   boolByte _running;
+  // Accumulated time in milliseconds
   double totalTaskTime;
+  // Distribution of the individual start/stop intervals. This is NULL unless
+  // taskTimerEnableHistogram() has been called.
+  LatencyHistogram histogram;
 
-#if WINDOWS
-  LARGE_INTEGER startTime;
-  double counterFrequency;
-#elif UNIX
-  struct timeval startTime;
-#endif
+  unsigned long long startTimeInNs;
+
+  // Private fields
+  boolByte _inGroup;
+  unsigned int _groupIntervals;
+  unsigned long long _groupTimeInNs;
 } TaskTimerMembers;
 typedef TaskTimerMembers *TaskTimer;
 
@@ -83,6 +84,33 @@ void taskTimerStart(TaskTimer self);
  */
 double taskTimerStop(TaskTimer self);
 
+/**
+ * Record the duration of each start/stop interval in a histogram, so that the
+ * tail latency of a task may be reported in addition to its total time. This is
+ * intended for timers which measure a single block of processing each time.
+ * @param self
+ * @param budgetInMs Maximum time a single interval may take before it is
+ * counted as being over budget, or 0 to disable the budget.
+ */
+void taskTimerEnableHistogram(TaskTimer self, const double budgetInMs);
+
+/**
+ * Begin a group of start/stop intervals which together measure one task, such
+ * as a block which is processed in several parts. Until taskTimerEndGroup() is
+ * called, the intervals are still added to the total time, but the histogram
+ * receives only their sum.
+ * @param self
+ */
+void taskTimerBeginGroup(TaskTimer self);
+
+/**
+ * End a group of intervals started with taskTimerBeginGroup(), and add their
+ * sum to the histogram. Nothing is added if no interval was measured.
+ * @param self
+ * @return Total time of the intervals in the group, in milliseconds
+ */
+double taskTimerEndGroup(TaskTimer self);
+
 /**
  * Get the string representation of the total accumulated time for this timer.
  * @param self
@@ -90,6 +118,14 @@ double taskTimerStop(TaskTimer self);
  */
 CharString taskTimerHumanReadbleString(TaskTimer self);
 
+/**
+ * Get the current value of the monotonic clock used by all task timers. This
+ * value has no meaning by itself, but the difference between two readings is
+ * the elapsed time between them.
+ * @return Current time in nanoseconds
+ */
+unsigned long long taskTimerGetCurrentTimeInNs(void);
+
 /**
  * Suspend execution for a given amount of milliseconds. Depending on the host
  * operating system, the amount of time actually slept may differ slightly from
@@ -0,0 +1,292 @@
+//
+// TempoMap.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "TempoMap.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t kTempoMapInitialCapacity = 8;
+
+static double _framesPerTick(const TempoMap self, const Tempo tempo) {
+  return (self->sampleRate * 60.0) / (tempo * (double)self->ticksPerBeat);
+}
+
+static double _quarterNotesPerBar(const TempoMapTimeSignature *timeSignature) {
+  return (double)timeSignature->numerator * 4.0 /
+         (double)timeSignature->denominator;
+}
+
+static double _ticksToPpq(const TempoMap self, const double tick) {
+  return tick / (double)self->ticksPerBeat;
+}
+
+// Find the index of the last segment starting at or before the given tick. The
+// first segment always starts at tick 0, so this never fails.
+static size_t _findSegment(const TempoMap self, const unsigned long tick) {
+  size_t low = 0;
+  size_t high = self->numSegments;
+  size_t middle;
+
+  while (high - low > 1) {
+    middle = low + (high - low) / 2;
+
+    if (self->segments[middle].tick <= tick) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+
+  return low;
+}
+
+static size_t _findSegmentForFrame(const TempoMap self, const double frame) {
+  size_t low = 0;
+  size_t high = self->numSegments;
+  size_t middle;
+
+  while (high - low > 1) {
+    middle = low + (high - low) / 2;
+
+    if (self->segments[middle].frame <= frame) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+
+  return low;
+}
+
+static size_t _findTimeSignature(const TempoMap self, const double tick) {
+  size_t low = 0;
+  size_t high = self->numTimeSignatures;
+  size_t middle;
+
+  while (high - low > 1) {
+    middle = low + (high - low) / 2;
+
+    if ((double)self->timeSignatures[middle].tick <= tick) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+
+  return low;
+}
+
+static void _updateSegmentFrames(TempoMap self, const size_t start) {
+  TempoMapSegment *previous;
+  size_t i;
+
+  for (i = start > 0 ? start : 1; i < self->numSegments; i++) {
+    previous = &(self->segments[i - 1]);
+    self->segments[i].frame =
+        previous->frame +
+        (double)(self->segments[i].tick - previous->tick) *
+            previous->framesPerTick;
+  }
+}
+
+static void _updateTimeSignatureBars(TempoMap self, const size_t start) {
+  TempoMapTimeSignature *previous;
+  double quarterNotes;
+  size_t i;
+
+  for (i = start > 0 ? start : 1; i < self->numTimeSignatures; i++) {
+    previous = &(self->timeSignatures[i - 1]);
+    quarterNotes = _ticksToPpq(
+        self, (double)(self->timeSignatures[i].tick - previous->tick));
+    self->timeSignatures[i].bar =
+        previous->bar + quarterNotes / _quarterNotesPerBar(previous);
+  }
+}
+
+TempoMap newTempoMap(const unsigned short ticksPerBeat,
+                     const Tempo initialTempo, const SampleRate sampleRate) {
+  TempoMap tempoMap = (TempoMap)malloc(sizeof(TempoMapMembers));
+
+  tempoMap->ticksPerBeat = ticksPerBeat;
+  tempoMap->sampleRate = sampleRate;
+
+  tempoMap->segments = (TempoMapSegment *)malloc(kTempoMapInitialCapacity *
+                                                 sizeof(TempoMapSegment));
+  tempoMap->_segmentsCapacity = kTempoMapInitialCapacity;
+  tempoMap->numSegments = 1;
+  tempoMap->segments[0].tick = 0;
+  tempoMap->segments[0].frame = 0.0;
+  tempoMap->segments[0].framesPerTick = _framesPerTick(tempoMap, initialTempo);
+  tempoMap->segments[0].tempo = initialTempo;
+
+  tempoMap->timeSignatures = (TempoMapTimeSignature *)malloc(
+      kTempoMapInitialCapacity * sizeof(TempoMapTimeSignature));
+  tempoMap->_timeSignaturesCapacity = kTempoMapInitialCapacity;
+  tempoMap->numTimeSignatures = 1;
+  tempoMap->timeSignatures[0].tick = 0;
+  tempoMap->timeSignatures[0].bar = 0.0;
+  tempoMap->timeSignatures[0].numerator = 4;
+  tempoMap->timeSignatures[0].denominator = 4;
+
+  return tempoMap;
+}
+
+void tempoMapAddTempoChange(TempoMap self, const unsigned long tick,
+                            const Tempo tempo) {
+  size_t index;
+
+  if (tempo <= 0.0) {
+    return;
+  }
+
+  index = _findSegment(self, tick);
+
+  if (self->segments[index].tick != tick) {
+    if (self->numSegments == self->_segmentsCapacity) {
+      self->_segmentsCapacity *= 2;
+      self->segments = (TempoMapSegment *)realloc(
+          self->segments, self->_segmentsCapacity * sizeof(TempoMapSegment));
+    }
+
+    index++;
+    memmove(self->segments + index + 1, self->segments + index,
+            (self->numSegments - index) * sizeof(TempoMapSegment));
+    self->segments[index].tick = tick;
+    self->numSegments++;
+  }
+
+  self->segments[index].framesPerTick = _framesPerTick(self, tempo);
+  self->segments[index].tempo = tempo;
+  _updateSegmentFrames(self, index);
+}
+
+void tempoMapAddTempoChangeFromMidiBytes(TempoMap self,
+                                         const unsigned long tick,
+                                         const byte *bytes) {
+  unsigned long microsecondsPerBeat = ((unsigned long)bytes[0] << 16) |
+                                      ((unsigned long)bytes[1] << 8) | bytes[2];
+
+  if (microsecondsPerBeat > 0) {
+    tempoMapAddTempoChange(self, tick,
+                           60000000.0 / (double)microsecondsPerBeat);
+  }
+}
+
+void tempoMapAddTimeSignatureChange(TempoMap self, const unsigned long tick,
+                                    const unsigned short numerator,
+                                    const unsigned short denominator) {
+  size_t index;
+
+  if (numerator == 0 || denominator == 0) {
+    return;
+  }
+
+  index = _findTimeSignature(self, (double)tick);
+
+  if (self->timeSignatures[index].tick != tick) {
+    if (self->numTimeSignatures == self->_timeSignaturesCapacity) {
+      self->_timeSignaturesCapacity *= 2;
+      self->timeSignatures = (TempoMapTimeSignature *)realloc(
+          self->timeSignatures,
+          self->_timeSignaturesCapacity * sizeof(TempoMapTimeSignature));
+    }
+
+    index++;
+    memmove(self->timeSignatures + index + 1, self->timeSignatures + index,
+            (self->numTimeSignatures - index) * sizeof(TempoMapTimeSignature));
+    self->timeSignatures[index].tick = tick;
+    self->numTimeSignatures++;
+  }
+
+  self->timeSignatures[index].numerator = numerator;
+  self->timeSignatures[index].denominator = denominator;
+  _updateTimeSignatureBars(self, index);
+}
+
+void tempoMapAddTimeSignatureChangeFromMidiBytes(TempoMap self,
+                                                 const unsigned long tick,
+                                                 const byte *bytes) {
+  // The denominator is stored as a power of two
+  if (bytes[1] < 16) {
+    tempoMapAddTimeSignatureChange(self, tick, bytes[0],
+                                   (unsigned short)(1 << bytes[1]));
+  }
+}
+
+unsigned long tempoMapTicksToFrames(const TempoMap self,
+                                    const unsigned long tick) {
+  const TempoMapSegment *segment = &(self->segments[_findSegment(self, tick)]);
+  return (unsigned long)(segment->frame + (double)(tick - segment->tick) *
+                                             segment->framesPerTick);
+}
+
+double tempoMapFramesToTicks(const TempoMap self, const unsigned long frame) {
+  const TempoMapSegment *segment =
+      &(self->segments[_findSegmentForFrame(self, (double)frame)]);
+  return (double)segment->tick +
+         ((double)frame - segment->frame) / segment->framesPerTick;
+}
+
+double tempoMapFramesToPpq(const TempoMap self, const unsigned long frame) {
+  return _ticksToPpq(self, tempoMapFramesToTicks(self, frame));
+}
+
+double tempoMapPpqToBars(const TempoMap self, const double ppq) {
+  const TempoMapTimeSignature *timeSignature =
+      tempoMapGetTimeSignatureAtPpq(self, ppq);
+  double startPpq = _ticksToPpq(self, (double)timeSignature->tick);
+  return timeSignature->bar +
+         (ppq - startPpq) / _quarterNotesPerBar(timeSignature);
+}
+
+double tempoMapGetBarStartPpq(const TempoMap self, const double ppq) {
+  const TempoMapTimeSignature *timeSignature =
+      tempoMapGetTimeSignatureAtPpq(self, ppq);
+  double startPpq = _ticksToPpq(self, (double)timeSignature->tick);
+  double quarterNotesPerBar = _quarterNotesPerBar(timeSignature);
+  return startPpq +
+         floor((ppq - startPpq) / quarterNotesPerBar) * quarterNotesPerBar;
+}
+
+Tempo tempoMapGetTempoAtFrame(const TempoMap self, const unsigned long frame) {
+  return self->segments[_findSegmentForFrame(self, (double)frame)].tempo;
+}
+
+const TempoMapTimeSignature *tempoMapGetTimeSignatureAtPpq(const TempoMap self,
+                                                           const double ppq) {
+  return &(self->timeSignatures[_findTimeSignature(
+      self, ppq * (double)self->ticksPerBeat)]);
+}
+
+void freeTempoMap(TempoMap self) {
+  if (self != NULL) {
+    free(self->segments);
+    free(self->timeSignatures);
+    free(self);
+  }
+}
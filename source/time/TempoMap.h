@@ -0,0 +1,190 @@
+//
+// TempoMap.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_TempoMap_h
+#define MrsWatson_TempoMap_h
+
+#include "base/Types.h"
+
+#include <stddef.h>
+
+typedef struct {
+  unsigned long tick;
+  // Position of this tempo change, in sample frames from the start
+  double frame;
+  double framesPerTick;
+  Tempo tempo;
+} TempoMapSegment;
+
+typedef struct {
+  unsigned long tick;
+  // Number of bars before this time signature change
+  double bar;
+  unsigned short numerator;
+  unsigned short denominator;
+} TempoMapTimeSignature;
+
+/**
+ * A TempoMap converts between sample frames, MIDI ticks, musical position in
+ * quarter notes (PPQ), and bars for a sequence which may contain tempo and time
+ * signature changes. Each change starts a new segment, and lookups use a binary
+ * search over the segments. The map is meant to be built once before
+ * processing, after which lookups don't allocate or modify it.
+ */
+typedef struct {
+  unsigned short ticksPerBeat;
+  SampleRate sampleRate;
+  TempoMapSegment *segments;
+  size_t numSegments;
+  TempoMapTimeSignature *timeSignatures;
+  size_t numTimeSignatures;
+
+  // Private fields
+  size_t _segmentsCapacity;
+  size_t _timeSignaturesCapacity;
+} TempoMapMembers;
+typedef TempoMapMembers *TempoMap;
+
+/**
+ * Create a new tempo map, which starts in 4/4 time
+ * @param ticksPerBeat Time division of the MIDI file, in ticks per quarter note
+ * @param initialTempo Tempo to use until the first tempo change, in BPM
+ * @param sampleRate Sample rate used to convert to sample frames
+ * @return TempoMap object
+ */
+TempoMap newTempoMap(const unsigned short ticksPerBeat,
+                     const Tempo initialTempo, const SampleRate sampleRate);
+
+/**
+ * Add a tempo change to the map. Changes may be added in any order, though
+ * adding them in tick order is fastest. A change at the same tick as an
+ * existing one replaces it.
+ * @param self
+ * @param tick Position of the tempo change
+ * @param tempo New tempo, in BPM
+ */
+void tempoMapAddTempoChange(TempoMap self, const unsigned long tick,
+                            const Tempo tempo);
+
+/**
+ * Add a tempo change from the data of a MIDI tempo meta event.
+ * @param self
+ * @param tick Position of the tempo change
+ * @param bytes Three bytes of tempo event data (microseconds per beat)
+ */
+void tempoMapAddTempoChangeFromMidiBytes(TempoMap self,
+                                         const unsigned long tick,
+                                         const byte *bytes);
+
+/**
+ * Add a time signature change to the map. Like tempo changes, these may be
+ * added in any order and replace any existing change at the same tick.
+ * @param self
+ * @param tick Position of the time signature change, which should be at the
+ * start of a bar
+ * @param numerator Beats per measure
+ * @param denominator Note value of one beat, for example 4 for quarter notes
+ */
+void tempoMapAddTimeSignatureChange(TempoMap self, const unsigned long tick,
+                                    const unsigned short numerator,
+                                    const unsigned short denominator);
+
+/**
+ * Add a time signature change from the data of a MIDI time signature event.
+ * @param self
+ * @param tick Position of the time signature change
+ * @param bytes At least two bytes of time signature event data
+ */
+void tempoMapAddTimeSignatureChangeFromMidiBytes(TempoMap self,
+                                                 const unsigned long tick,
+                                                 const byte *bytes);
+
+/**
+ * Convert a position in ticks to sample frames.
+ * @param self
+ * @param tick Position in MIDI ticks
+ * @return Position in sample frames
+ */
+unsigned long tempoMapTicksToFrames(const TempoMap self,
+                                    const unsigned long tick);
+
+/**
+ * Convert a position in sample frames to ticks.
+ * @param self
+ * @param frame Position in sample frames
+ * @return Position in MIDI ticks, including any fraction of a tick
+ */
+double tempoMapFramesToTicks(const TempoMap self, const unsigned long frame);
+
+/**
+ * Convert a position in sample frames to quarter notes.
+ * @param self
+ * @param frame Position in sample frames
+ * @return Number of quarter notes from the start of the sequence
+ */
+double tempoMapFramesToPpq(const TempoMap self, const unsigned long frame);
+
+/**
+ * Convert a position in quarter notes to bars.
+ * @param self
+ * @param ppq Position in quarter notes
+ * @return Number of bars from the start of the sequence, including the fraction
+ * of the current bar
+ */
+double tempoMapPpqToBars(const TempoMap self, const double ppq);
+
+/**
+ * Get the position of the start of the bar containing a given position.
+ * @param self
+ * @param ppq Position in quarter notes
+ * @return Start of the bar, in quarter notes
+ */
+double tempoMapGetBarStartPpq(const TempoMap self, const double ppq);
+
+/**
+ * Get the tempo at a given position.
+ * @param self
+ * @param frame Position in sample frames
+ * @return Tempo in BPM
+ */
+Tempo tempoMapGetTempoAtFrame(const TempoMap self, const unsigned long frame);
+
+/**
+ * Get the time signature at a given position.
+ * @param self
+ * @param ppq Position in quarter notes
+ * @return Time signature, which is owned by the tempo map
+ */
+const TempoMapTimeSignature *tempoMapGetTimeSignatureAtPpq(const TempoMap self,
+                                                           const double ppq);
+
+/**
+ * Free a tempo map and its segments
+ * @param self
+ */
+void freeTempoMap(TempoMap self);
+
+#endif
@@ -0,0 +1,265 @@
+//
+// ParameterSweepTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "app/ParameterSweep.h"
+
+#include "base/File.h"
+#include "plugin/PluginMock.h"
+#include "unit/TestRunner.h"
+
+#define TEST_SWEEP_OUTPUT_NAME "test_sweep.wav"
+#define TEST_SWEEP_MANIFEST_NAME "test_sweep-manifest.csv"
+
+static void _parameterSweepTestSetup(void) {}
+
+static void _parameterSweepTestTeardown(void) {
+  File manifest = newFileWithPathCString(TEST_SWEEP_MANIFEST_NAME);
+
+  if (fileExists(manifest)) {
+    fileRemove(manifest);
+  }
+
+  freeFile(manifest);
+}
+
+static ParameterSweep _newParameterSweepWithString(const char *sweepString) {
+  ParameterSweep s = newParameterSweep();
+  CharString c = newCharStringWithCString(sweepString);
+
+  if (!parameterSweepParse(s, c)) {
+    freeParameterSweep(s);
+    s = NULL;
+  }
+
+  freeCharString(c);
+  return s;
+}
+
+static CharString _getOutputName(ParameterSweep s, const char *outputName,
+                                 unsigned long point) {
+  CharString c = newCharStringWithCString(outputName);
+  CharString result = parameterSweepGetOutputName(s, c, point);
+  freeCharString(c);
+  return result;
+}
+
+static int _testNewParameterSweep(void) {
+  ParameterSweep s = newParameterSweep();
+  assertIntEquals(0, s->numAxes);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, s->numPoints);
+  freeParameterSweep(s);
+  return 0;
+}
+
+static int _testParseRange(void) {
+  ParameterSweep s = _newParameterSweepWithString("3:0..1:0.1");
+
+  assertNotNull(s);
+  assertIntEquals(1, s->numAxes);
+  assertIntEquals(3, s->axes[0].parameterIndex);
+  assertIntEquals(11, s->axes[0].numValues);
+  assertUnsignedLongEquals(11ul, s->numPoints);
+  assertDoubleEquals(0.0, parameterSweepGetValue(s, 0, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.5, parameterSweepGetValue(s, 5, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, parameterSweepGetValue(s, 10, 0),
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeParameterSweep(s);
+  return 0;
+}
+
+static int _testParseList(void) {
+  ParameterSweep s = _newParameterSweepWithString("7:{0,0.5,1}");
+
+  assertNotNull(s);
+  assertIntEquals(1, s->numAxes);
+  assertIntEquals(7, s->axes[0].parameterIndex);
+  assertUnsignedLongEquals(3ul, s->numPoints);
+  assertDoubleEquals(0.5, parameterSweepGetValue(s, 1, 0),
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeParameterSweep(s);
+  return 0;
+}
+
+static int _testParseGrid(void) {
+  ParameterSweep s = _newParameterSweepWithString("3:0..1:0.1,7:{0,0.5,1}");
+
+  assertNotNull(s);
+  assertIntEquals(2, s->numAxes);
+  assertUnsignedLongEquals(33ul, s->numPoints);
+
+  // The last parameter changes fastest
+  assertDoubleEquals(0.0, parameterSweepGetValue(s, 2, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, parameterSweepGetValue(s, 2, 1),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.1, parameterSweepGetValue(s, 3, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, parameterSweepGetValue(s, 3, 1),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, parameterSweepGetValue(s, 32, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, parameterSweepGetValue(s, 32, 1),
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeParameterSweep(s);
+  return 0;
+}
+
+static int _testParseInvalid(void) {
+  assertIsNull(_newParameterSweepWithString("3"));
+  assertIsNull(_newParameterSweepWithString("3:0..1"));
+  assertIsNull(_newParameterSweepWithString("3:1..0:0.1"));
+  assertIsNull(_newParameterSweepWithString("3:0..1:0"));
+  assertIsNull(_newParameterSweepWithString("3:{0,0.5"));
+  assertIsNull(_newParameterSweepWithString("3:{}"));
+  assertIsNull(_newParameterSweepWithString("3:{0,x}"));
+  assertIsNull(_newParameterSweepWithString("3:0..1:0.1,"));
+  assertIsNull(_newParameterSweepWithString(""));
+  return 0;
+}
+
+static int _testParseTooManyPoints(void) {
+  assertIsNull(_newParameterSweepWithString(
+      "0:0..1:0.001,1:0..1:0.001,2:0..1:0.001"));
+  return 0;
+}
+
+static int _testRandomize(void) {
+  const char *sweepString = "3:0.25..0.75:0.25,7:{0,1}";
+  ParameterSweep s = _newParameterSweepWithString(sweepString);
+  ParameterSweep s2 = _newParameterSweepWithString(sweepString);
+  unsigned long i;
+  float value;
+
+  parameterSweepRandomize(s, 100, 1);
+  parameterSweepRandomize(s2, 100, 1);
+  assertUnsignedLongEquals(100ul, s->numPoints);
+
+  for (i = 0; i < s->numPoints; i++) {
+    value = parameterSweepGetValue(s, i, 0);
+    assert(value >= 0.25f && value <= 0.75f);
+    value = parameterSweepGetValue(s, i, 1);
+    assert(value == 0.0f || value == 1.0f);
+    // The same seed gives the same points
+    assert(parameterSweepGetValue(s, i, 0) ==
+           parameterSweepGetValue(s2, i, 0));
+  }
+
+  freeParameterSweep(s);
+  freeParameterSweep(s2);
+  return 0;
+}
+
+static int _testApply(void) {
+  ParameterSweep s = _newParameterSweepWithString("0:{0.25,0.75},1:{0.5}");
+  Plugin p = newPluginMock();
+  PluginMockData mockData = (PluginMockData)p->extraData;
+
+  // The mock plugin refuses all parameter changes, so the sweep should stop
+  // after the first parameter
+  assertFalse(parameterSweepApply(s, 1, p));
+  assertIntEquals(1, mockData->numParameterChanges);
+  assertDoubleEquals(0.75, mockData->lastParameterValue,
+                     TEST_DEFAULT_TOLERANCE);
+
+  freePlugin(p);
+  freeParameterSweep(s);
+  return 0;
+}
+
+static int _testGetOutputName(void) {
+  ParameterSweep s = _newParameterSweepWithString("0:0..1:0.1");
+  CharString name;
+
+  name = _getOutputName(s, "out.wav", 3);
+  assertCharStringEquals("out-03.wav", name);
+  freeCharString(name);
+  name = _getOutputName(s, "out/{point}.wav", 10);
+  assertCharStringEquals("out/10.wav", name);
+  freeCharString(name);
+  assertIsNull(_getOutputName(s, "out.wav", 11));
+
+  freeParameterSweep(s);
+  return 0;
+}
+
+static int _testGetManifestName(void) {
+  CharString c = newCharStringWithCString("out/{point}.wav");
+  CharString name = parameterSweepGetManifestName(c);
+
+  assertCharStringEquals("out/manifest.csv", name);
+  freeCharString(name);
+  charStringCopyCString(c, "out.pcm");
+  name = parameterSweepGetManifestName(c);
+  assertCharStringEquals("out-manifest.csv", name);
+
+  freeCharString(name);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testWriteManifest(void) {
+  ParameterSweep s = _newParameterSweepWithString("3:{0,1},7:{0.5}");
+  CharString c = newCharStringWithCString(TEST_SWEEP_OUTPUT_NAME);
+  File manifest;
+  CharString contents;
+
+  assert(parameterSweepWriteManifest(s, c));
+  manifest = newFileWithPathCString(TEST_SWEEP_MANIFEST_NAME);
+  contents = fileReadContents(manifest);
+  assertCharStringEquals("point,output,parameter_3,parameter_7\n"
+                         "0,test_sweep-0.wav,0,0.5\n"
+                         "1,test_sweep-1.wav,1,0.5\n",
+                         contents);
+
+  freeCharString(contents);
+  freeFile(manifest);
+  freeCharString(c);
+  freeParameterSweep(s);
+  return 0;
+}
+
+TestSuite addParameterSweepTests(void);
+TestSuite addParameterSweepTests(void) {
+  TestSuite testSuite = newTestSuite("ParameterSweep", _parameterSweepTestSetup,
+                                     _parameterSweepTestTeardown);
+  addTest(testSuite, "NewObject", _testNewParameterSweep);
+  addTest(testSuite, "ParseRange", _testParseRange);
+  addTest(testSuite, "ParseList", _testParseList);
+  addTest(testSuite, "ParseGrid", _testParseGrid);
+  addTest(testSuite, "ParseInvalid", _testParseInvalid);
+  addTest(testSuite, "ParseTooManyPoints", _testParseTooManyPoints);
+  addTest(testSuite, "Randomize", _testRandomize);
+  addTest(testSuite, "Apply", _testApply);
+  addTest(testSuite, "GetOutputName", _testGetOutputName);
+  addTest(testSuite, "GetManifestName", _testGetManifestName);
+  addTest(testSuite, "WriteManifest", _testWriteManifest);
+  return testSuite;
+}
@@ -0,0 +1,139 @@
+//
+// PipelineBenchmarkTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "app/PipelineBenchmark.h"
+
+#include "audio/AudioSettings.h"
+#include "plugin/PluginChain.h"
+#include "plugin/PluginMock.h"
+#include "unit/TestRunner.h"
+
+static void _pipelineBenchmarkTestSetup(void) {
+  initAudioSettings();
+  initPluginChain();
+}
+
+static void _pipelineBenchmarkTestTeardown(void) {
+  freePluginChain(getPluginChain());
+  freeAudioSettings();
+}
+
+static void _recordIteration(PipelineBenchmark b, PluginChain p,
+                             double pluginTimeInMs) {
+  pipelineBenchmarkBeginIteration(b, p);
+  p->audioTimers[0]->totalTaskTime += pluginTimeInMs;
+  // One second of audio
+  pipelineBenchmarkEndIteration(b, p, (unsigned long)getSampleRate());
+}
+
+static int _testNewPipelineBenchmark(void) {
+  PluginChain p = getPluginChain();
+  PipelineBenchmark b;
+  double mean, stddev, min;
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  b = newPipelineBenchmark(4, p);
+  assertUnsignedLongEquals(4ul, b->numIterations);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, b->numIterationsRecorded);
+  assertIntEquals(1, b->numPlugins);
+  assertFalse(pipelineBenchmarkGetStats(b, PIPELINE_BENCHMARK_WHOLE_CHAIN,
+                                        &mean, &stddev, &min));
+
+  freePipelineBenchmark(b);
+  return 0;
+}
+
+static int _testRecordIterations(void) {
+  PluginChain p = getPluginChain();
+  PipelineBenchmark b;
+  double mean, stddev, min;
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  b = newPipelineBenchmark(2, p);
+  _recordIteration(b, p, 100.0);
+  _recordIteration(b, p, 200.0);
+  assertUnsignedLongEquals(2ul, b->numIterationsRecorded);
+
+  assert(pipelineBenchmarkGetStats(b, 0, &mean, &stddev, &min));
+  assertDoubleEquals(7.5, mean, TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(3.535534, stddev, TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(5.0, min, TEST_DEFAULT_TOLERANCE);
+
+  assert(pipelineBenchmarkGetStats(b, PIPELINE_BENCHMARK_WHOLE_CHAIN, &mean,
+                                   &stddev, &min));
+  assert(min > 0.0);
+  assert(min <= mean);
+
+  freePipelineBenchmark(b);
+  return 0;
+}
+
+static int _testRecordTooManyIterations(void) {
+  PluginChain p = getPluginChain();
+  PipelineBenchmark b;
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  b = newPipelineBenchmark(1, p);
+  _recordIteration(b, p, 100.0);
+  _recordIteration(b, p, 100.0);
+  assertUnsignedLongEquals(1ul, b->numIterationsRecorded);
+
+  freePipelineBenchmark(b);
+  return 0;
+}
+
+static int _testGetStatsInvalidPlugin(void) {
+  PluginChain p = getPluginChain();
+  PipelineBenchmark b;
+  double mean, stddev, min;
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  b = newPipelineBenchmark(1, p);
+  _recordIteration(b, p, 100.0);
+  assertFalse(pipelineBenchmarkGetStats(b, 1, &mean, &stddev, &min));
+  assertFalse(pipelineBenchmarkGetStats(b, -2, &mean, &stddev, &min));
+
+  freePipelineBenchmark(b);
+  return 0;
+}
+
+static int _testFreeNullPipelineBenchmark(void) {
+  freePipelineBenchmark(NULL);
+  return 0;
+}
+
+TestSuite addPipelineBenchmarkTests(void);
+TestSuite addPipelineBenchmarkTests(void) {
+  TestSuite testSuite =
+      newTestSuite("PipelineBenchmark", _pipelineBenchmarkTestSetup,
+                   _pipelineBenchmarkTestTeardown);
+  addTest(testSuite, "Initialization", _testNewPipelineBenchmark);
+  addTest(testSuite, "RecordIterations", _testRecordIterations);
+  addTest(testSuite, "RecordTooManyIterations", _testRecordTooManyIterations);
+  addTest(testSuite, "GetStatsInvalidPlugin", _testGetStatsInvalidPlugin);
+  addTest(testSuite, "FreeNull", _testFreeNullPipelineBenchmark);
+  return testSuite;
+}
@@ -0,0 +1,201 @@
+//
+// PresetSweepTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "app/PresetSweep.h"
+
+#include "base/File.h"
+#include "unit/TestRunner.h"
+
+#define TEST_PRESET_DIRNAME "test_presets"
+
+static void _presetSweepTestSetup(void) {}
+
+static void _presetSweepTestTeardown(void) {
+  File presetDir = newFileWithPathCString(TEST_PRESET_DIRNAME);
+
+  if (fileExists(presetDir)) {
+    fileRemove(presetDir);
+  }
+
+  freeFile(presetDir);
+}
+
+static void _createPresetFile(const File directory, const char *name) {
+  CharString fileName = newCharStringWithCString(name);
+  File presetFile = newFileWithParent(directory, fileName);
+  fileCreate(presetFile, kFileTypeFile);
+  freeFile(presetFile);
+  freeCharString(fileName);
+}
+
+static CharString _getOutputName(PresetSweep s, const char *outputName,
+                                 unsigned int index) {
+  CharString c = newCharStringWithCString(outputName);
+  CharString result = presetSweepGetOutputName(s, c, index);
+  freeCharString(c);
+  return result;
+}
+
+static int _testNewPresetSweep(void) {
+  PresetSweep s = newPresetSweep();
+  assertIntEquals(0, s->numPresets);
+  freePresetSweep(s);
+  return 0;
+}
+
+static int _testAddPresetsFromList(void) {
+  PresetSweep s = newPresetSweep();
+  CharString c = newCharStringWithCString("a.fxp;b.fxp;;3");
+
+  assert(presetSweepAddPresets(s, c));
+  assertIntEquals(3, s->numPresets);
+  assertCharStringEquals("a.fxp", s->presetNames[0]);
+  assertCharStringEquals("b.fxp", s->presetNames[1]);
+  assertCharStringEquals("3", s->presetNames[2]);
+
+  freeCharString(c);
+  freePresetSweep(s);
+  return 0;
+}
+
+static int _testAddPresetsFromEmptyString(void) {
+  PresetSweep s = newPresetSweep();
+  CharString c = newCharString();
+
+  assertFalse(presetSweepAddPresets(s, c));
+  assertIntEquals(0, s->numPresets);
+
+  freeCharString(c);
+  freePresetSweep(s);
+  return 0;
+}
+
+static int _testAddPresetsFromDirectory(void) {
+  PresetSweep s = newPresetSweep();
+  CharString c = newCharStringWithCString(TEST_PRESET_DIRNAME);
+  File presetDir = newFileWithPath(c);
+  CharString name;
+
+  assert(fileCreate(presetDir, kFileTypeDirectory));
+  _createPresetFile(presetDir, "b.fxp");
+  _createPresetFile(presetDir, "a.FXP");
+  _createPresetFile(presetDir, "notes.txt");
+
+  assert(presetSweepAddPresets(s, c));
+  assertIntEquals(2, s->numPresets);
+
+  // Presets are sorted and have the full path to the preset
+  name = _getOutputName(s, "out.wav", 0);
+  assertCharStringEquals("out-a.wav", name);
+  freeCharString(name);
+  name = _getOutputName(s, "out.wav", 1);
+  assertCharStringEquals("out-b.wav", name);
+  freeCharString(name);
+
+  freeFile(presetDir);
+  freeCharString(c);
+  freePresetSweep(s);
+  return 0;
+}
+
+static int _testAddPresetsFromEmptyDirectory(void) {
+  PresetSweep s = newPresetSweep();
+  CharString c = newCharStringWithCString(TEST_PRESET_DIRNAME);
+  File presetDir = newFileWithPath(c);
+
+  assert(fileCreate(presetDir, kFileTypeDirectory));
+  assertFalse(presetSweepAddPresets(s, c));
+  assertIntEquals(0, s->numPresets);
+
+  freeFile(presetDir);
+  freeCharString(c);
+  freePresetSweep(s);
+  return 0;
+}
+
+static int _testGetOutputNameWithTemplate(void) {
+  PresetSweep s = newPresetSweep();
+  CharString c = newCharStringWithCString("presets/Lead.fxp");
+  CharString name;
+
+  assert(presetSweepAddPresets(s, c));
+  name = _getOutputName(s, "render_{preset}_final.wav", 0);
+  assertCharStringEquals("render_Lead_final.wav", name);
+
+  freeCharString(name);
+  freeCharString(c);
+  freePresetSweep(s);
+  return 0;
+}
+
+static int _testGetOutputNameWithoutExtension(void) {
+  PresetSweep s = newPresetSweep();
+  CharString c = newCharStringWithCString("7");
+  CharString name;
+
+  assert(presetSweepAddPresets(s, c));
+  name = _getOutputName(s, "out.dir/render", 0);
+  assertCharStringEquals("out.dir/render-7", name);
+
+  freeCharString(name);
+  freeCharString(c);
+  freePresetSweep(s);
+  return 0;
+}
+
+static int _testGetOutputNameInvalidIndex(void) {
+  PresetSweep s = newPresetSweep();
+  CharString c = newCharStringWithCString("a.fxp");
+  CharString name;
+
+  assert(presetSweepAddPresets(s, c));
+  name = _getOutputName(s, "out.wav", 1);
+  assertIsNull(name);
+
+  freeCharString(c);
+  freePresetSweep(s);
+  return 0;
+}
+
+TestSuite addPresetSweepTests(void);
+TestSuite addPresetSweepTests(void) {
+  TestSuite testSuite = newTestSuite("PresetSweep", _presetSweepTestSetup,
+                                     _presetSweepTestTeardown);
+  addTest(testSuite, "NewObject", _testNewPresetSweep);
+  addTest(testSuite, "AddPresetsFromList", _testAddPresetsFromList);
+  addTest(testSuite, "AddPresetsFromEmptyString",
+          _testAddPresetsFromEmptyString);
+  addTest(testSuite, "AddPresetsFromDirectory", _testAddPresetsFromDirectory);
+  addTest(testSuite, "AddPresetsFromEmptyDirectory",
+          _testAddPresetsFromEmptyDirectory);
+  addTest(testSuite, "GetOutputNameWithTemplate",
+          _testGetOutputNameWithTemplate);
+  addTest(testSuite, "GetOutputNameWithoutExtension",
+          _testGetOutputNameWithoutExtension);
+  addTest(testSuite, "GetOutputNameInvalidIndex",
+          _testGetOutputNameInvalidIndex);
+  return testSuite;
+}
@@ -0,0 +1,230 @@
+//
+// RenderCacheTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "app/RenderCache.h"
+
+#include "base/File.h"
+#include "unit/TestRunner.h"
+
+#define TEST_RENDER_CACHE_DIRNAME "test_render_cache"
+#define TEST_RENDER_CACHE_OUTPUT "test_render_output.wav"
+
+static void _renderCacheTestSetup(void) {}
+
+static void _renderCacheTestTeardown(void) {
+  File f = newFileWithPathCString(TEST_RENDER_CACHE_DIRNAME);
+
+  if (fileExists(f)) {
+    fileRemove(f);
+  }
+
+  freeFile(f);
+  f = newFileWithPathCString(TEST_RENDER_CACHE_OUTPUT);
+
+  if (fileExists(f)) {
+    fileRemove(f);
+  }
+
+  freeFile(f);
+}
+
+static RenderCache _newTestRenderCache(void) {
+  CharString c = newCharStringWithCString(TEST_RENDER_CACHE_DIRNAME);
+  RenderCache result = newRenderCache(c);
+  freeCharString(c);
+  return result;
+}
+
+static void _writeOutputFile(const char *contents) {
+  CharString p = newCharStringWithCString(TEST_RENDER_CACHE_OUTPUT);
+  CharString c = newCharStringWithCString(contents);
+  File f = newFileWithPath(p);
+
+  if (fileExists(f)) {
+    fileRemove(f);
+  }
+
+  fileCreate(f, kFileTypeFile);
+  fileWrite(f, c);
+  freeFile(f);
+  freeCharString(c);
+  freeCharString(p);
+}
+
+static int _testNewRenderCache(void) {
+  RenderCache r = _newTestRenderCache();
+  assertCharStringEquals(TEST_RENDER_CACHE_DIRNAME, r->directory);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, r->numHits);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, r->numMisses);
+  freeRenderCache(r);
+  return 0;
+}
+
+static int _testRenderCacheKeyIsStable(void) {
+  RenderCache r1 = _newTestRenderCache();
+  RenderCache r2 = _newTestRenderCache();
+
+  renderCacheAddString(r1, "parameter", "0,0.5");
+  renderCacheAddNumber(r1, "sampleRate", 44100.0);
+  renderCacheAddString(r2, "parameter", "0,0.5");
+  renderCacheAddNumber(r2, "sampleRate", 44100.0);
+  assert(r1->key == r2->key);
+
+  freeRenderCache(r1);
+  freeRenderCache(r2);
+  return 0;
+}
+
+static int _testRenderCacheKeyChangesWithSettings(void) {
+  RenderCache r1 = _newTestRenderCache();
+  RenderCache r2 = _newTestRenderCache();
+
+  renderCacheAddNumber(r1, "sampleRate", 44100.0);
+  renderCacheAddNumber(r2, "sampleRate", 48000.0);
+  assertFalse(r1->key == r2->key);
+
+  freeRenderCache(r1);
+  freeRenderCache(r2);
+  return 0;
+}
+
+static int _testRenderCacheGetEntryPath(void) {
+  RenderCache r = _newTestRenderCache();
+  CharString outputPath = newCharStringWithCString(TEST_RENDER_CACHE_OUTPUT);
+  CharString result = renderCacheGetEntryPath(r, outputPath);
+  File f = newFileWithPath(result);
+  CharString extension = fileGetExtension(f);
+
+  assertCharStringEquals("wav", extension);
+  assertCharStringContains(TEST_RENDER_CACHE_DIRNAME, result);
+
+  freeCharString(extension);
+  freeFile(f);
+  freeCharString(result);
+  freeCharString(outputPath);
+  freeRenderCache(r);
+  return 0;
+}
+
+static int _testRenderCacheMiss(void) {
+  RenderCache r = _newTestRenderCache();
+  CharString outputPath = newCharStringWithCString(TEST_RENDER_CACHE_OUTPUT);
+
+  assertFalse(renderCacheHasEntry(r, outputPath));
+  assertUnsignedLongEquals(1ul, r->numMisses);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, r->numHits);
+
+  freeCharString(outputPath);
+  freeRenderCache(r);
+  return 0;
+}
+
+static int _testRenderCacheStoreAndRestore(void) {
+  RenderCache r = _newTestRenderCache();
+  CharString outputPath = newCharStringWithCString(TEST_RENDER_CACHE_OUTPUT);
+  File f;
+  CharString contents;
+
+  _writeOutputFile("rendered");
+  assert(renderCacheStore(r, outputPath));
+  _writeOutputFile("empty");
+  assert(renderCacheHasEntry(r, outputPath));
+  assert(renderCacheRestore(r, outputPath));
+  assertUnsignedLongEquals(1ul, r->numHits);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, r->numMisses);
+
+  f = newFileWithPath(outputPath);
+  contents = fileReadContents(f);
+  assertCharStringEquals("rendered", contents);
+
+  freeCharString(contents);
+  freeFile(f);
+  freeCharString(outputPath);
+  freeRenderCache(r);
+  return 0;
+}
+
+static int _testRenderCacheRestoreIsNotChangedByLaterOutput(void) {
+  RenderCache r = _newTestRenderCache();
+  CharString outputPath = newCharStringWithCString(TEST_RENDER_CACHE_OUTPUT);
+  File f;
+  FILE *fp;
+  CharString contents;
+
+  _writeOutputFile("rendered");
+  assert(renderCacheStore(r, outputPath));
+  assert(renderCacheRestore(r, outputPath));
+
+  // Output sources overwrite the restored file in place
+  fp = fopen(TEST_RENDER_CACHE_OUTPUT, "wb");
+  assertNotNull(fp);
+  fputs("changed", fp);
+  fclose(fp);
+
+  assert(renderCacheRestore(r, outputPath));
+  f = newFileWithPath(outputPath);
+  contents = fileReadContents(f);
+  assertCharStringEquals("rendered", contents);
+
+  freeCharString(contents);
+  freeFile(f);
+  freeCharString(outputPath);
+  freeRenderCache(r);
+  return 0;
+}
+
+static int _testRenderCacheWithUnreadableFile(void) {
+  RenderCache r = _newTestRenderCache();
+  CharString outputPath = newCharStringWithCString(TEST_RENDER_CACHE_OUTPUT);
+  CharString invalid = newCharStringWithCString("invalid");
+
+  renderCacheAddFile(r, "input", invalid);
+  _writeOutputFile("rendered");
+  assertFalse(renderCacheStore(r, outputPath));
+  assertFalse(renderCacheHasEntry(r, outputPath));
+
+  freeCharString(invalid);
+  freeCharString(outputPath);
+  freeRenderCache(r);
+  return 0;
+}
+
+TestSuite addRenderCacheTests(void);
+TestSuite addRenderCacheTests(void) {
+  TestSuite testSuite = newTestSuite("RenderCache", _renderCacheTestSetup,
+                                     _renderCacheTestTeardown);
+  addTest(testSuite, "NewRenderCache", _testNewRenderCache);
+  addTest(testSuite, "KeyIsStable", _testRenderCacheKeyIsStable);
+  addTest(testSuite, "KeyChangesWithSettings",
+          _testRenderCacheKeyChangesWithSettings);
+  addTest(testSuite, "GetEntryPath", _testRenderCacheGetEntryPath);
+  addTest(testSuite, "Miss", _testRenderCacheMiss);
+  addTest(testSuite, "StoreAndRestore", _testRenderCacheStoreAndRestore);
+  addTest(testSuite, "RestoreIsNotChangedByLaterOutput",
+          _testRenderCacheRestoreIsNotChangedByLaterOutput);
+  addTest(testSuite, "WithUnreadableFile", _testRenderCacheWithUnreadableFile);
+  return testSuite;
+}
@@ -0,0 +1,258 @@
+//
+// StageCacheTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "app/StageCache.h"
+
+#include "audio/AudioSettings.h"
+#include "base/File.h"
+#include "unit/TestRunner.h"
+
+#define TEST_STAGE_CACHE_DIRNAME "test_stage_cache"
+
+static const HashValue kTestStageKeys[] = {1, 2, 3};
+static const unsigned int kTestNumStages = 3;
+
+static void _stageCacheTestSetup(void) { initAudioSettings(); }
+
+static void _stageCacheTestTeardown(void) {
+  File f = newFileWithPathCString(TEST_STAGE_CACHE_DIRNAME);
+
+  if (fileExists(f)) {
+    fileRemove(f);
+  }
+
+  freeFile(f);
+  freeAudioSettings();
+}
+
+static StageCache _newTestStageCache(const unsigned long maxSizeInBytes,
+                                     const HashValue *stageKeys) {
+  CharString c = newCharStringWithCString(TEST_STAGE_CACHE_DIRNAME);
+  StageCache result =
+      newStageCache(c, maxSizeInBytes, stageKeys, kTestNumStages);
+  freeCharString(c);
+  return result;
+}
+
+// Write the given number of stages, where each sample is the stage index
+static void _writeTestStages(StageCache s, const unsigned int numStages) {
+  SampleBuffer b = newSampleBuffer(getNumChannels(), getBlocksize());
+  unsigned int stage;
+  ChannelCount i;
+  SampleCount j;
+
+  stageCacheBeginWriting(s, getNumChannels(), getSampleRate());
+
+  for (stage = 0; stage < numStages; stage++) {
+    for (i = 0; i < b->numChannels; i++) {
+      for (j = 0; j < b->blocksize; j++) {
+        b->samples[i][j] = (Sample)stage;
+      }
+    }
+
+    stageCacheWriteStage(s, stage, b);
+  }
+
+  stageCacheFinishWriting(s, getBlocksize(), NULL);
+  freeSampleBuffer(b);
+}
+
+static int _testNewStageCache(void) {
+  StageCache s = _newTestStageCache(0, kTestStageKeys);
+  assertIntEquals(kTestNumStages, s->numStages);
+  assertIntEquals(0, s->numCachedStages);
+  assertIntEquals(0, s->numStoredStages);
+  freeStageCache(s);
+  return 0;
+}
+
+static int _testGetEntryPath(void) {
+  StageCache s = _newTestStageCache(0, kTestStageKeys);
+  CharString result = stageCacheGetEntryPath(s, 2);
+
+  assertCharStringContains(STAGE_CACHE_ENTRY_PREFIX "0000000000000003.f32",
+                           result);
+
+  freeCharString(result);
+  freeStageCache(s);
+  return 0;
+}
+
+static int _testOpenDeepestStageEmpty(void) {
+  StageCache s = _newTestStageCache(0, kTestStageKeys);
+  assertIsNull(stageCacheOpenDeepestStage(s));
+  assertIntEquals(0, s->numCachedStages);
+  freeStageCache(s);
+  return 0;
+}
+
+static int _testWriteAndOpenDeepestStage(void) {
+  StageCache s = _newTestStageCache(0, kTestStageKeys);
+  SampleSource cached;
+  SampleBuffer b = newSampleBuffer(getNumChannels(), getBlocksize());
+
+  _writeTestStages(s, kTestNumStages);
+  assertIntEquals(kTestNumStages, s->numStoredStages);
+  freeStageCache(s);
+
+  s = _newTestStageCache(0, kTestStageKeys);
+  cached = stageCacheOpenDeepestStage(s);
+  assertNotNull(cached);
+  assertIntEquals(kTestNumStages, s->numCachedStages);
+  cached->readSampleBlock(cached, b);
+  assertDoubleEquals(2.0, b->samples[0][0], 0.0);
+
+  freeSampleSource(cached);
+  freeSampleBuffer(b);
+  freeStageCache(s);
+  return 0;
+}
+
+static int _testOpenDeepestStageWithChangedSuffix(void) {
+  const HashValue changedKeys[] = {1, 2, 4};
+  StageCache s = _newTestStageCache(0, kTestStageKeys);
+  SampleSource cached;
+  SampleBuffer b = newSampleBuffer(getNumChannels(), getBlocksize());
+
+  _writeTestStages(s, kTestNumStages);
+  freeStageCache(s);
+
+  s = _newTestStageCache(0, changedKeys);
+  cached = stageCacheOpenDeepestStage(s);
+  assertNotNull(cached);
+  assertIntEquals(2, s->numCachedStages);
+  cached->readSampleBlock(cached, b);
+  assertDoubleEquals(1.0, b->samples[0][0], 0.0);
+
+  // Only the changed stage is written
+  _writeTestStages(s, kTestNumStages);
+  assertIntEquals(1, s->numStoredStages);
+
+  freeSampleSource(cached);
+  freeSampleBuffer(b);
+  freeStageCache(s);
+  return 0;
+}
+
+static int _testFinishWritingTruncatesPadding(void) {
+  StageCache s = _newTestStageCache(0, kTestStageKeys);
+  SampleBuffer b = newSampleBuffer(getNumChannels(), getBlocksize());
+  SampleSource cached;
+
+  stageCacheBeginWriting(s, getNumChannels(), getSampleRate());
+  stageCacheWriteStage(s, 0, b);
+  stageCacheFinishWriting(s, getBlocksize() / 2, NULL);
+  freeStageCache(s);
+
+  s = _newTestStageCache(0, kTestStageKeys);
+  cached = stageCacheOpenDeepestStage(s);
+  assertNotNull(cached);
+  assertIntEquals(1, s->numCachedStages);
+  cached->readSampleBlock(cached, b);
+  assertUnsignedLongEquals(getBlocksize() / 2, b->blocksize);
+
+  freeSampleSource(cached);
+  freeSampleBuffer(b);
+  freeStageCache(s);
+  return 0;
+}
+
+static int _testFinishWritingKeepsDelayedFrames(void) {
+  StageCache s = _newTestStageCache(0, kTestStageKeys);
+  SampleBuffer b = newSampleBuffer(getNumChannels(), getBlocksize());
+  unsigned long stageDelays[3] = {100, 0, 0};
+  SampleSource cached;
+
+  stageCacheBeginWriting(s, getNumChannels(), getSampleRate());
+  stageCacheWriteStage(s, 0, b);
+  stageCacheFinishWriting(s, getBlocksize() / 2, stageDelays);
+  freeStageCache(s);
+
+  s = _newTestStageCache(0, kTestStageKeys);
+  cached = stageCacheOpenDeepestStage(s);
+  assertNotNull(cached);
+  cached->readSampleBlock(cached, b);
+  assertUnsignedLongEquals(getBlocksize() / 2 + 100, b->blocksize);
+
+  freeSampleSource(cached);
+  freeSampleBuffer(b);
+  freeStageCache(s);
+  return 0;
+}
+
+static int _testEvict(void) {
+  StageCache s = _newTestStageCache(0, kTestStageKeys);
+  CharString otherPath = newCharStringWithCString(TEST_STAGE_CACHE_DIRNAME);
+  File otherFile;
+  SampleSource cached;
+
+  _writeTestStages(s, kTestNumStages);
+  charStringAppendCString(otherPath, "/other.f32");
+  otherFile = newFileWithPath(otherPath);
+  assert(fileCreate(otherFile, kFileTypeFile));
+  fileClose(otherFile);
+
+  // No limit, nothing is removed
+  stageCacheEvict(s);
+  freeStageCache(s);
+  s = _newTestStageCache(0, kTestStageKeys);
+  cached = stageCacheOpenDeepestStage(s);
+  assertNotNull(cached);
+  assertIntEquals(kTestNumStages, s->numCachedStages);
+  freeSampleSource(cached);
+  freeStageCache(s);
+
+  // Every entry is larger than this limit, so all entries are removed, but
+  // other files are left alone
+  s = _newTestStageCache(1, kTestStageKeys);
+  stageCacheEvict(s);
+  assertIsNull(stageCacheOpenDeepestStage(s));
+  assert(fileExists(otherFile));
+
+  freeFile(otherFile);
+  freeCharString(otherPath);
+  freeStageCache(s);
+  return 0;
+}
+
+TestSuite addStageCacheTests(void);
+TestSuite addStageCacheTests(void) {
+  TestSuite testSuite = newTestSuite("StageCache", _stageCacheTestSetup,
+                                     _stageCacheTestTeardown);
+  addTest(testSuite, "NewStageCache", _testNewStageCache);
+  addTest(testSuite, "GetEntryPath", _testGetEntryPath);
+  addTest(testSuite, "OpenDeepestStageEmpty", _testOpenDeepestStageEmpty);
+  addTest(testSuite, "WriteAndOpenDeepestStage",
+          _testWriteAndOpenDeepestStage);
+  addTest(testSuite, "OpenDeepestStageWithChangedSuffix",
+          _testOpenDeepestStageWithChangedSuffix);
+  addTest(testSuite, "FinishWritingTruncatesPadding",
+          _testFinishWritingTruncatesPadding);
+  addTest(testSuite, "FinishWritingKeepsDelayedFrames",
+          _testFinishWritingKeepsDelayedFrames);
+  addTest(testSuite, "Evict", _testEvict);
+  return testSuite;
+}
@@ -0,0 +1,275 @@
+//
+// ChannelMapTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/ChannelMap.h"
+#include "unit/TestRunner.h"
+
+static const SampleCount kTestBlocksize = 4;
+
+// Fill a buffer where each sample of a channel is the channel number plus one
+static SampleBuffer _newChannelBuffer(const ChannelCount numChannels) {
+  SampleBuffer result = newSampleBuffer(numChannels, kTestBlocksize);
+  ChannelCount i;
+  SampleCount j;
+
+  for (i = 0; i < result->numChannels; i++) {
+    for (j = 0; j < result->blocksize; j++) {
+      result->samples[i][j] = (Sample)(i + 1);
+    }
+  }
+
+  return result;
+}
+
+static ChannelMap _newChannelMapWithCString(const ChannelCount numInputs,
+                                            const ChannelCount numOutputs,
+                                            const char *routes) {
+  CharString routesString = newCharStringWithCString(routes);
+  ChannelMap result =
+      newChannelMapWithString(numInputs, numOutputs, routesString);
+  freeCharString(routesString);
+  return result;
+}
+
+static int _testNewChannelMap(void) {
+  ChannelMap c = newChannelMap(2, 3);
+  assertIntEquals(2, c->numInputs);
+  assertIntEquals(3, c->numOutputs);
+  assertDoubleEquals(0.0, channelMapGetGain(c, 0, 0), TEST_DEFAULT_TOLERANCE);
+  freeChannelMap(c);
+  return 0;
+}
+
+static int _testSetGain(void) {
+  ChannelMap c = newChannelMap(2, 2);
+  assert(channelMapSetGain(c, 1, 0, 0.5f));
+  assertDoubleEquals(0.5, channelMapGetGain(c, 1, 0), TEST_DEFAULT_TOLERANCE);
+  assert(channelMapSetGain(c, 1, 0, 0.25f));
+  assertDoubleEquals(0.25, channelMapGetGain(c, 1, 0), TEST_DEFAULT_TOLERANCE);
+  assert(channelMapSetGain(c, 1, 0, 0.0f));
+  assertDoubleEquals(0.0, channelMapGetGain(c, 1, 0), TEST_DEFAULT_TOLERANCE);
+  freeChannelMap(c);
+  return 0;
+}
+
+static int _testSetGainOutOfRange(void) {
+  ChannelMap c = newChannelMap(2, 2);
+  assertFalse(channelMapSetGain(c, 2, 0, 1.0f));
+  assertFalse(channelMapSetGain(c, 0, 2, 1.0f));
+  freeChannelMap(c);
+  return 0;
+}
+
+static int _testDefaultGainIdentity(void) {
+  assertDoubleEquals(1.0, channelMapGetDefaultGain(2, 2, 1, 1),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, channelMapGetDefaultGain(2, 2, 0, 1),
+                     TEST_DEFAULT_TOLERANCE);
+  return 0;
+}
+
+static int _testDefaultGainSurroundToStereo(void) {
+  // Left output gets L, C and Ls but not R, LFE or Rs
+  assertDoubleEquals(1.0, channelMapGetDefaultGain(6, 2, 0, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, channelMapGetDefaultGain(6, 2, 1, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.70710678, channelMapGetDefaultGain(6, 2, 2, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, channelMapGetDefaultGain(6, 2, 3, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.70710678, channelMapGetDefaultGain(6, 2, 4, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, channelMapGetDefaultGain(6, 2, 5, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.70710678, channelMapGetDefaultGain(6, 2, 5, 1),
+                     TEST_DEFAULT_TOLERANCE);
+  return 0;
+}
+
+static int _testDefaultGainMonoToSurround(void) {
+  assertDoubleEquals(1.0, channelMapGetDefaultGain(1, 6, 0, 2),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, channelMapGetDefaultGain(1, 6, 0, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  return 0;
+}
+
+static int _testDefaultGainStereoToSurround(void) {
+  assertDoubleEquals(1.0, channelMapGetDefaultGain(2, 6, 1, 1),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, channelMapGetDefaultGain(2, 6, 0, 4),
+                     TEST_DEFAULT_TOLERANCE);
+  return 0;
+}
+
+static int _testDefaultGainDownmixToMono(void) {
+  assertDoubleEquals(0.5, channelMapGetDefaultGain(2, 1, 1, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.25, channelMapGetDefaultGain(4, 1, 3, 0),
+                     TEST_DEFAULT_TOLERANCE);
+  return 0;
+}
+
+static int _testApplyIdentity(void) {
+  ChannelMap c = newChannelMapDefault(2, 2);
+  SampleBuffer in = _newChannelBuffer(2);
+  SampleBuffer out = newSampleBuffer(2, kTestBlocksize);
+
+  assert(channelMapApply(c, out, 0, in, 0, kTestBlocksize));
+  assertDoubleEquals(1.0, out->samples[0][3], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(2.0, out->samples[1][3], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(in);
+  freeSampleBuffer(out);
+  freeChannelMap(c);
+  return 0;
+}
+
+static int _testApplyMix(void) {
+  ChannelMap c = newChannelMap(3, 2);
+  SampleBuffer in = _newChannelBuffer(3);
+  SampleBuffer out = _newChannelBuffer(2);
+
+  channelMapSetGain(c, 0, 0, 1.0f);
+  channelMapSetGain(c, 2, 0, 0.5f);
+  assert(channelMapApply(c, out, 0, in, 0, kTestBlocksize));
+  assertDoubleEquals(2.5, out->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  // Outputs without any routes are cleared
+  assertDoubleEquals(0.0, out->samples[1][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(in);
+  freeSampleBuffer(out);
+  freeChannelMap(c);
+  return 0;
+}
+
+static int _testApplyWithOffset(void) {
+  ChannelMap c = newChannelMap(2, 1);
+  SampleBuffer in = _newChannelBuffer(2);
+  SampleBuffer out = newSampleBuffer(1, kTestBlocksize);
+
+  channelMapSetGain(c, 1, 0, 2.0f);
+  sampleBufferClear(out);
+  assert(channelMapApply(c, out, 2, in, 1, 2));
+  assertDoubleEquals(0.0, out->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(4.0, out->samples[0][2], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(4.0, out->samples[0][3], TEST_DEFAULT_TOLERANCE);
+  assertFalse(channelMapApply(c, out, 3, in, 0, 2));
+
+  freeSampleBuffer(in);
+  freeSampleBuffer(out);
+  freeChannelMap(c);
+  return 0;
+}
+
+static int _testApplyWrongChannelCount(void) {
+  ChannelMap c = newChannelMapDefault(2, 2);
+  SampleBuffer in = _newChannelBuffer(1);
+  SampleBuffer out = newSampleBuffer(2, kTestBlocksize);
+
+  assertFalse(channelMapApply(c, out, 0, in, 0, kTestBlocksize));
+
+  freeSampleBuffer(in);
+  freeSampleBuffer(out);
+  freeChannelMap(c);
+  return 0;
+}
+
+static int _testApplyDefaultSurroundToStereo(void) {
+  SampleBuffer in = _newChannelBuffer(6);
+  SampleBuffer out = newSampleBuffer(2, kTestBlocksize);
+
+  channelMapApplyDefault(out, 0, in, 0, kTestBlocksize);
+  // L + C * -3dB + Ls * -3dB
+  assertDoubleEquals((1.0 + 0.70710678 * (3.0 + 5.0)), out->samples[0][0],
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals((2.0 + 0.70710678 * (3.0 + 6.0)), out->samples[1][0],
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(in);
+  freeSampleBuffer(out);
+  return 0;
+}
+
+static int _testNewChannelMapWithString(void) {
+  ChannelMap c = _newChannelMapWithCString(2, 2, "0:0,0:1,1:0:0.5");
+  assertNotNull(c);
+  assertDoubleEquals(1.0, channelMapGetGain(c, 0, 0), TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, channelMapGetGain(c, 0, 1), TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.5, channelMapGetGain(c, 1, 0), TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, channelMapGetGain(c, 1, 1), TEST_DEFAULT_TOLERANCE);
+  freeChannelMap(c);
+  return 0;
+}
+
+static int _testNewChannelMapWithInvalidString(void) {
+  assertIsNull(_newChannelMapWithCString(2, 2, ""));
+  assertIsNull(_newChannelMapWithCString(2, 2, "0"));
+  assertIsNull(_newChannelMapWithCString(2, 2, "0:1x"));
+  assertIsNull(_newChannelMapWithCString(2, 2, "0:1:"));
+  return 0;
+}
+
+static int _testNewChannelMapWithStringOutOfRange(void) {
+  assertIsNull(_newChannelMapWithCString(2, 2, "0:0,2:1"));
+  assertIsNull(_newChannelMapWithCString(2, 2, "0:2"));
+  return 0;
+}
+
+static int _testFreeNullChannelMap(void) {
+  freeChannelMap(NULL);
+  return 0;
+}
+
+TestSuite addChannelMapTests(void);
+TestSuite addChannelMapTests(void) {
+  TestSuite testSuite = newTestSuite("ChannelMap", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewChannelMap);
+  addTest(testSuite, "SetGain", _testSetGain);
+  addTest(testSuite, "SetGainOutOfRange", _testSetGainOutOfRange);
+  addTest(testSuite, "DefaultGainIdentity", _testDefaultGainIdentity);
+  addTest(testSuite, "DefaultGainSurroundToStereo",
+          _testDefaultGainSurroundToStereo);
+  addTest(testSuite, "DefaultGainMonoToSurround",
+          _testDefaultGainMonoToSurround);
+  addTest(testSuite, "DefaultGainStereoToSurround",
+          _testDefaultGainStereoToSurround);
+  addTest(testSuite, "DefaultGainDownmixToMono", _testDefaultGainDownmixToMono);
+  addTest(testSuite, "ApplyIdentity", _testApplyIdentity);
+  addTest(testSuite, "ApplyMix", _testApplyMix);
+  addTest(testSuite, "ApplyWithOffset", _testApplyWithOffset);
+  addTest(testSuite, "ApplyWrongChannelCount", _testApplyWrongChannelCount);
+  addTest(testSuite, "ApplyDefaultSurroundToStereo",
+          _testApplyDefaultSurroundToStereo);
+  addTest(testSuite, "NewWithString", _testNewChannelMapWithString);
+  addTest(testSuite, "NewWithInvalidString",
+          _testNewChannelMapWithInvalidString);
+  addTest(testSuite, "NewWithStringOutOfRange",
+          _testNewChannelMapWithStringOutOfRange);
+  addTest(testSuite, "FreeNull", _testFreeNullChannelMap);
+  return testSuite;
+}
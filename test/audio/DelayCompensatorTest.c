@@ -0,0 +1,247 @@
+//
+// DelayCompensatorTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/DelayCompensator.h"
+#include "unit/TestRunner.h"
+
+static const ChannelCount kTestNumChannels = 2;
+static const SampleCount kTestBlocksize = 8;
+
+// Fill a block where each sample is its frame number, starting at firstFrame
+static SampleBuffer _newRampBuffer(const unsigned long firstFrame) {
+  SampleBuffer result = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+  ChannelCount i;
+  SampleCount j;
+
+  for (i = 0; i < result->numChannels; i++) {
+    for (j = 0; j < result->blocksize; j++) {
+      result->samples[i][j] = (Sample)(firstFrame + j);
+    }
+  }
+
+  return result;
+}
+
+static void _pushRamp(DelayCompensator d, const unsigned long firstFrame) {
+  SampleBuffer b = _newRampBuffer(firstFrame);
+  delayCompensatorPush(d, b);
+  freeSampleBuffer(b);
+}
+
+static int _testNewDelayCompensator(void) {
+  DelayCompensator d =
+      newDelayCompensator(kTestNumChannels, kTestBlocksize, 3);
+  assertUnsignedLongEquals(3ul, d->delayInFrames);
+  assertIntEquals(0, d->numFrames);
+  freeDelayCompensator(d);
+  return 0;
+}
+
+static int _testPushAndReadWithoutDelay(void) {
+  DelayCompensator d =
+      newDelayCompensator(kTestNumChannels, kTestBlocksize, 0);
+  SampleBuffer b = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+
+  _pushRamp(d, 0);
+  assert(delayCompensatorRead(d, b));
+  assertDoubleEquals(0.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(7.0, b->samples[1][7], TEST_DEFAULT_TOLERANCE);
+  assertIntEquals(0, d->numFrames);
+  assertFalse(delayCompensatorRead(d, b));
+
+  freeSampleBuffer(b);
+  freeDelayCompensator(d);
+  return 0;
+}
+
+static int _testPushAndReadWithDelay(void) {
+  DelayCompensator d =
+      newDelayCompensator(kTestNumChannels, kTestBlocksize, 3);
+  SampleBuffer b = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+
+  _pushRamp(d, 0);
+  assertIntEquals(5, d->numFrames);
+  assertFalse(delayCompensatorRead(d, b));
+
+  _pushRamp(d, 8);
+  assert(delayCompensatorRead(d, b));
+  assertDoubleEquals(3.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(10.0, b->samples[1][7], TEST_DEFAULT_TOLERANCE);
+  assertIntEquals(5, d->numFrames);
+
+  freeSampleBuffer(b);
+  freeDelayCompensator(d);
+  return 0;
+}
+
+static int _testDelayLongerThanBlock(void) {
+  DelayCompensator d =
+      newDelayCompensator(kTestNumChannels, kTestBlocksize, 11);
+  SampleBuffer b = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+
+  _pushRamp(d, 0);
+  assertIntEquals(0, d->numFrames);
+  _pushRamp(d, 8);
+  _pushRamp(d, 16);
+  assert(delayCompensatorRead(d, b));
+  assertDoubleEquals(11.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayCompensator(d);
+  return 0;
+}
+
+static int _testReadAcrossEndOfRingBuffer(void) {
+  DelayCompensator d =
+      newDelayCompensator(kTestNumChannels, kTestBlocksize, 5);
+  SampleBuffer b = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+  unsigned long frame;
+  unsigned long expectedFrame = 5;
+  SampleCount j;
+
+  for (frame = 0; frame < kTestBlocksize * 10; frame += kTestBlocksize) {
+    _pushRamp(d, frame);
+
+    while (delayCompensatorRead(d, b)) {
+      for (j = 0; j < b->blocksize; j++) {
+        assertDoubleEquals((double)(expectedFrame + j), b->samples[1][j],
+                           TEST_DEFAULT_TOLERANCE);
+      }
+
+      expectedFrame += b->blocksize;
+    }
+  }
+
+  // The last frames do not fill a whole block
+  assertUnsignedLongEquals(77ul, expectedFrame);
+  assertIntEquals(3, d->numFrames);
+
+  freeSampleBuffer(b);
+  freeDelayCompensator(d);
+  return 0;
+}
+
+static int _testReadPartialBlock(void) {
+  DelayCompensator d =
+      newDelayCompensator(kTestNumChannels, kTestBlocksize, 2);
+  SampleBuffer b = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+
+  _pushRamp(d, 0);
+  b->blocksize = 6;
+  assert(delayCompensatorRead(d, b));
+  assertDoubleEquals(7.0, b->samples[0][5], TEST_DEFAULT_TOLERANCE);
+  assertIntEquals(0, d->numFrames);
+
+  freeSampleBuffer(b);
+  freeDelayCompensator(d);
+  return 0;
+}
+
+static int _testSetLongerDelay(void) {
+  DelayCompensator d =
+      newDelayCompensator(kTestNumChannels, kTestBlocksize, 0);
+  SampleBuffer b = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+
+  _pushRamp(d, 0);
+  assert(delayCompensatorRead(d, b));
+
+  // The first frames of the next block are now only delay
+  delayCompensatorSetDelay(d, 2);
+  _pushRamp(d, 8);
+  _pushRamp(d, 16);
+  assert(delayCompensatorRead(d, b));
+  assertDoubleEquals(10.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayCompensator(d);
+  return 0;
+}
+
+static int _testSetShorterDelay(void) {
+  DelayCompensator d =
+      newDelayCompensator(kTestNumChannels, kTestBlocksize, 2);
+  SampleBuffer b = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+
+  _pushRamp(d, 0);
+  _pushRamp(d, 8);
+  assert(delayCompensatorRead(d, b));
+  assertDoubleEquals(2.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+
+  // Silence is inserted for the frames which were not delayed any longer
+  delayCompensatorSetDelay(d, 0);
+  _pushRamp(d, 16);
+  assert(delayCompensatorRead(d, b));
+  assertDoubleEquals(15.0, b->samples[0][5], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b->samples[0][6], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b->samples[0][7], TEST_DEFAULT_TOLERANCE);
+  assertIntEquals(8, d->numFrames);
+  assert(delayCompensatorRead(d, b));
+  assertDoubleEquals(16.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayCompensator(d);
+  return 0;
+}
+
+static int _testReset(void) {
+  DelayCompensator d =
+      newDelayCompensator(kTestNumChannels, kTestBlocksize, 3);
+  SampleBuffer b = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+
+  _pushRamp(d, 0);
+  delayCompensatorReset(d);
+  assertIntEquals(0, d->numFrames);
+  _pushRamp(d, 0);
+  _pushRamp(d, 8);
+  assert(delayCompensatorRead(d, b));
+  assertDoubleEquals(3.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayCompensator(d);
+  return 0;
+}
+
+static int _testFreeNullDelayCompensator(void) {
+  freeDelayCompensator(NULL);
+  return 0;
+}
+
+TestSuite addDelayCompensatorTests(void);
+TestSuite addDelayCompensatorTests(void) {
+  TestSuite testSuite = newTestSuite("DelayCompensator", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewDelayCompensator);
+  addTest(testSuite, "PushAndReadWithoutDelay", _testPushAndReadWithoutDelay);
+  addTest(testSuite, "PushAndReadWithDelay", _testPushAndReadWithDelay);
+  addTest(testSuite, "DelayLongerThanBlock", _testDelayLongerThanBlock);
+  addTest(testSuite, "ReadAcrossEndOfRingBuffer",
+          _testReadAcrossEndOfRingBuffer);
+  addTest(testSuite, "ReadPartialBlock", _testReadPartialBlock);
+  addTest(testSuite, "SetLongerDelay", _testSetLongerDelay);
+  addTest(testSuite, "SetShorterDelay", _testSetShorterDelay);
+  addTest(testSuite, "Reset", _testReset);
+  addTest(testSuite, "FreeNull", _testFreeNullDelayCompensator);
+  return testSuite;
+}
@@ -0,0 +1,194 @@
+//
+// DelayLineTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/DelayLine.h"
+#include "unit/TestRunner.h"
+
+static const ChannelCount kTestNumChannels = 2;
+static const SampleCount kTestBlocksize = 4;
+
+// Fill a block where each sample is its frame number plus one, starting at
+// firstFrame, so that delayed silence can be told apart from the first frame
+static SampleBuffer _newRampBuffer(const unsigned long firstFrame) {
+  SampleBuffer result = newSampleBuffer(kTestNumChannels, kTestBlocksize);
+  ChannelCount i;
+  SampleCount j;
+
+  for (i = 0; i < result->numChannels; i++) {
+    for (j = 0; j < result->blocksize; j++) {
+      result->samples[i][j] = (Sample)(firstFrame + j + 1);
+    }
+  }
+
+  return result;
+}
+
+static int _testNewDelayLine(void) {
+  DelayLine d = newDelayLine(kTestNumChannels);
+  assertIntEquals(kTestNumChannels, d->numChannels);
+  assertUnsignedLongEquals(0ul, d->delayInFrames);
+  freeDelayLine(d);
+  return 0;
+}
+
+static int _testProcessWithoutDelay(void) {
+  DelayLine d = newDelayLine(kTestNumChannels);
+  SampleBuffer b = _newRampBuffer(0);
+
+  delayLineProcess(d, b);
+  assertDoubleEquals(1.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(4.0, b->samples[1][3], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayLine(d);
+  return 0;
+}
+
+static int _testProcessWithDelay(void) {
+  DelayLine d = newDelayLine(kTestNumChannels);
+  SampleBuffer b = _newRampBuffer(0);
+
+  delayLineSetDelay(d, 3);
+  delayLineProcess(d, b);
+  assertDoubleEquals(0.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b->samples[1][2], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, b->samples[0][3], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, b->samples[1][3], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayLine(d);
+  return 0;
+}
+
+static int _testProcessWithDelayAcrossBlocks(void) {
+  DelayLine d = newDelayLine(kTestNumChannels);
+  SampleBuffer b = _newRampBuffer(0);
+
+  // Longer than a block, so the first block is all silence
+  delayLineSetDelay(d, 6);
+  delayLineProcess(d, b);
+  assert(sampleBufferIsSilent(b));
+  freeSampleBuffer(b);
+
+  b = _newRampBuffer(4);
+  delayLineProcess(d, b);
+  assertDoubleEquals(0.0, b->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, b->samples[0][2], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(2.0, b->samples[1][3], TEST_DEFAULT_TOLERANCE);
+  freeSampleBuffer(b);
+
+  b = _newRampBuffer(8);
+  delayLineProcess(d, b);
+  assertDoubleEquals(3.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(6.0, b->samples[1][3], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayLine(d);
+  return 0;
+}
+
+static int _testProcessPartialBlock(void) {
+  DelayLine d = newDelayLine(kTestNumChannels);
+  SampleBuffer b = _newRampBuffer(0);
+
+  delayLineSetDelay(d, 1);
+  b->blocksize = 2;
+  delayLineProcess(d, b);
+  assertDoubleEquals(0.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, b->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  // Frames past the blocksize are left alone
+  assertDoubleEquals(3.0, b->samples[0][2], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayLine(d);
+  return 0;
+}
+
+static int _testSetDelay(void) {
+  DelayLine d = newDelayLine(kTestNumChannels);
+  SampleBuffer b = _newRampBuffer(0);
+
+  delayLineSetDelay(d, 2);
+  delayLineProcess(d, b);
+  freeSampleBuffer(b);
+
+  // The delayed audio is dropped when the delay changes
+  delayLineSetDelay(d, 1);
+  assertUnsignedLongEquals(1ul, d->delayInFrames);
+  b = _newRampBuffer(4);
+  delayLineProcess(d, b);
+  assertDoubleEquals(0.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(5.0, b->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  freeSampleBuffer(b);
+
+  delayLineSetDelay(d, 0);
+  b = _newRampBuffer(8);
+  delayLineProcess(d, b);
+  assertDoubleEquals(9.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayLine(d);
+  return 0;
+}
+
+static int _testReset(void) {
+  DelayLine d = newDelayLine(kTestNumChannels);
+  SampleBuffer b = _newRampBuffer(0);
+
+  delayLineSetDelay(d, 2);
+  delayLineProcess(d, b);
+  delayLineReset(d);
+  freeSampleBuffer(b);
+
+  b = _newRampBuffer(4);
+  delayLineProcess(d, b);
+  assertDoubleEquals(0.0, b->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(5.0, b->samples[0][2], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeDelayLine(d);
+  return 0;
+}
+
+static int _testFreeNullDelayLine(void) {
+  freeDelayLine(NULL);
+  return 0;
+}
+
+TestSuite addDelayLineTests(void);
+TestSuite addDelayLineTests(void) {
+  TestSuite testSuite = newTestSuite("DelayLine", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewDelayLine);
+  addTest(testSuite, "ProcessWithoutDelay", _testProcessWithoutDelay);
+  addTest(testSuite, "ProcessWithDelay", _testProcessWithDelay);
+  addTest(testSuite, "ProcessWithDelayAcrossBlocks",
+          _testProcessWithDelayAcrossBlocks);
+  addTest(testSuite, "ProcessPartialBlock", _testProcessPartialBlock);
+  addTest(testSuite, "SetDelay", _testSetDelay);
+  addTest(testSuite, "Reset", _testReset);
+  addTest(testSuite, "FreeNull", _testFreeNullDelayLine);
+  return testSuite;
+}
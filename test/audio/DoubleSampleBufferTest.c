@@ -0,0 +1,181 @@
+//
+// DoubleSampleBufferTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "audio/DoubleSampleBuffer.h"
+#include "unit/TestRunner.h"
+
+static int _testNewDoubleSampleBuffer(void) {
+  DoubleSampleBuffer b = newDoubleSampleBuffer(2, 8);
+  assertNotNull(b);
+  assertIntEquals(2, b->numChannels);
+  assertUnsignedLongEquals(8ul, b->blocksize);
+  assertDoubleEquals(0.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b->samples[1][7], TEST_DEFAULT_TOLERANCE);
+  freeDoubleSampleBuffer(b);
+  return 0;
+}
+
+static int _testClearDoubleSampleBuffer(void) {
+  DoubleSampleBuffer b = newDoubleSampleBuffer(2, 8);
+  b->samples[0][3] = 1.0;
+  b->samples[1][7] = -1.0;
+  doubleSampleBufferClear(b);
+  assertDoubleEquals(0.0, b->samples[0][3], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b->samples[1][7], TEST_DEFAULT_TOLERANCE);
+  freeDoubleSampleBuffer(b);
+  return 0;
+}
+
+static int _testCopyDoubleSampleBuffer(void) {
+  DoubleSampleBuffer b1 = newDoubleSampleBuffer(2, 8);
+  DoubleSampleBuffer b2 = newDoubleSampleBuffer(2, 8);
+
+  b2->samples[0][0] = 1e-40;
+  b2->samples[1][7] = 0.5;
+  assert(doubleSampleBufferCopy(b1, b2));
+  // Values which single precision cannot represent should be kept
+  assert(b1->samples[0][0] > 0.0);
+  assertDoubleEquals(0.5, b1->samples[1][7], TEST_DEFAULT_TOLERANCE);
+
+  freeDoubleSampleBuffer(b1);
+  freeDoubleSampleBuffer(b2);
+  return 0;
+}
+
+static int _testCopyPartialDoubleSampleBuffer(void) {
+  DoubleSampleBuffer b1 = newDoubleSampleBuffer(1, 8);
+  DoubleSampleBuffer b2 = newDoubleSampleBuffer(1, 8);
+
+  b2->samples[0][3] = 1.0;
+  b2->samples[0][4] = 2.0;
+  b1->blocksize = 4;
+  assert(doubleSampleBufferCopy(b1, b2));
+  assertDoubleEquals(1.0, b1->samples[0][3], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b1->samples[0][4], TEST_DEFAULT_TOLERANCE);
+
+  b1->blocksize = 8;
+  freeDoubleSampleBuffer(b1);
+  freeDoubleSampleBuffer(b2);
+  return 0;
+}
+
+static int _testCopyDoubleSampleBufferDifferentChannels(void) {
+  DoubleSampleBuffer b1 = newDoubleSampleBuffer(1, 8);
+  DoubleSampleBuffer b2 = newDoubleSampleBuffer(2, 8);
+
+  assertFalse(doubleSampleBufferCopy(b1, b2));
+
+  freeDoubleSampleBuffer(b1);
+  freeDoubleSampleBuffer(b2);
+  return 0;
+}
+
+static int _testCopyDoubleSampleBufferTooSmall(void) {
+  DoubleSampleBuffer b1 = newDoubleSampleBuffer(1, 8);
+  DoubleSampleBuffer b2 = newDoubleSampleBuffer(1, 4);
+
+  assertFalse(doubleSampleBufferCopy(b1, b2));
+
+  freeDoubleSampleBuffer(b1);
+  freeDoubleSampleBuffer(b2);
+  return 0;
+}
+
+static int _testCopyFromSampleBuffer(void) {
+  DoubleSampleBuffer d = newDoubleSampleBuffer(2, 8);
+  SampleBuffer s = newSampleBuffer(2, 8);
+
+  s->samples[0][0] = 0.25f;
+  s->samples[1][7] = -0.75f;
+  assert(doubleSampleBufferCopyFromSampleBuffer(d, s));
+  assertDoubleEquals(0.25, d->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(-0.75, d->samples[1][7], TEST_DEFAULT_TOLERANCE);
+
+  freeDoubleSampleBuffer(d);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testCopyFromSampleBufferDifferentChannels(void) {
+  DoubleSampleBuffer d = newDoubleSampleBuffer(2, 8);
+  SampleBuffer s = newSampleBuffer(1, 8);
+
+  assertFalse(doubleSampleBufferCopyFromSampleBuffer(d, s));
+
+  freeDoubleSampleBuffer(d);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testCopyToSampleBuffer(void) {
+  DoubleSampleBuffer d = newDoubleSampleBuffer(2, 8);
+  SampleBuffer s = newSampleBuffer(2, 8);
+
+  d->samples[0][0] = 0.25;
+  d->samples[1][7] = -0.75;
+  assert(doubleSampleBufferCopyToSampleBuffer(d, s));
+  assertDoubleEquals(0.25, s->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(-0.75, s->samples[1][7], TEST_DEFAULT_TOLERANCE);
+
+  freeDoubleSampleBuffer(d);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testCopyToSampleBufferTooSmall(void) {
+  DoubleSampleBuffer d = newDoubleSampleBuffer(2, 8);
+  SampleBuffer s = newSampleBuffer(2, 4);
+
+  assertFalse(doubleSampleBufferCopyToSampleBuffer(d, s));
+
+  freeDoubleSampleBuffer(d);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testFreeNullDoubleSampleBuffer(void) {
+  freeDoubleSampleBuffer(NULL);
+  return 0;
+}
+
+TestSuite addDoubleSampleBufferTests(void);
+TestSuite addDoubleSampleBufferTests(void) {
+  TestSuite testSuite = newTestSuite("DoubleSampleBuffer", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewDoubleSampleBuffer);
+  addTest(testSuite, "Clear", _testClearDoubleSampleBuffer);
+  addTest(testSuite, "Copy", _testCopyDoubleSampleBuffer);
+  addTest(testSuite, "CopyPartial", _testCopyPartialDoubleSampleBuffer);
+  addTest(testSuite, "CopyDifferentChannels",
+          _testCopyDoubleSampleBufferDifferentChannels);
+  addTest(testSuite, "CopyTooSmall", _testCopyDoubleSampleBufferTooSmall);
+  addTest(testSuite, "CopyFromSampleBuffer", _testCopyFromSampleBuffer);
+  addTest(testSuite, "CopyFromSampleBufferDifferentChannels",
+          _testCopyFromSampleBufferDifferentChannels);
+  addTest(testSuite, "CopyToSampleBuffer", _testCopyToSampleBuffer);
+  addTest(testSuite, "CopyToSampleBufferTooSmall",
+          _testCopyToSampleBufferTooSmall);
+  addTest(testSuite, "FreeNull", _testFreeNullDoubleSampleBuffer);
+  return testSuite;
+}
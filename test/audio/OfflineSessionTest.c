@@ -0,0 +1,196 @@
+//
+// OfflineSessionTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "audio/OfflineSession.h"
+#include "unit/TestRunner.h"
+
+static const SampleCount kTestNumFrames = 8;
+
+static SampleBuffer _newRampBuffer(void) {
+  SampleBuffer result = newSampleBuffer(2, kTestNumFrames);
+  SampleCount i;
+
+  for (i = 0; i < kTestNumFrames; i++) {
+    result->samples[0][i] = (Sample)i;
+    result->samples[1][i] = (Sample)(i + 100);
+  }
+
+  return result;
+}
+
+static OfflineSession _newTestOfflineSession(SampleBuffer input) {
+  CharString name = newCharStringWithCString("test");
+  OfflineSession result = newOfflineSession(name, input, 2);
+  freeCharString(name);
+  return result;
+}
+
+static int _testNewOfflineSession(void) {
+  SampleBuffer input = _newRampBuffer();
+  OfflineSession s = _newTestOfflineSession(input);
+
+  assertCharStringEquals("test", s->name);
+  assert(s->input == input);
+  assertIntEquals(2, s->output->numChannels);
+  assertUnsignedLongEquals(0ul, s->output->blocksize);
+  assertIntEquals(0, s->currentPass);
+
+  freeOfflineSession(s);
+  freeSampleBuffer(input);
+  return 0;
+}
+
+static int _testReadInput(void) {
+  SampleBuffer input = _newRampBuffer();
+  OfflineSession s = _newTestOfflineSession(input);
+  SampleBuffer b = newSampleBuffer(2, 4);
+
+  assertUnsignedLongEquals(4ul, offlineSessionRead(s, true, 2, 4, 2,
+                                                   b->samples));
+  assertDoubleEquals(2.0, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(105.0, b->samples[1][3], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeOfflineSession(s);
+  freeSampleBuffer(input);
+  return 0;
+}
+
+static int _testReadPastEnd(void) {
+  SampleBuffer input = _newRampBuffer();
+  OfflineSession s = _newTestOfflineSession(input);
+  SampleBuffer b = newSampleBuffer(2, 4);
+
+  b->samples[0][3] = 1.0f;
+  assertUnsignedLongEquals(2ul, offlineSessionRead(s, true, 6, 4, 2,
+                                                   b->samples));
+  assertDoubleEquals(7.0, b->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b->samples[0][3], TEST_DEFAULT_TOLERANCE);
+  assertUnsignedLongEquals(0ul, offlineSessionRead(s, true, 20, 4, 2,
+                                                   b->samples));
+  assertDoubleEquals(0.0, b->samples[1][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeOfflineSession(s);
+  freeSampleBuffer(input);
+  return 0;
+}
+
+static int _testReadMoreChannels(void) {
+  SampleBuffer input = _newRampBuffer();
+  OfflineSession s = _newTestOfflineSession(input);
+  SampleBuffer b = newSampleBuffer(3, 4);
+
+  b->samples[2][0] = 1.0f;
+  assertUnsignedLongEquals(4ul, offlineSessionRead(s, true, 0, 4, 3,
+                                                   b->samples));
+  assertDoubleEquals(100.0, b->samples[1][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b->samples[2][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeOfflineSession(s);
+  freeSampleBuffer(input);
+  return 0;
+}
+
+static int _testWriteAndReadOutput(void) {
+  SampleBuffer input = _newRampBuffer();
+  OfflineSession s = _newTestOfflineSession(input);
+  SampleBuffer b = newSampleBuffer(2, 4);
+
+  offlineSessionRead(s, true, 0, 4, 2, b->samples);
+  offlineSessionWrite(s, 0, 4, 2, b->samples);
+  assertUnsignedLongEquals(4ul, s->output->blocksize);
+
+  sampleBufferClear(b);
+  assertUnsignedLongEquals(4ul, offlineSessionRead(s, false, 0, 4, 2,
+                                                   b->samples));
+  assertDoubleEquals(3.0, b->samples[0][3], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(101.0, b->samples[1][1], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeOfflineSession(s);
+  freeSampleBuffer(input);
+  return 0;
+}
+
+static int _testWriteAfterEnd(void) {
+  SampleBuffer input = _newRampBuffer();
+  OfflineSession s = _newTestOfflineSession(input);
+  SampleBuffer b = newSampleBuffer(2, 4);
+
+  offlineSessionRead(s, true, 0, 4, 2, b->samples);
+  offlineSessionWrite(s, 100, 4, 2, b->samples);
+  assertUnsignedLongEquals(104ul, s->output->blocksize);
+  // The gap before the written frames is silent
+  assertDoubleEquals(0.0, s->output->samples[0][50], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(3.0, s->output->samples[0][103], TEST_DEFAULT_TOLERANCE);
+
+  // Writing before the end does not shorten the output
+  offlineSessionWrite(s, 0, 4, 2, b->samples);
+  assertUnsignedLongEquals(104ul, s->output->blocksize);
+  assertDoubleEquals(102.0, s->output->samples[1][2], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeOfflineSession(s);
+  freeSampleBuffer(input);
+  return 0;
+}
+
+static int _testWriteMoreChannels(void) {
+  SampleBuffer input = _newRampBuffer();
+  OfflineSession s = _newTestOfflineSession(input);
+  SampleBuffer b = newSampleBuffer(3, 1);
+
+  b->samples[0][0] = 1.0f;
+  b->samples[2][0] = 3.0f;
+  offlineSessionWrite(s, 0, 1, 3, b->samples);
+  assertIntEquals(2, s->output->numChannels);
+  assertDoubleEquals(1.0, s->output->samples[0][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(b);
+  freeOfflineSession(s);
+  freeSampleBuffer(input);
+  return 0;
+}
+
+static int _testFreeNullOfflineSession(void) {
+  freeOfflineSession(NULL);
+  return 0;
+}
+
+TestSuite addOfflineSessionTests(void);
+TestSuite addOfflineSessionTests(void) {
+  TestSuite testSuite = newTestSuite("OfflineSession", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewOfflineSession);
+  addTest(testSuite, "ReadInput", _testReadInput);
+  addTest(testSuite, "ReadPastEnd", _testReadPastEnd);
+  addTest(testSuite, "ReadMoreChannels", _testReadMoreChannels);
+  addTest(testSuite, "WriteAndReadOutput", _testWriteAndReadOutput);
+  addTest(testSuite, "WriteAfterEnd", _testWriteAfterEnd);
+  addTest(testSuite, "WriteMoreChannels", _testWriteMoreChannels);
+  addTest(testSuite, "FreeNull", _testFreeNullOfflineSession);
+  return testSuite;
+}
@@ -65,6 +65,26 @@ static int _testClearSampleBuffer(void) {
   return 0;
 }
 
+static int _testIsSilent(void) {
+  SampleBuffer s = _newMockSampleBuffer();
+  sampleBufferClear(s);
+  assert(sampleBufferIsSilent(s));
+  s->samples[0][0] = kSampleBufferSilenceThreshold / 2.0f;
+  assert(sampleBufferIsSilent(s));
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testIsSilentWithSignal(void) {
+  SampleBuffer s = newSampleBuffer(2, 100);
+  sampleBufferClear(s);
+  // Past the first chunk, and in the last channel
+  s->samples[1][99] = -0.001f;
+  assertFalse(sampleBufferIsSilent(s));
+  freeSampleBuffer(s);
+  return 0;
+}
+
 static int _testCopyAndMapChannelsSampleBuffers(void) {
   SampleBuffer s1 = _newMockSampleBuffer();
   SampleBuffer s2 = _newMockSampleBuffer();
@@ -141,6 +161,8 @@ TestSuite addSampleBufferTests(void) {
   addTest(testSuite, "NewSampleBufferMultichannel",
           _testNewSampleBufferMultichannel);
   addTest(testSuite, "ClearSampleBuffer", _testClearSampleBuffer);
+  addTest(testSuite, "IsSilent", _testIsSilent);
+  addTest(testSuite, "IsSilentWithSignal", _testIsSilentWithSignal);
   addTest(testSuite, "CopyAndMapChannelsSampleBuffers",
           _testCopyAndMapChannelsSampleBuffers);
   addTest(testSuite, "CopyAndMapChannelsSampleBuffersDifferentSizes",
@@ -28,6 +28,10 @@
 
 #include "unit/TestRunner.h"
 
+#if UNIX
+#include <sys/stat.h>
+#endif
+
 #define TEST_DIRNAME "test_dir"
 #define TEST_DIRNAME_WITH_DOT "test.dir"
 #define TEST_DIRNAME_COPY_DEST "test_dir_dest"
@@ -429,6 +433,36 @@ static int _testFileExistsInvalid(void) {
   return 0;
 }
 
+static int _testFileIsNamedPipeRegularFile(void) {
+  File f;
+  FILE *fp = fopen(TEST_FILENAME, "w");
+  CharString c = newCharStringWithCString(TEST_FILENAME);
+  assert(fp != NULL);
+  fclose(fp);
+
+  f = newFileWithPath(c);
+  assertFalse(fileIsNamedPipe(f));
+
+  freeFile(f);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testFileIsNamedPipe(void) {
+#if UNIX
+  CharString c = newCharStringWithCString(TEST_FILENAME);
+  File f;
+
+  assertIntEquals(0, mkfifo(TEST_FILENAME, 0600));
+  f = newFileWithPath(c);
+  assert(fileIsNamedPipe(f));
+
+  freeFile(f);
+  freeCharString(c);
+#endif
+  return 0;
+}
+
 static int _testFileCreateFile(void) {
   CharString p = newCharStringWithCString(TEST_FILENAME);
   File f, f2;
@@ -1035,6 +1069,43 @@ static int _testFileReadBytes(void) {
   return 0;
 }
 
+static int _testFileMapContents(void) {
+  CharString p = newCharStringWithCString(TEST_FILENAME);
+  File f = newFileWithPath(p);
+  size_t s = 0;
+  const char *contents;
+
+  assert(fileCreate(f, kFileTypeFile));
+  assert(fileWrite(f, p));
+  fileClose(f);
+  contents = (const char *)fileMapContents(f, &s);
+  assertNotNull(contents);
+  assertSizeEquals(strlen(TEST_FILENAME), s);
+  assertIntEquals(0, strncmp(TEST_FILENAME, contents, s));
+
+  fileUnmapContents(contents, s);
+  freeCharString(p);
+  freeFile(f);
+  return 0;
+}
+
+static int _testFileMapContentsNotExists(void) {
+  File f = newFileWithPathCString(TEST_FILENAME);
+  size_t s = 0;
+  assertIsNull(fileMapContents(f, &s));
+  freeFile(f);
+  return 0;
+}
+
+static int _testFileMapContentsEmpty(void) {
+  File f = newFileWithPathCString(TEST_FILENAME);
+  size_t s = 0;
+  assert(fileCreate(f, kFileTypeFile));
+  assertIsNull(fileMapContents(f, &s));
+  freeFile(f);
+  return 0;
+}
+
 static int _testFileReadBytesNotExists(void) {
   CharString p = newCharStringWithCString(TEST_FILENAME);
   File f = newFileWithPath(p);
@@ -1425,6 +1496,9 @@ TestSuite addFileTests(void) {
 
   addTest(testSuite, "FileExists", _testFileExists);
   addTest(testSuite, "FileExistsInvalid", _testFileExistsInvalid);
+  addTest(testSuite, "FileIsNamedPipeRegularFile",
+          _testFileIsNamedPipeRegularFile);
+  addTest(testSuite, "FileIsNamedPipe", _testFileIsNamedPipe);
 
   addTest(testSuite, "FileCreateFile", _testFileCreateFile);
   addTest(testSuite, "FileCreateDir", _testFileCreateDir);
@@ -1471,6 +1545,10 @@ TestSuite addFileTests(void) {
   addTest(testSuite, "FileReadBytesZeroSize", _testFileReadBytesZeroSize);
   addTest(testSuite, "FileReadBytesGreaterSize", _testFileReadBytesGreaterSize);
 
+  addTest(testSuite, "FileMapContents", _testFileMapContents);
+  addTest(testSuite, "FileMapContentsNotExists", _testFileMapContentsNotExists);
+  addTest(testSuite, "FileMapContentsEmpty", _testFileMapContentsEmpty);
+
   addTest(testSuite, "FileWrite", _testFileWrite);
   addTest(testSuite, "FileWriteMulitple", _testFileWriteMultiple);
   addTest(testSuite, "FileWriteInvalid", _testFileWriteInvalid);
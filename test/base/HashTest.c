@@ -0,0 +1,120 @@
+//
+// HashTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "base/Hash.h"
+
+#include "base/File.h"
+#include "unit/TestRunner.h"
+
+#define TEST_HASH_FILENAME "test_hash.txt"
+
+static void _hashTestSetup(void) {}
+
+static void _hashTestTeardown(void) {
+  File f = newFileWithPathCString(TEST_HASH_FILENAME);
+
+  if (fileExists(f)) {
+    fileRemove(f);
+  }
+
+  freeFile(f);
+}
+
+static int _testHashBytes(void) {
+  // Reference values for 64-bit FNV-1a
+  assert(hashBytes(kHashInitialValue, "a", 1) == 0xaf63dc4c8601ec8cull);
+  assert(hashBytes(kHashInitialValue, "abc", 3) == 0xe71fa2190541574bull);
+  return 0;
+}
+
+static int _testHashBytesEmpty(void) {
+  assert(hashBytes(kHashInitialValue, "", 0) == kHashInitialValue);
+  return 0;
+}
+
+static int _testHashCStringSeparatesStrings(void) {
+  HashValue first = hashCString(hashCString(kHashInitialValue, "ab"), "c");
+  HashValue second = hashCString(hashCString(kHashInitialValue, "a"), "bc");
+  assertFalse(first == second);
+  return 0;
+}
+
+static int _testHashFileContents(void) {
+  CharString p = newCharStringWithCString(TEST_HASH_FILENAME);
+  CharString contents = newCharStringWithCString("abc");
+  File f = newFileWithPath(p);
+  HashValue hash = kHashInitialValue;
+
+  assert(fileCreate(f, kFileTypeFile));
+  assert(fileWrite(f, contents));
+  fileClose(f);
+  assert(hashFileContents(&hash, p));
+  assert(hash == 0xe71fa2190541574bull);
+
+  freeFile(f);
+  freeCharString(contents);
+  freeCharString(p);
+  return 0;
+}
+
+static int _testHashFileContentsEmpty(void) {
+  CharString p = newCharStringWithCString(TEST_HASH_FILENAME);
+  File f = newFileWithPath(p);
+  HashValue hash = kHashInitialValue;
+
+  assert(fileCreate(f, kFileTypeFile));
+  fileClose(f);
+  assert(hashFileContents(&hash, p));
+  assert(hash == kHashInitialValue);
+
+  freeFile(f);
+  freeCharString(p);
+  return 0;
+}
+
+static int _testHashFileContentsInvalid(void) {
+  CharString p = newCharStringWithCString("invalid");
+  HashValue hash = kHashInitialValue;
+
+  assertFalse(hashFileContents(&hash, p));
+  assert(hash == kHashInitialValue);
+
+  freeCharString(p);
+  return 0;
+}
+
+TestSuite addHashTests(void);
+TestSuite addHashTests(void) {
+  TestSuite testSuite = newTestSuite("Hash", _hashTestSetup, _hashTestTeardown);
+  addTest(testSuite, "HashBytes", _testHashBytes);
+  addTest(testSuite, "HashBytesEmpty", _testHashBytesEmpty);
+  addTest(testSuite, "HashCStringSeparatesStrings",
+          _testHashCStringSeparatesStrings);
+  addTest(testSuite, "HashFileContents", _testHashFileContents);
+  addTest(testSuite, "HashFileContentsEmpty", _testHashFileContentsEmpty);
+  addTest(testSuite, "HashFileContentsInvalid", _testHashFileContentsInvalid);
+  return testSuite;
+}
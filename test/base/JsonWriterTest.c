@@ -0,0 +1,201 @@
+//
+// JsonWriterTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "base/JsonWriter.h"
+
+#include "base/File.h"
+#include "unit/TestRunner.h"
+
+#define TEST_JSON_FILENAME "test_writer.json"
+
+static void _jsonWriterTestTeardown(void) {
+  File jsonFile = newFileWithPathCString(TEST_JSON_FILENAME);
+
+  if (fileExists(jsonFile)) {
+    fileRemove(jsonFile);
+  }
+
+  freeFile(jsonFile);
+}
+
+static JsonWriter _newTestJsonWriter(void) {
+  CharString path = newCharStringWithCString(TEST_JSON_FILENAME);
+  JsonWriter jsonWriter = newJsonWriterWithPath(path);
+  freeCharString(path);
+  return jsonWriter;
+}
+
+static CharString _readJsonFile(void) {
+  File jsonFile = newFileWithPathCString(TEST_JSON_FILENAME);
+  CharString contents = fileReadContents(jsonFile);
+  freeFile(jsonFile);
+  return contents;
+}
+
+static int _testNewJsonWriterWithInvalidPath(void) {
+  CharString path = newCharStringWithCString("invalid/path/to/file.json");
+  JsonWriter jsonWriter = newJsonWriterWithPath(path);
+  assertIsNull(jsonWriter);
+  freeCharString(path);
+  return 0;
+}
+
+static int _testWriteEmptyObject(void) {
+  JsonWriter jsonWriter = _newTestJsonWriter();
+  CharString contents;
+
+  assertNotNull(jsonWriter);
+  jsonWriterBeginObject(jsonWriter, NULL);
+  jsonWriterEndObject(jsonWriter);
+  freeJsonWriter(jsonWriter);
+
+  contents = _readJsonFile();
+  assertCharStringEquals("{}\n", contents);
+  freeCharString(contents);
+  return 0;
+}
+
+static int _testWriteValues(void) {
+  JsonWriter jsonWriter = _newTestJsonWriter();
+  CharString contents;
+
+  jsonWriterBeginObject(jsonWriter, NULL);
+  jsonWriterWriteString(jsonWriter, "string", "test");
+  jsonWriterWriteDouble(jsonWriter, "double", 1.5);
+  jsonWriterWriteUnsignedLong(jsonWriter, "unsigned", 123);
+  jsonWriterWriteBool(jsonWriter, "bool", true);
+  jsonWriterEndObject(jsonWriter);
+  freeJsonWriter(jsonWriter);
+
+  contents = _readJsonFile();
+  assertCharStringEquals("{\n"
+                         "  \"string\": \"test\",\n"
+                         "  \"double\": 1.500000,\n"
+                         "  \"unsigned\": 123,\n"
+                         "  \"bool\": true\n"
+                         "}\n",
+                         contents);
+  freeCharString(contents);
+  return 0;
+}
+
+static int _testWriteNestedContainers(void) {
+  JsonWriter jsonWriter = _newTestJsonWriter();
+  CharString contents;
+
+  jsonWriterBeginObject(jsonWriter, NULL);
+  jsonWriterBeginArray(jsonWriter, "array");
+  jsonWriterWriteUnsignedLong(jsonWriter, NULL, 1);
+  jsonWriterBeginObject(jsonWriter, NULL);
+  jsonWriterEndObject(jsonWriter);
+  jsonWriterEndArray(jsonWriter);
+  jsonWriterBeginArray(jsonWriter, "empty");
+  jsonWriterEndArray(jsonWriter);
+  jsonWriterEndObject(jsonWriter);
+  freeJsonWriter(jsonWriter);
+
+  contents = _readJsonFile();
+  assertCharStringEquals("{\n"
+                         "  \"array\": [\n"
+                         "    1,\n"
+                         "    {}\n"
+                         "  ],\n"
+                         "  \"empty\": []\n"
+                         "}\n",
+                         contents);
+  freeCharString(contents);
+  return 0;
+}
+
+static int _testWriteEscapedString(void) {
+  JsonWriter jsonWriter = _newTestJsonWriter();
+  CharString contents;
+
+  jsonWriterBeginArray(jsonWriter, NULL);
+  jsonWriterWriteString(jsonWriter, NULL, "a \"b\"\\c\n");
+  jsonWriterEndArray(jsonWriter);
+  freeJsonWriter(jsonWriter);
+
+  contents = _readJsonFile();
+  assertCharStringEquals("[\n  \"a \\\"b\\\"\\\\c\\n\"\n]\n", contents);
+  freeCharString(contents);
+  return 0;
+}
+
+static int _testWriteInvalidDouble(void) {
+  JsonWriter jsonWriter = _newTestJsonWriter();
+  CharString contents;
+  double zero = 0.0;
+
+  jsonWriterBeginArray(jsonWriter, NULL);
+  jsonWriterWriteDouble(jsonWriter, NULL, zero / zero);
+  jsonWriterWriteDouble(jsonWriter, NULL, 1.0 / zero);
+  jsonWriterEndArray(jsonWriter);
+  freeJsonWriter(jsonWriter);
+
+  contents = _readJsonFile();
+  assertCharStringEquals("[\n  null,\n  null\n]\n", contents);
+  freeCharString(contents);
+  return 0;
+}
+
+static int _testFreeClosesOpenContainers(void) {
+  JsonWriter jsonWriter = _newTestJsonWriter();
+  CharString contents;
+
+  jsonWriterBeginObject(jsonWriter, NULL);
+  jsonWriterBeginArray(jsonWriter, "array");
+  freeJsonWriter(jsonWriter);
+
+  contents = _readJsonFile();
+  assertCharStringEquals("{\n  \"array\": []\n}\n", contents);
+  freeCharString(contents);
+  return 0;
+}
+
+static int _testFreeNullJsonWriter(void) {
+  freeJsonWriter(NULL);
+  return 0;
+}
+
+TestSuite addJsonWriterTests(void);
+TestSuite addJsonWriterTests(void) {
+  TestSuite testSuite =
+      newTestSuite("JsonWriter", NULL, _jsonWriterTestTeardown);
+
+  addTest(testSuite, "NewJsonWriterWithInvalidPath",
+          _testNewJsonWriterWithInvalidPath);
+  addTest(testSuite, "WriteEmptyObject", _testWriteEmptyObject);
+  addTest(testSuite, "WriteValues", _testWriteValues);
+  addTest(testSuite, "WriteNestedContainers", _testWriteNestedContainers);
+  addTest(testSuite, "WriteEscapedString", _testWriteEscapedString);
+  addTest(testSuite, "WriteInvalidDouble", _testWriteInvalidDouble);
+  addTest(testSuite, "FreeClosesOpenContainers",
+          _testFreeClosesOpenContainers);
+  addTest(testSuite, "FreeNullJsonWriter", _testFreeNullJsonWriter);
+
+  return testSuite;
+}
@@ -222,6 +222,73 @@ static int _testForeachOverUserData(void) {
   return 0;
 }
 
+static int _testClearList(void) {
+  LinkedList l = newLinkedList();
+  CharString c = newCharString();
+
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  linkedListClear(l);
+  assertIntEquals(0, linkedListLength(l));
+  assertIsNull(l->item);
+  assertIsNull(linkedListToArray(l));
+  linkedListForeach(l, _linkedListTestStringCallback, NULL);
+  assertIntEquals(0, _gNumForeachCallbacksMade);
+
+  freeLinkedList(l);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testClearAndReuseList(void) {
+  LinkedList l = newLinkedList();
+  CharString c = newCharStringWithCString(TEST_ITEM_STRING);
+  LinkedListIterator secondNode;
+
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  secondNode = (LinkedListIterator)(l->nextItem);
+  linkedListClear(l);
+
+  // Nodes from the previous contents should be filled in again
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  assertIntEquals(2, linkedListLength(l));
+  assert(l->nextItem == secondNode);
+  assert(secondNode->item == c);
+  linkedListForeach(l, _linkedListTestStringCallback, NULL);
+  assertIntEquals(2, _gNumForeachCallbacksMade);
+
+  // Appending past the reused nodes adds new ones at the end
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  assertIntEquals(4, linkedListLength(l));
+
+  freeLinkedList(l);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testClearNullList(void) {
+  linkedListClear(NULL);
+  return 0;
+}
+
+static int _testFreeClearedListAndItems(void) {
+  LinkedList l = newLinkedList();
+  CharString c = newCharString();
+
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  linkedListClear(l);
+  linkedListAppend(l, newCharString());
+  // Should only free the one item still in the list
+  freeLinkedListAndItems(l, (LinkedListFreeItemFunc)freeCharString);
+  freeCharString(c);
+  return 0;
+}
+
 static int _testFreeNullLinkedList(void) {
   freeLinkedList(NULL);
   return 0;
@@ -250,6 +317,11 @@ TestSuite addLinkedListTests(void) {
   addTest(testSuite, "ForeachOverList", _testForeachOverList);
   addTest(testSuite, "ForeachWithUserData", _testForeachOverUserData);
 
+  addTest(testSuite, "ClearList", _testClearList);
+  addTest(testSuite, "ClearAndReuseList", _testClearAndReuseList);
+  addTest(testSuite, "ClearNullList", _testClearNullList);
+
+  addTest(testSuite, "FreeClearedListAndItems", _testFreeClearedListAndItems);
   addTest(testSuite, "FreeNullLinkedList", _testFreeNullLinkedList);
 
   return testSuite;
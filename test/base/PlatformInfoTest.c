@@ -82,6 +82,24 @@ static int _testIsHostLittleEndian(void) {
   return 0;
 }
 
+static int _testGetPeakMemoryUsage(void) {
+#if LINUX || MACOSX || WINDOWS
+  assert(platformInfoGetPeakMemoryUsage() > 0);
+#endif
+  return 0;
+}
+
+static int _testGetNumProcessors(void) {
+  assert(platformInfoGetNumProcessors() >= 1);
+  return 0;
+}
+
+static int _testGetProcessId(void) {
+  assert(platformInfoGetProcessId() == platformInfoGetProcessId());
+  assert(platformInfoGetProcessId() > 0);
+  return 0;
+}
+
 TestSuite addPlatformInfoTests(void);
 TestSuite addPlatformInfoTests(void) {
   TestSuite testSuite = newTestSuite("PlatformInfo", NULL, NULL);
@@ -91,6 +109,9 @@ TestSuite addPlatformInfoTests(void) {
   addTest(testSuite, "GetShortPlatformName", _testGetShortPlatformName);
 
   addTest(testSuite, "IsHostLittleEndian", _testIsHostLittleEndian);
+  addTest(testSuite, "GetPeakMemoryUsage", _testGetPeakMemoryUsage);
+  addTest(testSuite, "GetNumProcessors", _testGetNumProcessors);
+  addTest(testSuite, "GetProcessId", _testGetProcessId);
 
   return testSuite;
 }
@@ -27,13 +27,27 @@
 #include "io/SampleSource.h"
 
 #include "audio/AudioSettings.h"
+#include "base/File.h"
+#include "io/SampleSourceMemory.h"
 #include "unit/TestRunner.h"
 
+#include <stdlib.h>
+
 const char *TEST_SAMPLESOURCE_FILENAME = "test.pcm";
+static const char *kTestSampleSourceCacheFilename = "test.f32";
 
 static void _sampleSourceSetup(void) { initAudioSettings(); }
 
-static void _sampleSourceTeardown(void) { freeAudioSettings(); }
+static void _sampleSourceTeardown(void) {
+  File cacheFile = newFileWithPathCString(kTestSampleSourceCacheFilename);
+
+  if (fileExists(cacheFile)) {
+    fileRemove(cacheFile);
+  }
+
+  freeFile(cacheFile);
+  freeAudioSettings();
+}
 
 static int _testGuessSampleSourceTypePcm(void) {
   CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FILENAME);
@@ -62,6 +76,245 @@ static int _testGuessSampleSourceTypeWrongCase(void) {
   return 0;
 }
 
+// Number of frames which the ramp source produces before it ends
+static const SampleCount kRampSourceLength = 1000;
+
+// Reads frames with a value equal to their index in the source
+static boolByte _readBlockFromRamp(void *sampleSourcePtr,
+                                   SampleBuffer sampleBuffer) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleCount position = sampleSource->numSamplesProcessed;
+  SampleCount originalBlocksize = sampleBuffer->blocksize;
+  ChannelCount c;
+  SampleCount i;
+
+  if (position + sampleBuffer->blocksize > kRampSourceLength) {
+    sampleBuffer->blocksize = kRampSourceLength - position;
+  }
+
+  for (c = 0; c < sampleBuffer->numChannels; c++) {
+    for (i = 0; i < sampleBuffer->blocksize; i++) {
+      sampleBuffer->samples[c][i] = (Sample)(position + i);
+    }
+  }
+
+  sampleSource->numSamplesProcessed += sampleBuffer->blocksize;
+  return (boolByte)(originalBlocksize == sampleBuffer->blocksize);
+}
+
+static SampleSource _newSampleSourceRamp(void) {
+  SampleSource s = sampleSourceFactory(NULL);
+  s->openedAs = SAMPLE_SOURCE_OPEN_READ;
+  s->sampleSourceType = SAMPLE_SOURCE_TYPE_PCM;
+  s->readSampleBlock = _readBlockFromRamp;
+  return s;
+}
+
+static int _testNewSampleSourceMemory(void) {
+  SampleSource ramp = _newSampleSourceRamp();
+  SampleSource s = newSampleSourceMemory(ramp);
+  SampleSourceMemoryData extraData;
+
+  assertNotNull(s);
+  assertIntEquals(SAMPLE_SOURCE_TYPE_MEMORY, s->sampleSourceType);
+  assertIntEquals(SAMPLE_SOURCE_OPEN_READ, s->openedAs);
+  extraData = (SampleSourceMemoryData)s->extraData;
+  assertUnsignedLongEquals(kRampSourceLength, extraData->buffer->blocksize);
+  assertDoubleEquals((kRampSourceLength - 1.0),
+                     extraData->buffer->samples[0][kRampSourceLength - 1],
+                     0.0);
+
+  freeSampleSource(s);
+  freeSampleSource(ramp);
+  return 0;
+}
+
+static int _testNewSampleSourceMemoryFromSilence(void) {
+  SampleSource silence = sampleSourceFactory(NULL);
+  silence->openSampleSource(silence, SAMPLE_SOURCE_OPEN_READ);
+  assertIsNull(newSampleSourceMemory(silence));
+  freeSampleSource(silence);
+  return 0;
+}
+
+static int _testReadSampleSourceMemory(void) {
+  SampleSource ramp = _newSampleSourceRamp();
+  SampleSource s = newSampleSourceMemory(ramp);
+  SampleBuffer b = newSampleBuffer(getNumChannels(), 400);
+  SampleCount expectedBlocksizes[] = {400, 400, 200};
+  int i;
+
+  for (i = 0; i < 3; i++) {
+    b->blocksize = 400;
+    assertIntEquals(i < 2, s->readSampleBlock(s, b));
+    assertUnsignedLongEquals(expectedBlocksizes[i], b->blocksize);
+    assertDoubleEquals(i * 400.0, b->samples[0][0], 0.0);
+  }
+
+  assertUnsignedLongEquals(kRampSourceLength * getNumChannels(),
+                           s->numSamplesProcessed);
+
+  freeSampleBuffer(b);
+  freeSampleSource(s);
+  freeSampleSource(ramp);
+  return 0;
+}
+
+static int _testRewindSampleSourceMemory(void) {
+  SampleSource ramp = _newSampleSourceRamp();
+  SampleSource s = newSampleSourceMemory(ramp);
+  SampleBuffer b = newSampleBuffer(getNumChannels(), 600);
+
+  s->readSampleBlock(s, b);
+  sampleSourceMemoryRewind(s);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, s->numSamplesProcessed);
+  assert(s->readSampleBlock(s, b));
+  assertDoubleEquals(0.0, b->samples[0][0], 0.0);
+  assertDoubleEquals(599.0, b->samples[0][599], 0.0);
+
+  freeSampleBuffer(b);
+  freeSampleSource(s);
+  freeSampleSource(ramp);
+  return 0;
+}
+
+static int _testOpenSampleSourceMemoryForWriting(void) {
+  SampleSource ramp = _newSampleSourceRamp();
+  SampleSource s = newSampleSourceMemory(ramp);
+
+  assertFalse(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+
+  freeSampleSource(s);
+  freeSampleSource(ramp);
+  return 0;
+}
+
+static int _testSampleSourceMemoryCache(void) {
+  SampleSource ramp = _newSampleSourceRamp();
+  SampleSource s = newSampleSourceMemory(ramp);
+  CharString cachePath =
+      newCharStringWithCString(kTestSampleSourceCacheFilename);
+  SampleSource cached;
+  SampleBuffer b = newSampleBuffer(getNumChannels(), 600);
+
+  assert(sampleSourceMemoryWriteCache(s, cachePath, getSampleRate()));
+  cached = newSampleSourceMemoryFromCache(cachePath);
+  assertNotNull(cached);
+  assertIntEquals(SAMPLE_SOURCE_TYPE_MEMORY, cached->sampleSourceType);
+
+  assert(cached->readSampleBlock(cached, b));
+  assertDoubleEquals(599.0, b->samples[0][599], 0.0);
+  assertDoubleEquals(599.0, b->samples[getNumChannels() - 1][599], 0.0);
+  assertFalse(cached->readSampleBlock(cached, b));
+  assertUnsignedLongEquals(400ul, b->blocksize);
+  assertDoubleEquals((kRampSourceLength - 1.0), b->samples[0][399], 0.0);
+
+  freeSampleBuffer(b);
+  freeSampleSource(cached);
+  freeCharString(cachePath);
+  freeSampleSource(s);
+  freeSampleSource(ramp);
+  return 0;
+}
+
+static int _testSampleSourceMemoryCacheInvalid(void) {
+  CharString cachePath =
+      newCharStringWithCString(kTestSampleSourceCacheFilename);
+  File cacheFile = newFileWithPath(cachePath);
+
+  assert(fileCreate(cacheFile, kFileTypeFile));
+  assert(fileWrite(cacheFile, cachePath));
+  fileClose(cacheFile);
+  assertIsNull(newSampleSourceMemoryFromCache(cachePath));
+
+  freeFile(cacheFile);
+  freeCharString(cachePath);
+  return 0;
+}
+
+static int _testSampleSourceMemoryCacheMissing(void) {
+  CharString cachePath = newCharStringWithCString("invalid");
+  assertIsNull(newSampleSourceMemoryFromCache(cachePath));
+  freeCharString(cachePath);
+  return 0;
+}
+
+static int _testGetSampleSourceMemoryCacheName(void) {
+  CharString cachePath =
+      newCharStringWithCString(kTestSampleSourceCacheFilename);
+  File cacheFile = newFileWithPath(cachePath);
+  CharString result;
+  CharString otherResult;
+
+  assert(fileCreate(cacheFile, kFileTypeFile));
+  assert(fileWrite(cacheFile, cachePath));
+  fileClose(cacheFile);
+  result = sampleSourceMemoryGetCacheName(cachePath, 44100.0, 2);
+  assertNotNull(result);
+  assertCharStringEquals("9f5d33a7f4d87020-44100-2.f32", result);
+  otherResult = sampleSourceMemoryGetCacheName(cachePath, 48000.0, 2);
+  assertFalse(charStringIsEqualTo(result, otherResult, false));
+
+  freeCharString(otherResult);
+  freeCharString(result);
+  freeFile(cacheFile);
+  freeCharString(cachePath);
+  return 0;
+}
+
+static int _testSampleSourceCacheWriter(void) {
+  CharString cachePath =
+      newCharStringWithCString(kTestSampleSourceCacheFilename);
+  SampleSourceCacheWriter w =
+      newSampleSourceCacheWriter(cachePath, getNumChannels(), getSampleRate());
+  SampleBuffer b = newSampleBuffer(getNumChannels(), 100);
+  SampleSource cached;
+  SampleSourceMemoryData extraData;
+  unsigned int i;
+
+  for (i = 0; i < 3; i++) {
+    sampleBufferClear(b);
+    b->samples[getNumChannels() - 1][0] = (Sample)i;
+    assert(sampleSourceCacheWriterAppend(w, b));
+  }
+
+  assertUnsignedLongEquals(300ul, w->numFrames);
+  assert(sampleSourceCacheWriterFinish(w));
+  cached = newSampleSourceMemoryFromCache(cachePath);
+  assertNotNull(cached);
+  extraData = (SampleSourceMemoryData)cached->extraData;
+  assertUnsignedLongEquals(300ul, extraData->buffer->blocksize);
+  assertDoubleEquals(2.0,
+                     extraData->buffer->samples[getNumChannels() - 1][200],
+                     0.0);
+  assertDoubleEquals(0.0, extraData->buffer->samples[0][200], 0.0);
+
+  freeSampleSource(cached);
+  freeSampleBuffer(b);
+  freeSampleSourceCacheWriter(w);
+  freeCharString(cachePath);
+  return 0;
+}
+
+static int _testSampleSourceCacheWriterWrongChannels(void) {
+  CharString cachePath =
+      newCharStringWithCString(kTestSampleSourceCacheFilename);
+  SampleSourceCacheWriter w =
+      newSampleSourceCacheWriter(cachePath, getNumChannels(), getSampleRate());
+  SampleBuffer b = newSampleBuffer(getNumChannels() + 1, 100);
+  File f = newFileWithPath(cachePath);
+
+  assertFalse(sampleSourceCacheWriterAppend(w, b));
+  assertFalse(sampleSourceCacheWriterFinish(w));
+  assertFalse(fileExists(f));
+
+  freeFile(f);
+  freeSampleBuffer(b);
+  freeSampleSourceCacheWriter(w);
+  freeCharString(cachePath);
+  return 0;
+}
+
 TestSuite addSampleSourceTests(void);
 TestSuite addSampleSourceTests(void) {
   TestSuite testSuite =
@@ -71,5 +324,23 @@ TestSuite addSampleSourceTests(void) {
           _testGuessSampleSourceTypeEmpty);
   addTest(testSuite, "GuessSampleSourceTypeWrongCase",
           _testGuessSampleSourceTypeWrongCase);
+  addTest(testSuite, "NewSampleSourceMemory", _testNewSampleSourceMemory);
+  addTest(testSuite, "NewSampleSourceMemoryFromSilence",
+          _testNewSampleSourceMemoryFromSilence);
+  addTest(testSuite, "ReadSampleSourceMemory", _testReadSampleSourceMemory);
+  addTest(testSuite, "RewindSampleSourceMemory",
+          _testRewindSampleSourceMemory);
+  addTest(testSuite, "OpenSampleSourceMemoryForWriting",
+          _testOpenSampleSourceMemoryForWriting);
+  addTest(testSuite, "SampleSourceMemoryCache", _testSampleSourceMemoryCache);
+  addTest(testSuite, "SampleSourceMemoryCacheInvalid",
+          _testSampleSourceMemoryCacheInvalid);
+  addTest(testSuite, "SampleSourceMemoryCacheMissing",
+          _testSampleSourceMemoryCacheMissing);
+  addTest(testSuite, "GetSampleSourceMemoryCacheName",
+          _testGetSampleSourceMemoryCacheName);
+  addTest(testSuite, "SampleSourceCacheWriter", _testSampleSourceCacheWriter);
+  addTest(testSuite, "SampleSourceCacheWriterWrongChannels",
+          _testSampleSourceCacheWriterWrongChannels);
   return testSuite;
 }
@@ -0,0 +1,207 @@
+//
+// TraceLoggerTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "logging/TraceLogger.h"
+
+#include "base/File.h"
+#include "time/TaskTimer.h"
+#include "unit/TestRunner.h"
+
+#if UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define TEST_TRACE_FILENAME "test_trace.json"
+
+static void _traceLoggerTestTeardown(void) {
+  File traceFile = newFileWithPathCString(TEST_TRACE_FILENAME);
+
+  freeTraceLogger();
+
+  if (fileExists(traceFile)) {
+    fileRemove(traceFile);
+  }
+
+  freeFile(traceFile);
+}
+
+static CharString _readTraceFile(void) {
+  File traceFile = newFileWithPathCString(TEST_TRACE_FILENAME);
+  CharString contents = fileReadContents(traceFile);
+  freeFile(traceFile);
+  return contents;
+}
+
+static boolByte _initTestTraceLogger(void) {
+  CharString traceFileName = newCharStringWithCString(TEST_TRACE_FILENAME);
+  boolByte result = initTraceLogger(traceFileName);
+  freeCharString(traceFileName);
+  return result;
+}
+
+static int _testTraceLoggerDisabledByDefault(void) {
+  assertFalse(isTraceLoggerEnabled());
+  // None of these should crash when tracing is disabled
+  traceLoggerBeginEvent("test", "test");
+  traceLoggerEndEvent();
+  traceLoggerCompleteEvent("test", "test", 0, 0);
+  traceLoggerSetThreadName("test");
+  freeTraceLogger();
+  return 0;
+}
+
+static int _testInitTraceLoggerWithInvalidPath(void) {
+  CharString traceFileName =
+      newCharStringWithCString("invalid/path/to/trace.json");
+  assertFalse(initTraceLogger(traceFileName));
+  assertFalse(isTraceLoggerEnabled());
+  freeCharString(traceFileName);
+  return 0;
+}
+
+static int _testWriteTraceFile(void) {
+  CharString contents;
+
+  assert(_initTestTraceLogger());
+  assert(isTraceLoggerEnabled());
+  traceLoggerBeginEvent("test", "span");
+  traceLoggerEndEvent();
+  traceLoggerCompleteEvent("test", "complete", 1000, 2000);
+  freeTraceLogger();
+  assertFalse(isTraceLoggerEnabled());
+
+  contents = _readTraceFile();
+  assertNotNull(contents);
+  assertIntEquals('[', contents->data[0]);
+  assertNotNull(strstr(contents->data, "\"name\":\"span\",\"cat\":\"test\","
+                                       "\"ph\":\"B\""));
+  assertNotNull(strstr(contents->data, "\"ph\":\"E\""));
+  assertNotNull(strstr(contents->data, "\"ph\":\"X\",\"ts\":1.000,"
+                                       "\"dur\":2.000"));
+  assertNotNull(strstr(contents->data, "}\n]\n"));
+
+  freeCharString(contents);
+  return 0;
+}
+
+static int _testEventNameIsEscaped(void) {
+  CharString contents;
+
+  assert(_initTestTraceLogger());
+  traceLoggerBeginEvent("test", "\"quoted\\name\"");
+  traceLoggerEndEvent();
+  freeTraceLogger();
+
+  contents = _readTraceFile();
+  assertNotNull(strstr(contents->data, "\\\"quoted\\\\name\\\""));
+
+  freeCharString(contents);
+  return 0;
+}
+
+static int _testTaskTimerWritesTraceEvent(void) {
+  TaskTimer t = newTaskTimerWithCString("component", "subcomponent");
+  CharString contents;
+
+  assert(_initTestTraceLogger());
+  taskTimerStart(t);
+  taskTimerStop(t);
+  freeTraceLogger();
+
+  contents = _readTraceFile();
+  assertNotNull(strstr(contents->data, "\"name\":\"component subcomponent\","
+                                       "\"cat\":\"timer\",\"ph\":\"X\""));
+
+  freeCharString(contents);
+  freeTaskTimer(t);
+  return 0;
+}
+
+#if UNIX
+static int _testReopenInChildProcess(void) {
+  CharString contents;
+  CharString childFileName = newCharString();
+  File childFile;
+  pid_t processId;
+  int status;
+
+  assert(_initTestTraceLogger());
+  // Left in the parent's buffer when the child is forked
+  traceLoggerCompleteEvent("test", "parent", 0, 0);
+  processId = fork();
+
+  if (processId == 0) {
+    traceLoggerReopenInChildProcess();
+    traceLoggerCompleteEvent("test", "child", 0, 0);
+    freeTraceLogger();
+    _exit(0);
+  }
+
+  assert(processId > 0);
+  assertIntEquals(processId, waitpid(processId, &status, 0));
+  freeTraceLogger();
+
+  contents = _readTraceFile();
+  assertNotNull(strstr(contents->data, "\"parent\""));
+  assertIsNull(strstr(strstr(contents->data, "\"parent\"") + 1,
+                      "\"parent\""));
+  assertIsNull(strstr(contents->data, "\"child\""));
+  freeCharString(contents);
+
+  snprintf(childFileName->data, childFileName->capacity, "%s.%d",
+           TEST_TRACE_FILENAME, (int)processId);
+  childFile = newFileWithPath(childFileName);
+  contents = fileReadContents(childFile);
+  assertNotNull(contents);
+  assertNotNull(strstr(contents->data, "\"child\""));
+  assertIsNull(strstr(contents->data, "\"parent\""));
+  assertNotNull(strstr(contents->data, "}\n]\n"));
+
+  fileRemove(childFile);
+  freeFile(childFile);
+  freeCharString(contents);
+  freeCharString(childFileName);
+  return 0;
+}
+#endif
+
+TestSuite addTraceLoggerTests(void);
+TestSuite addTraceLoggerTests(void) {
+  TestSuite testSuite =
+      newTestSuite("TraceLogger", NULL, _traceLoggerTestTeardown);
+  addTest(testSuite, "DisabledByDefault", _testTraceLoggerDisabledByDefault);
+  addTest(testSuite, "InitWithInvalidPath",
+          _testInitTraceLoggerWithInvalidPath);
+  addTest(testSuite, "WriteTraceFile", _testWriteTraceFile);
+  addTest(testSuite, "EventNameIsEscaped", _testEventNameIsEscaped);
+  addTest(testSuite, "TaskTimerWritesTraceEvent",
+          _testTaskTimerWritesTraceEvent);
+#if UNIX
+  addTest(testSuite, "ReopenInChildProcess", _testReopenInChildProcess);
+#endif
+  return testSuite;
+}
@@ -31,7 +31,7 @@
 static int _testNewMidiSequence(void) {
   MidiSequence m = newMidiSequence();
   assertNotNull(m);
-  assertIntEquals(0, linkedListLength(m->midiEvents));
+  assertSizeEquals((size_t)0, m->numMidiEvents);
   freeMidiSequence(m);
   return 0;
 }
@@ -40,7 +40,7 @@ static int _testAppendMidiEventToSequence(void) {
   MidiSequence m = newMidiSequence();
   MidiEvent e = newMidiEvent();
   appendMidiEventToSequence(m, e);
-  assertIntEquals(1, linkedListLength(m->midiEvents));
+  assertSizeEquals((size_t)1, m->numMidiEvents);
   freeMidiSequence(m);
   return 0;
 }
@@ -48,7 +48,7 @@ static int _testAppendMidiEventToSequence(void) {
 static int _testAppendNullMidiEventToSequence(void) {
   MidiSequence m = newMidiSequence();
   appendMidiEventToSequence(m, NULL);
-  assertIntEquals(0, linkedListLength(m->midiEvents));
+  assertSizeEquals((size_t)0, m->numMidiEvents);
   freeMidiSequence(m);
   return 0;
 }
@@ -118,6 +118,133 @@ static int _testFillEventsSequentially(void) {
   return 0;
 }
 
+static int _testRewind(void) {
+  MidiSequence m = newMidiSequence();
+  MidiEvent e = newMidiEvent();
+  LinkedList l = newLinkedList();
+
+  e->status = 0xf7;
+  e->timestamp = 100;
+  appendMidiEventToSequence(m, e);
+  assertFalse(fillMidiEventsFromRange(m, 0, 256, l));
+  assertIntEquals(1, m->numMidiEventsProcessed);
+  freeLinkedList(l);
+  l = newLinkedList();
+  midiSequenceRewind(m);
+  assertIntEquals(0, m->numMidiEventsProcessed);
+  assertFalse(fillMidiEventsFromRange(m, 0, 256, l));
+  assertIntEquals(1, linkedListLength(l));
+
+  freeMidiSequence(m);
+  freeLinkedList(l);
+  return 0;
+}
+
+static int _testAppendManyEvents(void) {
+  MidiSequence m = newMidiSequence();
+  MidiEvent e;
+  LinkedList l = newLinkedList();
+  unsigned long i;
+
+  for (i = 0; i < 1000; i++) {
+    e = newMidiEvent();
+    e->timestamp = i;
+    appendMidiEventToSequence(m, e);
+  }
+
+  assertSizeEquals((size_t)1000, m->numMidiEvents);
+  assertFalse(fillMidiEventsFromRange(m, 0, 1000, l));
+  assertIntEquals(1000, linkedListLength(l));
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, ((MidiEvent)l->item)->timestamp);
+
+  freeMidiSequence(m);
+  freeLinkedList(l);
+  return 0;
+}
+
+static MidiEvent _newMidiEventWithTimestamp(unsigned long timestamp,
+                                            byte data1) {
+  MidiEvent e = newMidiEvent();
+  e->eventType = MIDI_TYPE_REGULAR;
+  e->status = 0x90;
+  e->data1 = data1;
+  e->timestamp = timestamp;
+  return e;
+}
+
+static int _testFillEventsFromMultipleTracks(void) {
+  MidiSequence m = newMidiSequence();
+  LinkedList l = newLinkedList();
+  LinkedListIterator iterator;
+  const byte expected[] = {1, 4, 2, 5, 7, 3, 6};
+  int i = 0;
+
+  // Three tracks, each of which is sorted by itself
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(10, 1));
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(20, 2));
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(30, 3));
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(10, 4));
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(25, 5));
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(40, 6));
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(25, 7));
+
+  assertFalse(fillMidiEventsFromRange(m, 0, 100, l));
+  assertIntEquals(7, linkedListLength(l));
+
+  // Events with equal timestamps must keep the order they were appended in
+  for (iterator = l; iterator != NULL; iterator = iterator->nextItem) {
+    assertIntEquals(expected[i], ((MidiEvent)iterator->item)->data1);
+    i++;
+  }
+
+  freeMidiSequence(m);
+  freeLinkedList(l);
+  return 0;
+}
+
+static int _testFillEventsAfterSkippingAhead(void) {
+  MidiSequence m = newMidiSequence();
+  LinkedList l = newLinkedList();
+
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(10, 1));
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(300, 2));
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(600, 3));
+  assertFalse(fillMidiEventsFromRange(m, 512, 256, l));
+  assertIntEquals(1, linkedListLength(l));
+  assertIntEquals(3, ((MidiEvent)l->item)->data1);
+  assertUnsignedLongEquals(88ul, ((MidiEvent)l->item)->deltaFrames);
+
+  freeMidiSequence(m);
+  freeLinkedList(l);
+  return 0;
+}
+
+static int _testAppendEventArray(void) {
+  MidiSequence m = newMidiSequence();
+  LinkedList l = newLinkedList();
+  MidiEventMembers events[2];
+  MidiEvent e;
+
+  e = _newMidiEventWithTimestamp(100, 1);
+  events[0] = *e;
+  free(e);
+  e = _newMidiEventWithTimestamp(20, 2);
+  events[1] = *e;
+  free(e);
+  appendMidiEventToSequence(m, _newMidiEventWithTimestamp(50, 3));
+  midiSequenceAppendEvents(m, events, 2);
+  assertSizeEquals((size_t)3, m->numMidiEvents);
+
+  // Events from the array must be sorted with those already in the sequence
+  assertFalse(fillMidiEventsFromRange(m, 0, 256, l));
+  assertIntEquals(3, linkedListLength(l));
+  assertIntEquals(2, ((MidiEvent)l->item)->data1);
+
+  freeMidiSequence(m);
+  freeLinkedList(l);
+  return 0;
+}
+
 static int _testFillEventsFromRangePastSequence(void) {
   MidiSequence m = newMidiSequence();
   MidiEvent e = newMidiEvent();
@@ -152,6 +279,13 @@ TestSuite addMidiSequenceTests(void) {
           _testFillMidiEventsFromRangeStart);
   addTest(testSuite, "FillEventsFromEmptyRange", _testFillEventsFromEmptyRange);
   addTest(testSuite, "FillEventsSequentially", _testFillEventsSequentially);
+  addTest(testSuite, "Rewind", _testRewind);
+  addTest(testSuite, "AppendManyEvents", _testAppendManyEvents);
+  addTest(testSuite, "FillEventsFromMultipleTracks",
+          _testFillEventsFromMultipleTracks);
+  addTest(testSuite, "AppendEventArray", _testAppendEventArray);
+  addTest(testSuite, "FillEventsAfterSkippingAhead",
+          _testFillEventsAfterSkippingAhead);
   addTest(testSuite, "FillEventsFromRangePastSequenceEnd",
           _testFillEventsFromRangePastSequence);
 
@@ -0,0 +1,179 @@
+//
+// MidiSourceFileTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/AudioSettings.h"
+#include "midi/MidiSourceFile.h"
+
+#include "unit/TestRunner.h"
+
+#include <stdio.h>
+
+#define TEST_MIDI_FILE_NAME "test_file.mid"
+
+// Header for a file with 96 ticks per beat, followed by the track chunks
+#define MIDI_FILE_HEADER(formatType, numTracks)                                \
+  'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, formatType, 0, numTracks, 0, 96
+
+#define MIDI_TRACK_HEADER(numBytes) 'M', 'T', 'r', 'k', 0, 0, 0, numBytes
+
+static void _midiSourceFileTestSetup(void) {
+  initAudioSettings();
+  setSampleRate(44100.0);
+  setTempo(120.0);
+}
+
+static void _midiSourceFileTestTeardown(void) {
+  remove(TEST_MIDI_FILE_NAME);
+  freeAudioSettings();
+}
+
+static MidiSequence _readTestFile(const byte *data, const size_t numBytes) {
+  CharString c = newCharStringWithCString(TEST_MIDI_FILE_NAME);
+  MidiSource m = newMidiSourceFile(c);
+  MidiSequence s = newMidiSequence();
+  FILE *fp = fopen(TEST_MIDI_FILE_NAME, "wb");
+
+  fwrite(data, 1, numBytes, fp);
+  fclose(fp);
+
+  if (!m->openMidiSource(m) || !m->readMidiEvents(m, s)) {
+    freeMidiSequence(s);
+    s = NULL;
+  }
+
+  freeMidiSource(m);
+  freeCharString(c);
+  return s;
+}
+
+static int _testReadType0File(void) {
+  const byte data[] = {MIDI_FILE_HEADER(0, 1), MIDI_TRACK_HEADER(12),
+                       0x60, 0x90, 0x3c, 0x40, 0x60, 0x80, 0x3c, 0x00,
+                       0x00, 0xff, 0x2f, 0x00};
+  MidiSequence s = _readTestFile(data, sizeof(data));
+
+  assertNotNull(s);
+  assertSizeEquals((size_t)3, s->numMidiEvents);
+  assertIntEquals(0x90, s->midiEvents[0].status);
+  assertUnsignedLongEquals(22050ul, s->midiEvents[0].timestamp);
+  assertIntEquals(0x80, s->midiEvents[1].status);
+  assertUnsignedLongEquals(44100ul, s->midiEvents[1].timestamp);
+  assertIntEquals(MIDI_META_TYPE_TRACK_END, s->midiEvents[2].status);
+
+  freeMidiSequence(s);
+  return 0;
+}
+
+static int _testReadType1File(void) {
+  const byte data[] = {
+      MIDI_FILE_HEADER(1, 3),
+      // Tempo track, changing to 60 BPM
+      MIDI_TRACK_HEADER(11), 0x00, 0xff, 0x51, 0x03, 0x0f, 0x42, 0x40, 0x00,
+      0xff, 0x2f, 0x00,
+      // Note on after one beat, track ends after two beats
+      MIDI_TRACK_HEADER(8), 0x60, 0x91, 0x3c, 0x40, 0x60, 0xff, 0x2f, 0x00,
+      // Two notes with running status, ending after one beat
+      MIDI_TRACK_HEADER(11), 0x30, 0x92, 0x3e, 0x40, 0x00, 0x40, 0x40, 0x30,
+      0xff, 0x2f, 0x00};
+  MidiSequence s = _readTestFile(data, sizeof(data));
+  LinkedList l = newLinkedList();
+  MidiEvent e;
+
+  assertNotNull(s);
+  // One tempo event, three notes, and a single track end
+  assertSizeEquals((size_t)5, s->numMidiEvents);
+  assertFalse(fillMidiEventsFromRange(s, 0, 100000, l));
+  assertIntEquals(5, linkedListLength(l));
+
+  e = (MidiEvent)l->item;
+  assertIntEquals(MIDI_META_TYPE_TEMPO, e->status);
+  e = (MidiEvent)((LinkedList)l->nextItem)->item;
+  assertIntEquals(0x92, e->status);
+  assertIntEquals(0x3e, e->data1);
+  assertUnsignedLongEquals(22050ul, e->timestamp);
+  e = (MidiEvent)((LinkedList)((LinkedList)l->nextItem)->nextItem)->item;
+  assertIntEquals(0x92, e->status);
+  assertIntEquals(0x40, e->data1);
+
+  assertIntEquals(0x91, s->midiEvents[3].status);
+  assertUnsignedLongEquals(44100ul, s->midiEvents[3].timestamp);
+  assertIntEquals(MIDI_META_TYPE_TRACK_END, s->midiEvents[4].status);
+  assertUnsignedLongEquals(88200ul, s->midiEvents[4].timestamp);
+
+  freeLinkedList(l);
+  freeMidiSequence(s);
+  return 0;
+}
+
+static int _testSkipUnknownChunks(void) {
+  const byte data[] = {MIDI_FILE_HEADER(0, 1),
+                       'X', 'F', 'I', 'H', 0, 0, 0, 2, 0x12, 0x34,
+                       MIDI_TRACK_HEADER(8),
+                       0x00, 0xc0, 0x05, 0x00, 0xff, 0x2f, 0x00, 0x00};
+  MidiSequence s = _readTestFile(data, sizeof(data));
+
+  assertNotNull(s);
+  assertSizeEquals((size_t)2, s->numMidiEvents);
+  assertIntEquals(0xc0, s->midiEvents[0].status);
+  assertIntEquals(0x05, s->midiEvents[0].data1);
+
+  freeMidiSequence(s);
+  return 0;
+}
+
+static int _testReadTruncatedTrack(void) {
+  const byte data[] = {MIDI_FILE_HEADER(0, 1), MIDI_TRACK_HEADER(3),
+                       0x00, 0x90, 0x3c};
+  assertIsNull(_readTestFile(data, sizeof(data)));
+  return 0;
+}
+
+static int _testReadTruncatedFile(void) {
+  const byte data[] = {MIDI_FILE_HEADER(1, 2), MIDI_TRACK_HEADER(4),
+                       0x00, 0xff, 0x2f, 0x00};
+  assertIsNull(_readTestFile(data, sizeof(data)));
+  return 0;
+}
+
+static int _testReadType2File(void) {
+  const byte data[] = {MIDI_FILE_HEADER(2, 1), MIDI_TRACK_HEADER(4),
+                       0x00, 0xff, 0x2f, 0x00};
+  assertIsNull(_readTestFile(data, sizeof(data)));
+  return 0;
+}
+
+TestSuite addMidiSourceFileTests(void);
+TestSuite addMidiSourceFileTests(void) {
+  TestSuite testSuite = newTestSuite("MidiSourceFile", _midiSourceFileTestSetup,
+                                     _midiSourceFileTestTeardown);
+  addTest(testSuite, "ReadType0File", _testReadType0File);
+  addTest(testSuite, "ReadType1File", _testReadType1File);
+  addTest(testSuite, "SkipUnknownChunks", _testSkipUnknownChunks);
+  addTest(testSuite, "ReadTruncatedTrack", _testReadTruncatedTrack);
+  addTest(testSuite, "ReadTruncatedFile", _testReadTruncatedFile);
+  addTest(testSuite, "ReadType2File", _testReadType2File);
+  return testSuite;
+}
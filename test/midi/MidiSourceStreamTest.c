@@ -0,0 +1,209 @@
+//
+// MidiSourceStreamTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/AudioSettings.h"
+#include "midi/MidiSourceStream.h"
+
+#include "unit/TestRunner.h"
+
+#include <stdio.h>
+
+#define TEST_STREAM_FILENAME "test_stream.mid"
+
+static void _midiSourceStreamTestSetup(void) {
+  initAudioSettings();
+  setSampleRate(44100.0);
+  setTempo(120.0);
+}
+
+static void _midiSourceStreamTestTeardown(void) {
+  remove(TEST_STREAM_FILENAME);
+  freeAudioSettings();
+}
+
+static MidiSource _newTestStream(const byte *data, const size_t numBytes) {
+  CharString c = newCharStringWithCString(TEST_STREAM_FILENAME);
+  FILE *fp = fopen(TEST_STREAM_FILENAME, "wb");
+  MidiSource m;
+
+  fwrite(data, 1, numBytes, fp);
+  fclose(fp);
+
+  m = newMidiSourceStream(c);
+  freeCharString(c);
+
+  if (!m->openMidiSource(m)) {
+    freeMidiSource(m);
+    return NULL;
+  }
+
+  return m;
+}
+
+static int _testNewMidiSourceStream(void) {
+  CharString c = newCharStringWithCString("-");
+  MidiSource m = newMidiSourceStream(c);
+  assertNotNull(m);
+  assertIntEquals(MIDI_SOURCE_TYPE_STREAM, m->midiSourceType);
+  assert(m->isStream);
+  assertFalse(m->endOfStream);
+  freeMidiSource(m);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testReadMidiFileStream(void) {
+  // Type 0 file with 96 ticks per beat, containing a note on after one beat
+  // and the note off one beat later
+  const byte data[] = {'M',  'T',  'h',  'd',  0,    0,    0,    6,
+                       0,    0,    0,    1,    0,    96,   'M',  'T',
+                       'r',  'k',  0,    0,    0,    0,    0x60, 0x90,
+                       0x3c, 0x40, 0x60, 0x80, 0x3c, 0x00, 0x00, 0xff,
+                       0x2f, 0x00};
+  MidiSource m = _newTestStream(data, sizeof(data));
+  MidiSequence s = newMidiSequence();
+
+  assertNotNull(m);
+  assert(m->readMidiEvents(m, s));
+  assert(m->endOfStream);
+  assertSizeEquals((size_t)3, s->numMidiEvents);
+  assertIntEquals(0x90, s->midiEvents[0].status);
+  assertUnsignedLongEquals(22050ul, s->midiEvents[0].timestamp);
+  assertIntEquals(0x80, s->midiEvents[1].status);
+  assertUnsignedLongEquals(44100ul, s->midiEvents[1].timestamp);
+  assertIntEquals(MIDI_TYPE_META, s->midiEvents[2].eventType);
+  assertIntEquals(MIDI_META_TYPE_TRACK_END, s->midiEvents[2].status);
+
+  freeMidiSequence(s);
+  freeMidiSource(m);
+  return 0;
+}
+
+static int _testReadRawStreamWithRunningStatus(void) {
+  // Raw events with delta times in frames, the second note on uses running
+  // status and the program change has only one data byte
+  const byte data[] = {0x00, 0x90, 0x3c, 0x40, 0x81, 0x00, 0x3e,
+                       0x40, 0x10, 0xc0, 0x05};
+  MidiSource m = _newTestStream(data, sizeof(data));
+  MidiSequence s = newMidiSequence();
+
+  assertNotNull(m);
+  assert(m->readMidiEvents(m, s));
+  assert(m->endOfStream);
+  assertSizeEquals((size_t)3, s->numMidiEvents);
+  assertUnsignedLongEquals(0ul, s->midiEvents[0].timestamp);
+  assertIntEquals(0x90, s->midiEvents[1].status);
+  assertIntEquals(0x3e, s->midiEvents[1].data1);
+  assertUnsignedLongEquals(128ul, s->midiEvents[1].timestamp);
+  assertIntEquals(0xc0, s->midiEvents[2].status);
+  assertIntEquals(0x05, s->midiEvents[2].data1);
+  assertUnsignedLongEquals(144ul, s->midiEvents[2].timestamp);
+
+  freeMidiSequence(s);
+  freeMidiSource(m);
+  return 0;
+}
+
+static int _testReadMidiEventsUntil(void) {
+  const byte data[] = {0x00, 0x90, 0x3c, 0x40, 0x81, 0x00, 0x3e,
+                       0x40, 0x82, 0x00, 0x40, 0x40};
+  MidiSource m = _newTestStream(data, sizeof(data));
+  MidiSequence s = newMidiSequence();
+
+  assertNotNull(m);
+  // The first event past the stop time is read, but nothing after it
+  assert(m->readMidiEventsUntil(m, s, 64));
+  assertFalse(m->endOfStream);
+  assertSizeEquals((size_t)2, s->numMidiEvents);
+
+  assert(m->readMidiEventsUntil(m, s, 512));
+  assert(m->endOfStream);
+  assertSizeEquals((size_t)3, s->numMidiEvents);
+  assertUnsignedLongEquals(384ul, s->midiEvents[2].timestamp);
+
+  freeMidiSequence(s);
+  freeMidiSource(m);
+  return 0;
+}
+
+static int _testReadTruncatedStream(void) {
+  const byte data[] = {0x00, 0x90, 0x3c};
+  MidiSource m = _newTestStream(data, sizeof(data));
+  MidiSequence s = newMidiSequence();
+
+  assertNotNull(m);
+  assertFalse(m->readMidiEvents(m, s));
+  assert(m->endOfStream);
+  assertSizeEquals((size_t)0, s->numMidiEvents);
+
+  freeMidiSequence(s);
+  freeMidiSource(m);
+  return 0;
+}
+
+static int _testRemoveProcessedEventsFromStream(void) {
+  const byte data[] = {0x00, 0x90, 0x3c, 0x40, 0x81, 0x00, 0x3e,
+                       0x40, 0x82, 0x00, 0x40, 0x40};
+  MidiSource m = _newTestStream(data, sizeof(data));
+  MidiSequence s = newMidiSequence();
+  LinkedList l = newLinkedList();
+
+  assertNotNull(m);
+  assert(m->readMidiEventsUntil(m, s, 64));
+  assert(fillMidiEventsFromRange(s, 0, 64, l));
+  assertIntEquals(1, linkedListLength(l));
+  freeLinkedList(l);
+
+  midiSequenceRemoveProcessedEvents(s);
+  assertSizeEquals((size_t)1, s->numMidiEvents);
+  assertIntEquals(0x3e, s->midiEvents[0].data1);
+
+  assert(m->readMidiEventsUntil(m, s, 192));
+  l = newLinkedList();
+  assertFalse(fillMidiEventsFromRange(s, 64, 512, l));
+  assertIntEquals(2, linkedListLength(l));
+
+  freeLinkedList(l);
+  freeMidiSequence(s);
+  freeMidiSource(m);
+  return 0;
+}
+
+TestSuite addMidiSourceStreamTests(void);
+TestSuite addMidiSourceStreamTests(void) {
+  TestSuite testSuite =
+      newTestSuite("MidiSourceStream", _midiSourceStreamTestSetup,
+                   _midiSourceStreamTestTeardown);
+  addTest(testSuite, "NewObject", _testNewMidiSourceStream);
+  addTest(testSuite, "ReadMidiFileStream", _testReadMidiFileStream);
+  addTest(testSuite, "ReadRawStreamWithRunningStatus",
+          _testReadRawStreamWithRunningStatus);
+  addTest(testSuite, "ReadMidiEventsUntil", _testReadMidiEventsUntil);
+  addTest(testSuite, "ReadTruncatedStream", _testReadTruncatedStream);
+  addTest(testSuite, "RemoveProcessedEventsFromStream",
+          _testRemoveProcessedEventsFromStream);
+  return testSuite;
+}
@@ -44,6 +44,13 @@ static int _testGuessMidiSourceTypeInvalid(void) {
   return 0;
 }
 
+static int _testGuessMidiSourceTypeStdin(void) {
+  CharString c = newCharStringWithCString("-");
+  assertIntEquals(MIDI_SOURCE_TYPE_STREAM, guessMidiSourceType(c));
+  freeCharString(c);
+  return 0;
+}
+
 static int _testNewMidiSource(void) {
   CharString c = newCharStringWithCString(TEST_MIDI_FILENAME);
   MidiSource m = newMidiSource(MIDI_SOURCE_TYPE_FILE, c);
@@ -60,6 +67,7 @@ TestSuite addMidiSourceTests(void) {
   addTest(testSuite, "GuessMidiSourceType", _testGuessMidiSourceType);
   addTest(testSuite, "GuessMidiSourceTypeInvalid",
           _testGuessMidiSourceTypeInvalid);
+  addTest(testSuite, "GuessMidiSourceTypeStdin", _testGuessMidiSourceTypeStdin);
   addTest(testSuite, "NewObject", _testNewMidiSource);
   return testSuite;
 }
@@ -0,0 +1,241 @@
+//
+// PluginAutomationTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "plugin/PluginAutomation.h"
+
+#include "unit/TestRunner.h"
+
+#include "PluginMock.h"
+
+#include <limits.h>
+#include <stdio.h>
+
+#define TEST_AUTOMATION_FILE_NAME "test_automation.txt"
+
+static void _pluginAutomationTestTeardown(void) {
+  remove(TEST_AUTOMATION_FILE_NAME);
+}
+
+static PluginAutomation _readTestFile(const void *data, const size_t size) {
+  CharString c = newCharStringWithCString(TEST_AUTOMATION_FILE_NAME);
+  PluginAutomation a = newPluginAutomation();
+  FILE *fp = fopen(TEST_AUTOMATION_FILE_NAME, "wb");
+
+  fwrite(data, 1, size, fp);
+  fclose(fp);
+
+  if (!pluginAutomationReadFile(a, c)) {
+    freePluginAutomation(a);
+    a = NULL;
+  }
+
+  freeCharString(c);
+  return a;
+}
+
+static int _testNewPluginAutomation(void) {
+  PluginAutomation a = newPluginAutomation();
+  assertSizeEquals((size_t)0, a->numLanes);
+  assertUnsignedLongEquals((unsigned long)DEFAULT_AUTOMATION_CONTROL_RATE,
+                           a->controlRate);
+  assertUnsignedLongEquals(ULONG_MAX, pluginAutomationGetNextChangeFrame(a, 0));
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testAddPointsOutOfOrder(void) {
+  PluginAutomation a = newPluginAutomation();
+  pluginAutomationAddPoint(a, 0, 1, 200, 0.2f, AUTOMATION_INTERPOLATION_STEP);
+  pluginAutomationAddPoint(a, 0, 1, 100, 0.1f, AUTOMATION_INTERPOLATION_STEP);
+  pluginAutomationAddPoint(a, 1, 1, 50, 0.3f, AUTOMATION_INTERPOLATION_STEP);
+  assertSizeEquals((size_t)2, a->numLanes);
+  assertSizeEquals((size_t)2, a->lanes[0].numPoints);
+  assertUnsignedLongEquals(100ul, a->lanes[0].points[0].frame);
+  assertUnsignedLongEquals(200ul, a->lanes[0].points[1].frame);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testApplyStep(void) {
+  PluginAutomation a = newPluginAutomation();
+  Plugin mock = newPluginMock();
+  PluginMockData mockData = (PluginMockData)mock->extraData;
+
+  pluginAutomationAddPoint(a, 0, 0, 100, 0.5f, AUTOMATION_INTERPOLATION_STEP);
+  pluginAutomationApply(a, 0, &mock, 1);
+  assertIntEquals(0, mockData->numParameterChanges);
+  assertUnsignedLongEquals(100ul, pluginAutomationGetNextChangeFrame(a, 0));
+
+  pluginAutomationApply(a, 100, &mock, 1);
+  assertIntEquals(1, mockData->numParameterChanges);
+  assertDoubleEquals(0.5, mockData->lastParameterValue, 0.0001);
+  assertUnsignedLongEquals(ULONG_MAX,
+                           pluginAutomationGetNextChangeFrame(a, 100));
+
+  // Unchanged values are not sent again
+  pluginAutomationApply(a, 200, &mock, 1);
+  assertIntEquals(1, mockData->numParameterChanges);
+
+  freePluginAutomation(a);
+  freePlugin(mock);
+  return 0;
+}
+
+static int _testApplyLinear(void) {
+  PluginAutomation a = newPluginAutomation();
+  Plugin mock = newPluginMock();
+  PluginMockData mockData = (PluginMockData)mock->extraData;
+
+  a->controlRate = 64;
+  pluginAutomationAddPoint(a, 0, 0, 0, 0.0f, AUTOMATION_INTERPOLATION_STEP);
+  pluginAutomationAddPoint(a, 0, 0, 256, 1.0f,
+                           AUTOMATION_INTERPOLATION_LINEAR);
+
+  pluginAutomationApply(a, 0, &mock, 1);
+  assertDoubleEquals(0.0, mockData->lastParameterValue, 0.0001);
+  assertUnsignedLongEquals(64ul, pluginAutomationGetNextChangeFrame(a, 0));
+  pluginAutomationApply(a, 64, &mock, 1);
+  assertDoubleEquals(0.25, mockData->lastParameterValue, 0.0001);
+  pluginAutomationApply(a, 200, &mock, 1);
+  assertUnsignedLongEquals(256ul, pluginAutomationGetNextChangeFrame(a, 200));
+  pluginAutomationApply(a, 256, &mock, 1);
+  assertDoubleEquals(1.0, mockData->lastParameterValue, 0.0001);
+  assertIntEquals(4, mockData->numParameterChanges);
+
+  freePluginAutomation(a);
+  freePlugin(mock);
+  return 0;
+}
+
+static int _testRewind(void) {
+  PluginAutomation a = newPluginAutomation();
+  Plugin mock = newPluginMock();
+  PluginMockData mockData = (PluginMockData)mock->extraData;
+
+  pluginAutomationAddPoint(a, 0, 0, 0, 0.5f, AUTOMATION_INTERPOLATION_STEP);
+  pluginAutomationApply(a, 0, &mock, 1);
+  pluginAutomationRewind(a);
+  pluginAutomationApply(a, 0, &mock, 1);
+  assertIntEquals(2, mockData->numParameterChanges);
+
+  freePluginAutomation(a);
+  freePlugin(mock);
+  return 0;
+}
+
+static int _testReadTextFile(void) {
+  const char text[] = "# frame,plugin,parameter,value\n"
+                      "\n"
+                      "0,0,2,0.5\n"
+                      "1000,0,2,1.0,linear\r\n"
+                      "500,1,0,0.25,step\n";
+  PluginAutomation a = _readTestFile(text, sizeof(text) - 1);
+
+  assertNotNull(a);
+  assertSizeEquals((size_t)2, a->numLanes);
+  assertIntEquals(2, a->lanes[0].parameterIndex);
+  assertSizeEquals((size_t)2, a->lanes[0].numPoints);
+  assertIntEquals(AUTOMATION_INTERPOLATION_LINEAR,
+                  a->lanes[0].points[1].interpolation);
+  assertUnsignedLongEquals(500ul, a->lanes[1].points[0].frame);
+  assertDoubleEquals(0.25, a->lanes[1].points[0].value, 0.0001);
+
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testReadInvalidTextFile(void) {
+  const char text[] = "0,0,2,0.5\nnot automation\n";
+  assertIsNull(_readTestFile(text, sizeof(text) - 1));
+  return 0;
+}
+
+static int _testReadTextFileWithInvalidInterpolation(void) {
+  const char text[] = "0,0,2,0.5,cubic\n";
+  assertIsNull(_readTestFile(text, sizeof(text) - 1));
+  return 0;
+}
+
+static int _testReadBinaryFile(void) {
+  // Frame 44100, plugin 1, parameter 3, value 0.5, linear
+  const byte data[] = {'M', 'W', 'A',  'U',  0x00, 0x00, 0xac, 0x44,
+                       0x00, 0x01, 0x00, 0x03, 0x3f, 0x00, 0x00, 0x00,
+                       0x01, 0x00, 0x00, 0x00};
+  PluginAutomation a = _readTestFile(data, sizeof(data));
+
+  assertNotNull(a);
+  assertSizeEquals((size_t)1, a->numLanes);
+  assertIntEquals(1, a->lanes[0].pluginIndex);
+  assertIntEquals(3, a->lanes[0].parameterIndex);
+  assertUnsignedLongEquals(44100ul, a->lanes[0].points[0].frame);
+  assertDoubleEquals(0.5, a->lanes[0].points[0].value, 0.0001);
+  assertIntEquals(AUTOMATION_INTERPOLATION_LINEAR,
+                  a->lanes[0].points[0].interpolation);
+
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testReadTruncatedBinaryFile(void) {
+  const byte data[] = {'M', 'W', 'A', 'U', 0x00, 0x00, 0xac, 0x44};
+  assertIsNull(_readTestFile(data, sizeof(data)));
+  return 0;
+}
+
+static int _testReadMissingFile(void) {
+  CharString c = newCharStringWithCString("invalid");
+  PluginAutomation a = newPluginAutomation();
+  assertFalse(pluginAutomationReadFile(a, c));
+  freePluginAutomation(a);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testFreeNullPluginAutomation(void) {
+  freePluginAutomation(NULL);
+  return 0;
+}
+
+TestSuite addPluginAutomationTests(void);
+TestSuite addPluginAutomationTests(void) {
+  TestSuite testSuite = newTestSuite("PluginAutomation", NULL,
+                                     _pluginAutomationTestTeardown);
+  addTest(testSuite, "Initialization", _testNewPluginAutomation);
+  addTest(testSuite, "AddPointsOutOfOrder", _testAddPointsOutOfOrder);
+  addTest(testSuite, "ApplyStep", _testApplyStep);
+  addTest(testSuite, "ApplyLinear", _testApplyLinear);
+  addTest(testSuite, "Rewind", _testRewind);
+  addTest(testSuite, "ReadTextFile", _testReadTextFile);
+  addTest(testSuite, "ReadInvalidTextFile", _testReadInvalidTextFile);
+  addTest(testSuite, "ReadTextFileWithInvalidInterpolation",
+          _testReadTextFileWithInvalidInterpolation);
+  addTest(testSuite, "ReadBinaryFile", _testReadBinaryFile);
+  addTest(testSuite, "ReadTruncatedBinaryFile", _testReadTruncatedBinaryFile);
+  addTest(testSuite, "ReadMissingFile", _testReadMissingFile);
+  addTest(testSuite, "FreeNullPluginAutomation",
+          _testFreeNullPluginAutomation);
+  return testSuite;
+}
@@ -28,13 +28,23 @@
 
 #include "audio/AudioSettings.h"
 #include "midi/MidiEvent.h"
+#include "plugin/PluginGain.h"
 #include "plugin/PluginPassthru.h"
+#include "time/AudioClock.h"
 #include "unit/TestRunner.h"
 
 #include "PluginMock.h"
 #include "PluginPresetMock.h"
 
-static void _pluginChainTestSetup(void) { initPluginChain(); }
+static void _pluginChainTestSetup(void) {
+  AudioClock audioClock = getAudioClock();
+
+  // The test runner creates one clock for the whole suite, so every test
+  // starts again from the beginning of the timeline
+  audioClock->currentFrame = 0;
+  audioClockUpdateTransport(audioClock);
+  initPluginChain();
+}
 
 static void _pluginChainTestTeardown(void) {
   freePluginChain(getPluginChain());
@@ -199,6 +209,33 @@ static int _testInitializePluginChain(void) {
   return 0;
 }
 
+static int _testLoadPreset(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  PluginPreset firstPreset = newPluginPresetMock();
+  PluginPreset secondPreset = newPluginPresetMock();
+
+  assert(pluginChainAppend(p, mock, firstPreset));
+  assertIntEquals(RETURN_CODE_SUCCESS, pluginChainInitialize(p));
+  assert(pluginChainLoadPreset(p, 0, secondPreset));
+  assert(((PluginPresetMockData)secondPreset->extraData)->isLoaded);
+  assert(p->presets[0] == secondPreset);
+
+  return 0;
+}
+
+static int _testLoadPresetInvalidIndex(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+
+  assert(pluginChainAppend(p, mock, NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS, pluginChainInitialize(p));
+  assertFalse(pluginChainLoadPreset(p, 1, newPluginPresetMock()));
+  assertIsNull(p->presets[0]);
+
+  return 0;
+}
+
 static int _testGetMaximumTailTime(void) {
   Plugin mock = newPluginMock();
   PluginChain p = getPluginChain();
@@ -223,6 +260,21 @@ static int _testPrepareForProcessing(void) {
   return 0;
 }
 
+static int _testSuspend(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+
+  assert(pluginChainAppend(p, mock, NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS, pluginChainInitialize(p));
+  pluginChainPrepareForProcessing(p);
+  pluginChainSuspend(p);
+  assertFalse(((PluginMockData)mock->extraData)->isPrepared);
+  pluginChainPrepareForProcessing(p);
+  assert(((PluginMockData)mock->extraData)->isPrepared);
+
+  return 0;
+}
+
 static int _testProcessPluginChainAudio(void) {
   Plugin mock = newPluginMock();
   PluginChain p = getPluginChain();
@@ -285,6 +337,633 @@ static int _testProcessPluginChainMidiEvents(void) {
   return 0;
 }
 
+static int _testProcessAudioWithAutomation(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  PluginMockData mockData = (PluginMockData)mock->extraData;
+  PluginAutomation a = newPluginAutomation();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+
+  pluginAutomationAddPoint(a, 0, 0, 100, 0.5f, AUTOMATION_INTERPOLATION_STEP);
+  assert(pluginChainAppend(p, mock, NULL));
+  assert(pluginChainSetAutomation(p, a));
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+
+  assertIntEquals(2, mockData->numProcessAudioCalls);
+  assertIntEquals(DEFAULT_BLOCKSIZE - 100, mockData->lastBlocksize);
+  assertIntEquals(1, mockData->numParameterChanges);
+  assertDoubleEquals(0.5, mockData->lastParameterValue, 0.0001);
+  assertIntEquals(DEFAULT_BLOCKSIZE, outBuffer->blocksize);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testProcessMidiWithAutomation(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  PluginMockData mockData = (PluginMockData)mock->extraData;
+  PluginAutomation a = newPluginAutomation();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  LinkedList list = newLinkedList();
+  MidiEvent midi = newMidiEvent();
+
+  midi->deltaFrames = 200;
+  linkedListAppend(list, midi);
+  pluginAutomationAddPoint(a, 0, 0, 100, 0.5f, AUTOMATION_INTERPOLATION_STEP);
+  assert(pluginChainAppend(p, mock, NULL));
+  assert(pluginChainSetAutomation(p, a));
+
+  // Events are held until the block is split, and then sent with offsets
+  // relative to the part of the block which they fall in
+  pluginChainProcessMidi(p, list);
+  assertFalse(mockData->processMidiCalled);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assert(mockData->processMidiCalled);
+  assertUnsignedLongEquals(100ul, mockData->lastMidiDeltaFrames);
+  assertUnsignedLongEquals(200ul, midi->deltaFrames);
+
+  freeMidiEvent(midi);
+  freeLinkedList(list);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testAutomatedBlockIsTimedAsWhole(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  PluginMockData mockData = (PluginMockData)mock->extraData;
+  PluginAutomation a = newPluginAutomation();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+
+  advanceAudioClock(getAudioClock(), DEFAULT_BLOCKSIZE);
+  pluginAutomationAddPoint(a, 0, 0, DEFAULT_BLOCKSIZE + 100, 0.5f,
+                           AUTOMATION_INTERPOLATION_STEP);
+  assert(pluginChainAppend(p, mock, NULL));
+  assert(pluginChainSetAutomation(p, a));
+  taskTimerEnableHistogram(p->audioTimers[0], 0.0);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+
+  // The second part of the block sees the clock at its own position, but the
+  // clock is back at the start of the block afterwards
+  assertIntEquals(2, mockData->numProcessAudioCalls);
+  assertUnsignedLongEquals((unsigned long)DEFAULT_BLOCKSIZE + 100ul,
+                           mockData->lastClockFrame);
+  assertUnsignedLongEquals((unsigned long)DEFAULT_BLOCKSIZE,
+                           getAudioClock()->currentFrame);
+  assertUnsignedLongEquals(1ul, p->audioTimers[0]->histogram->numSamples);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testSetAutomationForMissingPlugin(void) {
+  PluginChain p = getPluginChain();
+  PluginAutomation a = newPluginAutomation();
+
+  pluginAutomationAddPoint(a, 1, 0, 0, 0.5f, AUTOMATION_INTERPOLATION_STEP);
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  assertFalse(pluginChainSetAutomation(p, a));
+
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testProcessWithFirstPlugin(void) {
+  Plugin mock1 = newPluginMock();
+  Plugin mock2 = newPluginMock();
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  LinkedList list = newLinkedList();
+  MidiEvent midi = newMidiEvent();
+
+  linkedListAppend(list, midi);
+  assert(pluginChainAppend(p, mock1, NULL));
+  assert(pluginChainAppend(p, mock2, NULL));
+  pluginChainSetFirstPlugin(p, 1);
+  pluginChainProcessMidi(p, list);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertFalse(((PluginMockData)mock1->extraData)->processAudioCalled);
+  assertFalse(((PluginMockData)mock1->extraData)->processMidiCalled);
+  assert(((PluginMockData)mock2->extraData)->processAudioCalled);
+
+  freeMidiEvent(midi);
+  freeLinkedList(list);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static void _countStageOutput(void *userData, const unsigned int index,
+                              const SampleBuffer output) {
+  unsigned int *numCalls = (unsigned int *)userData;
+  numCalls[index]++;
+}
+
+static int _testProcessWithStageOutputCallback(void) {
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  unsigned int numCalls[2] = {0, 0};
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  pluginChainSetStageOutputCallback(p, _countStageOutput, numCalls);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertIntEquals(1, numCalls[0]);
+  assertIntEquals(1, numCalls[1]);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+// Process silent blocks until the chain starts to skip them, and return the
+// number of blocks which were processed
+static unsigned int _processUntilSkipped(PluginChain p, SampleBuffer inBuffer,
+                                         SampleBuffer outBuffer) {
+  unsigned int numBlocks = 0;
+
+  sampleBufferClear(inBuffer);
+
+  while (p->numSkippedBlocks == 0 && numBlocks < 1000) {
+    pluginChainProcessAudio(p, inBuffer, outBuffer);
+    numBlocks++;
+  }
+
+  return numBlocks - 1;
+}
+
+static int _testProcessWithSkipSilence(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  const unsigned long tailTimeInFrames =
+      (unsigned long)(kPluginMockTailTime * getSampleRate() / 1000.0);
+  unsigned int numProcessedBlocks;
+
+  assert(pluginChainAppend(p, mock, NULL));
+  pluginChainSetSkipSilence(p, true);
+  numProcessedBlocks = _processUntilSkipped(p, inBuffer, outBuffer);
+
+  // The tail time must pass before any block is skipped
+  assertUnsignedLongEquals(
+      (tailTimeInFrames + DEFAULT_BLOCKSIZE - 1) / DEFAULT_BLOCKSIZE,
+      numProcessedBlocks);
+  assertIntEquals(numProcessedBlocks,
+                  ((PluginMockData)mock->extraData)->numProcessAudioCalls);
+  assertUnsignedLongEquals(DEFAULT_BLOCKSIZE, outBuffer->blocksize);
+  assert(sampleBufferIsSilent(outBuffer));
+
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertUnsignedLongEquals(2ul, p->numSkippedBlocks);
+  assertIntEquals(numProcessedBlocks,
+                  ((PluginMockData)mock->extraData)->numProcessAudioCalls);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testProcessWithSkipSilenceResumesWithInput(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  unsigned int numProcessedBlocks;
+
+  assert(pluginChainAppend(p, mock, NULL));
+  pluginChainSetSkipSilence(p, true);
+  numProcessedBlocks = _processUntilSkipped(p, inBuffer, outBuffer);
+
+  inBuffer->samples[0][0] = 0.5f;
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertIntEquals(numProcessedBlocks + 1,
+                  ((PluginMockData)mock->extraData)->numProcessAudioCalls);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testProcessWithSkipSilenceResumesWithMidi(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  LinkedList list = newLinkedList();
+  MidiEvent midi = newMidiEvent();
+  unsigned int numProcessedBlocks;
+
+  assert(pluginChainAppend(p, mock, NULL));
+  pluginChainSetSkipSilence(p, true);
+  numProcessedBlocks = _processUntilSkipped(p, inBuffer, outBuffer);
+
+  linkedListAppend(list, midi);
+  pluginChainProcessMidi(p, list);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertIntEquals(numProcessedBlocks + 1,
+                  ((PluginMockData)mock->extraData)->numProcessAudioCalls);
+
+  freeMidiEvent(midi);
+  freeLinkedList(list);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testProcessWithChannelMap(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  ChannelMap channelMap = newChannelMap(DEFAULT_NUM_CHANNELS, 2);
+
+  assert(pluginChainAppend(p, mock, NULL));
+  assertIntEquals(2, mock->inputBuffer->numChannels);
+  // Swap the channels, and mix the right channel into both at half volume
+  channelMapSetGain(channelMap, 1, 0, 0.5f);
+  channelMapSetGain(channelMap, 0, 1, 1.0f);
+  channelMapSetGain(channelMap, 1, 1, 0.5f);
+  assert(pluginChainSetChannelMap(p, 0, channelMap));
+
+  sampleBufferClear(inBuffer);
+  inBuffer->samples[0][0] = 1.0f;
+  inBuffer->samples[1][0] = 2.0f;
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertDoubleEquals(1.0, mock->inputBuffer->samples[0][0],
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(2.0, mock->inputBuffer->samples[1][0],
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testSetChannelMapInvalid(void) {
+  PluginChain p = getPluginChain();
+  ChannelMap channelMap = newChannelMap(DEFAULT_NUM_CHANNELS, 3);
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  assertFalse(pluginChainSetChannelMap(p, 2, channelMap));
+  assertFalse(pluginChainSetChannelMap(p, 0, channelMap));
+  // The output of the chain has the same number of channels as the input
+  assertFalse(pluginChainSetChannelMap(p, 1, channelMap));
+  assert(pluginChainSetChannelMap(p, 0, NULL));
+
+  freeChannelMap(channelMap);
+  return 0;
+}
+
+static Plugin _newPluginGainWithGain(const float gain) {
+  CharString pluginName = newCharStringWithCString(kInternalPluginGainName);
+  Plugin result = newPluginGain(pluginName);
+  result->setParameter(result, PLUGIN_GAIN_SETTINGS_GAIN, gain);
+  freeCharString(pluginName);
+  return result;
+}
+
+// Attenuate a signal so far that it cannot be represented with single
+// precision samples, and then bring it back again
+static Sample _processWithExtremeGains(const boolByte doublePrecision,
+                                       const boolByte withPassthruInBetween) {
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  CharString passthruName =
+      newCharStringWithCString(kInternalPluginPassthruName);
+  Sample result;
+
+  pluginChainAppend(p, _newPluginGainWithGain(1e-30f), NULL);
+
+  if (withPassthruInBetween) {
+    pluginChainAddFromArgumentString(p, passthruName, NULL);
+  }
+
+  pluginChainAppend(p, _newPluginGainWithGain(1e30f), NULL);
+  pluginChainSetDoublePrecision(p, doublePrecision);
+  pluginChainPrepareForProcessing(p);
+
+  sampleBufferClear(inBuffer);
+  inBuffer->samples[0][0] = 1e-20f;
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  result = outBuffer->samples[0][0];
+
+  freeCharString(passthruName);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return result;
+}
+
+static int _testProcessWithDoublePrecision(void) {
+  assert(_processWithExtremeGains(true, false) > 0.0f);
+  return 0;
+}
+
+static int _testProcessWithoutDoublePrecision(void) {
+  assert(_processWithExtremeGains(false, false) == 0.0f);
+  return 0;
+}
+
+static int _testProcessWithDoublePrecisionAndSinglePrecisionPlugin(void) {
+  // The passthru plugin only processes single precision audio, so the signal
+  // is lost
+  assert(_processWithExtremeGains(true, true) == 0.0f);
+  return 0;
+}
+
+static int _testSetDoublePrecision(void) {
+  PluginChain p = getPluginChain();
+  Plugin gain = _newPluginGainWithGain(1.0f);
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  assert(pluginChainAppend(p, gain, NULL));
+  assertIntEquals(1, pluginChainSetDoublePrecision(p, true));
+  assert(pluginIsDoublePrecision(gain));
+  assertIntEquals(0, pluginChainSetDoublePrecision(p, false));
+  assertFalse(pluginIsDoublePrecision(gain));
+  return 0;
+}
+
+static int _testProcessOffline(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  CharString name = newCharStringWithCString("test");
+  SampleBuffer input = newSampleBuffer(DEFAULT_NUM_CHANNELS, 4);
+  OfflineSession session;
+  SampleCount i;
+
+  for (i = 0; i < input->blocksize; i++) {
+    input->samples[0][i] = (Sample)i;
+  }
+
+  assert(pluginChainAppend(p, mock, NULL));
+  session = newOfflineSession(name, input, mock->outputBuffer->numChannels);
+  assert(pluginChainCanProcessOffline(p));
+  assert(pluginChainProcessOffline(p, session));
+  assertIntEquals(1, ((PluginMockData)mock->extraData)->numProcessOfflineCalls);
+  assertUnsignedLongEquals(4ul, session->output->blocksize);
+  assertDoubleEquals(6.0, session->output->samples[0][0],
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, session->output->samples[0][3],
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeOfflineSession(session);
+  freeSampleBuffer(input);
+  freeCharString(name);
+  return 0;
+}
+
+static int _testCannotProcessOffline(void) {
+  PluginChain p = getPluginChain();
+
+  // Only a single plugin may process offline
+  assertFalse(pluginChainCanProcessOffline(p));
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  assert(pluginChainCanProcessOffline(p));
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  assertFalse(pluginChainCanProcessOffline(p));
+  return 0;
+}
+
+static int _testCannotProcessOfflineInRealtime(void) {
+  PluginChain p = getPluginChain();
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  pluginChainSetRealtime(p, true);
+  assertFalse(pluginChainCanProcessOffline(p));
+  return 0;
+}
+
+static int _testCannotProcessOfflineWithoutSupport(void) {
+  PluginChain p = getPluginChain();
+  Plugin gain = _newPluginGainWithGain(1.0f);
+
+  assert(pluginChainAppend(p, gain, NULL));
+  assertFalse(pluginChainCanProcessOffline(p));
+  return 0;
+}
+
+static PluginGraph _newGraph(const char *graphString) {
+  CharString c = newCharStringWithCString(graphString);
+  PluginGraph result = newPluginGraph(c, NULL);
+  freeCharString(c);
+  return result;
+}
+
+static int _testAddGraphFromArgumentString(void) {
+  PluginChain p = getPluginChain();
+  CharString c = newCharStringWithCString("mrs_passthru;[|mrs_gain]");
+
+  assert(pluginChainAddFromArgumentString(p, c, NULL));
+  assertIntEquals(2, p->numPlugins);
+  assertNotNull(p->graph);
+  assertIntEquals(2, p->graph->numPlugins);
+
+  freeCharString(c);
+  return 0;
+}
+
+static int _testAddMalformedGraphFromArgumentString(void) {
+  PluginChain p = getPluginChain();
+  CharString c = newCharStringWithCString("mrs_passthru;[|mrs_gain");
+
+  assertFalse(pluginChainAddFromArgumentString(p, c, NULL));
+  assertIntEquals(0, p->numPlugins);
+  assertIsNull(p->graph);
+
+  freeCharString(c);
+  return 0;
+}
+
+static int _testSetGraphWithWrongNumberOfPlugins(void) {
+  PluginChain p = getPluginChain();
+  PluginGraph g = _newGraph("[a|b]");
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  assertFalse(pluginChainSetGraph(p, g));
+  assertIsNull(p->graph);
+
+  freePluginGraph(g);
+  return 0;
+}
+
+static int _testAppendToGraph(void) {
+  PluginChain p = getPluginChain();
+  Plugin mock = newPluginMock();
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  assert(pluginChainSetGraph(p, _newGraph("[a]")));
+  assertFalse(pluginChainAppend(p, mock, NULL));
+  assertIntEquals(1, p->numPlugins);
+
+  freePlugin(mock);
+  return 0;
+}
+
+// Process a block of ones with two gains in parallel to the dry signal
+static Sample _processGraphWithGains(const boolByte parallelBranches) {
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  ChannelCount i;
+  SampleCount j;
+  Sample result;
+
+  pluginChainAppend(p, _newPluginGainWithGain(0.5f), NULL);
+  pluginChainAppend(p, _newPluginGainWithGain(0.25f), NULL);
+  pluginChainSetGraph(p, _newGraph("[a|b|]"));
+  pluginChainSetParallelBranches(p, parallelBranches);
+  pluginChainPrepareForProcessing(p);
+
+  for (i = 0; i < inBuffer->numChannels; i++) {
+    for (j = 0; j < inBuffer->blocksize; j++) {
+      inBuffer->samples[i][j] = 1.0f;
+    }
+  }
+
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  result = outBuffer->samples[DEFAULT_NUM_CHANNELS - 1][DEFAULT_BLOCKSIZE - 1];
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return result;
+}
+
+static int _testProcessGraph(void) {
+  assertDoubleEquals(1.75, _processGraphWithGains(false),
+                     TEST_DEFAULT_TOLERANCE);
+  return 0;
+}
+
+static int _testProcessGraphWithParallelBranches(void) {
+  assertDoubleEquals(1.75, _processGraphWithGains(true),
+                     TEST_DEFAULT_TOLERANCE);
+  return 0;
+}
+
+static int _testProcessNestedGraphWithParallelBranches(void) {
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  ChannelCount i;
+  SampleCount j;
+  int block;
+
+  pluginChainAppend(p, _newPluginGainWithGain(0.5f), NULL);
+  pluginChainAppend(p, _newPluginGainWithGain(0.25f), NULL);
+  pluginChainAppend(p, _newPluginGainWithGain(0.125f), NULL);
+  pluginChainSetGraph(p, _newGraph("[a|[b|c]|]"));
+  pluginChainSetParallelBranches(p, true);
+  pluginChainPrepareForProcessing(p);
+
+  // The same threads are used for each block, and the inner split is
+  // processed by whichever thread reaches it
+  for (block = 0; block < 4; block++) {
+    for (i = 0; i < inBuffer->numChannels; i++) {
+      for (j = 0; j < inBuffer->blocksize; j++) {
+        inBuffer->samples[i][j] = 1.0f;
+      }
+    }
+
+    pluginChainProcessAudio(p, inBuffer, outBuffer);
+    assertDoubleEquals(
+        1.875,
+        outBuffer->samples[DEFAULT_NUM_CHANNELS - 1][DEFAULT_BLOCKSIZE - 1],
+        TEST_DEFAULT_TOLERANCE);
+  }
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testProcessGraphWithDelayCompensation(void) {
+  PluginChain p = getPluginChain();
+  Plugin mock = newPluginMock();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+
+  // The mock only outputs silence, but the dry branch is delayed to line up
+  // with it anyways
+  ((PluginMockData)mock->extraData)->initialDelay = 3;
+  assert(pluginChainAppend(p, mock, NULL));
+  assert(pluginChainAppend(p, _newPluginGainWithGain(1.0f), NULL));
+  assert(pluginChainSetGraph(p, _newGraph("[a|];b")));
+  assertUnsignedLongEquals(3ul, pluginChainGetProcessingDelay(p));
+  pluginChainPrepareForProcessing(p);
+
+  sampleBufferClear(inBuffer);
+  inBuffer->samples[0][0] = 1.0f;
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertDoubleEquals(0.0, outBuffer->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, outBuffer->samples[0][3], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testGetStageDelay(void) {
+  PluginChain p = getPluginChain();
+  Plugin first = newPluginMock();
+  Plugin second = newPluginMock();
+
+  ((PluginMockData)first->extraData)->initialDelay = 3;
+  ((PluginMockData)second->extraData)->initialDelay = 5;
+  assert(pluginChainAppend(p, first, NULL));
+  assert(pluginChainAppend(p, _newPluginGainWithGain(1.0f), NULL));
+  assert(pluginChainAppend(p, second, NULL));
+  assertUnsignedLongEquals(3ul, pluginChainGetStageDelay(p, 0));
+  assertUnsignedLongEquals(3ul, pluginChainGetStageDelay(p, 1));
+  assertUnsignedLongEquals(8ul, pluginChainGetStageDelay(p, 2));
+  return 0;
+}
+
+static int _testCannotProcessGraphOffline(void) {
+  PluginChain p = getPluginChain();
+
+  assert(pluginChainAppend(p, newPluginMock(), NULL));
+  assert(pluginChainSetGraph(p, _newGraph("[a|]")));
+  assertFalse(pluginChainCanProcessOffline(p));
+  return 0;
+}
+
 static int _testShutdown(void) {
   Plugin mock = newPluginMock();
   PluginChain p = getPluginChain();
@@ -320,16 +999,67 @@ TestSuite addPluginChainTests(void) {
   addTest(testSuite, "AppendWithNullPlugin", _testAppendWithNullPlugin);
   addTest(testSuite, "AppendWithPreset", _testAppendWithPreset);
   addTest(testSuite, "InitializePluginChain", _testInitializePluginChain);
+  addTest(testSuite, "LoadPreset", _testLoadPreset);
+  addTest(testSuite, "LoadPresetInvalidIndex", _testLoadPresetInvalidIndex);
 
   addTest(testSuite, "GetMaximumTailTime", _testGetMaximumTailTime);
 
   addTest(testSuite, "PrepareForProcessing", _testPrepareForProcessing);
+  addTest(testSuite, "Suspend", _testSuspend);
   addTest(testSuite, "ProcessPluginChainAudio", _testProcessPluginChainAudio);
   addTest(testSuite, "ProcessPluginChainAudioRealtime",
           _testProcessPluginChainAudioRealtime);
+  addTest(testSuite, "ProcessAudioWithAutomation",
+          _testProcessAudioWithAutomation);
+  addTest(testSuite, "ProcessMidiWithAutomation",
+          _testProcessMidiWithAutomation);
+  addTest(testSuite, "AutomatedBlockIsTimedAsWhole",
+          _testAutomatedBlockIsTimedAsWhole);
+  addTest(testSuite, "SetAutomationForMissingPlugin",
+          _testSetAutomationForMissingPlugin);
   addTest(testSuite, "ProcessPluginChainMidiEvents",
           _testProcessPluginChainMidiEvents);
+  addTest(testSuite, "ProcessWithFirstPlugin", _testProcessWithFirstPlugin);
+  addTest(testSuite, "ProcessWithStageOutputCallback",
+          _testProcessWithStageOutputCallback);
 
+  addTest(testSuite, "ProcessWithSkipSilence", _testProcessWithSkipSilence);
+  addTest(testSuite, "ProcessWithSkipSilenceResumesWithInput",
+          _testProcessWithSkipSilenceResumesWithInput);
+  addTest(testSuite, "ProcessWithSkipSilenceResumesWithMidi",
+          _testProcessWithSkipSilenceResumesWithMidi);
+  addTest(testSuite, "ProcessWithChannelMap", _testProcessWithChannelMap);
+  addTest(testSuite, "SetChannelMapInvalid", _testSetChannelMapInvalid);
+  addTest(testSuite, "ProcessWithDoublePrecision",
+          _testProcessWithDoublePrecision);
+  addTest(testSuite, "ProcessWithoutDoublePrecision",
+          _testProcessWithoutDoublePrecision);
+  addTest(testSuite, "ProcessWithDoublePrecisionAndSinglePrecisionPlugin",
+          _testProcessWithDoublePrecisionAndSinglePrecisionPlugin);
+  addTest(testSuite, "SetDoublePrecision", _testSetDoublePrecision);
+  addTest(testSuite, "ProcessOffline", _testProcessOffline);
+  addTest(testSuite, "CannotProcessOffline", _testCannotProcessOffline);
+  addTest(testSuite, "CannotProcessOfflineInRealtime",
+          _testCannotProcessOfflineInRealtime);
+  addTest(testSuite, "CannotProcessOfflineWithoutSupport",
+          _testCannotProcessOfflineWithoutSupport);
+  addTest(testSuite, "AddGraphFromArgumentString",
+          _testAddGraphFromArgumentString);
+  addTest(testSuite, "AddMalformedGraphFromArgumentString",
+          _testAddMalformedGraphFromArgumentString);
+  addTest(testSuite, "SetGraphWithWrongNumberOfPlugins",
+          _testSetGraphWithWrongNumberOfPlugins);
+  addTest(testSuite, "AppendToGraph", _testAppendToGraph);
+  addTest(testSuite, "ProcessGraph", _testProcessGraph);
+  addTest(testSuite, "ProcessGraphWithParallelBranches",
+          _testProcessGraphWithParallelBranches);
+  addTest(testSuite, "ProcessNestedGraphWithParallelBranches",
+          _testProcessNestedGraphWithParallelBranches);
+  addTest(testSuite, "ProcessGraphWithDelayCompensation",
+          _testProcessGraphWithDelayCompensation);
+  addTest(testSuite, "GetStageDelay", _testGetStageDelay);
+  addTest(testSuite, "CannotProcessGraphOffline",
+          _testCannotProcessGraphOffline);
   addTest(testSuite, "Shutdown", _testShutdown);
 
   return testSuite;
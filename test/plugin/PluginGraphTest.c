@@ -0,0 +1,186 @@
+//
+// PluginGraphTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "plugin/PluginGraph.h"
+
+#include "unit/TestRunner.h"
+
+#include "PluginMock.h"
+
+#include <stdlib.h>
+
+// Parse a graph string, and check that it is described the same way with
+// the plugin indexes in place of the names
+static boolByte _graphStringIsDescribedAs(const char *graphString,
+                                          const char *expected) {
+  CharString c = newCharStringWithCString(graphString);
+  PluginGraph g = newPluginGraph(c, NULL);
+  CharString description;
+  boolByte result = false;
+
+  if (g != NULL) {
+    description = pluginGraphDescribe(g);
+    result = charStringIsEqualToCString(description, expected, false);
+    freeCharString(description);
+  }
+
+  freePluginGraph(g);
+  freeCharString(c);
+  return result;
+}
+
+static boolByte _graphStringIsMalformed(const char *graphString) {
+  CharString c = newCharStringWithCString(graphString);
+  PluginGraph g = newPluginGraph(c, NULL);
+  boolByte result = (boolByte)(g == NULL);
+
+  freePluginGraph(g);
+  freeCharString(c);
+  return result;
+}
+
+static int _testIsGraphString(void) {
+  CharString c = newCharStringWithCString("a;b,preset");
+
+  assertFalse(pluginGraphIsGraphString(NULL));
+  assertFalse(pluginGraphIsGraphString(c));
+  charStringCopyCString(c, "a;[b|c]");
+  assert(pluginGraphIsGraphString(c));
+
+  freeCharString(c);
+  return 0;
+}
+
+static int _testNewPluginGraph(void) {
+  CharString c = newCharStringWithCString("a;[|b,preset;c];d");
+  LinkedList pluginStrings = newLinkedList();
+  PluginGraph g = newPluginGraph(c, pluginStrings);
+  CharString *strings;
+
+  assertNotNull(g);
+  assertIntEquals(4, g->numPlugins);
+  assertIntEquals(3, g->root->numNodes);
+  assertIntEquals(0, g->root->nodes[0]->numBranches);
+  assertIntEquals(2, g->root->nodes[1]->numBranches);
+  assertIntEquals(0, g->root->nodes[1]->branches[0]->numNodes);
+  assertIntEquals(2, g->root->nodes[1]->branches[1]->numNodes);
+  assertIntEquals(3, g->root->nodes[2]->pluginIndex);
+
+  assertIntEquals(4, linkedListLength(pluginStrings));
+  strings = (CharString *)linkedListToArray(pluginStrings);
+  assertCharStringEquals("a", strings[0]);
+  assertCharStringEquals("b,preset", strings[1]);
+  assertCharStringEquals("c", strings[2]);
+  assertCharStringEquals("d", strings[3]);
+
+  free(strings);
+  freeLinkedListAndItems(pluginStrings, (LinkedListFreeItemFunc)freeCharString);
+  freePluginGraph(g);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testNewPluginGraphSerial(void) {
+  assert(_graphStringIsDescribedAs("a", "0"));
+  assert(_graphStringIsDescribedAs("a;b;c", "0;1;2"));
+  return 0;
+}
+
+static int _testNewPluginGraphWithSplits(void) {
+  assert(_graphStringIsDescribedAs("[a|b]", "[0|1]"));
+  assert(_graphStringIsDescribedAs("a;[|b];c", "0;[|1];2"));
+  assert(_graphStringIsDescribedAs("[a;b|]", "[0;1|]"));
+  assert(_graphStringIsDescribedAs("[a|b|c];[d|e]", "[0|1|2];[3|4]"));
+  return 0;
+}
+
+static int _testNewPluginGraphWithNestedSplits(void) {
+  assert(_graphStringIsDescribedAs("[a|[b|c;d]];e", "[0|[1|2;3]];4"));
+  assert(_graphStringIsDescribedAs("[[a]]", "[[0]]"));
+  return 0;
+}
+
+static int _testNewPluginGraphMalformed(void) {
+  assert(_graphStringIsMalformed(""));
+  assert(_graphStringIsMalformed("a;"));
+  assert(_graphStringIsMalformed("a;;b"));
+  assert(_graphStringIsMalformed("[a|b"));
+  assert(_graphStringIsMalformed("[a|[b]"));
+  assert(_graphStringIsMalformed("a]"));
+  assert(_graphStringIsMalformed("a|b"));
+  assert(_graphStringIsMalformed("a[b]"));
+  assert(_graphStringIsMalformed("[a]b"));
+  assert(_graphStringIsMalformed("[a;|b]"));
+  return 0;
+}
+
+static int _testGetDelay(void) {
+  CharString c = newCharStringWithCString("a;[b|c;d|];e");
+  PluginGraph g = newPluginGraph(c, NULL);
+  Plugin plugins[5];
+  int delays[5] = {1, 10, 4, 5, 2};
+  int i;
+
+  for (i = 0; i < 5; i++) {
+    plugins[i] = newPluginMock();
+    ((PluginMockData)plugins[i]->extraData)->initialDelay = delays[i];
+  }
+
+  // The longest branch of the split is b, so c and d do not count
+  assertUnsignedLongEquals(13ul, pluginGraphGetDelay(g, plugins));
+  assertUnsignedLongEquals(
+      9ul, pluginGraphGetBranchDelay(g->root->nodes[1]->branches[1], plugins));
+  assertUnsignedLongEquals(
+      0ul, pluginGraphGetBranchDelay(g->root->nodes[1]->branches[2], plugins));
+
+  for (i = 0; i < 5; i++) {
+    freePlugin(plugins[i]);
+  }
+
+  freePluginGraph(g);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testFreeNullPluginGraph(void) {
+  freePluginGraph(NULL);
+  return 0;
+}
+
+TestSuite addPluginGraphTests(void);
+TestSuite addPluginGraphTests(void) {
+  TestSuite testSuite = newTestSuite("PluginGraph", NULL, NULL);
+  addTest(testSuite, "IsGraphString", _testIsGraphString);
+  addTest(testSuite, "NewObject", _testNewPluginGraph);
+  addTest(testSuite, "NewObjectSerial", _testNewPluginGraphSerial);
+  addTest(testSuite, "NewObjectWithSplits", _testNewPluginGraphWithSplits);
+  addTest(testSuite, "NewObjectWithNestedSplits",
+          _testNewPluginGraphWithNestedSplits);
+  addTest(testSuite, "NewObjectMalformed", _testNewPluginGraphMalformed);
+  addTest(testSuite, "GetDelay", _testGetDelay);
+  addTest(testSuite, "FreeNull", _testFreeNullPluginGraph);
+  return testSuite;
+}
@@ -26,6 +26,9 @@
 
 #include "PluginMock.h"
 
+#include "midi/MidiEvent.h"
+#include "time/AudioClock.h"
+
 static void _pluginMockEmpty(void *pluginPtr) {
   // Nothing to do here
 }
@@ -38,6 +41,9 @@ static boolByte _pluginMockOpen(void *pluginPtr) {
 }
 
 static int _pluginMockGetSetting(void *pluginPtr, PluginSetting pluginSetting) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginMockData extraData = (PluginMockData)self->extraData;
+
   switch (pluginSetting) {
   case PLUGIN_SETTING_TAIL_TIME_IN_MS:
     return kPluginMockTailTime;
@@ -49,7 +55,7 @@ static int _pluginMockGetSetting(void *pluginPtr, PluginSetting pluginSetting) {
     return 2;
 
   case PLUGIN_INITIAL_DELAY:
-    return 0;
+    return extraData->initialDelay;
 
   default:
     return 0;
@@ -62,11 +68,21 @@ static void _pluginMockPrepareForProcessing(void *pluginPtr) {
   extraData->isPrepared = true;
 }
 
+static void _pluginMockSuspend(void *pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginMockData extraData = (PluginMockData)self->extraData;
+  extraData->isPrepared = false;
+}
+
 static void _pluginMockProcessAudio(void *pluginPtr, SampleBuffer inputs,
                                     SampleBuffer outputs) {
   Plugin self = (Plugin)pluginPtr;
   PluginMockData extraData = (PluginMockData)self->extraData;
   extraData->processAudioCalled = true;
+  extraData->numProcessAudioCalls++;
+  extraData->lastBlocksize = outputs->blocksize;
+  extraData->lastClockFrame =
+      getAudioClock() != NULL ? getAudioClock()->currentFrame : 0;
   sampleBufferClear(outputs);
 }
 
@@ -75,13 +91,55 @@ static void _pluginMockProcessMidiEvents(void *pluginPtr,
   Plugin self = (Plugin)pluginPtr;
   PluginMockData extraData = (PluginMockData)self->extraData;
   extraData->processMidiCalled = true;
+
+  if (midiEvents->item != NULL) {
+    extraData->lastMidiDeltaFrames = ((MidiEvent)midiEvents->item)->deltaFrames;
+  }
 }
 
 static boolByte _pluginMockSetParameter(void *pluginPtr, unsigned int i,
                                         float value) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginMockData extraData = (PluginMockData)self->extraData;
+  extraData->numParameterChanges++;
+  extraData->lastParameterValue = value;
   return false;
 }
 
+// Reverse the input and then double it, which needs a pass over the input and
+// another one over the output
+static boolByte _pluginMockProcessOffline(void *pluginPtr,
+                                          OfflineSession session) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginMockData extraData = (PluginMockData)self->extraData;
+  const SampleCount numFrames = session->input->blocksize;
+  SampleBuffer frame = newSampleBuffer(session->output->numChannels, 1);
+  SampleCount i;
+  ChannelCount j;
+
+  extraData->numProcessOfflineCalls++;
+
+  for (i = 0; i < numFrames; i++) {
+    offlineSessionRead(session, true, numFrames - i - 1, 1, frame->numChannels,
+                       frame->samples);
+    offlineSessionWrite(session, i, 1, frame->numChannels, frame->samples);
+  }
+
+  for (i = 0; i < numFrames; i++) {
+    offlineSessionRead(session, false, i, 1, frame->numChannels,
+                       frame->samples);
+
+    for (j = 0; j < frame->numChannels; j++) {
+      frame->samples[j][0] *= 2.0f;
+    }
+
+    offlineSessionWrite(session, i, 1, frame->numChannels, frame->samples);
+  }
+
+  freeSampleBuffer(frame);
+  return true;
+}
+
 static void _pluginMockClose(void *pluginPtr) {
   Plugin self = (Plugin)pluginPtr;
   PluginMockData extraData = (PluginMockData)self->extraData;
@@ -97,8 +155,10 @@ Plugin newPluginMock(void) {
   plugin->displayInfo = _pluginMockEmpty;
   plugin->getSetting = _pluginMockGetSetting;
   plugin->prepareForProcessing = _pluginMockPrepareForProcessing;
+  plugin->suspend = _pluginMockSuspend;
   plugin->processAudio = _pluginMockProcessAudio;
   plugin->processMidiEvents = _pluginMockProcessMidiEvents;
+  plugin->processOffline = _pluginMockProcessOffline;
   plugin->setParameter = _pluginMockSetParameter;
   plugin->closePlugin = _pluginMockClose;
   plugin->freePluginData = _pluginMockEmpty;
@@ -109,6 +169,14 @@ Plugin newPluginMock(void) {
   extraData->isPrepared = false;
   extraData->processAudioCalled = false;
   extraData->processMidiCalled = false;
+  extraData->numProcessAudioCalls = 0;
+  extraData->lastBlocksize = 0;
+  extraData->lastClockFrame = 0;
+  extraData->numParameterChanges = 0;
+  extraData->lastParameterValue = 0.0f;
+  extraData->lastMidiDeltaFrames = 0;
+  extraData->numProcessOfflineCalls = 0;
+  extraData->initialDelay = 0;
   plugin->extraData = extraData;
 
   return plugin;
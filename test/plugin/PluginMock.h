@@ -37,6 +37,17 @@ typedef struct {
   boolByte isPrepared;
   boolByte processAudioCalled;
   boolByte processMidiCalled;
+  unsigned int numProcessAudioCalls;
+  SampleCount lastBlocksize;
+  // Position of the audio clock during the last call to processAudio
+  unsigned long lastClockFrame;
+  unsigned int numParameterChanges;
+  float lastParameterValue;
+  // Offset of the first MIDI event sent in the last call to processMidiEvents
+  unsigned long lastMidiDeltaFrames;
+  unsigned int numProcessOfflineCalls;
+  // Reported as the initial delay, although the output is not delayed
+  int initialDelay;
 } PluginMockDataMembers;
 typedef PluginMockDataMembers *PluginMockData;
 
@@ -0,0 +1,226 @@
+//
+// PluginSandboxTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "plugin/PluginSandbox.h"
+
+#include "audio/AudioSettings.h"
+#include "plugin/PluginGain.h"
+#include "unit/TestRunner.h"
+
+#include "PluginMock.h"
+
+#if LINUX
+#include <signal.h>
+#include <unistd.h>
+
+static const unsigned long kTestTimeoutInMs = 200;
+// Input samples which make the test plugin crash or hang
+static const Sample kTestCrashSample = -1.0f;
+static const Sample kTestHangSample = -2.0f;
+
+static PluginProcessAudioFunc _gainProcessAudio = NULL;
+
+static void _failingProcessAudio(void *pluginPtr, SampleBuffer inputs,
+                                 SampleBuffer outputs) {
+  if (inputs->samples[0][0] == kTestCrashSample) {
+    raise(SIGKILL);
+  } else if (inputs->samples[0][0] == kTestHangSample) {
+    sleep(60);
+  }
+
+  _gainProcessAudio(pluginPtr, inputs, outputs);
+}
+
+// A gain plugin which crashes or hangs on certain input
+static Plugin _newFailingPlugin(void) {
+  CharString pluginName = newCharStringWithCString(kInternalPluginGainName);
+  Plugin result = newPluginGain(pluginName);
+
+  _gainProcessAudio = result->processAudio;
+  result->processAudio = _failingProcessAudio;
+  freeCharString(pluginName);
+  return result;
+}
+
+static Plugin _newOpenSandbox(void) {
+  Plugin result = newPluginSandbox(_newFailingPlugin(), kTestTimeoutInMs);
+
+  if (result != NULL && !openPlugin(result)) {
+    freePlugin(result);
+    return NULL;
+  }
+
+  return result;
+}
+
+// Process a block where every input sample has the given value, and return
+// the first output sample
+static Sample _processBlock(Plugin plugin, const Sample value) {
+  SampleBuffer inputs = newSampleBuffer(DEFAULT_NUM_CHANNELS, 4);
+  SampleBuffer outputs = newSampleBuffer(DEFAULT_NUM_CHANNELS, 4);
+  Sample result;
+  ChannelCount i;
+  SampleCount j;
+
+  for (i = 0; i < inputs->numChannels; i++) {
+    for (j = 0; j < inputs->blocksize; j++) {
+      inputs->samples[i][j] = value;
+      outputs->samples[i][j] = 123.0f;
+    }
+  }
+
+  plugin->processAudio(plugin, inputs, outputs);
+  result = outputs->samples[1][3];
+  freeSampleBuffer(inputs);
+  freeSampleBuffer(outputs);
+  return result;
+}
+
+static int _testNewPluginSandbox(void) {
+  Plugin p = newPluginSandbox(newPluginMock(), kTestTimeoutInMs);
+  assertNotNull(p);
+  assertIntEquals(PLUGIN_TYPE_SANDBOX, p->interfaceType);
+  assertIntEquals(PLUGIN_TYPE_INSTRUMENT, p->pluginType);
+  assertCharStringEquals("Mock", p->pluginName);
+  assertFalse(p->isOpen);
+  assertIntEquals(0, pluginSandboxGetNumRestarts(p));
+  freePlugin(p);
+  return 0;
+}
+
+static int _testOpenPluginSandbox(void) {
+  Plugin p = _newOpenSandbox();
+  assertNotNull(p);
+  assert(p->isOpen);
+  assertIntEquals(PLUGIN_TYPE_EFFECT, p->pluginType);
+  assertIntEquals(2, p->inputBuffer->numChannels);
+  assertIntEquals(2, p->outputBuffer->numChannels);
+  assert(closePlugin(p));
+  freePlugin(p);
+  return 0;
+}
+
+static int _testProcessAudio(void) {
+  Plugin p = _newOpenSandbox();
+  assertNotNull(p);
+  assert(p->setParameter(p, PLUGIN_GAIN_SETTINGS_GAIN, 0.5f));
+  assertDoubleEquals(0.25, _processBlock(p, 0.5f), TEST_DEFAULT_TOLERANCE);
+  closePlugin(p);
+  freePlugin(p);
+  return 0;
+}
+
+static int _testSetInvalidParameter(void) {
+  Plugin p = _newOpenSandbox();
+  assertNotNull(p);
+  assertFalse(p->setParameter(p, PLUGIN_GAIN_NUM_SETTINGS, 0.5f));
+  assertIntEquals(0, pluginSandboxGetNumRestarts(p));
+  closePlugin(p);
+  freePlugin(p);
+  return 0;
+}
+
+static int _testRestartAfterCrash(void) {
+  Plugin p = _newOpenSandbox();
+  assertNotNull(p);
+  assert(p->setParameter(p, PLUGIN_GAIN_SETTINGS_GAIN, 0.5f));
+  assertDoubleEquals(0.0, _processBlock(p, kTestCrashSample),
+                     TEST_DEFAULT_TOLERANCE);
+  assertIntEquals(1, pluginSandboxGetNumRestarts(p));
+  // The restarted plugin must still have its parameters
+  assertDoubleEquals(0.25, _processBlock(p, 0.5f), TEST_DEFAULT_TOLERANCE);
+  closePlugin(p);
+  freePlugin(p);
+  return 0;
+}
+
+static int _testRestartAfterHang(void) {
+  Plugin p = _newOpenSandbox();
+  assertNotNull(p);
+  assertDoubleEquals(0.0, _processBlock(p, kTestHangSample),
+                     TEST_DEFAULT_TOLERANCE);
+  assertIntEquals(1, pluginSandboxGetNumRestarts(p));
+  assertDoubleEquals(0.5, _processBlock(p, 0.5f), TEST_DEFAULT_TOLERANCE);
+  closePlugin(p);
+  freePlugin(p);
+  return 0;
+}
+
+static int _testStopRestartingAfterRepeatedCrashes(void) {
+  Plugin p = _newOpenSandbox();
+  unsigned int restarts;
+  int i;
+
+  assertNotNull(p);
+
+  for (i = 0; i < 10; i++) {
+    _processBlock(p, kTestCrashSample);
+  }
+
+  restarts = pluginSandboxGetNumRestarts(p);
+  assert(restarts < 10);
+  assertDoubleEquals(0.0, _processBlock(p, 0.5f), TEST_DEFAULT_TOLERANCE);
+  assertIntEquals(restarts, pluginSandboxGetNumRestarts(p));
+  closePlugin(p);
+  freePlugin(p);
+  return 0;
+}
+
+static int _testFreeWithoutClose(void) {
+  Plugin p = _newOpenSandbox();
+  assertNotNull(p);
+  freePlugin(p);
+  return 0;
+}
+#endif
+
+static int _testIsSupported(void) {
+#if LINUX
+  assert(pluginSandboxIsSupported());
+#else
+  assertFalse(pluginSandboxIsSupported());
+  assertIsNull(newPluginSandbox(newPluginMock(), 1000));
+#endif
+  return 0;
+}
+
+TestSuite addPluginSandboxTests(void);
+TestSuite addPluginSandboxTests(void) {
+  TestSuite testSuite = newTestSuite("PluginSandbox", NULL, NULL);
+  addTest(testSuite, "IsSupported", _testIsSupported);
+#if LINUX
+  addTest(testSuite, "NewObject", _testNewPluginSandbox);
+  addTest(testSuite, "Open", _testOpenPluginSandbox);
+  addTest(testSuite, "ProcessAudio", _testProcessAudio);
+  addTest(testSuite, "SetInvalidParameter", _testSetInvalidParameter);
+  addTest(testSuite, "RestartAfterCrash", _testRestartAfterCrash);
+  addTest(testSuite, "RestartAfterHang", _testRestartAfterHang);
+  addTest(testSuite, "StopRestartingAfterRepeatedCrashes",
+          _testStopRestartingAfterRepeatedCrashes);
+  addTest(testSuite, "FreeWithoutClose", _testFreeWithoutClose);
+#endif
+  return testSuite;
+}
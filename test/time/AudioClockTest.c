@@ -71,6 +71,19 @@ static int _testRestartAudioClock(void) {
   return 0;
 }
 
+static int _testRewindAudioClock(void) {
+  AudioClock audioClock = getAudioClock();
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  audioClockRewind(audioClock);
+  assertFalse(audioClock->isPlaying);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, audioClock->currentFrame);
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  assert(audioClock->isPlaying);
+  assert(audioClock->transportChanged);
+  return 0;
+}
+
 static int _testAdvanceClockMulitpleTimes(void) {
   AudioClock audioClock = getAudioClock();
   int i;
@@ -86,6 +99,75 @@ static int _testAdvanceClockMulitpleTimes(void) {
   return 0;
 }
 
+static int _testTransportWithoutTempoMap(void) {
+  AudioClock audioClock = getAudioClock();
+  // One beat at 120 BPM and 44.1kHz
+  advanceAudioClock(audioClock, 22050);
+  assertDoubleEquals(1.0, audioClock->ppqPosition, 0.0001);
+  assertDoubleEquals(0.0, audioClock->barStartPpqPosition, 0.0001);
+  assertDoubleEquals(120.0, audioClock->tempo, 0.0001);
+  assertIntEquals(4, audioClock->timeSignatureNumerator);
+  assertIntEquals(4, audioClock->timeSignatureDenominator);
+  return 0;
+}
+
+static int _testTransportWithTempoMap(void) {
+  AudioClock audioClock = getAudioClock();
+  TempoMap tempoMap = newTempoMap(96, 120.0, 44100.0);
+  tempoMapAddTempoChange(tempoMap, 4 * 96, 60.0);
+  audioClockSetTempoMap(audioClock, tempoMap);
+
+  // The first bar lasts 88200 frames, after which each beat is 44100 frames
+  advanceAudioClock(audioClock, 88200);
+  advanceAudioClock(audioClock, 44100);
+  assertDoubleEquals(5.0, audioClock->ppqPosition, 0.0001);
+  assertDoubleEquals(4.0, audioClock->barStartPpqPosition, 0.0001);
+  assertDoubleEquals(60.0, audioClock->tempo, 0.0001);
+
+  audioClockRewind(audioClock);
+  assertDoubleEquals(0.0, audioClock->ppqPosition, 0.0001);
+  assertDoubleEquals(120.0, audioClock->tempo, 0.0001);
+
+  audioClockSetTempoMap(audioClock, NULL);
+  freeTempoMap(tempoMap);
+  return 0;
+}
+
+static int _testSamplesToNextClock(void) {
+  AudioClock audioClock = getAudioClock();
+  // At 120 BPM and 44.1kHz, MIDI clocks are 918.75 frames apart
+  assertIntEquals(0, audioClock->samplesToNextClock);
+  advanceAudioClock(audioClock, 900);
+  assertIntEquals(19, audioClock->samplesToNextClock);
+  advanceAudioClock(audioClock, 100);
+  assertIntEquals(-81, audioClock->samplesToNextClock);
+  return 0;
+}
+
+static int _testTransportVersionChanges(void) {
+  AudioClock audioClock = getAudioClock();
+  unsigned long version = audioClock->transportVersion;
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  assert(audioClock->transportVersion != version);
+  version = audioClock->transportVersion;
+  audioClockStop(audioClock);
+  assert(audioClock->transportVersion != version);
+  version = audioClock->transportVersion;
+  audioClockUpdateTransport(audioClock);
+  assert(audioClock->transportVersion != version);
+  return 0;
+}
+
+static int _testNanosecondsOnlyInRealtime(void) {
+  AudioClock audioClock = getAudioClock();
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  assert(audioClock->nanoseconds == 0);
+  audioClock->isRealtime = true;
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  assert(audioClock->nanoseconds > 0);
+  return 0;
+}
+
 TestSuite addAudioClockTests(void);
 TestSuite addAudioClockTests(void) {
   TestSuite testSuite =
@@ -94,6 +176,14 @@ TestSuite addAudioClockTests(void) {
   addTest(testSuite, "AdvanceClock", _testAdvanceAudioClock);
   addTest(testSuite, "StopClock", _testStopAudioClock);
   addTest(testSuite, "RestartClock", _testRestartAudioClock);
+  addTest(testSuite, "RewindClock", _testRewindAudioClock);
   addTest(testSuite, "MultipleAdvance", _testAdvanceClockMulitpleTimes);
+  addTest(testSuite, "TransportWithoutTempoMap",
+          _testTransportWithoutTempoMap);
+  addTest(testSuite, "TransportWithTempoMap", _testTransportWithTempoMap);
+  addTest(testSuite, "SamplesToNextClock", _testSamplesToNextClock);
+  addTest(testSuite, "TransportVersionChanges", _testTransportVersionChanges);
+  addTest(testSuite, "NanosecondsOnlyInRealtime",
+          _testNanosecondsOnlyInRealtime);
   return testSuite;
 }
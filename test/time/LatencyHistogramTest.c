@@ -0,0 +1,199 @@
+//
+// LatencyHistogramTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "time/LatencyHistogram.h"
+
+#include "unit/TestRunner.h"
+
+#define NS_PER_MS 1000000ull
+
+static int _testNewLatencyHistogram(void) {
+  LatencyHistogram h = newLatencyHistogram(10.0);
+
+  assertNotNull(h);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, h->numSamples);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, h->numOverBudget);
+  assertDoubleEquals(0.0, latencyHistogramGetPercentile(h, 50.0),
+                     TEST_EXACT_TOLERANCE);
+
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+static int _testAddSamples(void) {
+  LatencyHistogram h = newLatencyHistogram(0.0);
+
+  latencyHistogramAdd(h, 3 * NS_PER_MS);
+  latencyHistogramAdd(h, 1 * NS_PER_MS);
+  latencyHistogramAdd(h, 2 * NS_PER_MS);
+
+  assertUnsignedLongEquals(3ul, h->numSamples);
+  assertDoubleEquals(1.0, latencyHistogramGetMin(h), TEST_EXACT_TOLERANCE);
+  assertDoubleEquals(3.0, latencyHistogramGetMax(h), TEST_EXACT_TOLERANCE);
+
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+static int _testSmallValuesAreExact(void) {
+  LatencyHistogram h = newLatencyHistogram(0.0);
+  unsigned long long i;
+
+  for (i = 0; i < LATENCY_HISTOGRAM_SUB_BUCKETS; i++) {
+    latencyHistogramAdd(h, i);
+  }
+
+  // Values below the number of sub-buckets each get their own bucket
+  assertDoubleEquals(0.0, latencyHistogramGetMin(h), TEST_EXACT_TOLERANCE);
+  assert(latencyHistogramGetPercentile(h, 50.0) * NS_PER_MS < 8.5);
+  assert(latencyHistogramGetPercentile(h, 50.0) * NS_PER_MS > 6.5);
+
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+static int _testPercentiles(void) {
+  LatencyHistogram h = newLatencyHistogram(0.0);
+  unsigned long long i;
+  double result;
+
+  // 1ms, 2ms, ... 1000ms
+  for (i = 1; i <= 1000; i++) {
+    latencyHistogramAdd(h, i * NS_PER_MS);
+  }
+
+  // Percentiles should be within one sub-bucket of the exact value
+  result = latencyHistogramGetPercentile(h, 50.0);
+  assert(fabs(result - 500.0) < 500.0 / LATENCY_HISTOGRAM_SUB_BUCKETS);
+  result = latencyHistogramGetPercentile(h, 90.0);
+  assert(fabs(result - 900.0) < 900.0 / LATENCY_HISTOGRAM_SUB_BUCKETS);
+  result = latencyHistogramGetPercentile(h, 99.0);
+  assert(fabs(result - 990.0) < 990.0 / LATENCY_HISTOGRAM_SUB_BUCKETS);
+  assertDoubleEquals(1.0, latencyHistogramGetPercentile(h, 0.0),
+                     TEST_EXACT_TOLERANCE);
+  assertDoubleEquals(1000.0, latencyHistogramGetPercentile(h, 100.0),
+                     TEST_EXACT_TOLERANCE);
+
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+static int _testPercentileIsClampedToRange(void) {
+  LatencyHistogram h = newLatencyHistogram(0.0);
+
+  latencyHistogramAdd(h, 1000001);
+  assertDoubleEquals(1.0, latencyHistogramGetPercentile(h, 50.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assert(latencyHistogramGetPercentile(h, 50.0) <= latencyHistogramGetMax(h));
+
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+static int _testVeryLargeValue(void) {
+  LatencyHistogram h = newLatencyHistogram(0.0);
+
+  latencyHistogramAdd(h, ~0ull);
+  assertUnsignedLongEquals(1ul, h->numSamples);
+  assert(latencyHistogramGetPercentile(h, 50.0) > 0.0);
+
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+static int _testOverBudget(void) {
+  LatencyHistogram h = newLatencyHistogram(10.0);
+
+  latencyHistogramAdd(h, 5 * NS_PER_MS);
+  latencyHistogramAdd(h, 10 * NS_PER_MS);
+  latencyHistogramAdd(h, 11 * NS_PER_MS);
+  latencyHistogramAdd(h, 50 * NS_PER_MS);
+
+  assertUnsignedLongEquals(2ul, h->numOverBudget);
+
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+static int _testClear(void) {
+  LatencyHistogram h = newLatencyHistogram(1.0);
+
+  latencyHistogramAdd(h, 5 * NS_PER_MS);
+  latencyHistogramClear(h);
+
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, h->numSamples);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, h->numOverBudget);
+  assertDoubleEquals(0.0, latencyHistogramGetMax(h), TEST_EXACT_TOLERANCE);
+  assertDoubleEquals(0.0, latencyHistogramGetPercentile(h, 99.0),
+                     TEST_EXACT_TOLERANCE);
+
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+static int _testToString(void) {
+  LatencyHistogram h = newLatencyHistogram(10.0);
+  CharString s;
+
+  latencyHistogramAdd(h, 500000);
+  latencyHistogramAdd(h, 20 * NS_PER_MS);
+  s = latencyHistogramToString(h);
+  assert(strstr(s->data, "min 500.0us") != NULL);
+  assert(strstr(s->data, "max 20.00ms") != NULL);
+  assert(strstr(s->data, "1/2 over budget") != NULL);
+
+  freeCharString(s);
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+static int _testToStringEmpty(void) {
+  LatencyHistogram h = newLatencyHistogram(10.0);
+  CharString s = latencyHistogramToString(h);
+
+  assertCharStringEquals("no samples", s);
+
+  freeCharString(s);
+  freeLatencyHistogram(h);
+  return 0;
+}
+
+TestSuite addLatencyHistogramTests(void);
+TestSuite addLatencyHistogramTests(void) {
+  TestSuite testSuite = newTestSuite("LatencyHistogram", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewLatencyHistogram);
+  addTest(testSuite, "AddSamples", _testAddSamples);
+  addTest(testSuite, "SmallValuesAreExact", _testSmallValuesAreExact);
+  addTest(testSuite, "Percentiles", _testPercentiles);
+  addTest(testSuite, "PercentileIsClampedToRange",
+          _testPercentileIsClampedToRange);
+  addTest(testSuite, "VeryLargeValue", _testVeryLargeValue);
+  addTest(testSuite, "OverBudget", _testOverBudget);
+  addTest(testSuite, "Clear", _testClear);
+  addTest(testSuite, "ToString", _testToString);
+  addTest(testSuite, "ToStringEmpty", _testToStringEmpty);
+  return testSuite;
+}
@@ -257,6 +257,75 @@ static int _testSleepMilliseconds(void) {
   return 0;
 }
 
+static int _testHistogramDisabledByDefault(void) {
+  assertIsNull(_testTaskTimer->histogram);
+  taskTimerStart(_testTaskTimer);
+  taskTimerStop(_testTaskTimer);
+  assertIsNull(_testTaskTimer->histogram);
+  return 0;
+}
+
+static int _testHistogramRecordsEachInterval(void) {
+  int i;
+
+  taskTimerEnableHistogram(_testTaskTimer, SLEEP_DURATION_MS / 2.0);
+  assertNotNull(_testTaskTimer->histogram);
+
+  for (i = 0; i < 3; i++) {
+    taskTimerStart(_testTaskTimer);
+    _testSleep();
+    taskTimerStop(_testTaskTimer);
+  }
+
+  assertUnsignedLongEquals(3ul, _testTaskTimer->histogram->numSamples);
+  assertUnsignedLongEquals(3ul, _testTaskTimer->histogram->numOverBudget);
+  assertTimeEquals(SLEEP_DURATION_MS,
+                   latencyHistogramGetMin(_testTaskTimer->histogram),
+                   MAX_TIMER_TOLERANCE_MS);
+  return 0;
+}
+
+static int _testHistogramStopBeforeStart(void) {
+  taskTimerEnableHistogram(_testTaskTimer, 0.0);
+  taskTimerStop(_testTaskTimer);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG,
+                           _testTaskTimer->histogram->numSamples);
+  return 0;
+}
+
+static int _testHistogramRecordsGroupSum(void) {
+  int i;
+  double groupTime;
+
+  taskTimerEnableHistogram(_testTaskTimer, SLEEP_DURATION_MS * 2.5);
+  taskTimerBeginGroup(_testTaskTimer);
+
+  for (i = 0; i < 3; i++) {
+    taskTimerStart(_testTaskTimer);
+    _testSleep();
+    taskTimerStop(_testTaskTimer);
+  }
+
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG,
+                           _testTaskTimer->histogram->numSamples);
+  groupTime = taskTimerEndGroup(_testTaskTimer);
+  assertTimeEquals(SLEEP_DURATION_MS * 3, groupTime,
+                   MAX_TIMER_TOLERANCE_MS * 3);
+  assertTimeEquals(_testTaskTimer->totalTaskTime, groupTime, 0.001);
+  assertUnsignedLongEquals(1ul, _testTaskTimer->histogram->numSamples);
+  assertUnsignedLongEquals(1ul, _testTaskTimer->histogram->numOverBudget);
+  return 0;
+}
+
+static int _testHistogramEmptyGroup(void) {
+  taskTimerEnableHistogram(_testTaskTimer, 0.0);
+  taskTimerBeginGroup(_testTaskTimer);
+  assertDoubleEquals(0.0, taskTimerEndGroup(_testTaskTimer), 0.0);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG,
+                           _testTaskTimer->histogram->numSamples);
+  return 0;
+}
+
 TestSuite addTaskTimerTests(void);
 TestSuite addTaskTimerTests(void) {
   TestSuite testSuite =
@@ -292,5 +361,15 @@ TestSuite addTaskTimerTests(void) {
           _testHumanReadableTimeNotStarted);
 
   addTest(testSuite, "SleepMilliseconds", _testSleepMilliseconds);
+
+  addTest(testSuite, "HistogramDisabledByDefault",
+          _testHistogramDisabledByDefault);
+  addTest(testSuite, "HistogramRecordsEachInterval",
+          _testHistogramRecordsEachInterval);
+  addTest(testSuite, "HistogramStopBeforeStart",
+          _testHistogramStopBeforeStart);
+  addTest(testSuite, "HistogramRecordsGroupSum",
+          _testHistogramRecordsGroupSum);
+  addTest(testSuite, "HistogramEmptyGroup", _testHistogramEmptyGroup);
   return testSuite;
 }
@@ -0,0 +1,200 @@
+//
+// TempoMapTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "time/TempoMap.h"
+
+#include "unit/TestRunner.h"
+
+static const unsigned short kTempoMapTestTicksPerBeat = 96;
+static const SampleRate kTempoMapTestSampleRate = 44100.0;
+
+static TempoMap _newTestTempoMap(void) {
+  return newTempoMap(kTempoMapTestTicksPerBeat, 120.0, kTempoMapTestSampleRate);
+}
+
+static int _testNewTempoMap(void) {
+  TempoMap t = _newTestTempoMap();
+  assertNotNull(t);
+  assertSizeEquals((size_t)1, t->numSegments);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, tempoMapTicksToFrames(t, 0));
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testTicksToFramesConstantTempo(void) {
+  TempoMap t = _newTestTempoMap();
+  // One beat at 120 BPM is half a second
+  assertUnsignedLongEquals(22050ul, tempoMapTicksToFrames(t, 96));
+  assertUnsignedLongEquals(88200ul, tempoMapTicksToFrames(t, 384));
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testTicksToFramesWithTempoChange(void) {
+  TempoMap t = _newTestTempoMap();
+  tempoMapAddTempoChange(t, 96, 60.0);
+  assertSizeEquals((size_t)2, t->numSegments);
+  assertUnsignedLongEquals(22050ul, tempoMapTicksToFrames(t, 96));
+  assertUnsignedLongEquals(66150ul, tempoMapTicksToFrames(t, 192));
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testAddTempoChangesOutOfOrder(void) {
+  TempoMap t = _newTestTempoMap();
+  tempoMapAddTempoChange(t, 192, 120.0);
+  tempoMapAddTempoChange(t, 96, 60.0);
+  assertSizeEquals((size_t)3, t->numSegments);
+  // Half a second, one second, then another half second
+  assertUnsignedLongEquals(66150ul, tempoMapTicksToFrames(t, 192));
+  assertUnsignedLongEquals(88200ul, tempoMapTicksToFrames(t, 288));
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testReplaceTempoChange(void) {
+  TempoMap t = _newTestTempoMap();
+  tempoMapAddTempoChange(t, 0, 60.0);
+  tempoMapAddTempoChange(t, 96, 240.0);
+  tempoMapAddTempoChange(t, 96, 120.0);
+  assertSizeEquals((size_t)2, t->numSegments);
+  assertUnsignedLongEquals(44100ul, tempoMapTicksToFrames(t, 96));
+  assertUnsignedLongEquals(66150ul, tempoMapTicksToFrames(t, 192));
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testAddTempoChangeFromMidiBytes(void) {
+  TempoMap t = _newTestTempoMap();
+  // 1000000 microseconds per beat, or 60 BPM
+  const byte bytes[3] = {0x0f, 0x42, 0x40};
+  tempoMapAddTempoChangeFromMidiBytes(t, 0, bytes);
+  assertUnsignedLongEquals(44100ul, tempoMapTicksToFrames(t, 96));
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testAddInvalidTempoChange(void) {
+  TempoMap t = _newTestTempoMap();
+  const byte bytes[3] = {0x00, 0x00, 0x00};
+  tempoMapAddTempoChange(t, 96, 0.0);
+  tempoMapAddTempoChangeFromMidiBytes(t, 96, bytes);
+  assertSizeEquals((size_t)1, t->numSegments);
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testFramesToTicksWithTempoChange(void) {
+  TempoMap t = _newTestTempoMap();
+  tempoMapAddTempoChange(t, 96, 60.0);
+  assertDoubleEquals(48.0, tempoMapFramesToTicks(t, 11025), 0.0001);
+  assertDoubleEquals(96.0, tempoMapFramesToTicks(t, 22050), 0.0001);
+  assertDoubleEquals(192.0, tempoMapFramesToTicks(t, 66150), 0.0001);
+  assertDoubleEquals(2.0, tempoMapFramesToPpq(t, 66150), 0.0001);
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testGetTempoAtFrame(void) {
+  TempoMap t = _newTestTempoMap();
+  tempoMapAddTempoChange(t, 96, 60.0);
+  assertDoubleEquals(120.0, tempoMapGetTempoAtFrame(t, 22049), 0.0001);
+  assertDoubleEquals(60.0, tempoMapGetTempoAtFrame(t, 22050), 0.0001);
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testBarsDefaultTimeSignature(void) {
+  TempoMap t = _newTestTempoMap();
+  assertSizeEquals((size_t)1, t->numTimeSignatures);
+  assertDoubleEquals(1.5, tempoMapPpqToBars(t, 6.0), 0.0001);
+  assertDoubleEquals(4.0, tempoMapGetBarStartPpq(t, 6.0), 0.0001);
+  assertDoubleEquals(0.0, tempoMapGetBarStartPpq(t, 3.5), 0.0001);
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testBarsWithTimeSignatureChange(void) {
+  TempoMap t = _newTestTempoMap();
+  const TempoMapTimeSignature *timeSignature;
+  // Two bars of 4/4, followed by 6/8 (3 quarter notes per bar)
+  tempoMapAddTimeSignatureChange(t, 8 * 96, 6, 8);
+  assertDoubleEquals(2.0, tempoMapPpqToBars(t, 8.0), 0.0001);
+  assertDoubleEquals(3.0, tempoMapPpqToBars(t, 11.0), 0.0001);
+  assertDoubleEquals(11.0, tempoMapGetBarStartPpq(t, 12.5), 0.0001);
+  timeSignature = tempoMapGetTimeSignatureAtPpq(t, 7.9);
+  assertIntEquals(4, timeSignature->numerator);
+  timeSignature = tempoMapGetTimeSignatureAtPpq(t, 8.0);
+  assertIntEquals(6, timeSignature->numerator);
+  assertIntEquals(8, timeSignature->denominator);
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testAddTimeSignatureChangeFromMidiBytes(void) {
+  TempoMap t = _newTestTempoMap();
+  // 3/4, with the denominator stored as a power of two
+  const byte bytes[4] = {0x03, 0x02, 0x18, 0x08};
+  tempoMapAddTimeSignatureChangeFromMidiBytes(t, 0, bytes);
+  assertSizeEquals((size_t)1, t->numTimeSignatures);
+  assertIntEquals(3, t->timeSignatures[0].numerator);
+  assertIntEquals(4, t->timeSignatures[0].denominator);
+  assertDoubleEquals(3.0, tempoMapGetBarStartPpq(t, 5.0), 0.0001);
+  freeTempoMap(t);
+  return 0;
+}
+
+static int _testFreeNullTempoMap(void) {
+  freeTempoMap(NULL);
+  return 0;
+}
+
+TestSuite addTempoMapTests(void);
+TestSuite addTempoMapTests(void) {
+  TestSuite testSuite = newTestSuite("TempoMap", NULL, NULL);
+  addTest(testSuite, "Initialization", _testNewTempoMap);
+  addTest(testSuite, "TicksToFramesConstantTempo",
+          _testTicksToFramesConstantTempo);
+  addTest(testSuite, "TicksToFramesWithTempoChange",
+          _testTicksToFramesWithTempoChange);
+  addTest(testSuite, "AddTempoChangesOutOfOrder",
+          _testAddTempoChangesOutOfOrder);
+  addTest(testSuite, "ReplaceTempoChange", _testReplaceTempoChange);
+  addTest(testSuite, "AddTempoChangeFromMidiBytes",
+          _testAddTempoChangeFromMidiBytes);
+  addTest(testSuite, "AddInvalidTempoChange", _testAddInvalidTempoChange);
+  addTest(testSuite, "FramesToTicksWithTempoChange",
+          _testFramesToTicksWithTempoChange);
+  addTest(testSuite, "GetTempoAtFrame", _testGetTempoAtFrame);
+  addTest(testSuite, "BarsDefaultTimeSignature",
+          _testBarsDefaultTimeSignature);
+  addTest(testSuite, "BarsWithTimeSignatureChange",
+          _testBarsWithTimeSignatureChange);
+  addTest(testSuite, "AddTimeSignatureChangeFromMidiBytes",
+          _testAddTimeSignatureChangeFromMidiBytes);
+  addTest(testSuite, "FreeNullTempoMap", _testFreeNullTempoMap);
+  return testSuite;
+}
@@ -32,22 +32,42 @@
 
 extern TestSuite addAudioClockTests(void);
 extern TestSuite addAudioSettingsTests(void);
+extern TestSuite addChannelMapTests(void);
 extern TestSuite addCharStringTests(void);
+extern TestSuite addDelayCompensatorTests(void);
+extern TestSuite addDelayLineTests(void);
+extern TestSuite addDoubleSampleBufferTests(void);
 extern TestSuite addEndianTests(void);
 extern TestSuite addFileTests(void);
+extern TestSuite addHashTests(void);
+extern TestSuite addJsonWriterTests(void);
+extern TestSuite addLatencyHistogramTests(void);
 extern TestSuite addLinkedListTests(void);
 extern TestSuite addMidiSequenceTests(void);
 extern TestSuite addMidiSourceTests(void);
+extern TestSuite addMidiSourceFileTests(void);
+extern TestSuite addMidiSourceStreamTests(void);
+extern TestSuite addOfflineSessionTests(void);
 extern TestSuite addPcmSampleBufferTests(void);
+extern TestSuite addParameterSweepTests(void);
+extern TestSuite addPipelineBenchmarkTests(void);
+extern TestSuite addPresetSweepTests(void);
 extern TestSuite addPlatformInfoTests(void);
 extern TestSuite addPluginTests(void);
+extern TestSuite addPluginAutomationTests(void);
 extern TestSuite addPluginChainTests(void);
+extern TestSuite addPluginGraphTests(void);
 extern TestSuite addPluginPresetTests(void);
+extern TestSuite addPluginSandboxTests(void);
 extern TestSuite addPluginVst2xIdTests(void);
 extern TestSuite addProgramOptionTests(void);
+extern TestSuite addRenderCacheTests(void);
 extern TestSuite addSampleBufferTests(void);
 extern TestSuite addSampleSourceTests(void);
+extern TestSuite addStageCacheTests(void);
 extern TestSuite addTaskTimerTests(void);
+extern TestSuite addTempoMapTests(void);
+extern TestSuite addTraceLoggerTests(void);
 
 extern TestSuite addAnalysisClippingTests(void);
 extern TestSuite addAnalysisDistortionTests(void);
@@ -71,22 +91,42 @@ LinkedList getTestSuites(File mrsWatsonExePath, File resourcesPath) {
 
   linkedListAppend(unitTestSuites, addAudioClockTests());
   linkedListAppend(unitTestSuites, addAudioSettingsTests());
+  linkedListAppend(unitTestSuites, addChannelMapTests());
   linkedListAppend(unitTestSuites, addCharStringTests());
+  linkedListAppend(unitTestSuites, addDelayCompensatorTests());
+  linkedListAppend(unitTestSuites, addDelayLineTests());
+  linkedListAppend(unitTestSuites, addDoubleSampleBufferTests());
   linkedListAppend(unitTestSuites, addEndianTests());
   linkedListAppend(unitTestSuites, addFileTests());
+  linkedListAppend(unitTestSuites, addHashTests());
+  linkedListAppend(unitTestSuites, addJsonWriterTests());
+  linkedListAppend(unitTestSuites, addLatencyHistogramTests());
   linkedListAppend(unitTestSuites, addLinkedListTests());
   linkedListAppend(unitTestSuites, addMidiSequenceTests());
   linkedListAppend(unitTestSuites, addMidiSourceTests());
+  linkedListAppend(unitTestSuites, addMidiSourceFileTests());
+  linkedListAppend(unitTestSuites, addMidiSourceStreamTests());
+  linkedListAppend(unitTestSuites, addOfflineSessionTests());
   linkedListAppend(unitTestSuites, addPcmSampleBufferTests());
+  linkedListAppend(unitTestSuites, addParameterSweepTests());
+  linkedListAppend(unitTestSuites, addPipelineBenchmarkTests());
+  linkedListAppend(unitTestSuites, addPresetSweepTests());
   linkedListAppend(unitTestSuites, addPlatformInfoTests());
   linkedListAppend(unitTestSuites, addPluginTests());
+  linkedListAppend(unitTestSuites, addPluginAutomationTests());
   linkedListAppend(unitTestSuites, addPluginChainTests());
+  linkedListAppend(unitTestSuites, addPluginGraphTests());
   linkedListAppend(unitTestSuites, addPluginPresetTests());
+  linkedListAppend(unitTestSuites, addPluginSandboxTests());
   linkedListAppend(unitTestSuites, addPluginVst2xIdTests());
   linkedListAppend(unitTestSuites, addProgramOptionTests());
+  linkedListAppend(unitTestSuites, addRenderCacheTests());
   linkedListAppend(unitTestSuites, addSampleBufferTests());
   linkedListAppend(unitTestSuites, addSampleSourceTests());
+  linkedListAppend(unitTestSuites, addStageCacheTests());
   linkedListAppend(unitTestSuites, addTaskTimerTests());
+  linkedListAppend(unitTestSuites, addTempoMapTests());
+  linkedListAppend(unitTestSuites, addTraceLoggerTests());
 
   linkedListAppend(unitTestSuites, addAnalysisClippingTests());
   linkedListAppend(unitTestSuites, addAnalysisDistortionTests());